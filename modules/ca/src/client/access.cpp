@@ -184,7 +184,7 @@ int epicsShareAPI ca_context_create (
 
         pcac = ( ca_client_context * ) epicsThreadPrivateGet ( caClientContextId );
 	    if ( pcac ) {
-            if ( premptiveCallbackSelect == ca_enable_preemptive_callback &&
+            if ( premptiveCallbackSelect != ca_disable_preemptive_callback &&
                 ! pcac->preemptiveCallbakIsEnabled() ) {
                 return ECA_NOTTHREADED;
             }
@@ -192,7 +192,8 @@ int epicsShareAPI ca_context_create (
 	    }
 
         pcac = new ca_client_context (
-            premptiveCallbackSelect == ca_enable_preemptive_callback );
+            premptiveCallbackSelect != ca_disable_preemptive_callback,
+            premptiveCallbackSelect == ca_enable_parallel_callback );
 	    if ( ! pcac ) {
 		    return ECA_ALLOCMEM;
 	    }
@@ -389,9 +390,12 @@ int epicsShareAPI ca_clear_channel ( chid pChan )
         // o user doesnt periodically call a ca function
         // o user calls this function from an auxiillary thread
         //
-        CallbackGuard cbGuard ( cac.cbMutex );
+        ContextCallbackGuard cbGuard ( cac );
         epicsGuard < epicsMutex > guard ( cac.mutex );
-        pChan->destructor ( *cac.pCallbackGuard.get(), guard );
+        if ( ! cbGuard.mayCancel ( guard, *pChan ) ) {
+            return ECA_EVDISALLOW;
+        }
+        pChan->destructor ( cbGuard, guard );
         cac.oldChannelNotifyFreeList.release ( pChan );
     }
     return ECA_NORMAL;
@@ -774,6 +778,15 @@ int epicsShareAPI ca_preemtive_callback_is_enabled ()
     return pcac->preemptiveCallbakIsEnabled ();
 }
 
+int epicsShareAPI ca_parallel_callback_is_enabled ()
+{
+    ca_client_context *pcac = (ca_client_context *) epicsThreadPrivateGet ( caClientContextId );
+    if ( ! pcac ) {
+        return 0;
+    }
+    return pcac->parallelCallbackIsEnabled ();
+}
+
 
 // extern "C"
 void epicsShareAPI ca_self_test ()
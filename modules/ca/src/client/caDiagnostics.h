@@ -19,6 +19,8 @@ extern "C" {
 
 enum appendNumberFlag {appendNumber, dontAppendNumber};
 int catime ( const char *channelName, unsigned channelCount, enum appendNumberFlag appNF );
+int catimeSelect ( const char *channelName, unsigned channelCount,
+            enum appendNumberFlag appNF, enum ca_preemptive_callback_select select );
 
 int acctst ( const char *pname, unsigned logggingInterestLevel, 
             unsigned channelCount, unsigned repetitionCount, 
@@ -14,6 +14,7 @@
 
 #include "cadef.h"
 #include "dbDefs.h"
+#include "epicsAtomic.h"
 #include "epicsTime.h"
 #include "errlog.h"
 
@@ -22,29 +23,39 @@
  */
 extern "C" void eventCallBack ( struct event_handler_args args )
 {
-    unsigned *pCount = static_cast < unsigned * > ( args.usr );
-    (*pCount)++;
+    size_t *pCount = static_cast < size_t * > ( args.usr );
+    epicsAtomicIncrSizeT ( pCount );
 }
 
 /*
  * caEventRate ()
+ *
+ * Subscribes count times to each of the named PVs and reports the
+ * aggregate rate of monitor events. When the PVs are served by
+ * different servers this measures the throughput of as many
+ * virtual circuits, which may deliver their callbacks in parallel
+ * when select is ca_enable_parallel_callback.
  */
-void caEventRate ( const char *pName, unsigned count )
+void caEventRate ( const char * const * pNames, unsigned nNames,
+    unsigned count, enum ca_preemptive_callback_select select )
 {
     static const double initialSamplePeriod = 1.0;
     static const double maxSamplePeriod = 60.0 * 5.0;
-    unsigned eventCount = 0u;
+    size_t eventCount = 0u;
+    unsigned nChannels = nNames * count;
+
+    SEVCHK ( ca_context_create ( select ), "ca_context_create" );
 
-    chid * pChidTable = new chid [ count ];
+    chid * pChidTable = new chid [ nChannels ];
 
     {
-        printf ( "Connecting to CA Channel \"%s\" %u times.", 
-                    pName, count );
+        printf ( "Connecting to %u CA Channel names %u times.", 
+                    nNames, count );
         fflush ( stdout );
     
         epicsTime begin = epicsTime::getCurrent ();
-        for ( unsigned i = 0u; i < count; i++ ) {
-            int status = ca_search ( pName,  & pChidTable[i] );
+        for ( unsigned i = 0u; i < nChannels; i++ ) {
+            int status = ca_search ( pNames[i % nNames],  & pChidTable[i] );
             SEVCHK ( status, NULL );
         }
     
@@ -56,14 +67,19 @@ void caEventRate ( const char *pName, unsigned count )
         epicsTime end = epicsTime::getCurrent ();
     
         printf ( " done(%f sec).\n", end - begin );
+        printf ( "Connected through %u virtual circuits, "
+            "%s callback.\n", ca_get_ioc_connection_count (),
+            ca_parallel_callback_is_enabled () ? "parallel" :
+            ca_preemtive_callback_is_enabled () ? "preemptive" :
+            "non-preemptive" );
     }
 
     {
-        printf ( "Subscribing %u times.", count );
+        printf ( "Subscribing %u times.", nChannels );
         fflush ( stdout );
         
         epicsTime begin = epicsTime::getCurrent ();
-        for ( unsigned i = 0u; i < count; i++ ) {
+        for ( unsigned i = 0u; i < nChannels; i++ ) {
             int addEventStatus = ca_add_event ( DBR_FLOAT, 
                 pChidTable[i], eventCallBack, &eventCount, NULL);
             SEVCHK ( addEventStatus, __FILE__ );
@@ -83,7 +99,7 @@ void caEventRate ( const char *pName, unsigned count )
     
         // let the first one go by 
         epicsTime begin = epicsTime::getCurrent ();
-        while ( eventCount < count ) {
+        while ( epicsAtomicGetSizeT ( & eventCount ) < nChannels ) {
             int status = ca_pend_event ( 0.01 );
             if ( status != ECA_TIMEOUT ) {
                 SEVCHK ( status, NULL );
@@ -99,23 +115,19 @@ void caEventRate ( const char *pName, unsigned count )
     double XX = 0.0;
     unsigned N = 0u;
     while ( true ) {
-        unsigned nEvents, lastEventCount, curEventCount;
+        size_t nEvents, lastEventCount, curEventCount;
 
         epicsTime beginPend = epicsTime::getCurrent ();
-        lastEventCount = eventCount;
+        lastEventCount = epicsAtomicGetSizeT ( & eventCount );
         int status = ca_pend_event ( samplePeriod );
-        curEventCount = eventCount;
+        curEventCount = epicsAtomicGetSizeT ( & eventCount );
         epicsTime endPend = epicsTime::getCurrent ();
         if ( status != ECA_TIMEOUT ) {
             SEVCHK ( status, NULL );
         }
 
-        if ( curEventCount >= lastEventCount ) {
-            nEvents = curEventCount - lastEventCount;
-        }
-        else {
-            nEvents = ( UINT_MAX - lastEventCount ) + curEventCount + 1u;
-        }
+        // wraps around like the count itself
+        nEvents = curEventCount - lastEventCount;
 
         N++;
 
@@ -137,3 +149,7 @@ void caEventRate ( const char *pName, unsigned count )
     }
 }
 
+void caEventRate ( const char *pName, unsigned count )
+{
+    caEventRate ( & pName, 1u, count, ca_disable_preemptive_callback );
+}
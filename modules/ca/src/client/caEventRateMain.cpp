@@ -10,29 +10,56 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-void caEventRate ( const char *pName, unsigned count );
+#include "cadef.h"
+
+void caEventRate ( const char * const * pNames, unsigned nNames,
+    unsigned count, enum ca_preemptive_callback_select select );
 
 int main ( int argc, char **argv )
 {
-    if ( argc < 2 || argc > 3 ) {
-        fprintf ( stderr, "usage: %s < PV name > [subscription count]\n", argv[0] );
-        return 0;
+    enum ca_preemptive_callback_select select =
+        ca_disable_preemptive_callback;
+    int first = 1;
+
+    while ( first < argc && argv[first][0] == '-' ) {
+        if ( strcmp ( argv[first], "-t" ) == 0 ) {
+            select = ca_enable_preemptive_callback;
+        }
+        else if ( strcmp ( argv[first], "-p" ) == 0 ) {
+            select = ca_enable_parallel_callback;
+        }
+        else {
+            break;
+        }
+        first++;
     }
 
-    unsigned count;
-    if ( argc == 3 ) {
-        int status = sscanf ( argv[2], " %u ", & count );
-        if ( status != 1 ) {
-            fprintf ( stderr, "expected unsigned integer 2nd argument\n" );
-            return 0;
+    // a trailing unsigned integer is the subscription count
+    int last = argc;
+    unsigned count = 1;
+    if ( last - first > 1 ) {
+        char dummy;
+        if ( sscanf ( argv[last - 1], " %u %c", & count, & dummy ) == 1 ) {
+            last--;
+        }
+        else {
+            count = 1;
         }
     }
-    else {
-        count = 1;
+
+    if ( last <= first || count == 0 ) {
+        fprintf ( stderr, "usage: %s [-t|-p] < PV name > "
+            "[< PV name > ...] [subscription count]\n", argv[0] );
+        fprintf ( stderr, "\t-t\tpreemptive callback\n" );
+        fprintf ( stderr, "\t-p\tparallel callback, name PVs "
+            "on different servers to measure their aggregate rate\n" );
+        return 0;
     }
 
-    caEventRate ( argv[1], count );
+    caEventRate ( argv + first, static_cast < unsigned > ( last - first ),
+        count, select );
 
     return 0;
 }
@@ -44,6 +44,7 @@ epicsShareDef epicsThreadPrivateId caClientCallbackThreadId;
 static epicsThreadOnceId cacOnce = EPICS_THREAD_ONCE_INIT;
 
 const unsigned ca_client_context :: flushBlockThreshold = 0x58000;
+static const unsigned minCallbackLanes = 2u;
 
 // runs once only for each process
 extern "C" void cacOnceFunc ( void * )
@@ -58,7 +59,8 @@ extern epicsThreadPrivateId caClientContextId;
 cacService * ca_client_context::pDefaultService = 0;
 epicsMutex * ca_client_context::pDefaultServiceInstallMutex;
 
-ca_client_context::ca_client_context ( bool enablePreemptiveCallback ) :
+ca_client_context::ca_client_context ( bool enablePreemptiveCallback,
+        bool enableParallelCallback ) :
     mutex(__FILE__, __LINE__),
     cbMutex(__FILE__, __LINE__),
     createdByThread ( epicsThreadGetIdSelf () ),
@@ -83,7 +85,18 @@ ca_client_context::ca_client_context ( bool enablePreemptiveCallback ) :
                     this->mutex, this->cbMutex, *this ) );
         }
         else {
-            this->pServiceContext.reset ( new cac ( this->mutex, this->cbMutex, *this ) );
+            // parallel callback requires preemptive callback, and
+            // it is not offered by an in-memory service
+            if ( enablePreemptiveCallback && enableParallelCallback ) {
+                unsigned nLanes = static_cast < unsigned >
+                    ( epicsThreadGetCPUs () );
+                if ( nLanes < minCallbackLanes ) {
+                    nLanes = minCallbackLanes;
+                }
+                this->pCallbackLanes.reset ( new callbackLanes ( nLanes ) );
+            }
+            this->pServiceContext.reset ( new cac ( this->mutex,
+                this->cbMutex, *this, this->pCallbackLanes.get () ) );
         }
     }
 
@@ -420,6 +433,9 @@ void ca_client_context::show ( unsigned level ) const
         this->pServiceContext->show ( guard, level - 1u );
         ::printf ( "\tpreemptive callback is %s\n",
             this->pCallbackGuard.get() ? "disabled" : "enabled" );
+        if ( this->pCallbackLanes.get () ) {
+            this->pCallbackLanes->show ( level - 1u );
+        }
         ::printf ( "\tthere are %u unsatisfied IO operations blocking ca_pend_io()\n",
                 this->pndRecvCnt );
         ::printf ( "\tthe current io sequence number is %u\n",
@@ -772,13 +788,72 @@ epicsShareFunc int epicsShareAPI ca_clear_subscription ( evid pMon )
       // o user doesnt periodically call a ca function
       // o user calls this function from an auxiillary thread
       //
-      CallbackGuard cbGuard ( cac.cbMutex );
+      ContextCallbackGuard cbGuard ( cac );
       epicsGuard < epicsMutex > guard ( cac.mutex );
+      if ( ! cbGuard.mayCancel ( guard, chan ) ) {
+          return ECA_EVDISALLOW;
+      }
       pMon->cancel ( cbGuard, guard );
     }
     return ECA_NORMAL;
 }
 
+epicsMutex * ContextCallbackGuard::laneOfThisThread (
+    ca_client_context & ctx )
+{
+    if ( ctx.pCallbackLanes.get () ) {
+        epicsMutex * pHeld = callbackLanes::heldByThisThread ();
+        if ( ctx.pCallbackLanes->owns ( pHeld ) ) {
+            return pHeld;
+        }
+    }
+    return 0;
+}
+
+epicsMutex & ContextCallbackGuard::callbackControl (
+    ca_client_context & ctx )
+{
+    epicsMutex * pLane = ContextCallbackGuard::laneOfThisThread ( ctx );
+    if ( pLane ) {
+        return *pLane;
+    }
+    return ctx.cbMutex;
+}
+
+ContextCallbackGuard::ContextCallbackGuard ( ca_client_context & ctx ) :
+    CallbackGuard ( ContextCallbackGuard::callbackControl ( ctx ) ),
+    pLockedLanes ( 0 ),
+    pOwnLane ( ContextCallbackGuard::laneOfThisThread ( ctx ) )
+{
+    if ( ctx.pCallbackLanes.get () && ! this->pOwnLane ) {
+        ctx.pCallbackLanes->lockAll ();
+        this->pLockedLanes = ctx.pCallbackLanes.get ();
+    }
+}
+
+ContextCallbackGuard::~ContextCallbackGuard ()
+{
+    if ( this->pLockedLanes ) {
+        this->pLockedLanes->unlockAll ();
+    }
+}
+
+bool ContextCallbackGuard::mayCancel (
+    epicsGuard < epicsMutex > & guard,
+    const oldChannelNotify & chan ) const
+{
+    if ( ! this->pOwnLane ) {
+        return true;
+    }
+    epicsMutex * pLane = chan.callbackLane ( guard );
+    return pLane == 0 || pLane == this->pOwnLane;
+}
+
+bool ContextCallbackGuard::withinLane () const
+{
+    return this->pOwnLane != 0;
+}
+
 void ca_client_context :: eliminateExcessiveSendBacklog (
     epicsGuard < epicsMutex > & guard, cacChannel & chan )
 {
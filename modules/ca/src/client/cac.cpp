@@ -128,12 +128,14 @@ const cac::pExcepProtoStubTCP cac::tcpExcepJumpTableCAC [] =
 cac::cac (
     epicsMutex & mutualExclusionIn,
     epicsMutex & callbackControlIn,
-    cacContextNotify & notifyIn ) :
+    cacContextNotify & notifyIn,
+    callbackLanes * pLanesIn ) :
     _refLocalHostName ( localHostNameCache.getReference () ),
     programBeginTime ( epicsTime::getMonotonic() ),
     connTMO ( CA_CONN_VERIFY_PERIOD ),
     mutex ( mutualExclusionIn ),
     cbMutex ( callbackControlIn ),
+    pCallbackLanes ( pLanesIn ),
     ipToAEngine ( ipAddrToAsciiEngine::allocate () ),
     timerQueue ( epicsTimerQueueActive::allocate ( false,
         lowestPriorityLevelAbove(epicsThreadGetPrioritySelf()) ) ),
@@ -290,23 +292,34 @@ cac::~cac ()
     // get the lock.
     {
         epicsGuard < epicsMutex > cbGuard ( this->cbMutex );
-        epicsGuard < epicsMutex > guard ( this->mutex );
-        if ( this->pudpiiu ) {
-            this->pudpiiu->shutdown ( cbGuard, guard );
-
-            // make sure no new tcp circuits are created
-            this->cacShutdownInProgress = true;
-
-            //
-            // shutdown all tcp circuits
-            //
-            tsDLIter < tcpiiu > iter = this->circuitList.firstIter ();
-            while ( iter.valid() ) {
-                // this causes a clean shutdown to occur
-                iter->unlinkAllChannels ( cbGuard, guard );
-                iter++;
+        if ( this->pCallbackLanes ) {
+            this->pCallbackLanes->lockAll ();
+        }
+        {
+            epicsGuard < epicsMutex > guard ( this->mutex );
+            if ( this->pudpiiu ) {
+                this->pudpiiu->shutdown ( cbGuard, guard );
+
+                // make sure no new tcp circuits are created
+                this->cacShutdownInProgress = true;
+
+                //
+                // shutdown all tcp circuits
+                //
+                tsDLIter < tcpiiu > iter = this->circuitList.firstIter ();
+                while ( iter.valid() ) {
+                    // this causes a clean shutdown to occur,
+                    // the circuit's lane is already held here
+                    epicsGuard < epicsMutex > laneGuard (
+                        iter->callbackControl () );
+                    iter->unlinkAllChannels ( laneGuard, guard );
+                    iter++;
+                }
             }
         }
+        if ( this->pCallbackLanes ) {
+            this->pCallbackLanes->unlockAll ();
+        }
     }
 
     //
@@ -547,11 +560,15 @@ bool cac::findOrCreateVirtCircuit (
         }
     }
     else {
+        // in parallel callback mode the circuit's lane
+        // takes the place of the callback lock
+        epicsMutex & callbackControl = this->pCallbackLanes ?
+            this->pCallbackLanes->assign ( guard ) : this->cbMutex;
         try {
             autoPtrFreeList < tcpiiu, 32, epicsMutexNOOP > pnewiiu (
                     this->freeListVirtualCircuit,
                     new ( this->freeListVirtualCircuit ) tcpiiu (
-                        *this, this->mutex, this->cbMutex, this->notify, this->connTMO,
+                        *this, this->mutex, callbackControl, this->notify, this->connTMO,
                         this->timerQueue, addr, this->comBufMemMgr, minorVersionNumber,
                         this->ipToAEngine, priority, pSearchDest ) );
 
@@ -560,26 +577,29 @@ bool cac::findOrCreateVirtCircuit (
                 pBHE = new ( this->bheFreeList )
                                     bhe ( this->mutex, epicsTime (), 0u, addr.ia );
                 if ( this->beaconTable.add ( *pBHE ) < 0 ) {
-                    return newIIU;
+                    pBHE = 0;
                 }
             }
-            this->serverTable.add ( *pnewiiu );
-            this->circuitList.add ( *pnewiiu );
-            this->iiuExistenceCount++;
-            pBHE->registerIIU ( guard, *pnewiiu );
-            piiu = pnewiiu.release ();
-            newIIU = true;
+            if ( pBHE ) {
+                this->serverTable.add ( *pnewiiu );
+                this->circuitList.add ( *pnewiiu );
+                this->iiuExistenceCount++;
+                pBHE->registerIIU ( guard, *pnewiiu );
+                piiu = pnewiiu.release ();
+                newIIU = true;
+            }
         }
         catch ( std :: exception & except ) {
             errlogPrintf (
                 "CAC: exception during virtual circuit creation \"%s\"\n",
                 except.what () );
-            return newIIU;
         }
         catch ( ... ) {
             errlogPrintf (
                 "CAC: Nonstandard exception during virtual circuit creation\n" );
-            return newIIU;
+        }
+        if ( ! newIIU && this->pCallbackLanes ) {
+            this->pCallbackLanes->release ( guard, callbackControl );
         }
     }
     return newIIU;
@@ -612,6 +632,15 @@ void cac::transferChanToVirtCircuit (
         return;
     }
 
+    /*
+     * In parallel callback mode the channel must not connect
+     * through another lane while its disconnect callback is still
+     * running on the old circuit's lane, it will be searched again
+     */
+    if ( pChan->disconnectNotifyPending ( guard ) ) {
+        return;
+    }
+
     /*
      * Ignore duplicate search replies
      */
@@ -677,7 +706,7 @@ void cac::disconnectAllIO (
     epicsGuard < epicsMutex > & guard,
     nciu & chan, tsDLList < baseNMIU > & ioList )
 {
-    cbGuard.assertIdenticalMutex ( this->cbMutex );
+    this->assertCallbackControl ( cbGuard );
     guard.assertIdenticalMutex ( this->mutex );
     char buf[128];
     chan.getHostName ( guard, buf, sizeof ( buf ) );
@@ -1018,7 +1047,7 @@ void cac::exception (
     epicsGuard < epicsMutex > & guard, int status,
     const char * pContext, const char * pFileName, unsigned lineNo )
 {
-    cbGuard.assertIdenticalMutex ( this->cbMutex );
+    this->assertCallbackControl ( cbGuard );
     guard.assertIdenticalMutex ( this->mutex );
     this->notify.exception ( guard, status, pContext,
         pFileName, lineNo );
@@ -1045,11 +1074,11 @@ bool cac::readExcep ( callbackManager &, tcpiiu &,
 
 bool cac::writeExcep (
     callbackManager & mgr,
-    tcpiiu &, const caHdrLargeArray & hdr,
+    tcpiiu & iiu, const caHdrLargeArray & hdr,
     const char * pCtx, unsigned status )
 {
     epicsGuard < epicsMutex > guard ( this->mutex );
-    nciu * pChan = this->chanTable.lookup ( hdr.m_available );
+    nciu * pChan = this->lookupChannel ( guard, iiu, hdr.m_available );
     if ( pChan ) {
         pChan->writeException ( mgr.cbGuard, guard, status, pCtx,
             hdr.m_dataType, hdr.m_count );
@@ -1116,11 +1145,11 @@ bool cac::exceptionRespAction ( callbackManager & cbMutexIn, tcpiiu & iiu,
 }
 
 bool cac::accessRightsRespAction (
-    callbackManager & mgr, tcpiiu &,
+    callbackManager & mgr, tcpiiu & iiu,
     const epicsTime &, const caHdrLargeArray & hdr, void * /* pMsgBody */ )
 {
     epicsGuard < epicsMutex > guard ( this->mutex );
-    nciu * pChan = this->chanTable.lookup ( hdr.m_cid );
+    nciu * pChan = this->lookupChannel ( guard, iiu, hdr.m_cid );
     if ( pChan ) {
         unsigned ar = hdr.m_available;
         caAccessRights accessRights (
@@ -1137,7 +1166,7 @@ bool cac::createChannelRespAction (
     const epicsTime &, const caHdrLargeArray & hdr, void * /* pMsgBody */ )
 {
     epicsGuard < epicsMutex > guard ( this->mutex );
-    nciu * pChan = this->chanTable.lookup ( hdr.m_cid );
+    nciu * pChan = this->lookupChannel ( guard, iiu, hdr.m_cid );
     if ( pChan ) {
         unsigned sidTmp;
         if ( iiu.ca_v44_ok ( guard ) ) {
@@ -1167,11 +1196,11 @@ bool cac::createChannelRespAction (
 }
 
 bool cac::verifyAndDisconnectChan (
-    callbackManager & mgr, tcpiiu &,
+    callbackManager & mgr, tcpiiu & iiu,
     const epicsTime &, const caHdrLargeArray & hdr, void * /* pMsgBody */ )
 {
     epicsGuard < epicsMutex > guard ( this->mutex );
-    nciu * pChan = this->chanTable.lookup ( hdr.m_cid );
+    nciu * pChan = this->lookupChannel ( guard, iiu, hdr.m_cid );
     if ( ! pChan ) {
         return true;
     }
@@ -1228,7 +1257,7 @@ void cac::selfTest (
 void cac::destroyIIU ( tcpiiu & iiu )
 {
     {
-        callbackManager mgr ( this->notify, this->cbMutex );
+        callbackManager mgr ( this->notify, iiu.callbackControl () );
         epicsGuard < epicsMutex > guard ( this->mutex );
 
         if ( iiu.channelCount ( guard ) ) {
@@ -1250,6 +1279,9 @@ void cac::destroyIIU ( tcpiiu & iiu )
 
         this->serverTable.remove ( iiu );
         this->circuitList.remove ( iiu );
+        if ( this->pCallbackLanes ) {
+            this->pCallbackLanes->release ( guard, iiu.callbackControl () );
+        }
     }
 
     // this destroys a timer that takes the primary mutex
@@ -47,6 +47,7 @@
 #include "netIO.h"
 #include "localHostName.h"
 #include "virtualCircuit.h"
+#include "callbackLanes.h"
 
 class netWriteNotifyIO;
 class netReadNotifyIO;
@@ -100,7 +101,10 @@ public:
     callbackManager (
         cacContextNotify &,
         epicsMutex & callbackControl );
+    ~callbackManager ();
     epicsGuard < epicsMutex > cbGuard;
+private:
+    epicsMutex * pPreviousCallbackControl;
 };
 
 class cac :
@@ -112,7 +116,8 @@ public:
     cac (
         epicsMutex & mutualExclusion,
         epicsMutex & callbackControl,
-        cacContextNotify & );
+        cacContextNotify &,
+        callbackLanes * pLanes = 0 );
     virtual ~cac ();
 
     // beacon management
@@ -141,6 +146,9 @@ public:
         epicsGuard < epicsMutex > &, nciu &, netiiu * & );
     nciu * lookupChannel (
         epicsGuard < epicsMutex > &, const cacChannel::ioid & );
+    nciu * lookupChannel (
+        epicsGuard < epicsMutex > &, const netiiu &,
+        const cacChannel::ioid & );
 
     // IO requests
     netWriteNotifyIO & writeNotifyRequest (
@@ -197,6 +205,7 @@ public:
     unsigned maxContiguousFrames ( epicsGuard < epicsMutex > & ) const;
 
     // misc
+    bool parallelCallback () const;
     const char * userNamePointer () const;
     unsigned getInitializingThreadsPriority () const;
     epicsMutex & mutexRef ();
@@ -258,8 +267,12 @@ private:
     // **** lock hierarchy ****
     // 1) callback lock must always be acquired before
     // the primary mutex if both locks are needed
+    // 2) in parallel callback mode each circuit's callback
+    // lane is taken in place of the callback lock, see
+    // callbackLanes.h
     epicsMutex & mutex;
     epicsMutex & cbMutex;
+    callbackLanes * pCallbackLanes;
     epicsEvent iiuUninstall;
     ipAddrToAsciiEngine & ipToAEngine;
     epicsTimerQueueActive & timerQueue;
@@ -287,6 +300,8 @@ private:
     void disconnectChannel (
         epicsGuard < epicsMutex > & cbGuard,
         epicsGuard < epicsMutex > & guard, nciu & chan );
+    void assertCallbackControl (
+        epicsGuard < epicsMutex > & cbGuard ) const;
 
     void ioExceptionNotify ( unsigned id, int status,
         const char * pContext, unsigned type, arrayElementCount count );
@@ -369,11 +384,25 @@ inline epicsMutex & cac::mutexRef ()
     return this->mutex;
 }
 
+inline bool cac::parallelCallback () const
+{
+    return this->pCallbackLanes != 0;
+}
+
+// in parallel callback mode the guard may be for a circuit's lane
+inline void cac::assertCallbackControl (
+    epicsGuard < epicsMutex > & cbGuard ) const
+{
+    if ( ! this->pCallbackLanes ) {
+        cbGuard.assertIdenticalMutex ( this->cbMutex );
+    }
+}
+
 inline int cac :: varArgsPrintFormated (
     epicsGuard < epicsMutex > & callbackControl,
     const char *pformat, va_list args ) const
 {
-    callbackControl.assertIdenticalMutex ( this->cbMutex );
+    this->assertCallbackControl ( callbackControl );
     return this->notify.varArgsPrintFormated ( pformat, args );
 }
 
@@ -402,10 +431,16 @@ inline notifyGuard::~notifyGuard ()
 
 inline callbackManager::callbackManager (
     cacContextNotify & notify, epicsMutex & callbackControl ) :
-    notifyGuard ( notify ), cbGuard ( callbackControl )
+    notifyGuard ( notify ), cbGuard ( callbackControl ),
+    pPreviousCallbackControl ( callbackLanes::enter ( callbackControl ) )
 {
 }
 
+inline callbackManager::~callbackManager ()
+{
+    callbackLanes::leave ( this->pPreviousCallbackControl );
+}
+
 inline nciu * cac::lookupChannel (
     epicsGuard < epicsMutex > & guard,
     const cacChannel::ioid & idIn )
@@ -414,6 +449,20 @@ inline nciu * cac::lookupChannel (
     return this->chanTable.lookup ( idIn );
 }
 
+// a circuit only speaks for the channels it serves, a stale
+// message must not reach a channel that has since moved on to
+// another circuit (and another callback lane)
+inline nciu * cac::lookupChannel (
+    epicsGuard < epicsMutex > & guard, const netiiu & iiu,
+    const cacChannel::ioid & idIn )
+{
+    nciu * pChan = this->lookupChannel ( guard, idIn );
+    if ( pChan && pChan->getConstPIIU ( guard ) != & iiu ) {
+        return 0;
+    }
+    return pChan;
+}
+
 inline const char * cac :: pLocalHostName ()
 {
     return _refLocalHostName->pointer ();
@@ -92,6 +92,12 @@ bool cacChannel::connected (
     return true;
 }
 
+epicsMutex * cacChannel::callbackLane (
+    epicsGuard < epicsMutex > & ) const
+{
+    return 0;
+}
+
 CACChannelPrivate :: 
     CACChannelPrivate() :
     _refLocalHostName ( localHostNameCache.getReference () )
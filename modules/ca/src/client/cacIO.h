@@ -254,6 +254,11 @@ public:
     // !! deprecated, avoid use  !!
     virtual const char * pHostName (
         epicsGuard < epicsMutex > & guard ) const throw ();
+    // the callback lock serializing this channel's callbacks when
+    // the service runs callbacks of different channels in parallel,
+    // nil if the service wide callback lock is used
+    virtual epicsMutex * callbackLane (
+        epicsGuard < epicsMutex > & ) const;
 
     // exceptions
     class badString {};
@@ -183,8 +183,18 @@ epicsShareFunc enum channel_state epicsShareAPI ca_state (chid chan);
 /*  Must be called once before calling any of the other routines        */
 /************************************************************************/
 epicsShareFunc int epicsShareAPI ca_task_initialize (void);
+/*
+ * ca_enable_parallel_callback is ca_enable_preemptive_callback where the
+ * callbacks of channels connected through different virtual circuits may
+ * run concurrently. The callbacks of any one channel stay serialized and
+ * in order, but connection, exception and printf handlers must be thread
+ * safe. From inside a callback only the channels (and their subscriptions)
+ * connected through the callback's own circuit may be cleared, otherwise
+ * ECA_EVDISALLOW is returned, as it is for sync group deletion and reset.
+ */
 enum ca_preemptive_callback_select 
-{ ca_disable_preemptive_callback, ca_enable_preemptive_callback };
+{ ca_disable_preemptive_callback, ca_enable_preemptive_callback,
+    ca_enable_parallel_callback };
 epicsShareFunc int epicsShareAPI 
         ca_context_create (enum ca_preemptive_callback_select select);
 epicsShareFunc void epicsShareAPI ca_detach_context (); 
@@ -840,6 +850,7 @@ epicsShareFunc int epicsShareAPI ca_replace_printf_handler (
  */
 epicsShareFunc unsigned epicsShareAPI ca_get_ioc_connection_count (void);
 epicsShareFunc int epicsShareAPI ca_preemtive_callback_is_enabled (void);
+epicsShareFunc int epicsShareAPI ca_parallel_callback_is_enabled (void);
 epicsShareFunc void epicsShareAPI ca_self_test (void);
 epicsShareFunc unsigned epicsShareAPI ca_beacon_anomaly_count (void);
 epicsShareFunc unsigned epicsShareAPI ca_search_attempts (chid chan);
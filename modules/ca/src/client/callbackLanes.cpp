@@ -0,0 +1,109 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+#include <stdio.h>
+
+#define epicsAssertAuthor "Jeff Hill johill@lanl.gov"
+
+#include "epicsAssert.h"
+#include "epicsThread.h"
+
+#define epicsExportSharedSymbols
+#include "callbackLanes.h"
+
+static epicsThreadOnceId callbackLanesOnce = EPICS_THREAD_ONCE_INIT;
+static epicsThreadPrivateId callbackLockHeldId;
+
+extern "C" void callbackLanesOnceFunc ( void * )
+{
+    callbackLockHeldId = epicsThreadPrivateCreate ();
+    assert ( callbackLockHeldId );
+}
+
+callbackLanes::callbackLanes ( unsigned nLanesIn ) :
+    pLanes ( 0 ), pCircuits ( 0 ),
+    nLanes ( nLanesIn > 0u ? nLanesIn : 1u )
+{
+    epicsThreadOnce ( & callbackLanesOnce, callbackLanesOnceFunc, 0 );
+    this->pLanes = new epicsMutex [ this->nLanes ];
+    this->pCircuits = new unsigned [ this->nLanes ];
+    for ( unsigned i = 0u; i < this->nLanes; i++ ) {
+        this->pCircuits[i] = 0u;
+    }
+}
+
+callbackLanes::~callbackLanes ()
+{
+    delete [] this->pCircuits;
+    delete [] this->pLanes;
+}
+
+// the least loaded lane, so that circuits spread evenly
+epicsMutex & callbackLanes::assign ( epicsGuard < epicsMutex > & )
+{
+    unsigned best = 0u;
+    for ( unsigned i = 1u; i < this->nLanes; i++ ) {
+        if ( this->pCircuits[i] < this->pCircuits[best] ) {
+            best = i;
+        }
+    }
+    this->pCircuits[best]++;
+    return this->pLanes[best];
+}
+
+void callbackLanes::release (
+    epicsGuard < epicsMutex > &, epicsMutex & lane )
+{
+    assert ( this->owns ( & lane ) );
+    unsigned i = static_cast < unsigned > ( & lane - this->pLanes );
+    assert ( this->pCircuits[i] > 0u );
+    this->pCircuits[i]--;
+}
+
+void callbackLanes::lockAll ()
+{
+    for ( unsigned i = 0u; i < this->nLanes; i++ ) {
+        this->pLanes[i].lock ();
+    }
+}
+
+void callbackLanes::unlockAll ()
+{
+    unsigned i = this->nLanes;
+    while ( i-- > 0u ) {
+        this->pLanes[i].unlock ();
+    }
+}
+
+void callbackLanes::show ( unsigned level ) const
+{
+    ::printf ( "\tparallel callback is enabled with %u lanes\n",
+        this->nLanes );
+    if ( level > 0u ) {
+        for ( unsigned i = 0u; i < this->nLanes; i++ ) {
+            ::printf ( "\t\tlane %u serves %u circuits\n",
+                i, this->pCircuits[i] );
+        }
+    }
+}
+
+epicsMutex * callbackLanes::heldByThisThread ()
+{
+    epicsThreadOnce ( & callbackLanesOnce, callbackLanesOnceFunc, 0 );
+    return static_cast < epicsMutex * >
+        ( epicsThreadPrivateGet ( callbackLockHeldId ) );
+}
+
+epicsMutex * callbackLanes::enter ( epicsMutex & callbackControl )
+{
+    epicsMutex * pPrevious = callbackLanes::heldByThisThread ();
+    epicsThreadPrivateSet ( callbackLockHeldId, & callbackControl );
+    return pPrevious;
+}
+
+void callbackLanes::leave ( epicsMutex * pPrevious )
+{
+    epicsThreadPrivateSet ( callbackLockHeldId, pPrevious );
+}
@@ -0,0 +1,74 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+//
+// Callback lanes for the parallel callback mode of a CA client context.
+//
+// Every virtual circuit is assigned to one lane, and the lane's mutex
+// replaces the context callback lock for everything that circuit
+// delivers. Callbacks of circuits in different lanes may therefore
+// run concurrently, while all callbacks for a particular channel are
+// still serialized by its circuit's lane.
+//
+// **** lock hierarchy ****
+// 1) the context callback lock
+// 2) the lanes, in ascending order
+// 3) the primary mutex
+// A thread delivering callbacks holds only its own lane.
+//
+
+#ifndef callbackLanesh
+#define callbackLanesh
+
+#ifdef epicsExportSharedSymbols
+#   define callbackLanesh_restore_epicsExportSharedSymbols
+#   undef epicsExportSharedSymbols
+#endif
+
+#include "epicsMutex.h"
+#include "epicsGuard.h"
+
+#ifdef callbackLanesh_restore_epicsExportSharedSymbols
+#   define epicsExportSharedSymbols
+#   include "shareLib.h"
+#endif
+
+class callbackLanes {
+public:
+    callbackLanes ( unsigned nLanes );
+    ~callbackLanes ();
+    // the caller must hold the primary mutex
+    epicsMutex & assign ( epicsGuard < epicsMutex > & );
+    void release ( epicsGuard < epicsMutex > &, epicsMutex & lane );
+    bool owns ( const epicsMutex * ) const;
+    unsigned count () const;
+    void lockAll ();
+    void unlockAll ();
+    void show ( unsigned level ) const;
+    // the callback lock held by the calling thread while it
+    // delivers callbacks, or nil
+    static epicsMutex * heldByThisThread ();
+    static epicsMutex * enter ( epicsMutex & callbackControl );
+    static void leave ( epicsMutex * pPrevious );
+private:
+    epicsMutex * pLanes;
+    unsigned * pCircuits;
+    const unsigned nLanes;
+    callbackLanes ( const callbackLanes & );
+    callbackLanes & operator = ( const callbackLanes & );
+};
+
+inline unsigned callbackLanes::count () const
+{
+    return this->nLanes;
+}
+
+inline bool callbackLanes::owns ( const epicsMutex * pMutex ) const
+{
+    return pMutex >= this->pLanes &&
+        pMutex < this->pLanes + this->nLanes;
+}
+
+#endif // ifndef callbackLanesh
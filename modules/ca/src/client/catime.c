@@ -28,6 +28,7 @@
 #define epicsAssertAuthor "Jeff Hill johill@lanl.gov"
 
 #include "epicsAssert.h"
+#include "epicsAtomic.h"
 #include "epicsTime.h"
 #include "cadef.h"
 #include "caProto.h"
@@ -40,6 +41,9 @@
 
 #define WAIT_FOR_ACK
 
+#define MONITOR_ROUNDS 10u
+#define MONITOR_TIMEOUT 10.0
+
 typedef struct testItem {
     chid                chix;
     char                name[128];
@@ -352,6 +356,84 @@ unsigned    *pInlineIter
     *pInlineIter = 1;
 }
 
+/*
+ * monitor_event ()
+ */
+static size_t monitorEventCount;
+
+static void monitor_event ( struct event_handler_args args )
+{
+    if ( args.status == ECA_NORMAL ) {
+        epicsAtomicIncrSizeT ( & monitorEventCount );
+    }
+}
+
+/*
+ * wait_for_monitor_events ()
+ */
+static int wait_for_monitor_events ( size_t target )
+{
+    epicsTimeStamp start_time;
+    epicsTimeStamp cur_time;
+
+    epicsTimeGetCurrent ( &start_time );
+    while ( epicsAtomicGetSizeT ( &monitorEventCount ) < target ) {
+        int status = ca_pend_event ( 1e-3 );
+        if ( status != ECA_TIMEOUT && status != ECA_NORMAL ) {
+            SEVCHK ( status, NULL );
+        }
+        epicsTimeGetCurrent ( &cur_time );
+        if ( epicsTimeDiffInSeconds ( &cur_time, &start_time ) >
+                MONITOR_TIMEOUT ) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * test_monitor ()
+ *
+ * Each round writes a new value to every channel and then waits for
+ * the monitor events this causes, so that when the channels are served
+ * by several servers their virtual circuits are all busy at once.
+ */
+static void test_monitor (
+ti      *pItems,
+unsigned    iterations,
+unsigned    *pInlineIter
+)
+{
+    size_t target = epicsAtomicGetSizeT ( &monitorEventCount );
+    unsigned round;
+    ti  *pi;
+    int status;
+
+    for ( round = 1u; round <= MONITOR_ROUNDS; round++ ) {
+        for ( pi = pItems; pi < &pItems[iterations]; pi++ ) {
+            dbr_double_t * pDblVal = ( dbr_double_t * ) pi->pValue;
+            int j;
+            for ( j = 0; j < pi->count; j++ ) {
+                pDblVal[j] = round;
+            }
+            status = ca_array_put ( DBR_DOUBLE, pi->count,
+                pi->chix, pi->pValue );
+            SEVCHK ( status, NULL );
+        }
+        status = ca_flush_io ();
+        SEVCHK ( status, NULL );
+        target += iterations;
+        if ( ! wait_for_monitor_events ( target ) ) {
+            printf ( "\tonly %lu of %lu monitor events arrived\n",
+                ( unsigned long ) epicsAtomicGetSizeT ( &monitorEventCount ),
+                ( unsigned long ) target );
+            break;
+        }
+    }
+
+    *pInlineIter = MONITOR_ROUNDS;
+}
+
 /*
  * measure_get_latency
  */
@@ -471,6 +553,53 @@ void timeIt ( tf *pfunc, ti *pItems, unsigned iterations,
     }
 }
 
+/*
+ * measure_monitor_throughput ()
+ */
+static void measure_monitor_throughput ( ti *pItems, unsigned iterations )
+{
+    unsigned payloadSize;
+    unsigned nBytes;
+    unsigned i;
+    evid * pMonitors;
+    int status;
+
+    pMonitors = calloc ( iterations, sizeof ( evid ) );
+    assert ( pMonitors );
+
+    epicsAtomicSetSizeT ( &monitorEventCount, 0u );
+    for ( i = 0; i < iterations; i++ ) {
+        status = ca_create_subscription ( DBR_DOUBLE, pItems[i].count,
+            pItems[i].chix, DBE_VALUE, monitor_event, NULL,
+            &pMonitors[i] );
+        SEVCHK ( status, NULL );
+    }
+    status = ca_flush_io ();
+    SEVCHK ( status, NULL );
+
+    printf ( "%u channels on %u virtual circuits, %s callback\n",
+        iterations, ca_get_ioc_connection_count (),
+        ca_parallel_callback_is_enabled () ? "parallel" :
+        ca_preemtive_callback_is_enabled () ? "preemptive" :
+        "non-preemptive" );
+
+    if ( wait_for_monitor_events ( iterations ) ) {
+        payloadSize = dbr_size_n ( DBR_DOUBLE, pItems[0].count );
+        nBytes = sizeof ( caHdr ) + CA_MESSAGE_ALIGN ( payloadSize );
+        timeIt ( test_monitor, pItems, iterations,
+            nBytes * iterations, nBytes * iterations );
+    }
+    else {
+        printf ( "\tinitial monitor events didn't arrive\n" );
+    }
+
+    for ( i = 0; i < iterations; i++ ) {
+        status = ca_clear_subscription ( pMonitors[i] );
+        SEVCHK ( status, NULL );
+    }
+    free ( pMonitors );
+}
+
 /*
  * test ()
  */
@@ -530,6 +659,17 @@ static void test ( ti *pItems, unsigned iterations )
  */
 int catime ( const char * channelName, 
     unsigned channelCount, enum appendNumberFlag appNF )
+{
+    return catimeSelect ( channelName, channelCount, appNF,
+        ca_disable_preemptive_callback );
+}
+
+/*
+ * catimeSelect ()
+ */
+int catimeSelect ( const char * channelName,
+    unsigned channelCount, enum appendNumberFlag appNF,
+    enum ca_preemptive_callback_select select )
 {
     unsigned i;
     int j;
@@ -547,7 +687,7 @@ int catime ( const char * channelName,
         return -1;
     }
 
-    SEVCHK ( ca_context_create ( ca_disable_preemptive_callback ), 
+    SEVCHK ( ca_context_create ( select ), 
         "Unable to initialize" );
 
     if ( appNF == appendNumber ) {
@@ -665,6 +805,10 @@ int catime ( const char * channelName,
     }   
     measure_get_latency ( pItemList, channelCount );
 
+    printf ( "Monitor Throughput Test\n" );
+    printf ( "-----------------------\n" );
+    measure_monitor_throughput ( pItemList, channelCount );
+
     printf ( "Free Channel Test\n" );
     printf ( "-----------------\n" );
     timeIt ( test_free, pItemList, channelCount, 0, 0 );
@@ -17,7 +17,8 @@ static const unsigned defaultIterations = 10000u;
 
 int main ( int argc, char **argv )
 {
-    const char *pUsage = "<PV name> [<channel count> [<append number to pv name if true>]]";
+    const char *pUsage = "<PV name> [<channel count> [<append number to pv name if true> "
+        "[<callback 0=non-preemptive 1=preemptive 2=parallel>]]]";
 
     if ( argc > 1 ) {
         char *pname = argv[1];
@@ -25,18 +26,22 @@ int main ( int argc, char **argv )
             int  iterations = atoi (argv[2]);
             if ( iterations > 0) {
                 if ( argc > 3 ) {
-                    if ( argc == 4 ) {
+                    if ( argc <= 5 ) {
                         int status;
                         unsigned appendNumberBool;
+                        unsigned callbackSelect = 0u;
                         status = sscanf ( argv[3], " %u ", &appendNumberBool );
-                        if ( status == 1 ) {
-                            if ( appendNumberBool ) {
-                                return catime ( pname, (unsigned) iterations, appendNumber );
-                            }
-                            else {
-                                return catime ( pname, (unsigned) iterations, dontAppendNumber );
+                        if ( status == 1 && argc == 5 ) {
+                            status = sscanf ( argv[4], " %u ", &callbackSelect );
+                            if ( callbackSelect > ca_enable_parallel_callback ) {
+                                status = 0;
                             }
                         }
+                        if ( status == 1 ) {
+                            return catimeSelect ( pname, (unsigned) iterations,
+                                appendNumberBool ? appendNumber : dontAppendNumber,
+                                (enum ca_preemptive_callback_select) callbackSelect );
+                        }
                     }
                 }
                 else {
@@ -98,6 +98,176 @@ inline epicsUInt32 dbr_htonl ( const epicsUInt32 & host )
     return tmp;
 }
 
+/*
+ * When the host stores integers and floats little endian, converting
+ * a numeric array to or from the wire is a byte order reversal of
+ * each element, which is done in bulk with vector instructions where
+ * available. AVX2 is used if the CPU supports it, SSE2 otherwise
+ * (always present on x86_64), and plain C for the last few elements.
+ */
+#if EPICS_BYTE_ORDER == EPICS_ENDIAN_LITTLE && \
+        EPICS_FLOAT_WORD_ORDER == EPICS_ENDIAN_LITTLE
+#   define CA_BULK_SWAP
+#   if defined ( __GNUC__ ) && defined ( __x86_64__ )
+#       define CA_SWAP_SSE2
+#       include <emmintrin.h>
+#       if defined ( __clang__ ) || __GNUC__ > 4 || \
+                ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 )
+#           define CA_SWAP_AVX2
+#           include <immintrin.h>
+#       endif
+#   endif
+#endif
+
+#ifdef CA_BULK_SWAP
+
+#ifdef CA_SWAP_SSE2
+/* reverse the bytes within each 16 bit lane */
+static inline __m128i swapLanes16 ( __m128i x )
+{
+    return _mm_or_si128 ( _mm_slli_epi16 ( x, 8 ), _mm_srli_epi16 ( x, 8 ) );
+}
+
+/* returns the number of bytes converted, a multiple of 16 */
+static size_t swapSSE2 ( const char * pSrc, char * pDest,
+    size_t nBytes, unsigned size )
+{
+    size_t i = 0u;
+    switch ( size ) {
+    case 2:
+        for ( ; i + 16u <= nBytes; i += 16u ) {
+            __m128i x = _mm_loadu_si128 ( ( const __m128i * ) ( pSrc + i ) );
+            _mm_storeu_si128 ( ( __m128i * ) ( pDest + i ), swapLanes16 ( x ) );
+        }
+        break;
+    case 4:
+        for ( ; i + 16u <= nBytes; i += 16u ) {
+            __m128i x = _mm_loadu_si128 ( ( const __m128i * ) ( pSrc + i ) );
+            x = _mm_shufflelo_epi16 ( x, _MM_SHUFFLE ( 2, 3, 0, 1 ) );
+            x = _mm_shufflehi_epi16 ( x, _MM_SHUFFLE ( 2, 3, 0, 1 ) );
+            _mm_storeu_si128 ( ( __m128i * ) ( pDest + i ), swapLanes16 ( x ) );
+        }
+        break;
+    case 8:
+        for ( ; i + 16u <= nBytes; i += 16u ) {
+            __m128i x = _mm_loadu_si128 ( ( const __m128i * ) ( pSrc + i ) );
+            x = _mm_shufflelo_epi16 ( x, _MM_SHUFFLE ( 0, 1, 2, 3 ) );
+            x = _mm_shufflehi_epi16 ( x, _MM_SHUFFLE ( 0, 1, 2, 3 ) );
+            _mm_storeu_si128 ( ( __m128i * ) ( pDest + i ), swapLanes16 ( x ) );
+        }
+        break;
+    }
+    return i;
+}
+#endif /* CA_SWAP_SSE2 */
+
+#ifdef CA_SWAP_AVX2
+/* byte shuffle masks for each element size, repeated for both lanes */
+static const epicsUInt8 swapMask [3][32] = {
+    { 1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14,
+      1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14 },
+    { 3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+      3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12 },
+    { 7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8,
+      7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8 }
+};
+
+/* returns the number of bytes converted, a multiple of 32 */
+__attribute__ (( target ( "avx2" ) ))
+static size_t swapAVX2 ( const char * pSrc, char * pDest,
+    size_t nBytes, unsigned size )
+{
+    const epicsUInt8 * pMask = swapMask [ size == 2u ? 0 : size == 4u ? 1 : 2 ];
+    const __m256i mask = _mm256_loadu_si256 ( ( const __m256i * ) pMask );
+    size_t i = 0u;
+    for ( ; i + 64u <= nBytes; i += 64u ) {
+        __m256i x = _mm256_loadu_si256 ( ( const __m256i * ) ( pSrc + i ) );
+        __m256i y = _mm256_loadu_si256 ( ( const __m256i * ) ( pSrc + i + 32u ) );
+        _mm256_storeu_si256 ( ( __m256i * ) ( pDest + i ),
+            _mm256_shuffle_epi8 ( x, mask ) );
+        _mm256_storeu_si256 ( ( __m256i * ) ( pDest + i + 32u ),
+            _mm256_shuffle_epi8 ( y, mask ) );
+    }
+    for ( ; i + 32u <= nBytes; i += 32u ) {
+        __m256i x = _mm256_loadu_si256 ( ( const __m256i * ) ( pSrc + i ) );
+        _mm256_storeu_si256 ( ( __m256i * ) ( pDest + i ),
+            _mm256_shuffle_epi8 ( x, mask ) );
+    }
+    return i;
+}
+
+static bool haveAVX2 ()
+{
+    __builtin_cpu_init ();
+    return __builtin_cpu_supports ( "avx2" ) != 0;
+}
+
+static const bool useAVX2 = haveAVX2 ();
+#endif /* CA_SWAP_AVX2 */
+
+/*
+ * Reverse the byte order of num elements of size 2, 4 or 8 bytes.
+ * The source and destination may be the same array.
+ */
+static void swapArray ( const void * s, void * d,
+    arrayElementCount num, unsigned size )
+{
+    const char * pSrc = static_cast < const char * > ( s );
+    char * pDest = static_cast < char * > ( d );
+    size_t nBytes = num * size;
+    size_t done = 0u;
+
+#   ifdef CA_SWAP_AVX2
+        if ( useAVX2 ) {
+            done = swapAVX2 ( pSrc, pDest, nBytes, size );
+        }
+#   endif
+#   ifdef CA_SWAP_SSE2
+        done += swapSSE2 ( pSrc + done, pDest + done, nBytes - done, size );
+#   endif
+
+    arrayElementCount i = done / size;
+    switch ( size ) {
+    case 2:
+        {
+            const epicsUInt16 * pS = static_cast < const epicsUInt16 * > ( s );
+            epicsUInt16 * pD = static_cast < epicsUInt16 * > ( d );
+            for ( ; i < num; i++ ) {
+                epicsUInt16 x = pS[i];
+                pD[i] = static_cast < epicsUInt16 > ( ( x << 8u ) | ( x >> 8u ) );
+            }
+        }
+        break;
+    case 4:
+        {
+            const epicsUInt32 * pS = static_cast < const epicsUInt32 * > ( s );
+            epicsUInt32 * pD = static_cast < epicsUInt32 * > ( d );
+            for ( ; i < num; i++ ) {
+                epicsUInt32 x = pS[i];
+                pD[i] = ( x << 24u ) | ( ( x & 0xff00u ) << 8u ) |
+                    ( ( x >> 8u ) & 0xff00u ) | ( x >> 24u );
+            }
+        }
+        break;
+    case 8:
+        {
+            const epicsUInt32 * pS = static_cast < const epicsUInt32 * > ( s );
+            epicsUInt32 * pD = static_cast < epicsUInt32 * > ( d );
+            for ( ; i < num; i++ ) {
+                epicsUInt32 lo = pS[2*i];
+                epicsUInt32 hi = pS[2*i+1];
+                pD[2*i] = ( hi << 24u ) | ( ( hi & 0xff00u ) << 8u ) |
+                    ( ( hi >> 8u ) & 0xff00u ) | ( hi >> 24u );
+                pD[2*i+1] = ( lo << 24u ) | ( ( lo & 0xff00u ) << 8u ) |
+                    ( ( lo >> 8u ) & 0xff00u ) | ( lo >> 24u );
+            }
+        }
+        break;
+    }
+}
+
+#endif /* CA_BULK_SWAP */
+
 /*
  * if hton is true then it is a host to network conversion
  * otherwise vise-versa
@@ -138,6 +308,9 @@ arrayElementCount   num         /* number of values     */
     dbr_short_t         *pSrc = (dbr_short_t *) s;
     dbr_short_t         *pDest = (dbr_short_t *) d;
 
+#ifdef CA_BULK_SWAP
+    swapArray ( pSrc, pDest, num, sizeof ( dbr_short_t ) );
+#else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htons( pSrc[i] );
@@ -148,6 +321,7 @@ arrayElementCount   num         /* number of values     */
             pDest[i] = dbr_ntohs( pSrc[i] );
         }
     }
+#endif
 }
 
 /*
@@ -188,6 +362,9 @@ arrayElementCount   num         /* number of values     */
     dbr_long_t          *pSrc = (dbr_long_t *) s;
     dbr_long_t          *pDest = (dbr_long_t *) d;
 
+#ifdef CA_BULK_SWAP
+    swapArray ( pSrc, pDest, num, sizeof ( dbr_long_t ) );
+#else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htonl( pSrc[i] );
@@ -198,6 +375,7 @@ arrayElementCount   num         /* number of values     */
             pDest[i] = dbr_ntohl( pSrc[i] );
         }
     }
+#endif
 }
 
 /*
@@ -217,6 +395,9 @@ arrayElementCount   num         /* number of values     */
     dbr_enum_t          *pSrc = (dbr_enum_t *) s;
     dbr_enum_t          *pDest = (dbr_enum_t *) d;
 
+#ifdef CA_BULK_SWAP
+    swapArray ( pSrc, pDest, num, sizeof ( dbr_enum_t ) );
+#else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             pDest[i] = dbr_htons ( pSrc[i] );
@@ -227,6 +408,7 @@ arrayElementCount   num         /* number of values     */
             pDest[i] = dbr_ntohs ( pSrc[i] );
         }
     }
+#endif
 }
 
 /*
@@ -248,6 +430,9 @@ arrayElementCount   num         /* number of values     */
     const dbr_float_t   *pSrc = (const dbr_float_t *) s;
     dbr_float_t         *pDest = (dbr_float_t *) d;
 
+#ifdef CA_BULK_SWAP
+    swapArray ( pSrc, pDest, num, sizeof ( dbr_float_t ) );
+#else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             dbr_htonf ( &pSrc[i], &pDest[i] );
@@ -258,6 +443,7 @@ arrayElementCount   num         /* number of values     */
             dbr_ntohf ( &pSrc[i], &pDest[i] );
         }
     }
+#endif
 }
 
 /*
@@ -273,6 +459,9 @@ arrayElementCount   num         /* number of values     */
     dbr_double_t        *pSrc = (dbr_double_t *) s;
     dbr_double_t        *pDest = (dbr_double_t *) d;
 
+#ifdef CA_BULK_SWAP
+    swapArray ( pSrc, pDest, num, sizeof ( dbr_double_t ) );
+#else
     if(encode){
         for(arrayElementCount i=0; i<num; i++){
             dbr_htond ( &pSrc[i], &pDest[i] );
@@ -283,6 +472,7 @@ arrayElementCount   num         /* number of values     */
             dbr_ntohd( &pSrc[i], &pDest[i] );
         }
     }
+#endif
 }
 
 /****************************************************************************
@@ -1081,7 +1271,7 @@ arrayElementCount   num         /* number of values     */
         pDest->value = dbr_ntohl(pSrc->value);
     else        /* array chan-- multiple pts */
     {
-        cvrt_long(&pDest->value, &pSrc->value, encode, num);
+        cvrt_long(&pSrc->value, &pDest->value, encode, num);
     }
 }
 
@@ -1301,7 +1491,7 @@ arrayElementCount   num         /* number of values     */
         pDest->value = dbr_ntohl(pSrc->value);
     else        /* array chan-- multiple pts */
     {
-        cvrt_long(&pDest->value, &pSrc->value, encode, num);
+        cvrt_long(&pSrc->value, &pDest->value, encode, num);
     }
 }
 
@@ -44,6 +44,7 @@ nciu::nciu ( cac & cacIn, netiiu & iiuIn, cacChannelNotify & chanIn,
     cacChannel ( chanIn ),
     cacCtx ( cacIn ),
     piiu ( & iiuIn ),
+    pDisconnectNotifyLane ( 0 ),
     sid ( UINT_MAX ),
     count ( 0 ),
     retry ( 0u ),
@@ -166,6 +167,9 @@ void nciu::unresponsiveCircuitNotify (
     ioid tmpId = this->getId ();
     cac & caRefTmp = this->cacCtx;
     guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    if ( caRefTmp.parallelCallback () ) {
+        this->pDisconnectNotifyLane = callbackLanes::heldByThisThread ();
+    }
     this->cacCtx.disconnectAllIO ( cbGuard, guard,
         *this, this->eventq );
     this->notify().disconnectNotify ( guard );
@@ -180,6 +184,20 @@ void nciu::unresponsiveCircuitNotify (
         // handler so we have to be very careful to not touch this
         // object from here on down
     }
+    pChan = caRefTmp.lookupChannel ( guard, tmpId );
+    if ( pChan ) {
+        pChan->pDisconnectNotifyLane = 0;
+    }
+}
+
+epicsMutex * nciu::callbackLane (
+    epicsGuard < epicsMutex > & guard ) const
+{
+    guard.assertIdenticalMutex ( this->cacCtx.mutexRef () );
+    if ( this->pDisconnectNotifyLane ) {
+        return this->pDisconnectNotifyLane;
+    }
+    return this->piiu->callbackLane ( guard );
 }
 
 void nciu::setServerAddressUnknown ( netiiu & newiiu,
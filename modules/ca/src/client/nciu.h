@@ -207,6 +207,10 @@ public:
         epicsGuard < epicsMutex > &, epicsGuard < epicsMutex > & );
     bool connected ( epicsGuard < epicsMutex > & ) const;
     unsigned getcount() const { return count; }
+    bool disconnectNotifyPending (
+        epicsGuard < epicsMutex > & ) const;
+    epicsMutex * callbackLane (
+        epicsGuard < epicsMutex > & ) const;
 
 private:
     tsDLList < class baseNMIU > eventq;
@@ -214,6 +218,9 @@ private:
     cac & cacCtx;
     char * pNameStr;
     netiiu * piiu;
+    // the lane running our disconnect callbacks in parallel
+    // callback mode, the channel has already left its circuit
+    epicsMutex * pDisconnectNotifyLane;
     ca_uint32_t sid; // server id
     unsigned count;
     unsigned retry; // search retry number
@@ -349,6 +356,12 @@ inline const netiiu * nciu::getConstPIIU (
     return this->piiu;
 }
 
+inline bool nciu::disconnectNotifyPending (
+    epicsGuard < epicsMutex > & ) const
+{
+    return this->pDisconnectNotifyLane != 0;
+}
+
 inline cac & nciu::getClient ()
 {
     return this->cacCtx;
@@ -172,3 +172,9 @@ bool netiiu::searchMsg (
 }
 
 
+
+epicsMutex * netiiu::callbackLane (
+    epicsGuard < epicsMutex > & ) const
+{
+    return 0;
+}
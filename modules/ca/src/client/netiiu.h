@@ -92,6 +92,9 @@ public:
     virtual bool searchMsg (
         epicsGuard < epicsMutex > &, ca_uint32_t id, 
             const char * pName, unsigned nameLength ) = 0;
+    // the parallel callback lane serving this circuit, or nil
+    virtual epicsMutex * callbackLane (
+        epicsGuard < epicsMutex > & ) const;
 };
 
 #endif // netiiuh
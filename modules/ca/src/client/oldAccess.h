@@ -47,6 +47,8 @@
 #include "cadef.h"
 #include "syncGroup.h"
 
+class callbackLanes;
+
 struct oldChannelNotify : private cacChannelNotify {
 public:
     oldChannelNotify (
@@ -133,6 +135,8 @@ public:
     ca_client_context & getClientCtx ();
     void eliminateExcessiveSendBacklog (
         epicsGuard < epicsMutex > & );
+    epicsMutex * callbackLane (
+        epicsGuard < epicsMutex > & ) const;
 
     void * operator new ( size_t size,
         tsFreeList < struct oldChannelNotify, 1024, epicsMutexNOOP > & );
@@ -293,7 +297,8 @@ extern "C" void cacOnceFunc ( void * );
 struct ca_client_context : public cacContextNotify
 {
 public:
-    ca_client_context ( bool enablePreemptiveCallback = false );
+    ca_client_context ( bool enablePreemptiveCallback = false,
+        bool enableParallelCallback = false );
     virtual ~ca_client_context ();
     void changeExceptionEvent (
         caExceptionHandler * pfunc, void * arg );
@@ -340,6 +345,7 @@ public:
     void vSignal ( int ca_status, const char * pfilenm,
                      int lineno, const char  *pFormat, va_list args );
     bool preemptiveCallbakIsEnabled () const;
+    bool parallelCallbackIsEnabled () const;
     void destroyGetCopy ( epicsGuard < epicsMutex > &, getCopy & );
     void destroyGetCallback ( epicsGuard < epicsMutex > &, getCallback & );
     void destroyPutCallback ( epicsGuard < epicsMutex > &, putCallback & );
@@ -384,8 +390,9 @@ public:
     friend int ca_sync_group_destroy ( CallbackGuard & cbGuard,
                                  epicsGuard < epicsMutex > & guard,
                                 ca_client_context & cac, const CA_SYNC_GID gid );
-    friend void sync_group_reset ( ca_client_context & client, 
+    friend int sync_group_reset ( ca_client_context & client,
                                                   CASG & sg );
+    friend class ContextCallbackGuard;
 
     // exceptions
     class noSocket {};
@@ -403,6 +410,7 @@ private:
     epicsEvent callbackThreadActivityComplete;
     epicsThreadId createdByThread;
     std::auto_ptr < CallbackGuard > pCallbackGuard;
+    std::auto_ptr < callbackLanes > pCallbackLanes;
     std::auto_ptr < cacContext > pServiceContext;
     caExceptionHandler * ca_exception_func;
     void * ca_exception_arg;
@@ -433,6 +441,28 @@ private:
     static const unsigned flushBlockThreshold;
 };
 
+// The callback lock needed to cancel IO or to destroy a channel from
+// the API. In parallel callback mode a thread delivering callbacks
+// keeps to its own lane while any other thread takes the context
+// callback lock followed by every lane.
+class ContextCallbackGuard : public CallbackGuard {
+public:
+    ContextCallbackGuard ( ca_client_context & );
+    ~ContextCallbackGuard ();
+    // false if this thread is delivering callbacks on a lane
+    // and the channel's callbacks are delivered on another
+    bool mayCancel ( epicsGuard < epicsMutex > &,
+        const oldChannelNotify & ) const;
+    bool withinLane () const;
+private:
+    callbackLanes * pLockedLanes;
+    epicsMutex * pOwnLane;
+    static epicsMutex * laneOfThisThread ( ca_client_context & );
+    static epicsMutex & callbackControl ( ca_client_context & );
+    ContextCallbackGuard ( const ContextCallbackGuard & );
+    ContextCallbackGuard & operator = ( const ContextCallbackGuard & );
+};
+
 int fetchClientContext ( ca_client_context * * ppcac );
 
 inline ca_client_context & oldChannelNotify::getClientCtx ()
@@ -481,6 +511,12 @@ inline void oldChannelNotify::eliminateExcessiveSendBacklog (
     this->cacCtx.eliminateExcessiveSendBacklog ( guard, this->io );
 }
 
+inline epicsMutex * oldChannelNotify::callbackLane (
+    epicsGuard < epicsMutex > & guard ) const
+{
+    return this->io.callbackLane ( guard );
+}
+
 inline void * oldChannelNotify::operator new ( size_t size,
     tsFreeList < struct oldChannelNotify, 1024, epicsMutexNOOP > & freeList )
 {
@@ -568,6 +604,11 @@ inline bool ca_client_context::preemptiveCallbakIsEnabled () const
     return this->pCallbackGuard.get () == 0;
 }
 
+inline bool ca_client_context::parallelCallbackIsEnabled () const
+{
+    return this->pCallbackLanes.get () != 0;
+}
+
 inline bool ca_client_context::ioComplete () const
 {
     return ( this->pndRecvCnt == 0u );
@@ -600,7 +641,10 @@ void ca_client_context :: whenThereIsAnExceptionDestroySyncGroupIO (
             // o user doesnt periodically call a ca function
             // o user calls this function from an auxiillary thread
             //
-            CallbackGuard cbGuard ( this->cbMutex );
+            // the IO failed to start so no callback can be in
+            // progress for it, a lane thread keeps to its lane
+            //
+            ContextCallbackGuard cbGuard ( *this );
             epicsGuard < epicsMutex > guard ( this->mutex );
             io.destroy ( cbGuard, guard );
         }
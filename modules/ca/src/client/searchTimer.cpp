@@ -21,6 +21,7 @@
 #include <stdexcept>
 #include <string> // vxWorks 6.0 requires this include 
 #include <limits.h>
+#include <math.h>
 
 #define epicsAssertAuthor "Jeff Hill johill@lanl.gov"
 
@@ -33,6 +34,8 @@
 
 static const unsigned initialTriesPerFrame = 1u; // initial UDP frames per search try
 static const unsigned maxTriesPerFrame = 64u; // max UDP frames per search try 
+static const unsigned maxFramesPerBurst = 8u; // max UDP frames sent back to back
+static const double responseRatioTolerance = 1.0 / 8.0; // drop taken as congestion
 
 //
 // searchTimer::searchTimer ()
@@ -49,6 +52,8 @@ searchTimer::searchTimer (
     mutex ( mutexIn ),
     framesPerTry ( initialTriesPerFrame ),
     framesPerTryCongestThresh ( DBL_MAX ),
+    responseRatio ( 1.0 ),
+    framesThisTry ( 0u ),
     retry ( 0 ),
     searchAttempts ( 0u ),
     searchResponses ( 0u ),
@@ -56,7 +61,8 @@ searchTimer::searchTimer (
     dgSeqNoAtTimerExpireBegin ( 0u ),
     dgSeqNoAtTimerExpireEnd ( 0u ),
     boostPossible ( boostPossibleIn ),
-    stopped ( false )
+    stopped ( false ),
+    tryInProgress ( false )
 {
 }
 
@@ -120,13 +126,11 @@ void searchTimer::moveChannels (
 }
 
 //
-// searchTimer::expire ()
+// searchTimer::beginTry ()
 //
-epicsTimerNotify::expireStatus searchTimer::expire ( 
-    const epicsTime & currentTime )
+void searchTimer::beginTry ( 
+    epicsGuard < epicsMutex > & guard, const epicsTime & currentTime )
 {
-    epicsGuard < epicsMutex > guard ( this->mutex );
-
     while ( nciu * pChan = this->chanListRespPending.get () ) {
         pChan->channelNode::listMember = 
             channelNode::cs_none;
@@ -146,92 +150,95 @@ epicsTimerNotify::expireStatus searchTimer::expire (
         }
     }
 
-    if ( this->searchAttempts ) {
-#if 0
-        //
-        // dynamically adjust the number of UDP frames per 
-        // try depending how many search requests are not 
-        // replied to
-        //
-        // The variable this->framesPerTry
-        // determines the number of UDP frames to be sent
-        // each time that expire() is called.
-        // If this value is too high we will waste some
-        // network bandwidth. If it is too low we will
-        // use very little of the incoming UDP message
-        // buffer associated with the server's port and
-        // will therefore take longer to connect. We 
-        // initialize this->framesPerTry to a prime number 
-        // so that it is less likely that the
-        // same channel is in the last UDP frame
-        // sent every time that this is called (and
-        // potentially discarded by a CA server with
-        // a small UDP input queue). 
-        //
-        // increase frames per try only if we see better than
-        // a 93.75% success rate for one pass through the list
-        //
-        if ( this->searchResponses >
-            ( this->searchAttempts - (this->searchAttempts/16u) ) ) {
-            // increase UDP frames per try if we have a good score
-            if ( this->framesPerTry < maxTriesPerFrame ) {
-                // a congestion avoidance threshold similar to TCP is now used
-                if ( this->framesPerTry < this->framesPerTryCongestThresh ) {
-                    this->framesPerTry += this->framesPerTry;
+    this->updateFramesPerTry ();
+
+    this->dgSeqNoAtTimerExpireBegin = 
+        this->iiu.datagramSeqNumber ( guard );
+
+    this->searchAttempts = 0;
+    this->searchResponses = 0;
+    this->framesThisTry = 0u;
+}
+
+//
+// searchTimer::updateFramesPerTry ()
+//
+// Dynamically adjust the number of UDP frames per try depending
+// on how many of the last try's search requests were answered,
+// with a congestion avoidance threshold similar to TCP.
+//
+// Channels that dont exist anywhere are never answered, so only
+// a response ratio clearly below the ratio this timer usually
+// sees is taken as a sign of congestion. Otherwise a few missing
+// channels in the list would keep the timer at one frame per try.
+//
+void searchTimer::updateFramesPerTry ()
+{
+    if ( ! this->searchAttempts ) {
+        return;
+    }
+
+    double ratio = static_cast < double > ( this->searchResponses ) / 
+        this->searchAttempts;
+
+    if ( ratio + responseRatioTolerance >= this->responseRatio ) {
+        // increase UDP frames per try if we have a good score
+        if ( this->framesPerTry < maxTriesPerFrame ) {
+            if ( this->framesPerTry < this->framesPerTryCongestThresh ) {
+                double doubled = 2 * this->framesPerTry;
+                if ( doubled > this->framesPerTryCongestThresh ) {
+                    this->framesPerTry = this->framesPerTryCongestThresh;
                 }
                 else {
-                    this->framesPerTry += (this->framesPerTry/8) + 1;
+                    this->framesPerTry = doubled;
                 }
-                debugPrintf ( ("Increasing frame count to %u t=%u r=%u\n", 
-                    this->framesPerTry, this->searchAttempts, this->searchResponses) );
             }
-        }
-        // if we detect congestion because we have less than a 87.5% success 
-        // rate then gradually reduce the frames per try
-        else if ( this->searchResponses < 
-            ( this->searchAttempts - (this->searchAttempts/8u) ) ) {
-            if ( this->framesPerTry > 1 ) {
-                this->framesPerTry--;
+            else {
+                this->framesPerTry += 1.0 / this->framesPerTry;
             }
-            this->framesPerTryCongestThresh = this->framesPerTry/2 + 1;
-            debugPrintf ( ("Congestion detected - set frames per try to %f t=%u r=%u\n", 
-                this->framesPerTry, this->searchAttempts, this->searchResponses) );
-        }
-#else
-        if ( this->searchResponses == this->searchAttempts ) {
-            // increase UDP frames per try if we have a good score
-            if ( this->framesPerTry < maxTriesPerFrame ) {
-                // a congestion avoidance threshold similar to TCP is now used
-                if ( this->framesPerTry < this->framesPerTryCongestThresh ) {
-                    double doubled = 2 * this->framesPerTry;
-                    if ( doubled > this->framesPerTryCongestThresh ) {
-                        this->framesPerTry = this->framesPerTryCongestThresh;
-                    }
-                    else {
-                        this->framesPerTry = doubled;
-                    }
-                }
-                else {
-                    this->framesPerTry += 1.0 / this->framesPerTry;
-                }
-                debugPrintf ( ("Increasing frame count to %g t=%u r=%u\n", 
-                    this->framesPerTry, this->searchAttempts, this->searchResponses) );
+            if ( this->framesPerTry > maxTriesPerFrame ) {
+                this->framesPerTry = maxTriesPerFrame;
             }
-        }
-        else  {
-            this->framesPerTryCongestThresh = this->framesPerTry / 2.0;
-            this->framesPerTry = 1u;
-            debugPrintf ( ("Congestion detected - set frames per try to %g t=%u r=%u\n", 
+            debugPrintf ( ("Increasing frame count to %g t=%u r=%u\n", 
                 this->framesPerTry, this->searchAttempts, this->searchResponses) );
         }
-#endif
+        this->responseRatio += ( ratio - this->responseRatio ) / 4.0;
+    }
+    else  {
+        this->framesPerTry /= 2.0;
+        if ( this->framesPerTry < initialTriesPerFrame ) {
+            this->framesPerTry = initialTriesPerFrame;
+        }
+        this->framesPerTryCongestThresh = this->framesPerTry;
+        // slowly follow a lasting change in the mix of channels
+        this->responseRatio += ( ratio - this->responseRatio ) / 8.0;
+        debugPrintf ( ("Congestion detected - set frames per try to %g t=%u r=%u\n", 
+            this->framesPerTry, this->searchAttempts, this->searchResponses) );
     }
+}
 
-    this->dgSeqNoAtTimerExpireBegin = 
-        this->iiu.datagramSeqNumber ( guard );
+//
+// searchTimer::expire ()
+//
+// A try is sent in bursts of at most maxFramesPerBurst frames,
+// spread over half of the period, so that a large try does not
+// reach the servers (and the switches in between) as one long
+// burst. The next try begins one period after the last burst.
+//
+epicsTimerNotify::expireStatus searchTimer::expire ( 
+    const epicsTime & currentTime )
+{
+    epicsGuard < epicsMutex > guard ( this->mutex );
 
-    this->searchAttempts = 0;
-    this->searchResponses = 0;
+    if ( ! this->tryInProgress ) {
+        this->beginTry ( guard, currentTime );
+    }
+
+    unsigned tryLimit = static_cast < unsigned > ( ceil ( this->framesPerTry ) );
+    unsigned burstLimit = tryLimit - this->framesThisTry;
+    if ( burstLimit > maxFramesPerBurst ) {
+        burstLimit = maxFramesPerBurst;
+    }
 
     unsigned nFrameSent = 0u;
     while ( true ) {
@@ -247,7 +254,7 @@ epicsTimerNotify::expireStatus searchTimer::expire (
         if ( ! success ) {
             if ( this->iiu.datagramFlush ( guard, currentTime ) ) {
                 nFrameSent++;
-                if ( nFrameSent < this->framesPerTry ) {
+                if ( nFrameSent < burstLimit ) {
                     success = pChan->searchMsg ( guard );
                 }
             }
@@ -272,6 +279,7 @@ epicsTimerNotify::expireStatus searchTimer::expire (
     if ( this->iiu.datagramFlush ( guard, currentTime ) ) {
         nFrameSent++;
     }
+    this->framesThisTry += nFrameSent;
 
     this->dgSeqNoAtTimerExpireEnd = 
         this->iiu.datagramSeqNumber ( guard ) - 1u;
@@ -285,6 +293,12 @@ epicsTimerNotify::expireStatus searchTimer::expire (
         }
 #   endif
 
+    this->tryInProgress = this->framesThisTry < tryLimit && 
+        this->chanListReqPending.count () > 0u;
+    if ( this->tryInProgress ) {
+        return expireStatus ( restart, this->period ( guard ) * 
+            maxFramesPerBurst / ( 2.0 * tryLimit ) );
+    }
     return expireStatus ( restart, this->period ( guard ) );
 }
 
@@ -293,6 +307,9 @@ void searchTimer :: show ( unsigned level ) const
     epicsGuard < epicsMutex > guard ( this->mutex );
     ::printf ( "searchTimer with period %f\n", this->period ( guard ) );
     if ( level > 0 ) {
+        ::printf ( "frames per try = %g, congestion threshold = %g, "
+            "usual response ratio = %.3f\n", this->framesPerTry,
+            this->framesPerTryCongestThresh, this->responseRatio );
         ::printf ( "channels with search request pending = %u\n", 
             this->chanListReqPending.count () );
         if ( level > 1u ) {
@@ -348,7 +365,8 @@ void searchTimer::uninstallChanDueToSuccessfulSearchResponse (
 
         if ( this->searchResponses < UINT_MAX ) {
             this->searchResponses++;
-            if ( this->searchResponses == this->searchAttempts ) {
+            if ( this->searchResponses == this->searchAttempts && 
+                    ! this->tryInProgress ) {
                 if ( this->chanListReqPending.count () ) {
                     //
                     // when we get 100% success immediately 
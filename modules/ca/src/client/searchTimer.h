@@ -90,6 +90,8 @@ private:
     epicsMutex & mutex;
     double framesPerTry; /* # of UDP frames per search try */
     double framesPerTryCongestThresh; /* one half N tries w congest */
+    double responseRatio; /* usual fraction of search requests answered */
+    unsigned framesThisTry; /* # of UDP frames sent so far this try */
     unsigned retry;
     unsigned searchAttempts; /* num search tries after last timer experation */
     unsigned searchResponses; /* num search resp after last timer experation */
@@ -98,9 +100,13 @@ private:
     ca_uint32_t dgSeqNoAtTimerExpireEnd;
     const bool boostPossible;
     bool stopped;
+    bool tryInProgress; /* more bursts to send before the try ends */
 
     expireStatus expire ( const epicsTime & currentTime );
     double period ( epicsGuard < epicsMutex > & ) const;
+    void beginTry ( epicsGuard < epicsMutex > &, 
+        const epicsTime & currentTime );
+    void updateFramesPerTry ();
 	searchTimer ( const searchTimer & ); // not implemented
 	searchTimer & operator = ( const searchTimer & ); // not implemented
 };
@@ -87,7 +87,12 @@ extern "C" int epicsShareAPI ca_sg_delete ( const CA_SYNC_GID gid )
           // o user doesnt periodically call a ca function
           // o user calls this function from an auxiillary thread
           //
-          CallbackGuard cbGuard ( pcac->cbMutex );
+          // the group's IO may be spread over several callback lanes
+          //
+          ContextCallbackGuard cbGuard ( *pcac );
+          if ( cbGuard.withinLane () ) {
+              return ECA_EVDISALLOW;
+          }
           epicsGuard < epicsMutex > guard ( pcac->mutex );
           caStatus = ca_sync_group_destroy ( cbGuard, guard, *pcac, gid );
         }
@@ -95,7 +100,7 @@ extern "C" int epicsShareAPI ca_sg_delete ( const CA_SYNC_GID gid )
     return caStatus;
 }
 
-void sync_group_reset ( ca_client_context & client, CASG & sg )
+int sync_group_reset ( ca_client_context & client, CASG & sg )
 {
     if ( client.pCallbackGuard.get() &&
         client.createdByThread == epicsThreadGetIdSelf () ) {
@@ -111,10 +116,16 @@ void sync_group_reset ( ca_client_context & client, CASG & sg )
         // o user doesnt periodically call a ca function
         // o user calls this function from an auxiillary thread
         //
-        CallbackGuard cbGuard ( client.cbMutex );
+        // the group's IO may be spread over several callback lanes
+        //
+        ContextCallbackGuard cbGuard ( client );
+        if ( cbGuard.withinLane () ) {
+            return ECA_EVDISALLOW;
+        }
         epicsGuard < epicsMutex > guard ( client.mutex );
         sg.reset ( cbGuard, guard );
     }
+    return ECA_NORMAL;
 }
 
 //
@@ -165,8 +176,7 @@ extern "C" int epicsShareAPI ca_sg_reset ( const CA_SYNC_GID gid )
             pcasg = pcac->lookupCASG ( guard, gid );
         }
         if ( pcasg ) {
-            sync_group_reset ( *pcac, *pcasg );
-            caStatus = ECA_NORMAL;
+            caStatus = sync_group_reset ( *pcac, *pcasg );
         }
         else {
             caStatus = ECA_BADSYNCGRP;
@@ -206,8 +216,11 @@ extern "C" int epicsShareAPI ca_sg_test ( const CA_SYNC_GID gid )
     ca_client_context * pcac;
     int caStatus = fetchClientContext ( &pcac );
     if ( caStatus == ECA_NORMAL ) {
-        epicsGuard < epicsMutex > guard ( pcac->mutexRef() );
-        CASG * pcasg = pcac->lookupCASG ( guard, gid );
+        CASG * pcasg;
+        {
+            epicsGuard < epicsMutex > guard ( pcac->mutexRef() );
+            pcasg = pcac->lookupCASG ( guard, gid );
+        }
         if ( pcasg ) {
             bool isComplete;
             if ( pcac->pCallbackGuard.get() &&
@@ -224,7 +237,14 @@ extern "C" int epicsShareAPI ca_sg_test ( const CA_SYNC_GID gid )
               // o user doesnt periodically call a ca function
               // o user calls this function from an auxiillary thread
               //
-              CallbackGuard cbGuard ( pcac->cbMutex );
+              // the callback lock(s) must be taken before the
+              // primary mutex, and the group's completed IO may be
+              // spread over several callback lanes
+              //
+              ContextCallbackGuard cbGuard ( *pcac );
+              if ( cbGuard.withinLane () ) {
+                  return ECA_EVDISALLOW;
+              }
               epicsGuard < epicsMutex > guard ( pcac->mutex );
               isComplete = pcasg->ioComplete ( cbGuard, guard );
             }
@@ -376,6 +376,32 @@ void tcpiiu::recvBytes (
     }
 }
 
+//
+// Once the bytes already queued have been copied into the message
+// body cache, the rest of a large message body is received straight
+// into the cache instead of through comBufs, saving a copy of each
+// byte. Only the receive thread uses the cache.
+//
+bool tcpiiu::bodyRecvPending ( char * & pBuf, unsigned & nBytes ) const
+{
+    if ( ! this->msgHeaderAvailable || 
+            this->curMsg.m_postsize > this->curDataMax ||
+            this->recvQue.occupiedBytes () > 0u ) {
+        return false;
+    }
+    arrayElementCount remaining = 
+        this->curMsg.m_postsize - this->curDataBytes;
+    if ( remaining < comBuf::capacityBytes () ) {
+        return false;
+    }
+    if ( remaining > INT_MAX ) {
+        remaining = INT_MAX;
+    }
+    pBuf = &this->pCurData[this->curDataBytes];
+    nBytes = static_cast < unsigned > ( remaining );
+    return true;
+}
+
 tcpRecvThread::tcpRecvThread ( 
     class tcpiiu & iiuIn, class epicsMutex & cbMutexIn,
     cacContextNotify & ctxNotifyIn, const char * pName, 
@@ -469,12 +495,19 @@ void tcpRecvThread::run ()
             // file manager call backs works correctly. This does not 
             // appear to impact performance.
             //
-            if ( ! pComBuf ) {
-                pComBuf = new ( this->iiu.comBufMemMgr ) comBuf;
-            }
-
             statusWireIO stat;
-            pComBuf->fillFromWire ( this->iiu, stat );
+            char * pBody;
+            unsigned bodyBytes;
+            bool direct = this->iiu.bodyRecvPending ( pBody, bodyBytes );
+            if ( direct ) {
+                this->iiu.recvBytes ( pBody, bodyBytes, stat );
+            }
+            else {
+                if ( ! pComBuf ) {
+                    pComBuf = new ( this->iiu.comBufMemMgr ) comBuf;
+                }
+                pComBuf->fillFromWire ( this->iiu, stat );
+            }
 
             epicsTime currentTime = epicsTime::getMonotonic ();
 
@@ -488,8 +521,13 @@ void tcpRecvThread::run ()
                     continue;
                 }
 
-                this->iiu.recvQue.pushLastComBufReceived ( *pComBuf );
-                pComBuf = 0;
+                if ( direct ) {
+                    this->iiu.curDataBytes += stat.bytesCopied;
+                }
+                else {
+                    this->iiu.recvQue.pushLastComBufReceived ( *pComBuf );
+                    pComBuf = 0;
+                }
 
                 this->iiu._receiveThreadIsBusy = true;
             }
@@ -1215,14 +1253,8 @@ bool tcpiiu::processIncoming (
                 // round size up to multiple of 4K
                 newsize = ((this->curMsg.m_postsize-1)|0xfff)+1;
 
-                if ( this->curDataMax <= MAX_TCP ) {
-                    // small -> large
-                    newbuf = (char*)malloc(newsize);
-
-                } else {
-                    // expand large to larger
-                    newbuf = (char*)realloc(this->pCurData, newsize);
-                }
+                // the old contents are stale, so dont realloc
+                newbuf = (char*)malloc(newsize);
 
             } else if ( this->curMsg.m_postsize <= this->cacRef.maxRecvBytesTCP ) {
                 newbuf = (char*) freeListMalloc(this->cacRef.tcpLargeRecvBufFreeList);
@@ -1238,7 +1270,7 @@ bool tcpiiu::processIncoming (
                     freeListFree(this->cacRef.tcpLargeRecvBufFreeList, this->pCurData );
 
                 } else {
-                    // called realloc()
+                    free ( this->pCurData );
                 }
                 this->pCurData = newbuf;
                 this->curDataMax = newsize;
@@ -2117,6 +2149,16 @@ unsigned tcpiiu::channelCount ( epicsGuard < epicsMutex > & guard )
     return this->channelCountTot;
 }
 
+epicsMutex * tcpiiu::callbackLane (
+    epicsGuard < epicsMutex > & guard ) const
+{
+    guard.assertIdenticalMutex ( this->mutex );
+    if ( this->cacRef.parallelCallback () ) {
+        return & this->cbMutex;
+    }
+    return 0;
+}
+
 void tcpiiu::uninstallChanDueToSuccessfulSearchResponse ( 
     epicsGuard < epicsMutex > & guard, nciu & chan, 
     const class epicsTime & currentTime )
@@ -0,0 +1,101 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measures how fast the CA client receives DBR_DOUBLE arrays of several
+ * sizes from a fake server on the loopback interface, checking every
+ * element of every array that reaches the callback.
+ */
+
+#include <stdio.h>
+
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "envDefs.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+#include "cadef.h"
+
+#include "caFakeServer.h"
+
+#define NELEMENTS 1250000u  /* 10 MB */
+#define NREADS 40u
+
+static epicsEventId readDone;
+static unsigned long readCount;
+static unsigned nGood;
+
+extern "C" void getHandler ( struct event_handler_args args )
+{
+    const dbr_double_t * pValue =
+        static_cast < const dbr_double_t * > ( args.dbr );
+    bool good = args.status == ECA_NORMAL &&
+        static_cast < unsigned long > ( args.count ) == readCount;
+
+    for ( unsigned long i = 0u; good && i < readCount; i++ ) {
+        good = pValue[i] == i;
+    }
+    if ( good ) {
+        nGood++;
+    }
+    epicsEventMustTrigger ( readDone );
+}
+
+static void measure ( chid chan, unsigned long count )
+{
+    unsigned i;
+
+    readCount = count;
+    nGood = 0u;
+    epicsTime start = epicsTime::getMonotonic ();
+    for ( i = 0u; i < NREADS; i++ ) {
+        SEVCHK ( ca_array_get_callback ( DBR_DOUBLE, count, chan,
+            getHandler, 0 ), "ca_array_get_callback" );
+        ca_flush_io ();
+        if ( epicsEventWaitWithTimeout ( readDone, 10.0 ) !=
+                epicsEventWaitOK ) {
+            break;
+        }
+    }
+    double delay = epicsTime::getMonotonic () - start;
+
+    testDiag ( "%lu elements: %.3f ms per read, %.0f MB/sec", count,
+        1e3 * delay / NREADS,
+        NREADS * count * sizeof ( dbr_double_t ) / delay / 1e6 );
+    testOk ( nGood == NREADS, "%u of %u reads of %lu elements correct",
+        nGood, NREADS, count );
+}
+
+MAIN ( caArrayRecvPerform )
+{
+    chid chan;
+
+    testPlan ( 4 );
+
+    caFakeServerStart ( NELEMENTS );
+    epicsEnvSet ( "EPICS_CA_MAX_ARRAY_BYTES", "20000000" );
+    readDone = epicsEventMustCreate ( epicsEventEmpty );
+
+    SEVCHK ( ca_context_create ( ca_enable_preemptive_callback ),
+        "ca_context_create" );
+    SEVCHK ( ca_create_channel ( "array", 0, 0, 0, &chan ),
+        "ca_create_channel" );
+    if ( ca_pend_io ( 10.0 ) != ECA_NORMAL ) {
+        testAbort ( "Channel \"array\" didn't connect" );
+    }
+    testOk ( ca_element_count ( chan ) == NELEMENTS,
+        "Channel has %lu elements", ca_element_count ( chan ) );
+
+    measure ( chan, 1000u );
+    measure ( chan, 100000u );
+    measure ( chan, NELEMENTS );
+
+    ca_context_destroy ();
+    caFakeServerStop ();
+    epicsEventDestroy ( readDone );
+
+    return testDone ();
+}
@@ -0,0 +1,467 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * A fake CA server for client measurements, see caFakeServer.h.  The UDP
+ * responder can emulate a rate limited path by dropping datagrams beyond
+ * a given rate.  The TCP side answers just enough of the protocol to
+ * connect channels, read them and subscribe to them, serving each circuit
+ * from its own thread.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "osiSock.h"
+#include "osiWireFormat.h"
+#include "epicsAtomic.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "envDefs.h"
+#include "epicsUnitTest.h"
+#include "db_access.h"
+#include "caerr.h"
+#include "caProto.h"
+
+#include "caFakeServer.h"
+
+#define CA_MINOR_PROTOCOL_REVISION 13
+#define BURST 16.0      /* datagrams the rate limited path can queue */
+#define ARRAY_SID 0x80000000u
+#define TCP_BUF_SIZE ( 1 << 16 )
+
+static SOCKET udpSock;
+static SOCKET listenSock;
+static unsigned short udpPort;
+static unsigned short tcpPort;
+static epicsThreadId udpThread;
+static epicsThreadId tcpThread;
+static double maxDatagramRate;  /* 0 for no limit */
+static int stopping;
+static unsigned datagramsIn;
+static unsigned datagramsDropped;
+static unsigned arrayCount;
+static unsigned monitorUpdates;
+static char * pArrayData;       /* the array in network byte order */
+
+static unsigned short boundPort ( SOCKET sock )
+{
+    osiSockAddr addr;
+    osiSocklen_t len = sizeof ( addr );
+
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr.ia.sin_family = AF_INET;
+    addr.ia.sin_addr.s_addr = htonl ( INADDR_LOOPBACK );
+    addr.ia.sin_port = 0;
+    if ( bind ( sock, &addr.sa, sizeof ( addr.ia ) ) ||
+         getsockname ( sock, &addr.sa, &len ) ) {
+        testAbort ( "Can't bind a socket to the loopback interface" );
+    }
+    return ntohs ( addr.ia.sin_port );
+}
+
+static char * putHdr ( char * pBuf, unsigned cmmd, unsigned postsize,
+    unsigned dataType, unsigned count, ca_uint32_t cid,
+    ca_uint32_t available )
+{
+    caHdr hdr;
+
+    hdr.m_cmmd = htons ( static_cast < ca_uint16_t > ( cmmd ) );
+    hdr.m_postsize = htons ( static_cast < ca_uint16_t > ( postsize ) );
+    hdr.m_dataType = htons ( static_cast < ca_uint16_t > ( dataType ) );
+    hdr.m_count = htons ( static_cast < ca_uint16_t > ( count ) );
+    hdr.m_cid = htonl ( cid );
+    hdr.m_available = htonl ( available );
+    memcpy ( pBuf, &hdr, sizeof ( hdr ) );
+    return pBuf + sizeof ( hdr );
+}
+
+/* Uses the large array header when the sizes dont fit in 16 bits */
+static char * putLargeHdr ( char * pBuf, unsigned cmmd, unsigned postsize,
+    unsigned dataType, unsigned count, ca_uint32_t cid,
+    ca_uint32_t available )
+{
+    if ( postsize < 0xffff && count < 0xffff ) {
+        return putHdr ( pBuf, cmmd, postsize, dataType, count,
+            cid, available );
+    }
+    pBuf = putHdr ( pBuf, cmmd, 0xffff, dataType, 0, cid, available );
+    ca_uint32_t sizes[2];
+    sizes[0] = htonl ( postsize );
+    sizes[1] = htonl ( count );
+    memcpy ( pBuf, sizes, sizeof ( sizes ) );
+    return pBuf + sizeof ( sizes );
+}
+
+struct msgHdr {
+    unsigned cmmd;
+    ca_uint32_t postsize;
+    unsigned dataType;
+    ca_uint32_t count;
+    ca_uint32_t cid;
+    ca_uint32_t available;
+};
+
+/* Returns the header size, or 0 if nBytes dont hold all of it */
+static size_t getHdr ( const char * pBuf, size_t nBytes, msgHdr & hdr )
+{
+    caHdr wire;
+
+    if ( nBytes < sizeof ( wire ) ) {
+        return 0u;
+    }
+    memcpy ( &wire, pBuf, sizeof ( wire ) );
+    hdr.cmmd = ntohs ( wire.m_cmmd );
+    hdr.postsize = ntohs ( wire.m_postsize );
+    hdr.dataType = ntohs ( wire.m_dataType );
+    hdr.count = ntohs ( wire.m_count );
+    hdr.cid = ntohl ( wire.m_cid );
+    hdr.available = ntohl ( wire.m_available );
+    if ( hdr.postsize != 0xffff ) {
+        return sizeof ( wire );
+    }
+
+    ca_uint32_t sizes[2];
+    if ( nBytes < sizeof ( wire ) + sizeof ( sizes ) ) {
+        return 0u;
+    }
+    memcpy ( sizes, pBuf + sizeof ( wire ), sizeof ( sizes ) );
+    hdr.postsize = ntohl ( sizes[0] );
+    hdr.count = ntohl ( sizes[1] );
+    return sizeof ( wire ) + sizeof ( sizes );
+}
+
+static bool sendAll ( SOCKET sock, const char * pBuf, size_t nBytes )
+{
+    while ( nBytes > 0u ) {
+        int status = send ( sock, pBuf, static_cast < int > ( nBytes ), 0 );
+
+        if ( status <= 0 ) {
+            return false;
+        }
+        pBuf += status;
+        nBytes -= status;
+    }
+    return true;
+}
+
+/* Emulates a path that forwards maxDatagramRate datagrams per second */
+static bool rateLimited ( epicsTime & last, double & tokens )
+{
+    epicsTime now = epicsTime::getMonotonic ();
+
+    if ( maxDatagramRate <= 0.0 ) {
+        return false;
+    }
+    tokens += maxDatagramRate * ( now - last );
+    last = now;
+    if ( tokens > BURST ) {
+        tokens = BURST;
+    }
+    if ( tokens < 1.0 ) {
+        return true;
+    }
+    tokens -= 1.0;
+    return false;
+}
+
+extern "C" void udpResponder ( void * )
+{
+    static char inBuf[MAX_UDP_RECV];
+    static char outBuf[ETHERNET_MAX_UDP];
+    epicsTime last = epicsTime::getMonotonic ();
+    double tokens = BURST;
+
+    while ( ! epicsAtomicGetIntT ( &stopping ) ) {
+        osiSockAddr from;
+        osiSocklen_t fromLen = sizeof ( from );
+        int status = recvfrom ( udpSock, inBuf, sizeof ( inBuf ), 0,
+            &from.sa, &fromLen );
+
+        if ( status < static_cast < int > ( sizeof ( caHdr ) ) ) {
+            continue;
+        }
+        datagramsIn++;
+        if ( rateLimited ( last, tokens ) ) {
+            datagramsDropped++;
+            continue;
+        }
+
+        const char * pIn = inBuf;
+        const char * pEnd = inBuf + status;
+        char * pOut = outBuf;
+        while ( true ) {
+            msgHdr hdr;
+            size_t hdrSize = getHdr ( pIn, pEnd - pIn, hdr );
+
+            if ( ! hdrSize || pEnd - pIn < 
+                    static_cast < int > ( hdrSize + hdr.postsize ) ) {
+                break;
+            }
+            const char * pName = pIn + hdrSize;
+            pIn = pName + hdr.postsize;
+            if ( hdr.cmmd == CA_PROTO_VERSION ) {
+                // echo the sequence number so the client can match replies
+                pOut = putHdr ( pOut, CA_PROTO_VERSION, 0, hdr.dataType,
+                    CA_MINOR_PROTOCOL_REVISION, hdr.cid, 0 );
+            }
+            else if ( hdr.cmmd == CA_PROTO_SEARCH && hdr.postsize &&
+                      strncmp ( pName, "missing", 7 ) ) {
+                pOut = putHdr ( pOut, CA_PROTO_SEARCH, 8, tcpPort, 0,
+                    INADDR_BROADCAST, hdr.available );
+                memset ( pOut, 0, 8 );
+                pOut[1] = CA_MINOR_PROTOCOL_REVISION;
+                pOut += 8;
+            }
+            if ( pOut - outBuf > static_cast < int >
+                    ( sizeof ( outBuf ) - 2 * sizeof ( caHdr ) - 8 ) ) {
+                sendto ( udpSock, outBuf, pOut - outBuf, 0,
+                    &from.sa, fromLen );
+                pOut = outBuf;
+            }
+        }
+        if ( pOut - outBuf > static_cast < int > ( sizeof ( caHdr ) ) ) {
+            sendto ( udpSock, outBuf, pOut - outBuf, 0, &from.sa, fromLen );
+        }
+    }
+}
+
+/* Appends the reply to a read, sending the array data straight away */
+static char * readNotify ( SOCKET sock, char * pOutBuf, char * pOut,
+    const msgHdr & hdr )
+{
+    unsigned count = ( hdr.cid & ARRAY_SID ) ? arrayCount : 1u;
+
+    if ( hdr.dataType != DBR_DOUBLE ) {
+        return putLargeHdr ( pOut, CA_PROTO_READ_NOTIFY, 0, hdr.dataType,
+            hdr.count, ECA_BADTYPE, hdr.available );
+    }
+    if ( hdr.count > count ) {
+        return putLargeHdr ( pOut, CA_PROTO_READ_NOTIFY, 0, hdr.dataType,
+            hdr.count, ECA_BADCOUNT, hdr.available );
+    }
+    if ( hdr.count ) {
+        count = hdr.count;
+    }
+    pOut = putLargeHdr ( pOut, CA_PROTO_READ_NOTIFY,
+        count * sizeof ( dbr_double_t ), DBR_DOUBLE, count, ECA_NORMAL,
+        hdr.available );
+    sendAll ( sock, pOutBuf, pOut - pOutBuf );
+    sendAll ( sock, pArrayData, count * sizeof ( dbr_double_t ) );
+    return pOutBuf;
+}
+
+/* Appends the updates of a new scalar DBR_DOUBLE subscription */
+static char * eventAdd ( SOCKET sock, char * pOutBuf, char * pOut,
+    const msgHdr & hdr )
+{
+    if ( hdr.dataType != DBR_DOUBLE || hdr.count > 1u ||
+            ( hdr.cid & ARRAY_SID ) ) {
+        return putHdr ( pOut, CA_PROTO_EVENT_ADD, 0, hdr.dataType,
+            hdr.count, ECA_BADTYPE, hdr.available );
+    }
+    for ( unsigned i = 0u; i < monitorUpdates; i++ ) {
+        dbr_double_t value = i;
+        pOut = putHdr ( pOut, CA_PROTO_EVENT_ADD, sizeof ( value ),
+            DBR_DOUBLE, 1u, ECA_NORMAL, hdr.available );
+        WireSet ( value, reinterpret_cast < epicsUInt8 * > ( pOut ) );
+        pOut += sizeof ( value );
+        if ( pOut - pOutBuf > TCP_BUF_SIZE / 2 ) {
+            sendAll ( sock, pOutBuf, pOut - pOutBuf );
+            pOut = pOutBuf;
+        }
+    }
+    return pOut;
+}
+
+/* Serves one virtual circuit until the client closes it */
+extern "C" void tcpCircuit ( void * pParm )
+{
+    SOCKET sock = * static_cast < SOCKET * > ( pParm );
+    char * inBuf = new char [TCP_BUF_SIZE];
+    char * outBuf = new char [TCP_BUF_SIZE];
+    ca_uint32_t sid = 1u;
+    size_t inLen = 0u;
+
+    putHdr ( outBuf, CA_PROTO_VERSION, 0, 0, CA_MINOR_PROTOCOL_REVISION,
+        0, 0 );
+    sendAll ( sock, outBuf, sizeof ( caHdr ) );
+
+    while ( true ) {
+        int status = recv ( sock, inBuf + inLen, TCP_BUF_SIZE - inLen, 0 );
+
+        if ( status <= 0 ) {
+            break;
+        }
+        inLen += status;
+
+        const char * pIn = inBuf;
+        const char * pEnd = inBuf + inLen;
+        char * pOut = outBuf;
+        while ( true ) {
+            msgHdr hdr;
+            size_t hdrSize = getHdr ( pIn, pEnd - pIn, hdr );
+
+            if ( ! hdrSize || pEnd - pIn <
+                    static_cast < int > ( hdrSize + hdr.postsize ) ) {
+                break;
+            }
+            const char * pName = pIn + hdrSize;
+            pIn = pName + hdr.postsize;
+            switch ( hdr.cmmd ) {
+            case CA_PROTO_CREATE_CHAN:
+            {
+                bool isArray = hdr.postsize && ! strcmp ( pName, "array" );
+
+                pOut = putHdr ( pOut, CA_PROTO_ACCESS_RIGHTS, 0, 0, 0,
+                    hdr.cid, CA_PROTO_ACCESS_RIGHT_READ |
+                    CA_PROTO_ACCESS_RIGHT_WRITE );
+                pOut = putLargeHdr ( pOut, CA_PROTO_CREATE_CHAN, 0,
+                    DBR_DOUBLE, isArray ? arrayCount : 1u,
+                    hdr.cid, isArray ? ARRAY_SID | sid : sid );
+                sid++;
+                break;
+            }
+            case CA_PROTO_READ_NOTIFY:
+                pOut = readNotify ( sock, outBuf, pOut, hdr );
+                break;
+            case CA_PROTO_EVENT_ADD:
+                pOut = eventAdd ( sock, outBuf, pOut, hdr );
+                break;
+            case CA_PROTO_CLEAR_CHANNEL:
+            case CA_PROTO_ECHO:
+                pOut = putHdr ( pOut, hdr.cmmd, 0, 0, 0,
+                    hdr.cid, hdr.available );
+                break;
+            default:
+                break;
+            }
+            if ( pOut - outBuf > static_cast < int >
+                    ( TCP_BUF_SIZE - 4 * sizeof ( caHdr ) ) ) {
+                sendAll ( sock, outBuf, pOut - outBuf );
+                pOut = outBuf;
+            }
+        }
+        if ( pOut > outBuf ) {
+            sendAll ( sock, outBuf, pOut - outBuf );
+        }
+        inLen = pEnd - pIn;
+        memmove ( inBuf, pIn, inLen );
+    }
+    epicsSocketDestroy ( sock );
+    delete [] inBuf;
+    delete [] outBuf;
+    delete static_cast < SOCKET * > ( pParm );
+}
+
+extern "C" void tcpListener ( void * )
+{
+    while ( true ) {
+        osiSockAddr addr;
+        osiSocklen_t addrLen = sizeof ( addr );
+        SOCKET sock = epicsSocketAccept ( listenSock, &addr.sa, &addrLen );
+
+        if ( epicsAtomicGetIntT ( &stopping ) ) {
+            if ( sock != INVALID_SOCKET ) {
+                epicsSocketDestroy ( sock );
+            }
+            break;
+        }
+        if ( sock != INVALID_SOCKET ) {
+            int flag = true;
+
+            setsockopt ( sock, IPPROTO_TCP, TCP_NODELAY,
+                (char *) &flag, sizeof ( flag ) );
+            epicsThreadMustCreate ( "tcpCircuit", epicsThreadPriorityHigh,
+                epicsThreadGetStackSize ( epicsThreadStackMedium ),
+                tcpCircuit, new SOCKET ( sock ) );
+        }
+    }
+}
+
+void caFakeServerStart ( unsigned arrayCountIn )
+{
+    epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    char addrList[32];
+    unsigned i;
+
+    arrayCount = arrayCountIn;
+    pArrayData = new char [arrayCount * sizeof ( dbr_double_t )];
+    for ( i = 0u; i < arrayCount; i++ ) {
+        dbr_double_t value = i;
+        WireSet ( value, reinterpret_cast < epicsUInt8 * >
+            ( &pArrayData[i * sizeof ( dbr_double_t )] ) );
+    }
+
+    osiSockAttach ();
+    udpSock = epicsSocketCreate ( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+    listenSock = epicsSocketCreate ( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+    if ( udpSock == INVALID_SOCKET || listenSock == INVALID_SOCKET ) {
+        testAbort ( "Can't create sockets" );
+    }
+    udpPort = boundPort ( udpSock );
+    tcpPort = boundPort ( listenSock );
+    if ( listen ( listenSock, 10 ) ) {
+        testAbort ( "Can't listen" );
+    }
+
+    opts.joinable = 1;
+    opts.priority = epicsThreadPriorityHigh;
+    udpThread = epicsThreadCreateOpt ( "udpResponder", udpResponder, 0,
+        &opts );
+    tcpThread = epicsThreadCreateOpt ( "tcpListener", tcpListener, 0,
+        &opts );
+
+    sprintf ( addrList, "127.0.0.1:%u", udpPort );
+    epicsEnvSet ( "EPICS_CA_ADDR_LIST", addrList );
+    epicsEnvSet ( "EPICS_CA_AUTO_ADDR_LIST", "NO" );
+}
+
+void caFakeServerStop ()
+{
+    SOCKET sock = epicsSocketCreate ( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+    osiSockAddr addr;
+    char msg[sizeof ( caHdr )];
+
+    // wake both threads so they see the stop request
+    epicsAtomicSetIntT ( &stopping, 1 );
+    memset ( &addr, 0, sizeof ( addr ) );
+    addr.ia.sin_family = AF_INET;
+    addr.ia.sin_addr.s_addr = htonl ( INADDR_LOOPBACK );
+    addr.ia.sin_port = htons ( udpPort );
+    memset ( msg, 0, sizeof ( msg ) );
+    sendto ( sock, msg, sizeof ( msg ), 0, &addr.sa, sizeof ( addr.ia ) );
+    epicsSocketDestroy ( sock );
+
+    sock = epicsSocketCreate ( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+    addr.ia.sin_port = htons ( tcpPort );
+    connect ( sock, &addr.sa, sizeof ( addr.ia ) );
+    epicsSocketDestroy ( sock );
+
+    epicsThreadMustJoin ( udpThread );
+    epicsThreadMustJoin ( tcpThread );
+    epicsSocketDestroy ( udpSock );
+    epicsSocketDestroy ( listenSock );
+    osiSockRelease ();
+    delete [] pArrayData;
+}
+
+void caFakeServerMonitorUpdates ( unsigned nUpdates )
+{
+    monitorUpdates = nUpdates;
+}
+
+void caFakeServerRateLimit ( double maxDatagramRateIn )
+{
+    maxDatagramRate = maxDatagramRateIn;
+    datagramsIn = datagramsDropped = 0u;
+}
+
+void caFakeServerStats ( unsigned & datagramsInOut,
+    unsigned & datagramsDroppedOut )
+{
+    datagramsInOut = datagramsIn;
+    datagramsDroppedOut = datagramsDropped;
+}
@@ -0,0 +1,31 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * A fake CA server on the loopback interface for measuring the client.
+ *
+ * It answers searches for every name except those starting with "missing"
+ * and connects them as DBR_DOUBLE channels.  The channel named "array" has
+ * arrayCount elements, all others one.  Reads of DBR_DOUBLE return element
+ * i as the value i.  Starting it points EPICS_CA_ADDR_LIST at it, so start
+ * it before creating a client context.  Each virtual circuit is served by
+ * its own thread, so channels created with different priorities connect
+ * through as many circuits.
+ */
+
+#ifndef caFakeServerh
+#define caFakeServerh
+
+void caFakeServerStart ( unsigned arrayCount );
+void caFakeServerStop ();
+
+/* New scalar DBR_DOUBLE subscriptions get the values 0 .. nUpdates-1 */
+void caFakeServerMonitorUpdates ( unsigned nUpdates );
+
+/* Drop search datagrams beyond this rate, 0 for no limit */
+void caFakeServerRateLimit ( double maxDatagramRate );
+void caFakeServerStats ( unsigned & datagramsIn, unsigned & datagramsDropped );
+
+#endif /* caFakeServerh */
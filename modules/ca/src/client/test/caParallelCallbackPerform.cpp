@@ -0,0 +1,178 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measures the aggregate monitor throughput of the CA client against a
+ * fake server reached through several virtual circuits, once with the
+ * callbacks serialized and once in the parallel callback mode, checking
+ * that every subscription sees its updates in order.
+ */
+
+#include <stdio.h>
+
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+#include "cadef.h"
+
+#include "caFakeServer.h"
+
+#define NCIRCUITS 4u
+#define NCHANNELS 2u        /* per circuit */
+#define NUPDATES 50u        /* per subscription */
+#define CALLBACK_DELAY 1e-3
+
+struct subscription {
+    chid chan;
+    evid id;
+    unsigned next;
+    unsigned outOfOrder;
+};
+
+static subscription subs[NCIRCUITS * NCHANNELS];
+static epicsEventId allDone;
+static size_t pending;
+static int active;
+static int maxActive;
+static int clearStatus[NCIRCUITS * NCHANNELS];
+
+extern "C" void monitorHandler ( struct event_handler_args args )
+{
+    subscription * pSub = static_cast < subscription * > ( args.usr );
+    int nowActive = epicsAtomicIncrIntT ( &active );
+    int max = epicsAtomicGetIntT ( &maxActive );
+
+    while ( nowActive > max ) {
+        int prev = epicsAtomicCmpAndSwapIntT ( &maxActive, max, nowActive );
+        if ( prev == max ) {
+            break;
+        }
+        max = prev;
+    }
+    // a callback that blocks briefly, as if it were writing somewhere
+    epicsThreadSleep ( CALLBACK_DELAY );
+    if ( args.status != ECA_NORMAL ||
+            * static_cast < const dbr_double_t * > ( args.dbr ) !=
+                pSub->next ) {
+        pSub->outOfOrder++;
+    }
+    pSub->next++;
+    epicsAtomicDecrIntT ( &active );
+    if ( epicsAtomicDecrSizeT ( &pending ) == 0u ) {
+        epicsEventMustTrigger ( allDone );
+    }
+}
+
+/* Clears all channels of the other circuits from within a callback */
+extern "C" void getHandler ( struct event_handler_args )
+{
+    for ( unsigned i = NCHANNELS; i < NCIRCUITS * NCHANNELS; i++ ) {
+        clearStatus[i] = ca_clear_channel ( subs[i].chan );
+    }
+    epicsEventMustTrigger ( allDone );
+}
+
+static void measure ( enum ca_preemptive_callback_select select,
+    const char * pMode )
+{
+    unsigned i, nOutOfOrder = 0u, nCleared = 0u, nRefused = 0u;
+
+    SEVCHK ( ca_context_create ( select ), "ca_context_create" );
+    for ( i = 0u; i < NCIRCUITS * NCHANNELS; i++ ) {
+        char name[32];
+
+        // each priority is served by a circuit of its own
+        sprintf ( name, "pv%u", i );
+        SEVCHK ( ca_create_channel ( name, 0, 0, i / NCHANNELS,
+            &subs[i].chan ), "ca_create_channel" );
+        subs[i].next = subs[i].outOfOrder = 0u;
+    }
+    if ( ca_pend_io ( 10.0 ) != ECA_NORMAL ) {
+        testAbort ( "Channels didn't connect" );
+    }
+    testOk ( ca_parallel_callback_is_enabled () ==
+        ( select == ca_enable_parallel_callback ),
+        "%s: parallel callback is %s", pMode,
+        ca_parallel_callback_is_enabled () ? "enabled" : "disabled" );
+
+    epicsAtomicSetSizeT ( &pending, NCIRCUITS * NCHANNELS * NUPDATES );
+    epicsAtomicSetIntT ( &maxActive, 0 );
+    epicsTime start = epicsTime::getMonotonic ();
+    for ( i = 0u; i < NCIRCUITS * NCHANNELS; i++ ) {
+        SEVCHK ( ca_create_subscription ( DBR_DOUBLE, 1, subs[i].chan,
+            DBE_VALUE, monitorHandler, &subs[i], &subs[i].id ),
+            "ca_create_subscription" );
+    }
+    ca_flush_io ();
+    bool done = epicsEventWaitWithTimeout ( allDone, 30.0 ) ==
+        epicsEventWaitOK;
+    double delay = epicsTime::getMonotonic () - start;
+
+    for ( i = 0u; i < NCIRCUITS * NCHANNELS; i++ ) {
+        nOutOfOrder += subs[i].outOfOrder;
+        SEVCHK ( ca_clear_subscription ( subs[i].id ),
+            "ca_clear_subscription" );
+    }
+    testDiag ( "%s: %u updates in %.3f sec, %.0f updates/sec",
+        pMode, NCIRCUITS * NCHANNELS * NUPDATES, delay,
+        NCIRCUITS * NCHANNELS * NUPDATES / delay );
+    testOk ( done && nOutOfOrder == 0u,
+        "%s: all updates delivered, %u out of order", pMode, nOutOfOrder );
+    if ( select == ca_enable_parallel_callback ) {
+        testOk ( maxActive > 1, "%s: up to %d callbacks at once",
+            pMode, maxActive );
+    }
+    else {
+        testOk ( maxActive == 1, "%s: one callback at a time", pMode );
+    }
+
+    SEVCHK ( ca_array_get_callback ( DBR_DOUBLE, 1, subs[0].chan,
+        getHandler, 0 ), "ca_array_get_callback" );
+    ca_flush_io ();
+    epicsEventMustWait ( allDone );
+    for ( i = NCHANNELS; i < NCIRCUITS * NCHANNELS; i++ ) {
+        if ( clearStatus[i] == ECA_NORMAL ) {
+            nCleared++;
+        }
+        else if ( clearStatus[i] == ECA_EVDISALLOW ) {
+            nRefused++;
+            ca_clear_channel ( subs[i].chan );
+        }
+    }
+    if ( select == ca_enable_parallel_callback ) {
+        testOk ( nRefused > 0u && nCleared + nRefused ==
+            ( NCIRCUITS - 1u ) * NCHANNELS,
+            "%s: callback cleared %u channels, refused for %u of other lanes",
+            pMode, nCleared, nRefused );
+    }
+    else {
+        testOk ( nCleared == ( NCIRCUITS - 1u ) * NCHANNELS,
+            "%s: callback cleared all %u channels", pMode, nCleared );
+    }
+    for ( i = 0u; i < NCHANNELS; i++ ) {
+        ca_clear_channel ( subs[i].chan );
+    }
+    ca_context_destroy ();
+}
+
+MAIN ( caParallelCallbackPerform )
+{
+    testPlan ( 8 );
+
+    caFakeServerStart ( 1u );
+    caFakeServerMonitorUpdates ( NUPDATES );
+    allDone = epicsEventMustCreate ( epicsEventEmpty );
+
+    measure ( ca_enable_preemptive_callback, "serialized" );
+    measure ( ca_enable_parallel_callback, "parallel" );
+
+    caFakeServerStop ();
+    epicsEventDestroy ( allDone );
+
+    return testDone ();
+}
@@ -0,0 +1,104 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measures how fast the CA client connects many channels, some of them
+ * missing, against a fake server on the loopback interface, directly and
+ * through an emulated rate limited path.
+ */
+
+#include <stdio.h>
+
+#include "epicsAtomic.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+#include "cadef.h"
+
+#include "caFakeServer.h"
+
+#define NCHANNELS 20000u
+#define NMISSING 2000u
+#define TIMEOUT 120.0   /* seconds */
+
+static int connected;
+
+extern "C" void connHandler ( struct connection_handler_args args )
+{
+    if ( args.op == CA_OP_CONN_UP ) {
+        epicsAtomicIncrIntT ( &connected );
+    }
+    else {
+        epicsAtomicDecrIntT ( &connected );
+    }
+}
+
+static void measure ( double rate )
+{
+    static chid chans[NCHANNELS + NMISSING];
+    unsigned i, nMissing = 0u;
+    char name[32];
+
+    unsigned datagramsIn, datagramsDropped;
+
+    caFakeServerRateLimit ( rate );
+    epicsAtomicSetIntT ( &connected, 0 );
+    if ( rate > 0.0 ) {
+        testDiag ( "Path forwards %g datagrams per second", rate );
+    }
+    else {
+        testDiag ( "Path forwards every datagram" );
+    }
+
+    epicsTime start = epicsTime::getMonotonic ();
+    SEVCHK ( ca_context_create ( ca_enable_preemptive_callback ),
+        "ca_context_create" );
+    for ( i = 0u; i < NCHANNELS + NMISSING; i++ ) {
+        // one name in eleven is missing, spread over all the frames
+        if ( i % 11u == 10u && nMissing < NMISSING ) {
+            sprintf ( name, "missing%u", nMissing++ );
+        }
+        else {
+            sprintf ( name, "chan%u", i - nMissing );
+        }
+        SEVCHK ( ca_create_channel ( name, connHandler, 0, 0, &chans[i] ),
+            "ca_create_channel" );
+    }
+    ca_flush_io ();
+
+    double delay;
+    do {
+        epicsThreadSleep ( 0.01 );
+        delay = epicsTime::getMonotonic () - start;
+    } while ( epicsAtomicGetIntT ( &connected ) <
+        static_cast < int > ( NCHANNELS ) && delay < TIMEOUT );
+
+    int nConnected = epicsAtomicGetIntT ( &connected );
+    caFakeServerStats ( datagramsIn, datagramsDropped );
+    testDiag ( "%d channels connected in %.3f sec, %.0f per sec",
+        nConnected, delay, nConnected / delay );
+    testDiag ( "%u search datagrams, %u dropped",
+        datagramsIn, datagramsDropped );
+    testOk ( nConnected == NCHANNELS, "All %u channels connected",
+        NCHANNELS );
+    epicsThreadSleep ( 0.5 );
+    testOk ( epicsAtomicGetIntT ( &connected ) == nConnected,
+        "No missing channel connected" );
+
+    ca_context_destroy ();
+}
+
+MAIN ( caSearchPerform )
+{
+    testPlan ( 4 );
+
+    caFakeServerStart ( 1u );
+    measure ( 0.0 );
+    measure ( 500.0 );
+    caFakeServerStop ();
+
+    return testDone ();
+}
@@ -0,0 +1,100 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measures caNetConvert() throughput for large arrays of each numeric
+ * DBR type, checking the result against an element by element
+ * conversion through AlignedWireRef.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "osiWireFormat.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+#include "db_access.h"
+#include "net_convert.h"
+
+#define NELEMENTS 1000000u
+#define NREPEAT 20u
+
+template < class T >
+static void referenceConvert ( const T * pSrc, T * pDest, unsigned count )
+{
+    for ( unsigned i = 0u; i < count; i++ ) {
+        AlignedWireRef < T > tmp ( pDest[i] );
+        tmp = pSrc[i];
+    }
+}
+
+static double rate ( size_t nBytes, const epicsTime & start )
+{
+    double delay = epicsTime::getMonotonic () - start;
+    return delay > 0.0 ? nBytes * NREPEAT / delay / 1e9 : 0.0;
+}
+
+template < class T >
+static void measure ( const char * pName, unsigned type, unsigned offset )
+{
+    size_t size = dbr_size_n ( type, NELEMENTS );
+    char * pHost = new char [size];
+    char * pNet = new char [size];
+    char * pExpect = new char [size];
+    T * pValue = reinterpret_cast < T * > ( pHost + offset );
+    unsigned i;
+
+    memset ( pHost, 0, size );
+    for ( i = 0u; i < NELEMENTS; i++ ) {
+        pValue[i] = static_cast < T > ( i * 3u + 1u );
+    }
+    memset ( pExpect, 0, size );
+    referenceConvert ( pValue,
+        reinterpret_cast < T * > ( pExpect + offset ), NELEMENTS );
+
+    epicsTime start = epicsTime::getMonotonic ();
+    for ( i = 0u; i < NREPEAT; i++ ) {
+        caNetConvert ( type, pHost, pNet, true, NELEMENTS );
+    }
+    double copyRate = rate ( size, start );
+    testOk ( memcmp ( pNet + offset, pExpect + offset, size - offset ) == 0,
+        "%s host to net matches", pName );
+
+    caNetConvert ( type, pNet, pNet, false, NELEMENTS );
+    testOk ( memcmp ( pNet + offset, pHost + offset, size - offset ) == 0,
+        "%s net to host in place restores the value", pName );
+
+    /* an even number of in place conversions leaves the data unchanged */
+    start = epicsTime::getMonotonic ();
+    for ( i = 0u; i < NREPEAT; i++ ) {
+        caNetConvert ( type, pNet, pNet, i & 1u, NELEMENTS );
+    }
+    double inPlaceRate = rate ( size, start );
+
+    testDiag ( "%-16s %6.2f GB/s copy, %6.2f GB/s in place",
+        pName, copyRate, inPlaceRate );
+
+    delete [] pExpect;
+    delete [] pNet;
+    delete [] pHost;
+}
+
+MAIN(convertPerform)
+{
+    testPlan(14);
+    testDiag ( "Converting %u elements %u times", NELEMENTS, NREPEAT );
+    measure < dbr_short_t > ( "DBR_SHORT", DBR_SHORT, 0u );
+    measure < dbr_long_t > ( "DBR_LONG", DBR_LONG, 0u );
+    measure < dbr_float_t > ( "DBR_FLOAT", DBR_FLOAT, 0u );
+    measure < dbr_double_t > ( "DBR_DOUBLE", DBR_DOUBLE, 0u );
+    measure < dbr_long_t > ( "DBR_TIME_LONG", DBR_TIME_LONG,
+        offsetof ( dbr_time_long, value ) );
+    measure < dbr_float_t > ( "DBR_TIME_FLOAT", DBR_TIME_FLOAT,
+        offsetof ( dbr_time_float, value ) );
+    measure < dbr_double_t > ( "DBR_CTRL_DOUBLE", DBR_CTRL_DOUBLE,
+        offsetof ( dbr_ctrl_double, value ) );
+    return testDone();
+}
@@ -154,7 +154,7 @@ private:
     private:
         udpiiu & m_udpiiu;
     };
-    char xmitBuf [MAX_UDP_SEND];   
+    char xmitBuf [ETHERNET_MAX_UDP]; // search requests fill an unfragmented frame
     char recvBuf [MAX_UDP_RECV];
     udpRecvThread recvThread;
     M_repeaterTimerNotify m_repeaterTimerNotify;
@@ -180,6 +180,9 @@ public:
         const char *pformat, ... );
     unsigned channelCount ( 
         epicsGuard < epicsMutex > & );
+    epicsMutex & callbackControl () const;
+    epicsMutex * callbackLane (
+        epicsGuard < epicsMutex > & ) const;
     void disconnectAllChannels (
         epicsGuard < epicsMutex > & cbGuard, 
         epicsGuard < epicsMutex > & guard, class udpiiu & );
@@ -261,6 +264,7 @@ private:
         const epicsTime & currentTime, callbackManager & );
     unsigned sendBytes ( const void *pBuf, 
         unsigned nBytesInBuf, const epicsTime & currentTime );
+    bool bodyRecvPending ( char * & pBuf, unsigned & nBytes ) const;
     void recvBytes ( 
         void * pBuf, unsigned nBytesInBuf, statusWireIO & );
     const char * pHostName (
@@ -381,6 +385,11 @@ inline bool tcpiiu::connecting (
     return ( this->state == iiucs_connecting );
 }
 
+inline epicsMutex & tcpiiu::callbackControl () const
+{
+    return this->cbMutex;
+}
+
 inline bool tcpiiu::receiveThreadIsBusy ( 
     epicsGuard < epicsMutex > & guard )
 {
@@ -50,9 +50,24 @@
 
 static int callbackQueueSize = 2000;
 
-typedef struct cbQueueSet {
+/* Each callback thread has its own queue, and takes work from the
+ * queues of the other threads of the same priority when its own is
+ * empty.  callbackRequest() prefers the queue of an idle thread.
+ * callbackQueueSize is split between the queues of a priority, which
+ * callbackRequest() fills in turn, so it stays the total capacity.
+ */
+typedef struct cbWorker {
     epicsEventId semWakeUp;
     epicsRingPointerId queue;
+    struct cbQueueSet *set;
+    int index;
+    int busy;     // running a callback, use atomic
+    int steals;   // callbacks taken from siblings, use atomic
+} cbWorker;
+
+typedef struct cbQueueSet {
+    cbWorker *workers;
+    int nextWorker; // round robin start for callbackRequest(), use atomic
     int queueOverflow;
     int queueOverflows;
     int shutdown; // use atomic
@@ -94,7 +109,6 @@ static unsigned int threadPriority[NUM_CALLBACK_PRIORITIES] = {
     epicsThreadPriorityScanLow + 4,
     epicsThreadPriorityScanHigh + 1
 };
-static int priorityValue[NUM_CALLBACK_PRIORITIES] = {0, 1, 2};
 
 
 int callbackSetQueueSize(int size)
@@ -115,10 +129,20 @@ int callbackQueueStatus(const int reset, callbackQueueStats *result)
         int prio;
         result->size = callbackQueueSize;
         for(prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-            epicsRingPointerId qId = callbackQueue[prio].queue;
-            result->numUsed[prio] = epicsRingPointerGetUsed(qId);
-            result->maxUsed[prio] = epicsRingPointerGetHighWaterMark(qId);
-            result->numOverflow[prio] = epicsAtomicGetIntT(&callbackQueue[prio].queueOverflows);
+            cbQueueSet *mySet = &callbackQueue[prio];
+            int j;
+
+            /* totals over the queues of all threads, so the high-water
+             * mark is the most that could have been queued at once */
+            result->numUsed[prio] = 0;
+            result->maxUsed[prio] = 0;
+            for (j = 0; j < mySet->threadsConfigured; j++) {
+                epicsRingPointerId qId = mySet->workers[j].queue;
+
+                result->numUsed[prio] += epicsRingPointerGetUsed(qId);
+                result->maxUsed[prio] += epicsRingPointerGetHighWaterMark(qId);
+            }
+            result->numOverflow[prio] = epicsAtomicGetIntT(&mySet->queueOverflows);
         }
         ret = 0;
     } else {
@@ -127,7 +151,13 @@ int callbackQueueStatus(const int reset, callbackQueueStats *result)
     if (reset) {
         int prio;
         for(prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
-            epicsRingPointerResetHighWaterMark(callbackQueue[prio].queue);
+            cbQueueSet *mySet = &callbackQueue[prio];
+            int j;
+
+            for (j = 0; j < mySet->threadsConfigured; j++) {
+                epicsRingPointerResetHighWaterMark(mySet->workers[j].queue);
+                epicsAtomicSetIntT(&mySet->workers[j].steals, 0);
+            }
         }
     }
     return ret;
@@ -149,6 +179,23 @@ void callbackQueueShow(const int reset)
                    stats.numUsed[prio], stats.size, qusage,
                    stats.numOverflow[prio]);
         }
+        for (prio = 0; prio < NUM_CALLBACK_PRIORITIES; prio++) {
+            cbQueueSet *mySet = &callbackQueue[prio];
+            int j;
+
+            if (mySet->threadsConfigured < 2)
+                continue;
+            printf("%8s  THREAD  HIGH-WATER MARK  ITEMS IN Q  STEALS\n",
+                   threadNamePrefix[prio]);
+            for (j = 0; j < mySet->threadsConfigured; j++) {
+                cbWorker *worker = &mySet->workers[j];
+
+                printf("%8s  %6d  %15d  %10d  %6d\n", "", j,
+                       epicsRingPointerGetHighWaterMark(worker->queue),
+                       epicsRingPointerGetUsed(worker->queue),
+                       epicsAtomicGetIntT(&worker->steals));
+            }
+        }
     }
 }
 
@@ -202,26 +249,63 @@ found:
     return 0;
 }
 
+/* Take the next callback from our own queue, or steal one */
+static epicsCallback * callbackPop(cbWorker *me)
+{
+    cbQueueSet *mySet = me->set;
+    int nWorkers = mySet->threadsConfigured;
+    void *ptr = epicsRingPointerPop(me->queue);
+    int i;
+
+    for (i = 1; !ptr && i < nWorkers; i++) {
+        cbWorker *victim = &mySet->workers[(me->index + i) % nWorkers];
+
+        ptr = epicsRingPointerPop(victim->queue);
+        if (ptr)
+            epicsAtomicIncrIntT(&me->steals);
+    }
+    return (epicsCallback *)ptr;
+}
+
+/* Wake an idle sibling to help with our backlog */
+static void callbackWakeSibling(cbWorker *me)
+{
+    cbQueueSet *mySet = me->set;
+    int nWorkers = mySet->threadsConfigured;
+    int i;
+
+    for (i = 1; i < nWorkers; i++) {
+        cbWorker *sibling = &mySet->workers[(me->index + i) % nWorkers];
+
+        if (!epicsAtomicGetIntT(&sibling->busy)) {
+            epicsEventMustTrigger(sibling->semWakeUp);
+            return;
+        }
+    }
+}
+
 static void callbackTask(void *arg)
 {
-    int prio = *(int*)arg;
-    cbQueueSet *mySet = &callbackQueue[prio];
+    cbWorker *me = (cbWorker *)arg;
+    cbQueueSet *mySet = me->set;
 
     taskwdInsert(0, NULL, NULL);
     epicsEventSignal(startStopEvent);
 
     while(!epicsAtomicGetIntT(&mySet->shutdown)) {
-        void *ptr;
-        if (epicsRingPointerIsEmpty(mySet->queue))
-            epicsEventMustWait(mySet->semWakeUp);
-
-        while ((ptr = epicsRingPointerPop(mySet->queue))) {
-            epicsCallback *pcallback = (epicsCallback *)ptr;
-            if(!epicsRingPointerIsEmpty(mySet->queue))
-                epicsEventMustTrigger(mySet->semWakeUp);
+        epicsCallback *pcallback;
+
+        while ((pcallback = callbackPop(me))) {
+            if(!epicsRingPointerIsEmpty(me->queue))
+                callbackWakeSibling(me);
             mySet->queueOverflow = FALSE;
+            epicsAtomicSetIntT(&me->busy, 1);
             (*pcallback->callback)(pcallback);
+            epicsAtomicSetIntT(&me->busy, 0);
         }
+
+        if (!epicsAtomicGetIntT(&mySet->shutdown))
+            epicsEventMustWait(me->semWakeUp);
     }
 
     if(!epicsAtomicDecrIntT(&mySet->threadsRunning))
@@ -236,15 +320,22 @@ void callbackStop(void)
     if (epicsAtomicCmpAndSwapIntT(&cbState, cbRun, cbStop)!=cbRun) return;
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
-        epicsAtomicSetIntT(&callbackQueue[i].shutdown, 1);
-        epicsEventSignal(callbackQueue[i].semWakeUp);
+        cbQueueSet *mySet = &callbackQueue[i];
+        int j;
+
+        epicsAtomicSetIntT(&mySet->shutdown, 1);
+        for (j = 0; j < mySet->threadsConfigured; j++)
+            epicsEventSignal(mySet->workers[j].semWakeUp);
     }
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
         cbQueueSet *mySet = &callbackQueue[i];
 
         while (epicsAtomicGetIntT(&mySet->threadsRunning)) {
-            epicsEventSignal(mySet->semWakeUp);
+            int j;
+
+            for (j = 0; j < mySet->threadsConfigured; j++)
+                epicsEventSignal(mySet->workers[j].semWakeUp);
             epicsEventWaitWithTimeout(startStopEvent, 0.1);
         }
     }
@@ -260,10 +351,14 @@ void callbackCleanup(void)
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
         cbQueueSet *mySet = &callbackQueue[i];
+        int j;
 
         assert(epicsAtomicGetIntT(&mySet->threadsRunning)==0);
-        epicsEventDestroy(mySet->semWakeUp);
-        epicsRingPointerDelete(mySet->queue);
+        for (j = 0; j < mySet->threadsConfigured; j++) {
+            epicsEventDestroy(mySet->workers[j].semWakeUp);
+            epicsRingPointerDelete(mySet->workers[j].queue);
+        }
+        free(mySet->workers);
     }
 
     epicsTimerQueueRelease(timerQueue);
@@ -274,6 +369,7 @@ void callbackInit(void)
 {
     int i;
     int j;
+    int queueSize;
     char threadName[32];
 
     if (epicsAtomicCmpAndSwapIntT(&cbState, cbInit, cbRun)!=cbInit) {
@@ -284,28 +380,42 @@ void callbackInit(void)
     if(!startStopEvent)
         startStopEvent = epicsEventMustCreate(epicsEventEmpty);
 
-    timerQueue = epicsTimerQueueAllocate(0, epicsThreadPriorityScanHigh);
+    timerQueue = epicsTimerQueueAllocateType(0, epicsThreadPriorityScanHigh,
+        epicsTimerQueueTypeHeap);
 
     for (i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
+        cbQueueSet *mySet = &callbackQueue[i];
         epicsThreadId tid;
 
-        callbackQueue[i].semWakeUp = epicsEventMustCreate(epicsEventEmpty);
-        callbackQueue[i].queue = epicsRingPointerLockedCreate(callbackQueueSize);
-        if (callbackQueue[i].queue == 0)
-            cantProceed("epicsRingPointerLockedCreate failed for %s\n",
-                threadNamePrefix[i]);
-        callbackQueue[i].queueOverflow = FALSE;
-        if (callbackQueue[i].threadsConfigured == 0)
-            callbackQueue[i].threadsConfigured = callbackThreadsDefault;
+        mySet->queueOverflow = FALSE;
+        if (mySet->threadsConfigured == 0)
+            mySet->threadsConfigured = callbackThreadsDefault;
+
+        mySet->workers = callocMustSucceed(mySet->threadsConfigured,
+            sizeof(cbWorker), "callbackInit");
+        queueSize = callbackQueueSize / mySet->threadsConfigured;
+        if (queueSize < 1)
+            queueSize = 1;
+        for (j = 0; j < mySet->threadsConfigured; j++) {
+            cbWorker *worker = &mySet->workers[j];
+
+            worker->set = mySet;
+            worker->index = j;
+            worker->semWakeUp = epicsEventMustCreate(epicsEventEmpty);
+            worker->queue = epicsRingPointerLockedCreate(queueSize);
+            if (worker->queue == 0)
+                cantProceed("epicsRingPointerLockedCreate failed for %s\n",
+                    threadNamePrefix[i]);
+        }
 
-        for (j = 0; j < callbackQueue[i].threadsConfigured; j++) {
+        for (j = 0; j < mySet->threadsConfigured; j++) {
             if (callbackQueue[i].threadsConfigured > 1 )
                 sprintf(threadName, "%s-%d", threadNamePrefix[i], j);
             else
                 strcpy(threadName, threadNamePrefix[i]);
             tid = epicsThreadCreate(threadName, threadPriority[i],
                 epicsThreadGetStackSize(epicsThreadStackBig),
-                (EPICSTHREADFUNC)callbackTask, &priorityValue[i]);
+                (EPICSTHREADFUNC)callbackTask, &mySet->workers[j]);
             if (tid == 0) {
                 cantProceed("Failed to spawn callback thread %s\n", threadName);
             } else {
@@ -321,7 +431,9 @@ int callbackRequest(epicsCallback *pcallback)
 {
     int priority;
     int pushOK;
+    int nWorkers, start, i;
     cbQueueSet *mySet;
+    cbWorker *target;
 
     if (!pcallback) {
         epicsInterruptContextMessage("callbackRequest: pcallback was NULL\n");
@@ -335,7 +447,25 @@ int callbackRequest(epicsCallback *pcallback)
     mySet = &callbackQueue[priority];
     if (mySet->queueOverflow) return S_db_bufFull;
 
-    pushOK = epicsRingPointerPush(mySet->queue, pcallback);
+    /* Prefer an idle thread, starting from the next in turn */
+    nWorkers = mySet->threadsConfigured;
+    start = nWorkers > 1 ?
+        (int)((unsigned)epicsAtomicIncrIntT(&mySet->nextWorker) % nWorkers) : 0;
+    target = &mySet->workers[start];
+    for (i = 0; i < nWorkers; i++) {
+        cbWorker *worker = &mySet->workers[(start + i) % nWorkers];
+
+        if (!epicsAtomicGetIntT(&worker->busy)) {
+            target = worker;
+            break;
+        }
+    }
+
+    pushOK = epicsRingPointerPush(target->queue, pcallback);
+    for (i = 1; !pushOK && i < nWorkers; i++) {
+        target = &mySet->workers[(target->index + 1) % nWorkers];
+        pushOK = epicsRingPointerPush(target->queue, pcallback);
+    }
 
     if (!pushOK) {
         epicsInterruptContextMessage(fullMessage[priority]);
@@ -343,7 +473,7 @@ int callbackRequest(epicsCallback *pcallback)
         epicsAtomicIncrIntT(&mySet->queueOverflows);
         return S_db_bufFull;
     }
-    epicsEventSignal(mySet->semWakeUp);
+    epicsEventSignal(target->semWakeUp);
     return 0;
 }
 
@@ -767,6 +767,9 @@ int dbLoadDatabase(const char *file, const char *path, const char *subs)
     return dbReadDatabase(&pdbbase, file, path, subs);
 }
 
+static dbReadList *loadBatch;
+static int loadBatchThreads;
+
 int dbLoadRecords(const char* file, const char* subs)
 {
     int status;
@@ -775,12 +778,69 @@ int dbLoadRecords(const char* file, const char* subs)
         printf("Usage: dbLoadRecords \"file\", \"subs\"\n");
         return -1;
     }
+    if (loadBatch) {
+        dbReadListAdd(&pdbbase, loadBatch, file, 0, subs);
+        return 0;
+    }
     status = dbReadDatabase(&pdbbase, file, 0, subs);
     if (!status && dbLoadRecordsHook)
         dbLoadRecordsHook(file, subs);
     return status;
 }
 
+int dbLoadRecordsBegin(int nThreads)
+{
+    if (loadBatch) {
+        printf("dbLoadRecordsBegin: %d files already queued\n",
+            dbReadListCount(loadBatch));
+        return -1;
+    }
+    loadBatch = dbReadListCreate();
+    loadBatchThreads = nThreads;
+    return 0;
+}
+
+static void loadBatchDone(const char* file, const char* subs)
+{
+    if (dbLoadRecordsHook)
+        dbLoadRecordsHook(file, subs);
+}
+
+int dbLoadRecordsEnd(void)
+{
+    dbReadList *plist = loadBatch;
+    int status;
+
+    if (!plist)
+        return 0;
+    loadBatch = NULL;
+    status = dbReadListRead(&pdbbase, plist, loadBatchThreads,
+        loadBatchDone);
+    dbReadListReport(plist);
+    dbReadListFree(plist);
+    return status;
+}
+
+int dbLoadSnapshot(const char* file)
+{
+    if (!file) {
+        printf("Usage: dbLoadSnapshot \"file\"\n");
+        return -1;
+    }
+    dbLoadRecordsEnd();
+    return dbReadSnapshot(pdbbase, file);
+}
+
+int dbSaveSnapshot(const char* file)
+{
+    if (!file) {
+        printf("Usage: dbSaveSnapshot \"file\"\n");
+        return -1;
+    }
+    dbLoadRecordsEnd();
+    return dbWriteSnapshot(pdbbase, file);
+}
+
 
 static long getLinkValue(DBADDR *paddr, short dbrType,
     char *pbuf, long *nRequest)
@@ -269,6 +269,14 @@ epicsShareFunc int  dbLoadDatabase(
     const char *filename, const char *path, const char *substitutions);
 epicsShareFunc int dbLoadRecords(
     const char* filename, const char* substitutions);
+/* Queue dbLoadRecords() calls until dbLoadRecordsEnd() (or iocInit) reads
+ * them all, with nThreads threads (0 for one per CPU) expanding the files.
+ */
+epicsShareFunc int dbLoadRecordsBegin(int nThreads);
+epicsShareFunc int dbLoadRecordsEnd(void);
+/* Load or save the records as a binary image, before iocInit */
+epicsShareFunc int dbLoadSnapshot(const char* filename);
+epicsShareFunc int dbSaveSnapshot(const char* filename);
 
 #ifdef __cplusplus
 }
@@ -39,7 +39,7 @@
 /* We can't include dbStaticLib.h here */
 #define dbCalloc(nobj,size) callocMustSucceed(nobj,size,"dbCalloc")
 
-#define epicsExportSharedSymbols
+#include "epicsExport.h" /* defines epicsExportSharedSymbols */
 #include "db_access_routines.h"
 #include "dbCa.h"
 #include "dbCaPvt.h"
@@ -58,17 +58,35 @@
 extern void dbServiceIOInit();
 extern int dbServiceIsolate;
 
-static ELLLIST workList = ELLLIST_INIT;    /* Work list for dbCaTask */
-static epicsMutexId workListLock; /*Mutual exclusions semaphores for workList*/
-static epicsEventId workListEvent; /*wakeup event for dbCaTask*/
-static int removesOutstanding = 0;
+/* Number of dbCaTask threads, 0 for one per CPU.
+ * Read each time iocInit starts the workers. */
+epicsShareDef int dbCaWorkers = 1;
+epicsExportAddress(int, dbCaWorkers);
+
+/* Each link is served by one worker, chosen by hashing its target name,
+ * so the actions on a link are taken in the order they were queued.
+ * The workers share one CA client context.
+ */
+typedef struct dbCaWorker {
+    ELLLIST workList;           /* Work list for this dbCaTask */
+    epicsMutexId workListLock;  /* Guards the fields below */
+    epicsEventId workListEvent; /* wakeup event for dbCaTask */
+    int removesOutstanding;
+    int maxQueued;              /* for dbcar */
+    unsigned long nActions;
+    int stop;
+    int index;
+    epicsThreadId tid;
+} dbCaWorker;
+
+static dbCaWorker *workers;
+static int nWorkers;
 #define removesOutstandingWarning 10000
 
 static volatile enum dbCaCtl_t {
     ctlInit, ctlRun, ctlPause, ctlExit
 } dbCaCtl;
 static epicsEventId startStopEvent;
-static epicsThreadId dbCaWorker;
 
 struct ca_client_context * dbCaClientContext;
 
@@ -89,7 +107,8 @@ static int dbca_chan_count;
  *  dbScanLock -> caLink.lock -> workListLock
  *
  * workListLock:
- *   Guards access to workList.
+ *   Guards access to the workList of one worker.  No thread holds
+ *   the workListLock of more than one worker.
  *
  * dbScanLock:
  *   All dbCa* functions operating on a single link may only be called when
@@ -107,7 +126,7 @@ static int dbca_chan_count;
  * caLink.lock:
  *   Guards the caLink structure (but not the struct DBLINK)
  *
- * The dbCaTask only locks caLink, and must not lock the record (a violation of lock order).
+ * The dbCaTasks only lock caLink, and must not lock the record (a violation of lock order).
  *
  * During link modification or IOC shutdown the pca->plink pointer (guarded by caLink.lock)
  * is used as a flag to indicate that a link is no longer active.
@@ -127,9 +146,10 @@ static int dbca_chan_count;
 
 static void addAction(caLink *pca, short link_action)
 {
+    dbCaWorker *pw = pca->worker;
     int callAdd;
 
-    epicsMutexMustLock(workListLock);
+    epicsMutexMustLock(pw->workListLock);
     callAdd = (pca->link_action == 0);
     if (pca->link_action & CA_CLEAR_CHANNEL) {
         errlogPrintf("dbCa::addAction %d with CA_CLEAR_CHANNEL set\n",
@@ -138,22 +158,30 @@ static void addAction(caLink *pca, short link_action)
         link_action = 0;
     }
     if (link_action & CA_CLEAR_CHANNEL) {
-        if (++removesOutstanding >= removesOutstandingWarning) {
+        if (++pw->removesOutstanding >= removesOutstandingWarning) {
             errlogPrintf("dbCa::addAction pausing, %d channels to clear\n",
-                removesOutstanding);
+                pw->removesOutstanding);
         }
-        while (removesOutstanding >= removesOutstandingWarning) {
-            epicsMutexUnlock(workListLock);
+        while (pw->removesOutstanding >= removesOutstandingWarning) {
+            epicsMutexUnlock(pw->workListLock);
             epicsThreadSleep(1.0);
-            epicsMutexMustLock(workListLock);
+            epicsMutexMustLock(pw->workListLock);
         }
     }
     pca->link_action |= link_action;
+    if (callAdd) {
+        ellAdd(&pw->workList, &pca->node);
+        if (ellCount(&pw->workList) > pw->maxQueued)
+            pw->maxQueued = ellCount(&pw->workList);
+    }
+    epicsMutexUnlock(pw->workListLock);
     if (callAdd)
-        ellAdd(&workList, &pca->node);
-    epicsMutexUnlock(workListLock);
-    if (callAdd)
-        epicsEventSignal(workListEvent);
+        epicsEventSignal(pw->workListEvent);
+}
+
+static dbCaWorker * workerFor(const char *pvname)
+{
+    return &workers[epicsStrHash(pvname, 0) % nWorkers];
 }
 
 static void caLinkInc(caLink *pca)
@@ -175,7 +203,7 @@ static void caLinkDec(caLink *pca)
 
     if (pca->chid) {
         ca_clear_channel(pca->chid);
-        --dbca_chan_count;
+        epicsAtomicDecrIntT(&dbca_chan_count);
     }
     callback = pca->putCallback;
     if (callback) {
@@ -193,13 +221,14 @@ static void caLinkDec(caLink *pca)
     if (callback) callback(userPvt);
 }
 
-/* Block until worker thread has processed all previously queued actions.
- * Does not prevent additional actions from being queued.
+/* Block until the worker threads have processed all previously queued
+ * actions.  Does not prevent additional actions from being queued.
  */
 void dbCaSync(void)
 {
     epicsEventId wake;
     caLink templink;
+    int i;
 
     /* we only partially initialize templink.
      * It has no link field and no subscription
@@ -213,15 +242,18 @@ void dbCaSync(void)
 
     templink.userPvt = wake;
 
-    addAction(&templink, CA_SYNC);
-
-    epicsEventMustWait(wake);
-    /* Worker holds workListLock when calling epicsEventMustTrigger()
-     * we cycle through workListLock to ensure worker call to
-     * epicsEventMustTrigger() returns before we destroy the event.
-     */
-    epicsMutexMustLock(workListLock);
-    epicsMutexUnlock(workListLock);
+    for (i = 0; i < nWorkers; i++) {
+        templink.worker = &workers[i];
+        addAction(&templink, CA_SYNC);
+
+        epicsEventMustWait(wake);
+        /* Worker holds workListLock when calling epicsEventMustTrigger()
+         * we cycle through workListLock to ensure worker call to
+         * epicsEventMustTrigger() returns before we reuse the event.
+         */
+        epicsMutexMustLock(workers[i].workListLock);
+        epicsMutexUnlock(workers[i].workListLock);
+    }
 
     assert(templink.refcount==1);
 
@@ -252,20 +284,49 @@ void dbCaCallbackProcess(void *userPvt)
     dbLinkAsyncComplete(plink);
 }
 
+static void stopWorker(dbCaWorker *pw)
+{
+    epicsMutexMustLock(pw->workListLock);
+    pw->stop = TRUE;
+    epicsMutexUnlock(pw->workListLock);
+    epicsEventSignal(pw->workListEvent);
+    epicsEventMustWait(startStopEvent);
+    if (pw->tid)
+        epicsThreadMustJoin(pw->tid);
+    pw->tid = 0;
+}
+
 void dbCaShutdown(void)
 {
     enum dbCaCtl_t cur = dbCaCtl;
+    int i;
+
     assert(cur == ctlRun || cur == ctlPause);
     dbCaCtl = ctlExit;
-    epicsEventSignal(workListEvent);
-    epicsEventMustWait(startStopEvent);
-    if(dbCaWorker)
-        epicsThreadMustJoin(dbCaWorker);
+    /* The first worker owns the CA context, it must stop last */
+    for (i = nWorkers - 1; i >= 0; i--)
+        stopWorker(&workers[i]);
+}
+
+static void freeWorkers(void)
+{
+    int i;
+
+    /* iocShutdown cleared all the links, nothing refers to these */
+    for (i = 0; i < nWorkers; i++) {
+        epicsMutexDestroy(workers[i].workListLock);
+        epicsEventDestroy(workers[i].workListEvent);
+    }
+    free(workers);
+    workers = NULL;
+    nWorkers = 0;
 }
 
 static void dbCaLinkInitImpl(int isolate)
 {
     epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    int want = dbCaWorkers > 0 ? dbCaWorkers : epicsThreadGetCPUs();
+    int i;
 
     opts.stackSize = epicsThreadGetStackSize(epicsThreadStackBig);
     opts.priority = epicsThreadPriorityMedium;
@@ -274,18 +335,36 @@ static void dbCaLinkInitImpl(int isolate)
     dbServiceIsolate = isolate;
     dbServiceIOInit();
 
-    if (!workListLock)
-        workListLock = epicsMutexMustCreate();
-    if (!workListEvent)
-        workListEvent = epicsEventMustCreate(epicsEventEmpty);
+    if (workers && nWorkers != want)
+        freeWorkers();
+    if (!workers) {
+        nWorkers = want;
+        workers = dbCalloc(nWorkers, sizeof(dbCaWorker));
+        for (i = 0; i < nWorkers; i++) {
+            workers[i].workListLock = epicsMutexMustCreate();
+            workers[i].workListEvent = epicsEventMustCreate(epicsEventEmpty);
+            workers[i].index = i;
+        }
+    }
 
     if(!startStopEvent)
         startStopEvent = epicsEventMustCreate(epicsEventEmpty);
     dbCaCtl = ctlPause;
 
-    dbCaWorker = epicsThreadCreateOpt("dbCaLink", dbCaTask, NULL, &opts);
-    /* wait for worker to startup and initialize dbCaClientContext */
-    epicsEventMustWait(startStopEvent);
+    for (i = 0; i < nWorkers; i++) {
+        char name[20];
+
+        if (i == 0)
+            strcpy(name, "dbCaLink");
+        else
+            sprintf(name, "dbCaLink%d", i);
+        workers[i].stop = FALSE;
+        workers[i].tid = epicsThreadCreateOpt(name, dbCaTask, &workers[i],
+            &opts);
+        /* wait for worker to startup, the first initializes
+         * dbCaClientContext which the others attach to */
+        epicsEventMustWait(startStopEvent);
+    }
 }
 
 void dbCaLinkInitIsolated(void)
@@ -300,17 +379,43 @@ void dbCaLinkInit(void)
 
 void dbCaRun(void)
 {
+    int i;
+
     if (dbCaCtl == ctlPause) {
         dbCaCtl = ctlRun;
-        epicsEventSignal(workListEvent);
+        for (i = 0; i < nWorkers; i++)
+            epicsEventSignal(workers[i].workListEvent);
     }
 }
 
 void dbCaPause(void)
 {
+    int i;
+
     if (dbCaCtl == ctlRun) {
         dbCaCtl = ctlPause;
-        epicsEventSignal(workListEvent);
+        for (i = 0; i < nWorkers; i++)
+            epicsEventSignal(workers[i].workListEvent);
+    }
+}
+
+/* Queue depths and actions taken, for dbcar */
+void dbCaReportWorkers(void)
+{
+    int i;
+
+    for (i = 0; i < nWorkers; i++) {
+        dbCaWorker *pw = &workers[i];
+        int queued, maxQueued;
+        unsigned long nActions;
+
+        epicsMutexMustLock(pw->workListLock);
+        queued = ellCount(&pw->workList);
+        maxQueued = pw->maxQueued;
+        nActions = pw->nActions;
+        epicsMutexUnlock(pw->workListLock);
+        printf("    dbCa worker %d: %d queued, %d at most, %lu done\n",
+            i, queued, maxQueued, nActions);
     }
 }
 
@@ -326,6 +431,7 @@ void dbCaAddLinkCallback(struct link *plink,
     pca->lock = epicsMutexMustCreate();
     pca->plink = plink;
     pca->pvname = epicsStrDup(plink->value.pv_link.pvname);
+    pca->worker = workerFor(pca->pvname);
     pca->connect = connect;
     pca->monitor = monitor;
     pca->userPvt = userPvt;
@@ -1046,36 +1152,47 @@ static void getAttribEventCallback(struct event_handler_args arg)
 
 static void dbCaTask(void *arg)
 {
+    dbCaWorker *pw = (dbCaWorker *) arg;
+
     taskwdInsert(0, NULL, NULL);
-    SEVCHK(ca_context_create(ca_enable_preemptive_callback),
-        "dbCaTask calling ca_context_create");
-    dbCaClientContext = ca_current_context ();
-    SEVCHK(ca_add_exception_event(exceptionCallback,NULL),
-        "ca_add_exception_event");
+    if (pw->index == 0) {
+        SEVCHK(ca_context_create(ca_enable_preemptive_callback),
+            "dbCaTask calling ca_context_create");
+        dbCaClientContext = ca_current_context ();
+        SEVCHK(ca_add_exception_event(exceptionCallback,NULL),
+            "ca_add_exception_event");
+    }
+    else {
+        SEVCHK(ca_attach_context(dbCaClientContext),
+            "dbCaTask calling ca_attach_context");
+    }
     epicsEventSignal(startStopEvent);
 
     /* channel access event loop */
     while (TRUE){
         do {
-            epicsEventMustWait(workListEvent);
+            epicsEventMustWait(pw->workListEvent);
         } while (dbCaCtl == ctlPause);
         while (TRUE) { /* process all requests in workList*/
             caLink *pca;
             short  link_action;
             int    status;
 
-            epicsMutexMustLock(workListLock);
-            if (!(pca = (caLink *)ellGet(&workList))){  /* Take off list head */
-                epicsMutexUnlock(workListLock);
-                if (dbCaCtl == ctlExit) goto shutdown;
+            epicsMutexMustLock(pw->workListLock);
+            if (!(pca = (caLink *)ellGet(&pw->workList))){  /* Take off list head */
+                int stop = pw->stop;
+
+                epicsMutexUnlock(pw->workListLock);
+                if (stop) goto shutdown;
                 break; /* workList is empty */
             }
             link_action = pca->link_action;
             if (link_action&CA_SYNC)
                 epicsEventMustTrigger((epicsEventId)pca->userPvt); /* dbCaSync() requires workListLock to be held here */
             pca->link_action = 0;
-            if (link_action & CA_CLEAR_CHANNEL) --removesOutstanding;
-            epicsMutexUnlock(workListLock);         /* Give back immediately */
+            if (link_action & CA_CLEAR_CHANNEL) --pw->removesOutstanding;
+            pw->nActions++;
+            epicsMutexUnlock(pw->workListLock);         /* Give back immediately */
             if (link_action&CA_SYNC)
                 continue;
             if (link_action & CA_CLEAR_CHANNEL) {   /* This must be first */
@@ -1093,7 +1210,7 @@ static void dbCaTask(void *arg)
                     printLinks(pca);
                     continue;
                 }
-                dbca_chan_count++;
+                epicsAtomicIncrIntT(&dbca_chan_count);
                 status = ca_replace_access_rights_event(pca->chid,
                     accessRightsCallback);
                 if (status != ECA_NORMAL) {
@@ -1197,7 +1314,9 @@ static void dbCaTask(void *arg)
     }
 shutdown:
     taskwdRemove(0);
-    if (dbca_chan_count == 0)
+    if (pw->index != 0)
+        ca_detach_context();
+    else if (dbca_chan_count == 0)
         ca_context_destroy();
     else
         fprintf(stderr, "dbCa: chan_count = %d at shutdown\n", dbca_chan_count);
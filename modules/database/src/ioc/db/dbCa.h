@@ -17,6 +17,9 @@
 extern "C" {
 #endif
 
+/* Threads serving CA links, 0 for one per CPU */
+epicsShareExtern int dbCaWorkers;
+
 typedef void (*dbCaCallback)(void *userPvt);
 epicsShareFunc void dbCaCallbackProcess(void *usrPvt);
 
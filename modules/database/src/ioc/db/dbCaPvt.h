@@ -34,10 +34,13 @@
 #define CA_PUT          0x1
 #define CA_PUT_CALLBACK 0x2
 
+struct dbCaWorker;
+
 typedef struct caLink
 {
     ELLNODE		node;
     int         refcount;
+    struct dbCaWorker	*worker; /* serves this link, see dbCa.c */
     epicsMutexId	lock;
     struct link	*plink;
     char		*pvname;
@@ -95,4 +98,6 @@ typedef struct caLink
     unsigned long   nUpdate;
 }caLink;
 
+void dbCaReportWorkers(void);
+
 #endif /* INC_dbCaPvt_H */
@@ -152,8 +152,10 @@ done:
            nconnected, (ncalinks - nconnected));
     printf("    %d can't read, %d can't write.",
            noReadAccess, noWriteAccess);
-    printf("  (%lu disconnects, %lu writes prohibited)\n\n",
+    printf("  (%lu disconnects, %lu writes prohibited)\n",
            nDisconnect, nNoWrite);
+    dbCaReportWorkers();
+    printf("\n");
     dbFinishEntry(pdbentry);
     
     if ( level > 2  && dbCaClientContext != 0 ) {
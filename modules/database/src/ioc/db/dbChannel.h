@@ -39,8 +39,11 @@ typedef struct evSubscrip {
     void                    *user_arg;
     struct event_que        *ev_que;
     db_field_log            **pLastLog;
-    unsigned long           npend;  /* n times this event is on the queue */
+    size_t                  npend;  /* n times this event is on the queue */
+    size_t                  putPos; /* lock free queue position of last event */
     unsigned long           nreplace;  /* n times replacing event on the queue */
+    unsigned long           ndropped;  /* n values lost (replaced or no memory) */
+    unsigned long           ncoalesced; /* n updates merged into a queued event */
     unsigned char           select;
     char                    useValque;
     char                    callBackInProgress;
@@ -18,9 +18,10 @@
 #include <math.h>
 #include <float.h>
 
+#include "compilerDependencies.h"
 #include "cvtFast.h"
 #include "dbDefs.h"
-#include "epicsConvert.h"
+#include "epicsMath.h"
 #include "epicsStdlib.h"
 #include "errlog.h"
 #include "errMdef.h"
@@ -36,7 +37,20 @@
 #include "recGbl.h"
 #include "recSup.h"
 
-/* Helper for copy as bytes with no type conversion.
+/* Number of elements which can be transferred before the request
+ * wraps around the end of a circular buffer. The remaining elements
+ * continue from the start of the buffer.
+ */
+static EPICS_ALWAYS_INLINE long firstRun(long nRequest, long no_elements,
+    long offset)
+{
+    if (offset < no_elements && offset + nRequest > no_elements)
+        return no_elements - offset;
+    return nRequest;
+}
+
+/* Helpers for copy as bytes with no type conversion, from the field
+ * for a get and to the field for a put. The offset is into the field.
  * Assumes nRequest <= no_bytes
  * nRequest, no_bytes, and offset should be given in bytes.
  */
@@ -57,25 +71,45 @@ static void copyNoConvert(const void *pfrom,
         memmove(pto, pfrom_offset, nRequest);
     }
 }
+
+static void copyNoConvertPut(const void *pfrom,
+    void *pto, long nRequest, long no_bytes, long offset)
+{
+    void *pto_offset = (char *) pto + offset;
+
+    if (offset > 0 && offset < no_bytes && offset + nRequest > no_bytes) {
+        const size_t N = no_bytes - offset;
+        const void *pfrom_N = (const char *) pfrom + N;
+
+        /* copy with wrap */
+        memmove(pto_offset, pfrom,   N);
+        memmove(pto,        pfrom_N, nRequest - N);
+    } else {
+        /* no wrap, just copy */
+        memmove(pto_offset, pfrom, nRequest);
+    }
+}
 #define COPYNOCONVERT(N, FROM, TO, NREQ, NO_ELEM, OFFSET) \
     copyNoConvert(FROM, TO, (N)*(NREQ), (N)*(NO_ELEM), (N)*(OFFSET))
+#define COPYNOCONVERTPUT(N, FROM, TO, NREQ, NO_ELEM, OFFSET) \
+    copyNoConvertPut(FROM, TO, (N)*(NREQ), (N)*(NO_ELEM), (N)*(OFFSET))
 
+/* The converting routines split the request at the wrap point, so that
+ * each part is a simple loop over contiguous elements which the
+ * compiler can vectorize.
+ */
 #define GET(typea, typeb) (const dbAddr *paddr, \
     void *pto, long nRequest, long no_elements, long offset) \
 { \
-    typea *psrc = (typea *) paddr->pfield; \
+    const typea *psrc = (const typea *) paddr->pfield; \
     typeb *pdst = (typeb *) pto; \
+    long i, n = firstRun(nRequest, no_elements, offset); \
     \
-    if (nRequest==1 && offset==0) { \
-        *pdst = (typeb) *psrc; \
-        return 0; \
-    } \
-    psrc += offset; \
-    while (nRequest--) { \
-        *pdst++ = (typeb) *psrc++; \
-        if (++offset == no_elements) \
-            psrc = (typea *) paddr->pfield; \
-    } \
+    for (i = 0; i < n; i++) \
+        pdst[i] = (typeb) psrc[offset + i]; \
+    pdst += n; \
+    for (i = 0; i < nRequest - n; i++) \
+        pdst[i] = (typeb) psrc[i]; \
     return 0; \
 }
 
@@ -98,17 +132,13 @@ static void copyNoConvert(const void *pfrom,
 { \
     const typea *psrc = (const typea *) pfrom; \
     typeb *pdst = (typeb *) paddr->pfield; \
+    long i, n = firstRun(nRequest, no_elements, offset); \
     \
-    if (nRequest==1 && offset==0) { \
-        *pdst = (typeb) *psrc; \
-        return 0; \
-    } \
-    pdst += offset; \
-    while (nRequest--) { \
-        *pdst++ = (typeb) *psrc++; \
-        if (++offset == no_elements) \
-            pdst = (typeb *) paddr->pfield; \
-    } \
+    for (i = 0; i < n; i++) \
+        pdst[offset + i] = (typeb) psrc[i]; \
+    psrc += n; \
+    for (i = 0; i < nRequest - n; i++) \
+        pdst[i] = (typeb) psrc[i]; \
     return 0; \
 }
 
@@ -122,11 +152,27 @@ static void copyNoConvert(const void *pfrom,
         *pdst = (typeb) *psrc; \
         return 0; \
     } \
-    COPYNOCONVERT(sizeof(typeb), pfrom, paddr->pfield, nRequest, no_elements, offset); \
+    COPYNOCONVERTPUT(sizeof(typeb), pfrom, paddr->pfield, nRequest, no_elements, offset); \
     return 0; \
 }
 
-
+/* Same as epicsConvertDoubleToFloat(), but inline so the array loops
+ * using it can be vectorized.
+ */
+static EPICS_ALWAYS_INLINE epicsFloat32 doubleToFloat(epicsFloat64 value)
+{
+    epicsFloat64 abs = fabs(value);
+
+    if (value == 0 || !finite(value))
+        return (epicsFloat32) value;
+    if (abs >= FLT_MAX)
+        return (value > 0) ? FLT_MAX : -FLT_MAX;
+    if (abs <= FLT_MIN)
+        return (value > 0) ? FLT_MIN : -FLT_MIN;
+    return (epicsFloat32) value;
+}
+
+
 /* dbAccess Get conversion support routines */
 
 static long getStringString(const dbAddr *paddr,
@@ -810,20 +856,15 @@ static long getDoubleUInt64 GET(epicsFloat64, epicsUInt64)
 static long getDoubleFloat(const dbAddr *paddr,
     void *pto, long nRequest, long no_elements, long offset)
 {
-    epicsFloat64 *psrc = (epicsFloat64 *) paddr->pfield;
+    const epicsFloat64 *psrc = (const epicsFloat64 *) paddr->pfield;
     epicsFloat32 *pdst = (epicsFloat32 *) pto;
+    long i, n = firstRun(nRequest, no_elements, offset);
 
-    if (nRequest==1 && offset==0) {
-        *pdst = epicsConvertDoubleToFloat(*psrc);
-        return 0;
-    }
-    psrc += offset;
-    while (nRequest--) {
-        *pdst = epicsConvertDoubleToFloat(*psrc);
-        ++psrc; ++pdst;
-        if (++offset == no_elements)
-            psrc = (epicsFloat64 *) paddr->pfield;
-    }
+    for (i = 0; i < n; i++)
+        pdst[i] = doubleToFloat(psrc[offset + i]);
+    pdst += n;
+    for (i = 0; i < nRequest - n; i++)
+        pdst[i] = doubleToFloat(psrc[i]);
     return 0;
 }
 
@@ -1641,17 +1682,13 @@ static long putDoubleFloat(dbAddr *paddr,
 {
     const epicsFloat64 *psrc = (const epicsFloat64 *) pfrom;
     epicsFloat32 *pdst = (epicsFloat32 *) paddr->pfield;
+    long i, n = firstRun(nRequest, no_elements, offset);
 
-    if (nRequest==1 && offset==0) {
-        *pdst = epicsConvertDoubleToFloat(*psrc);
-        return 0;
-    }
-    pdst += offset;
-    while (nRequest--) {
-        *pdst++ = epicsConvertDoubleToFloat(*psrc++);
-        if (++offset == no_elements)
-            pdst = (epicsFloat32 *) paddr->pfield;
-    }
+    for (i = 0; i < n; i++)
+        pdst[offset + i] = doubleToFloat(psrc[i]);
+    psrc += n;
+    for (i = 0; i < nRequest - n; i++)
+        pdst[i] = doubleToFloat(psrc[i]);
     return 0;
 }
 
@@ -27,16 +27,19 @@
 #include "cantProceed.h"
 #include "dbDefs.h"
 #include "epicsAssert.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
+#include "epicsStdio.h"
 #include "epicsThread.h"
+#include "epicsTime.h"
 #include "errlog.h"
 #include "freeList.h"
 #include "taskwd.h"
 
 #include "caeventmask.h"
 
-#define epicsExportSharedSymbols
+#include "epicsExport.h" /* #define epicsExportSharedSymbols */
 #include "dbAccessDefs.h"
 #include "dbAddr.h"
 #include "dbBase.h"
@@ -47,6 +50,7 @@
 #include "dbFldTypes.h"
 #include "dbLock.h"
 #include "link.h"
+#include "recSup.h"
 #include "special.h"
 
 /* Queue size based on Ethernet MTU of 1500 bytes.
@@ -56,26 +60,108 @@
  * (1500-66)/40 -> 35
  */
 #define EVENTSPERQUE    36
-#define EVENTENTRIES    4      /* the number of que entries for each event */
-#define EVENTQUESIZE    (EVENTENTRIES  * EVENTSPERQUE)
+#define EVENTENTRIES    4      /* default que entries for each event */
+#define EVENTQUESIZE    (EVENTENTRIES  * EVENTSPERQUE) /* minimum que size */
 #define EVENTQEMPTY     ((struct evSubscrip *)NULL)
 
+/* Number of queue entries reserved for each subscription */
+epicsShareDef int dbEventQueueDepth = EVENTENTRIES;
+epicsExportAddress(int, dbEventQueueDepth);
+
+/* Queue type used by db_init_events() */
+epicsShareDef int dbEventQueueLockFree = 0;
+epicsExportAddress(int, dbEventQueueLockFree);
+
+/* Event task batching defaults, see db_event_set_batching() */
+epicsShareDef int dbEventSpinYields = 0;
+epicsExportAddress(int, dbEventSpinYields);
+epicsShareDef double dbEventBatchDelay = 0.0;
+epicsExportAddress(double, dbEventBatchDelay);
+
+/* Threads serving db_start_events_pooled() contexts, 0 for one per CPU */
+epicsShareDef int dbEventPoolThreads = 0;
+epicsExportAddress(int, dbEventPoolThreads);
+
+/* Smallest array posted as a shared snapshot, 0 to disable */
+epicsShareDef int dbEventSnapshotBytes = 0;
+epicsExportAddress(int, dbEventSnapshotBytes);
+
+/*
+ * Copy of an array field taken once by db_post_events() and referenced
+ * by the field logs of all subscriptions to that field, which must not
+ * write to it.  Filters may narrow their reference to a slice of it (see
+ * db_field_log_view()).  Servers may hang converted copies of the whole
+ * data on it (see db_snapshot_derived()) which are freed along with the
+ * snapshot.
+ */
+struct snapshotDerived {
+    struct snapshotDerived  *next;
+    int                     dbrType;
+    long                    count;
+    size_t                  size;
+    double                  data[1];    /* aligned for any DBR type */
+};
+
+struct dbEventSnapshot {
+    int                     refcnt;     /* atomic */
+    epicsMutexId            lock;       /* guards derived */
+    struct snapshotDerived  *derived;
+    const void              *pfield;    /* field this was copied from */
+    long                    no_elements;
+    epicsTimeStamp          time;       /* record's, when copied */
+    unsigned short          stat;
+    unsigned short          sevr;
+    double                  data[1];    /* aligned for any DBF type */
+};
+
+/*
+ * Entry in a lock free queue.
+ *
+ * The seq member follows the queue position p which the slot holds:
+ *   p      free, may be taken by the producer which reserves position p
+ *   p+1    published, holds an event
+ *   p+2    claimed, by the event task while it removes the event
+ *          or by a producer which is replacing its last event
+ * When the event task is done the slot is freed for position p+size.
+ */
+struct event_slot {
+    size_t                  seq;
+    struct evSubscrip       *pevent;
+    db_field_log            *pfl;
+};
+
 /*
  * really a ring buffer
+ *
+ * The locked ring is sized from the number of subscriptions, and is
+ * grown or shrunk by ev_que_resize() while holding only the
+ * writelock of this queue.
+ *
+ * A lock free ring (slots != NULL) has a fixed power of two size.
+ * Posting threads never take the writelock, which then only
+ * serializes the event task against db_add_event()/db_cancel_event().
+ * More lock free rings are chained on when the quota is exceeded.
  */
 struct event_que {
     /* lock writers to the ring buffer only */
     /* readers must never slow up writers */
     epicsMutexId            writelock;
-    db_field_log            *valque[EVENTQUESIZE];
-    struct evSubscrip       *evque[EVENTQUESIZE];
-    struct event_que        *nextque;       /* in case que quota exceeded */
+    db_field_log            **valque;
+    struct evSubscrip       **evque;
+    struct event_slot       *slots;         /* lock free ring or NULL */
+    struct event_que        *nextque;       /* chained lock free rings */
     struct event_user       *evUser;        /* event user parent struct */
-    unsigned short          putix;
-    unsigned short          getix;
-    unsigned short          quota;          /* the number of assigned entries*/
-    unsigned short          nDuplicates;    /* N events duplicated on this q */
-    unsigned short          nCanceled;      /* the number of canceled entries */
+    size_t                  lfPutix;        /* atomic, next lock free put */
+    size_t                  lfGetix;        /* atomic, next lock free get */
+    int                     lfDuplicates;   /* atomic nDuplicates */
+    unsigned                size;           /* the number of ring entries */
+    unsigned                putix;
+    unsigned                getix;
+    unsigned                depth;          /* entries per subscription */
+    unsigned                quota;          /* the number of assigned entries*/
+    unsigned                nDuplicates;    /* N events duplicated on this q */
+    unsigned                nCanceled;      /* the number of canceled entries */
+    unsigned                nResize;        /* the number of ring resizes */
 };
 
 struct event_user {
@@ -97,16 +183,56 @@ struct event_user {
     unsigned char       extraLaborBusy;
     void                (*init_func)();
     epicsThreadId       init_func_arg;
+
+    unsigned            spinYields;     /* yields before blocking */
+    double              batchDelay;     /* min delay after a wakeup */
+    size_t              nWakeups;       /* passes of the event task */
+    size_t              nEvents;        /* events delivered */
+    /* db_event_stats() interval, guarded by lock */
+    epicsTimeStamp      statsStart;
+    size_t              statsWakeups;   /* nWakeups at statsStart */
+    size_t              statsEvents;    /* nEvents at statsStart */
+    double              wakeupRate;     /* over the previous interval */
+    double              eventsPerWakeup;
+    unsigned char       statsValid;     /* an interval has completed */
+
+    ELLNODE             poolNode;       /* on eventPool.ready */
+    unsigned char       pooled;         /* served by the event pool */
+    unsigned char       scheduled;      /* on eventPool.ready */
+    unsigned char       running;        /* a pool thread has it */
+    unsigned char       rerun;          /* signaled while running */
 };
 
+/*
+ * Threads shared by the event users started with db_start_events_pooled().
+ * A user which is signaled is queued once on the ready list, and is only
+ * ever run by one pool thread at a time.  The threads are started for the
+ * first pooled user, and joined when the last one is closed.
+ */
+static struct {
+    epicsMutexId        lock;
+    epicsMutexId        startStop;      /* held to start or join threads */
+    epicsEventId        wakeup;
+    ELLLIST             ready;
+    epicsThreadId       *threads;
+    unsigned            nThreads;
+    unsigned            nUsers;         /* guarded by startStop */
+    unsigned char       exiting;        /* threads return when idle */
+} eventPool;
+static epicsThreadOnceId eventPoolOnce = EPICS_THREAD_ONCE_INIT;
+
+static void event_signal ( struct event_user * const evUser );
+static void event_user_free ( struct event_user * const evUser );
+static void event_pool_stop ( void );
+
 /*
  * Reliable intertask communication requires copying the current value of the
  * channel for later queing so 3 stepper motor steps of 10 each do not turn
  * into only 10 or 20 total steps part of the time.
  */
 
-#define RNGINC(OLD)\
-( (unsigned short) ( (OLD) >= (EVENTQUESIZE-1) ? 0 : (OLD)+1 ) )
+#define RNGINC(EV_QUE, OLD)\
+( (OLD) + 1u >= (EV_QUE)->size ? 0u : (OLD) + 1u )
 
 #define LOCKEVQUE(EV_QUE)   epicsMutexMustLock((EV_QUE)->writelock)
 #define UNLOCKEVQUE(EV_QUE) epicsMutexUnlock((EV_QUE)->writelock)
@@ -114,7 +240,6 @@ struct event_user {
 #define UNLOCKREC(RECPTR)   epicsMutexUnlock((RECPTR)->mlok)
 
 static void *dbevEventUserFreeList;
-static void *dbevEventQueueFreeList;
 static void *dbevEventSubscriptionFreeList;
 static void *dbevFieldLogFreeList;
 
@@ -122,19 +247,64 @@ static char *EVENT_PEND_NAME = "eventTask";
 
 static struct evSubscrip canceledEvent;
 
-static unsigned short ringSpace ( const struct event_que *pevq )
+static unsigned ringSpace ( const struct event_que *pevq )
 {
+    if ( pevq->slots ) {
+        /* read getix first so that the difference can't go negative */
+        size_t getix = epicsAtomicGetSizeT ( &pevq->lfGetix );
+        size_t used = epicsAtomicGetSizeT ( &pevq->lfPutix ) - getix;
+        return used < pevq->size ? pevq->size - (unsigned) used : 0u;
+    }
     if ( pevq->evque[pevq->putix] == EVENTQEMPTY ) {
         if ( pevq->getix > pevq->putix ) {
-            return ( unsigned short ) ( pevq->getix - pevq->putix );
+            return pevq->getix - pevq->putix;
         }
         else {
-            return ( unsigned short ) ( ( EVENTQUESIZE + pevq->getix ) - pevq->putix );
+            return ( pevq->size + pevq->getix ) - pevq->putix;
         }
     }
     return 0;
 }
 
+/*
+ * Once a queue has no more than this many free entries, subscriptions
+ * which already have an event queued replace their last event.
+ * There must always be room for one event from each subscription.
+ */
+static unsigned ringReserve ( const struct event_que *pevq )
+{
+    unsigned nSubscr = pevq->quota / pevq->depth;
+    return nSubscr > EVENTSPERQUE ? nSubscr : EVENTSPERQUE;
+}
+
+/*
+ * The number of entries needed for the present subscriptions
+ * plus any canceled entries still occupying the ring.
+ */
+static unsigned ringNeeded ( const struct event_que *pevq )
+{
+    return pevq->quota + pevq->nCanceled + ringReserve ( pevq );
+}
+
+/*
+ * The ring size this queue should have.  Grow by at least doubling,
+ * shrink by halving once less than a quarter of the ring is needed.
+ */
+static unsigned ringWanted ( const struct event_que *pevq )
+{
+    unsigned need = ringNeeded ( pevq );
+
+    if ( need > pevq->size ) {
+        unsigned want = pevq->size * 2u;
+        return want > need ? want : need;
+    }
+    if ( pevq->size > EVENTQUESIZE && need * 4u <= pevq->size ) {
+        unsigned want = pevq->size / 2u;
+        return want > EVENTQUESIZE ? want : EVENTQUESIZE;
+    }
+    return pevq->size;
+}
+
 /*
  *  db_event_list ()
  */
@@ -187,21 +357,23 @@ int dbel ( const char *pname, unsigned level )
 	        printf ( "}" );
 
             if ( pevent->npend ) {
-                printf ( " undelivered=%ld", pevent->npend );
+                printf ( " undelivered=%lu", (unsigned long) pevent->npend );
             }
 
             if ( level > 1 ) {
                 unsigned nEntriesFree;
+                unsigned nEntries;
                 const void * taskId;
                 LOCKEVQUE(pevent->ev_que);
                 nEntriesFree = ringSpace ( pevent->ev_que );
+                nEntries = pevent->ev_que->size;
                 taskId = ( void * ) pevent->ev_que->evUser->taskid;
                 UNLOCKEVQUE(pevent->ev_que);
                 if ( nEntriesFree == 0u ) {
                     printf ( ", thread=%p, queue full",
                         (void *) taskId );
                 }
-                else if ( nEntriesFree == EVENTQUESIZE ) {
+                else if ( nEntriesFree == nEntries ) {
                     printf ( ", thread=%p, queue empty",
                         (void *) taskId );
                 }
@@ -209,6 +381,14 @@ int dbel ( const char *pname, unsigned level )
                     printf ( ", thread=%p, unused entries=%u",
                         (void *) taskId, nEntriesFree );
                 }
+                printf ( ", queue size=%u", nEntries );
+                {
+                    double wakeupRate, eventsPerWakeup;
+                    db_event_stats ( pevent->ev_que->evUser,
+                        &wakeupRate, &eventsPerWakeup );
+                    printf ( ", %.1f wakeups/s, %.1f events/wakeup",
+                        wakeupRate, eventsPerWakeup );
+                }
             }
 
             if ( level > 2 ) {
@@ -217,11 +397,18 @@ int dbel ( const char *pname, unsigned level )
                 if ( pevent->nreplace ) {
                     printf (", discarded by replacement=%ld", pevent->nreplace);
                 }
+                if ( pevent->ndropped ) {
+                    printf (", dropped=%lu", pevent->ndropped);
+                }
+                if ( pevent->ncoalesced ) {
+                    printf (", coalesced=%lu", pevent->ncoalesced);
+                }
                 if ( ! pevent->useValque ) {
                     printf (", queueing disabled" );
                 }
                 LOCKEVQUE(pevent->ev_que);
-                nDuplicates = pevent->ev_que->nDuplicates;
+                nDuplicates = pevent->ev_que->nDuplicates + (unsigned)
+                    epicsAtomicGetIntT ( &pevent->ev_que->lfDuplicates );
                 nCanceled = pevent->ev_que->nCanceled;
                 UNLOCKEVQUE(pevent->ev_que);
                 if  ( nDuplicates ) {
@@ -259,7 +446,61 @@ int dbel ( const char *pname, unsigned level )
  *
  * returns: ptr to event user block or NULL if memory can't be allocated
  */
+/*
+ * lock free rings are sized to a power of two with room for
+ * EVENTSPERQUE subscriptions, plus their reserve
+ */
+static int ev_que_init_lf ( struct event_que * const ev_que )
+{
+    size_t size = 4u;
+    size_t i;
+
+    while ( size < ( ev_que->depth + 1u ) * EVENTSPERQUE ) {
+        size <<= 1;
+    }
+    ev_que->slots = (struct event_slot *)
+        calloc ( size, sizeof(struct event_slot) );
+    if ( ! ev_que->slots ) {
+        return -1;
+    }
+    for ( i = 0u; i < size; i++ ) {
+        ev_que->slots[i].seq = i;
+    }
+    ev_que->size = (unsigned) size;
+    return 0;
+}
+
+/*
+ * create_ev_que()
+ * another lock free ring for the chain
+ */
+static struct event_que * create_ev_que ( struct event_user * const evUser )
+{
+    struct event_que * const ev_que = (struct event_que *)
+        calloc ( 1, sizeof(struct event_que) );
+    if ( ! ev_que ) {
+        return NULL;
+    }
+    ev_que->writelock = epicsMutexCreate();
+    ev_que->evUser = evUser;
+    ev_que->depth = evUser->firstque.depth;
+    if ( ! ev_que->writelock || ev_que_init_lf ( ev_que ) ) {
+        if ( ev_que->writelock ) {
+            epicsMutexDestroy ( ev_que->writelock );
+        }
+        free ( ev_que );
+        return NULL;
+    }
+    return ev_que;
+}
+
 dbEventCtx db_init_events (void)
+{
+    return db_init_events_type ( dbEventQueueLockFree ?
+        DB_EVENT_QUE_LOCKFREE : DB_EVENT_QUE_LOCKED );
+}
+
+dbEventCtx db_init_events_type (int queType)
 {
     struct event_user * evUser;
 
@@ -267,17 +508,14 @@ dbEventCtx db_init_events (void)
         freeListInitPvt(&dbevEventUserFreeList,
             sizeof(struct event_user),8);
     }
-    if (!dbevEventQueueFreeList) {
-        freeListInitPvt(&dbevEventQueueFreeList,
-            sizeof(struct event_que),8);
-    }
     if (!dbevEventSubscriptionFreeList) {
         freeListInitPvt(&dbevEventSubscriptionFreeList,
             sizeof(struct evSubscrip),256);
     }
     if (!dbevFieldLogFreeList) {
-        freeListInitPvt(&dbevFieldLogFreeList,
-            sizeof(struct db_field_log),2048);
+        /* allocated by posting threads, freed by the event tasks */
+        freeListInitPvtCache(&dbevFieldLogFreeList,
+            sizeof(struct db_field_log),2048,64);
     }
 
     evUser = (struct event_user *)
@@ -290,6 +528,21 @@ dbEventCtx db_init_events (void)
     evUser->firstque.writelock = epicsMutexCreate();
     if (!evUser->firstque.writelock)
         goto fail;
+    evUser->firstque.depth = dbEventQueueDepth > 0 ?
+        (unsigned) dbEventQueueDepth : 1u;
+    if (queType == DB_EVENT_QUE_LOCKFREE) {
+        if (ev_que_init_lf(&evUser->firstque))
+            goto fail;
+    }
+    else {
+        evUser->firstque.size = EVENTQUESIZE;
+        evUser->firstque.evque = (struct evSubscrip **)
+            calloc(EVENTQUESIZE, sizeof(struct evSubscrip *));
+        evUser->firstque.valque = (db_field_log **)
+            calloc(EVENTQUESIZE, sizeof(db_field_log *));
+        if (!evUser->firstque.evque || !evUser->firstque.valque)
+            goto fail;
+    }
 
     evUser->ppendsem = epicsEventCreate(epicsEventEmpty);
     if (!evUser->ppendsem)
@@ -304,12 +557,19 @@ dbEventCtx db_init_events (void)
     evUser->flowCtrlMode = FALSE;
     evUser->extraLaborBusy = FALSE;
     evUser->pSuicideEvent = NULL;
+    evUser->spinYields = dbEventSpinYields > 0 ?
+        (unsigned) dbEventSpinYields : 0u;
+    evUser->batchDelay = dbEventBatchDelay;
+    epicsTimeGetMonotonic(&evUser->statsStart);
     return (dbEventCtx) evUser;
 fail:
     if(evUser->lock)
         epicsMutexDestroy (evUser->lock);
     if(evUser->firstque.writelock)
         epicsMutexDestroy (evUser->firstque.writelock);
+    free(evUser->firstque.evque);
+    free(evUser->firstque.valque);
+    free(evUser->firstque.slots);
     if(evUser->ppendsem)
         epicsEventDestroy (evUser->ppendsem);
     if(evUser->pflush_sem)
@@ -324,9 +584,6 @@ epicsShareFunc void db_cleanup_events(void)
     if(dbevEventUserFreeList) freeListCleanup(dbevEventUserFreeList);
     dbevEventUserFreeList = NULL;
 
-    if(dbevEventQueueFreeList) freeListCleanup(dbevEventQueueFreeList);
-    dbevEventQueueFreeList = NULL;
-
     if(dbevEventSubscriptionFreeList) freeListCleanup(dbevEventSubscriptionFreeList);
     dbevEventSubscriptionFreeList = NULL;
 
@@ -358,6 +615,20 @@ void db_close_events (dbEventCtx ctx)
     evUser->pendexit = TRUE;
     epicsMutexUnlock ( evUser->lock );
 
+    if ( evUser->pooled ) {
+        /* the pool thread signals ppendsem after its last pass */
+        event_signal ( evUser );
+        epicsEventMustWait ( evUser->ppendsem );
+        event_user_free ( evUser );
+
+        epicsMutexMustLock ( eventPool.startStop );
+        if ( --eventPool.nUsers == 0u ) {
+            event_pool_stop ();
+        }
+        epicsMutexUnlock ( eventPool.startStop );
+        return;
+    }
+
     /* notify the waiting task */
     epicsEventSignal(evUser->ppendsem);
 
@@ -367,22 +638,78 @@ void db_close_events (dbEventCtx ctx)
 }
 
 /*
- * create_ev_que()
+ * ev_que_resize()
+ *
+ * Grow or shrink the ring to suit the current subscription quota.
+ * Called without the queue lock; the new ring is allocated before
+ * the lock is taken so writers are only held off while the queued
+ * entries are moved.  Callers serialize through evUser->lock.
  */
-static struct event_que * create_ev_que ( struct event_user * const evUser )
+static int ev_que_resize ( struct event_que * const ev_que )
 {
-    struct event_que * const ev_que = (struct event_que *) 
-        freeListCalloc ( dbevEventQueueFreeList );
-    if ( ! ev_que ) {
-        return NULL;
+    if ( ev_que->slots ) {
+        return 0;   /* lock free rings are chained instead */
     }
-    ev_que->writelock = epicsMutexCreate();
-    if ( ! ev_que->writelock ) {
-        freeListFree ( dbevEventQueueFreeList, ev_que );
-        return NULL;
+    while ( TRUE ) {
+        struct evSubscrip **evque, **oldEvque;
+        db_field_log **valque, **oldValque;
+        unsigned want, nUsed, ix, i;
+
+        LOCKEVQUE ( ev_que );
+        want = ringWanted ( ev_que );
+        if ( want == ev_que->size ) {
+            UNLOCKEVQUE ( ev_que );
+            return 0;
+        }
+        UNLOCKEVQUE ( ev_que );
+
+        evque = (struct evSubscrip **)
+            calloc ( want, sizeof(struct evSubscrip *) );
+        valque = (db_field_log **)
+            calloc ( want, sizeof(db_field_log *) );
+        if ( ! evque || ! valque ) {
+            free ( evque );
+            free ( valque );
+            return -1;
+        }
+
+        LOCKEVQUE ( ev_que );
+        nUsed = ev_que->size - ringSpace ( ev_que );
+        if ( want < ringNeeded ( ev_que ) || want < nUsed ) {
+            /* the queue changed while unlocked, try again */
+            UNLOCKEVQUE ( ev_que );
+            free ( evque );
+            free ( valque );
+            continue;
+        }
+
+        /*
+         * move the entries in queue order so that each subscription's
+         * pLastLog ends up pointing at its last entry in the new ring
+         */
+        ix = ev_que->getix;
+        for ( i = 0u; i < nUsed; i++ ) {
+            evque[i] = ev_que->evque[ix];
+            valque[i] = ev_que->valque[ix];
+            if ( evque[i] != &canceledEvent ) {
+                evque[i]->pLastLog = &valque[i];
+            }
+            ix = RNGINC ( ev_que, ix );
+        }
+        oldEvque = ev_que->evque;
+        oldValque = ev_que->valque;
+        ev_que->evque = evque;
+        ev_que->valque = valque;
+        ev_que->size = want;
+        ev_que->getix = 0u;
+        ev_que->putix = nUsed < want ? nUsed : 0u;
+        ev_que->nResize++;
+        UNLOCKEVQUE ( ev_que );
+
+        free ( oldEvque );
+        free ( oldValque );
+        return 0;
     }
-    ev_que->evUser = evUser;
-    return ev_que;
 }
 
 /*
@@ -408,17 +735,17 @@ dbEventSubscription db_add_event (
         return NULL;
     }
 
-    /* find an event que block with enough quota */
-    /* otherwise add a new one to the list */
+    /* reserve entries for this subscription, growing the que if needed */
     epicsMutexMustLock ( evUser->lock );
     ev_que = & evUser->firstque;
-    while ( TRUE ) {
-        int success = 0;
+    while ( ev_que->slots ) {
+        /* find a lock free ring with enough quota, or chain on a new one */
+        int success;
         LOCKEVQUE ( ev_que );
-        success = ( ev_que->quota + ev_que->nCanceled < 
-                                EVENTQUESIZE - EVENTENTRIES );
-        if ( success ) {
-            ev_que->quota += EVENTENTRIES;
+        ev_que->quota += ev_que->depth;
+        success = ringNeeded ( ev_que ) <= ev_que->size;
+        if ( ! success ) {
+            ev_que->quota -= ev_que->depth;
         }
         UNLOCKEVQUE ( ev_que );
         if ( success ) {
@@ -433,6 +760,17 @@ dbEventSubscription db_add_event (
         }
         ev_que = ev_que->nextque;
     }
+    if ( ev_que && ! ev_que->slots ) {
+        LOCKEVQUE ( ev_que );
+        ev_que->quota += ev_que->depth;
+        UNLOCKEVQUE ( ev_que );
+    }
+    if ( ev_que && ev_que_resize ( ev_que ) ) {
+        LOCKEVQUE ( ev_que );
+        ev_que->quota -= ev_que->depth;
+        UNLOCKEVQUE ( ev_que );
+        ev_que = NULL;
+    }
     epicsMutexUnlock ( evUser->lock );
 
     if ( ! ev_que ) {
@@ -440,8 +778,11 @@ dbEventSubscription db_add_event (
         return NULL;
     }
 
-    pevent->npend =     0ul;
+    pevent->npend =     0u;
+    pevent->putPos =    0u;
     pevent->nreplace =  0ul;
+    pevent->ndropped =  0ul;
+    pevent->ncoalesced = 0ul;
     pevent->user_sub =  user_sub;
     pevent->user_arg =  user_arg;
     pevent->chan =      chan;
@@ -506,7 +847,7 @@ void db_event_disable (dbEventSubscription event)
  * this nulls the entry in the queue, but doesn't delete the db_field_log chunk
  */
 static void event_remove ( struct event_que *ev_que,
-    unsigned short index, struct evSubscrip *placeHolder )
+    unsigned index, struct evSubscrip *placeHolder )
 {
     struct evSubscrip * const pevent = ev_que->evque[index];
 
@@ -523,6 +864,41 @@ static void event_remove ( struct event_que *ev_que,
     pevent->npend--;
 }
 
+/*
+ * event_purge_lf()
+ * event queue lock _must_ be applied, which keeps the event task out
+ * mark all entries of a canceled subscription on a lock free ring
+ */
+static void event_purge_lf ( struct event_que *ev_que,
+    struct evSubscrip *pevent )
+{
+    size_t pos = epicsAtomicGetSizeT ( &ev_que->lfGetix );
+    size_t const putix = epicsAtomicGetSizeT ( &ev_que->lfPutix );
+
+    for ( ; pos != putix; pos++ ) {
+        struct event_slot * const pslot =
+            &ev_que->slots[pos & ( ev_que->size - 1u )];
+
+        /* skip entries being written or replaced by other subscriptions */
+        if ( epicsAtomicCmpAndSwapSizeT ( &pslot->seq,
+                pos + 1u, pos + 2u ) != pos + 1u ) {
+            continue;
+        }
+        epicsAtomicReadMemoryBarrier ();
+        if ( pslot->pevent == pevent ) {
+            pslot->pevent = &canceledEvent;
+            db_delete_field_log ( pslot->pfl );
+            pslot->pfl = NULL;
+            ev_que->nCanceled++;
+            if ( epicsAtomicDecrSizeT ( &pevent->npend ) > 0u ) {
+                epicsAtomicDecrIntT ( &ev_que->lfDuplicates );
+            }
+        }
+        epicsAtomicWriteMemoryBarrier ();
+        epicsAtomicSetSizeT ( &pslot->seq, pos + 1u );
+    }
+}
+
 /*
  * DB_CANCEL_EVENT()
  *
@@ -533,7 +909,8 @@ static void event_remove ( struct event_que *ev_que,
 void db_cancel_event (dbEventSubscription event)
 {
     struct evSubscrip * const pevent = (struct evSubscrip *) event;
-    unsigned short getix;
+    struct event_que * const ev_que = pevent->ev_que;
+    unsigned getix;
 
     db_event_disable ( event );
 
@@ -557,14 +934,17 @@ void db_cancel_event (dbEventSubscription event)
      * here will block CA's TCP input queue then a dead lock
      * would be possible.
      */
-    for (   getix = pevent->ev_que->getix;
+    if ( pevent->ev_que->slots ) {
+        event_purge_lf ( pevent->ev_que, pevent );
+    }
+    else for (   getix = pevent->ev_que->getix;
             pevent->ev_que->evque[getix] != EVENTQEMPTY; ) {
         if ( pevent->ev_que->evque[getix] == pevent ) {
-            assert ( pevent->ev_que->nCanceled < USHRT_MAX );
+            assert ( pevent->ev_que->nCanceled < UINT_MAX );
             pevent->ev_que->nCanceled++;
             event_remove ( pevent->ev_que, getix, &canceledEvent );
         }
-        getix = RNGINC ( getix );
+        getix = RNGINC ( pevent->ev_que, getix );
         if ( getix == pevent->ev_que->getix ) {
             break;
         }
@@ -582,12 +962,17 @@ void db_cancel_event (dbEventSubscription event)
         }
     }
 
-    pevent->ev_que->quota -= EVENTENTRIES;
+    pevent->ev_que->quota -= pevent->ev_que->depth;
 
     UNLOCKEVQUE (pevent->ev_que);
 
     freeListFree ( dbevEventSubscriptionFreeList, pevent );
 
+    /* give back ring entries which are no longer needed */
+    epicsMutexMustLock ( ev_que->evUser->lock );
+    ev_que_resize ( ev_que );
+    epicsMutexUnlock ( ev_que->evUser->lock );
+
     return;
 }
 
@@ -648,7 +1033,7 @@ int db_post_extra_labor (dbEventCtx ctx)
     epicsMutexUnlock ( evUser->lock );
 
     if ( doit ) {
-        epicsEventSignal(evUser->ppendsem);
+        event_signal ( evUser );
     }
 
     return DB_EVENT_OK;
@@ -709,6 +1094,106 @@ db_field_log* db_create_read_log (struct dbChannel *chan)
  *  DB_QUEUE_EVENT_LOG()
  *
  */
+static void db_queue_event_log_lf (evSubscrip *pevent, db_field_log *pLog)
+{
+    struct event_que * const ev_que = pevent->ev_que;
+    size_t const mask = ev_que->size - 1u;
+    struct event_slot *pslot;
+    size_t pos, seq;
+
+    /*
+     * Only one thread posts to any subscription at a time (the
+     * record is locked), so putPos is ours.  Claiming our last
+     * entry fails if the event task has already taken it.
+     */
+    if ( epicsAtomicGetSizeT ( &pevent->npend ) > 0u ) {
+        pos = pevent->putPos;
+        pslot = &ev_que->slots[pos & mask];
+        if ( epicsAtomicCmpAndSwapSizeT ( &pslot->seq,
+                pos + 1u, pos + 2u ) == pos + 1u ) {
+            db_field_log *pLast;
+            int done = FALSE;
+
+            epicsAtomicReadMemoryBarrier ();
+            pLast = pslot->pfl;
+            if ( pslot->pevent != pevent || ! pLast ) {
+                /* not ours, leave it alone */
+            }
+            else if ( pLast->type == dbfl_type_rec &&
+                    pLog->type == dbfl_type_rec ) {
+                /* see db_queue_event_log() */
+                db_delete_field_log ( pLog );
+                pevent->ncoalesced++;
+                done = TRUE;
+            }
+            else if ( ev_que->evUser->flowCtrlMode ||
+                    ringSpace ( ev_que ) <= ringReserve ( ev_que ) ) {
+                if ( pLast->type == dbfl_type_rec ) {
+                    pevent->ncoalesced++;
+                }
+                else {
+                    pevent->ndropped++;
+                }
+                db_delete_field_log ( pLast );
+                pslot->pfl = pLog;
+                pevent->nreplace++;
+                done = TRUE;
+            }
+            /*
+             * The event task gives up on a slot which is claimed here
+             * and waits to be woken, see event_get_lf().  The CAS is a
+             * full barrier, so lfGetix is read after the release.
+             */
+            epicsAtomicCmpAndSwapSizeT ( &pslot->seq, pos + 2u, pos + 1u );
+            if ( epicsAtomicGetSizeT ( &ev_que->lfGetix ) == pos ) {
+                event_signal ( ev_que->evUser );
+            }
+            if ( done ) {
+                return;
+            }
+        }
+    }
+
+    /* reserve the next free position */
+    while ( TRUE ) {
+        pos = epicsAtomicGetSizeT ( &ev_que->lfPutix );
+        pslot = &ev_que->slots[pos & mask];
+        seq = epicsAtomicGetSizeT ( &pslot->seq );
+        epicsAtomicReadMemoryBarrier ();
+        if ( seq == pos ) {
+            if ( epicsAtomicCmpAndSwapSizeT ( &ev_que->lfPutix,
+                    pos, pos + 1u ) == pos ) {
+                break;
+            }
+        }
+        else if ( (ptrdiff_t) ( seq - pos ) < 0 ) {
+            /* full, the reserve should prevent this */
+            db_delete_field_log ( pLog );
+            pevent->ndropped++;
+            return;
+        }
+    }
+
+    pslot->pevent = pevent;
+    pslot->pfl = pLog;
+    pevent->putPos = pos;
+    if ( epicsAtomicIncrSizeT ( &pevent->npend ) > 1u ) {
+        epicsAtomicIncrIntT ( &ev_que->lfDuplicates );
+    }
+    epicsAtomicCmpAndSwapSizeT ( &pslot->seq, pos, pos + 1u );
+
+    /*
+     * the event task only needs waking if this is the first
+     * event it will find.  The event task advances lfGetix and then
+     * reads the next slot, this publishes the slot and then reads
+     * lfGetix, so both must be full barriers (atomic read-modify-write
+     * operations) or each could miss the other's store.
+     */
+    if ( epicsAtomicGetSizeT ( &ev_que->lfGetix ) == pos ) {
+        event_signal ( ev_que->evUser );
+    }
+}
+
 static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
 {
     struct event_que    *ev_que;
@@ -716,6 +1201,10 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
     unsigned rngSpace;
 
     ev_que = pevent->ev_que;
+    if ( ev_que->slots ) {
+        db_queue_event_log_lf ( pevent, pLog );
+        return;
+    }
     /*
      * evUser ring buffer must be locked for the multiple
      * threads writing/reading it
@@ -733,6 +1222,7 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
         (*pevent->pLastLog)->type == dbfl_type_rec &&
         pLog->type == dbfl_type_rec) {
         db_delete_field_log(pLog);
+        pevent->ncoalesced++;
         UNLOCKEVQUE (ev_que);
         return;
     }
@@ -748,11 +1238,19 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
      */
     rngSpace = ringSpace ( ev_que );
     if ( pevent->npend>0u &&
-        (ev_que->evUser->flowCtrlMode || rngSpace<=EVENTSPERQUE) ) {
+        (ev_que->evUser->flowCtrlMode || rngSpace<=ringReserve(ev_que)) ) {
         /*
          * replace last event if no space is left
          */
         if (*pevent->pLastLog) {
+            /* a replaced value is a lost sample, a replaced
+             * record reference is not */
+            if ((*pevent->pLastLog)->type == dbfl_type_rec) {
+                pevent->ncoalesced++;
+            }
+            else {
+                pevent->ndropped++;
+            }
             db_delete_field_log(*pevent->pLastLog);
             *pevent->pLastLog = pLog;
         }
@@ -780,13 +1278,13 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
          * if the ring buffer was empty before
          * adding this event
          */
-        if (rngSpace==EVENTQUESIZE) {
+        if (rngSpace==ev_que->size) {
             firstEventFlag = 1;
         }
         else {
             firstEventFlag = 0;
         }
-        ev_que->putix = RNGINC ( ev_que->putix );
+        ev_que->putix = RNGINC ( ev_que, ev_que->putix );
     }
 
     UNLOCKEVQUE (ev_que);
@@ -801,8 +1299,219 @@ static void db_queue_event_log (evSubscrip *pevent, db_field_log *pLog)
         /*
          * notify the event handler
          */
-        epicsEventSignal(ev_que->evUser->ppendsem);
+        event_signal ( ev_que->evUser );
+    }
+}
+
+/*
+ *  SNAPSHOT_CREATE()
+ *
+ *  Copy the array field of a channel, NULL if it is too small to be
+ *  worth sharing.  The record must be locked.
+ */
+static dbEventSnapshot * snapshot_create (struct dbChannel *chan,
+    long *pno_elements)
+{
+    dbAddr *paddr = &chan->addr;
+    long no_elements = paddr->no_elements;
+    long offset = 0;
+    size_t nbytes;
+    dbEventSnapshot *ps;
+    rset *prset;
+
+    if (dbEventSnapshotBytes <= 0 || no_elements <= 1 ||
+        paddr->field_type > DBF_ENUM)
+        return NULL;
+
+    if (paddr->special == SPC_DBADDR &&
+        (prset = dbGetRset(paddr)) &&
+        prset->get_array_info) {
+        void *pfieldsave = paddr->pfield;
+        long status = prset->get_array_info(paddr, &no_elements, &offset);
+        const void *pfield = paddr->pfield;
+
+        paddr->pfield = pfieldsave;
+        /* circular buffers are left to the record's own conversion */
+        if (status || offset != 0 || !pfield)
+            return NULL;
+        nbytes = (size_t) no_elements * paddr->field_size;
+        if (nbytes < (size_t) dbEventSnapshotBytes)
+            return NULL;
+        ps = malloc(offsetof(dbEventSnapshot, data) + nbytes);
+        if (!ps)
+            return NULL;
+        memcpy(ps->data, pfield, nbytes);
+    }
+    else {
+        nbytes = (size_t) no_elements * paddr->field_size;
+        if (nbytes < (size_t) dbEventSnapshotBytes)
+            return NULL;
+        ps = malloc(offsetof(dbEventSnapshot, data) + nbytes);
+        if (!ps)
+            return NULL;
+        memcpy(ps->data, paddr->pfield, nbytes);
     }
+
+    ps->lock = epicsMutexCreate();
+    if (!ps->lock) {
+        free(ps);
+        return NULL;
+    }
+    ps->refcnt = 1;
+    ps->derived = NULL;
+    ps->pfield = dbChannelField(chan);
+    ps->no_elements = no_elements;
+    ps->time = dbChannelRecord(chan)->time;
+    ps->stat = dbChannelRecord(chan)->stat;
+    ps->sevr = dbChannelRecord(chan)->sevr;
+    *pno_elements = no_elements;
+    return ps;
+}
+
+void db_snapshot_incr (dbEventSnapshot *ps)
+{
+    epicsAtomicIncrIntT(&ps->refcnt);
+}
+
+void db_snapshot_decr (dbEventSnapshot *ps)
+{
+    struct snapshotDerived *pd, *next;
+
+    if (epicsAtomicDecrIntT(&ps->refcnt) > 0)
+        return;
+
+    for (pd = ps->derived; pd; pd = next) {
+        next = pd->next;
+        free(pd);
+    }
+    epicsMutexDestroy(ps->lock);
+    free(ps);
+}
+
+static void snapshot_log_dtor (db_field_log *pfl)
+{
+    db_snapshot_decr((dbEventSnapshot *) pfl->u.r.pvt);
+}
+
+/*
+ *  SNAPSHOT_LOG()
+ *
+ *  Turn an event log into a reference to the snapshot
+ */
+static void snapshot_log (db_field_log *pLog, struct dbChannel *chan,
+    dbEventSnapshot *ps, long no_elements)
+{
+    struct dbCommon *prec = dbChannelRecord(chan);
+
+    db_snapshot_incr(ps);
+    pLog->type = dbfl_type_ref;
+    pLog->stat = prec->stat;
+    pLog->sevr = prec->sevr;
+    pLog->time = prec->time;
+    pLog->field_type  = dbChannelFieldType(chan);
+    pLog->field_size  = dbChannelFieldSize(chan);
+    pLog->no_elements = no_elements;
+    pLog->u.r.dtor  = snapshot_log_dtor;
+    pLog->u.r.pvt   = ps;
+    pLog->u.r.field = ps->data;
+}
+
+/*
+ *  DB_FIELD_LOG_SNAPSHOT()
+ *
+ *  Returns the snapshot that a field log references, provided no filter
+ *  has sliced it or changed its meta-data, so that anything derived from
+ *  the snapshot also applies to this field log.
+ */
+dbEventSnapshot * db_field_log_snapshot (const db_field_log *pfl)
+{
+    dbEventSnapshot *ps;
+
+    if (!pfl || pfl->type != dbfl_type_ref ||
+        pfl->u.r.dtor != snapshot_log_dtor)
+        return NULL;
+    ps = (dbEventSnapshot *) pfl->u.r.pvt;
+    if (pfl->u.r.field != ps->data || pfl->no_elements != ps->no_elements ||
+        pfl->stat != ps->stat || pfl->sevr != ps->sevr ||
+        !epicsTimeEqual(&pfl->time, &ps->time))
+        return NULL;
+    return ps;
+}
+
+/*
+ *  DB_FIELD_LOG_VIEW()
+ *
+ *  Narrows a field log that references a snapshot to count elements
+ *  starting at offset, without copying them.  Returns non-zero if the
+ *  field log isn't a snapshot reference, or the slice isn't inside it,
+ *  and the caller must copy the elements instead.
+ */
+int db_field_log_view (db_field_log *pfl, long offset, long count)
+{
+    if (pfl->type != dbfl_type_ref || pfl->u.r.dtor != snapshot_log_dtor ||
+        offset < 0 || count < 0 || offset > pfl->no_elements ||
+        count > pfl->no_elements - offset)
+        return -1;
+    pfl->u.r.field = (char *) pfl->u.r.field + offset * pfl->field_size;
+    pfl->no_elements = count;
+    return 0;
+}
+
+/*
+ *  DB_SNAPSHOT_DERIVED()
+ *
+ *  Returns the data derived from a snapshot for dbrType and count,
+ *  calling fill() to make it the first time it is asked for.  The
+ *  data remains valid while the caller holds a reference to the
+ *  snapshot.  Returns NULL if fill() fails.
+ */
+const void * db_snapshot_derived (dbEventSnapshot *ps, int dbrType,
+    long count, size_t size, dbSnapshotFillFunc *fill, void *arg)
+{
+    struct snapshotDerived *pd;
+
+    epicsMutexMustLock(ps->lock);
+    for (pd = ps->derived; pd; pd = pd->next) {
+        if (pd->dbrType == dbrType && pd->count == count &&
+            pd->size == size)
+            break;
+    }
+    if (!pd) {
+        pd = malloc(offsetof(struct snapshotDerived, data) + size);
+        if (pd && (*fill)(pd->data, size, arg) == 0) {
+            pd->dbrType = dbrType;
+            pd->count = count;
+            pd->size = size;
+            pd->next = ps->derived;
+            ps->derived = pd;
+        }
+        else {
+            free(pd);
+            pd = NULL;
+        }
+    }
+    epicsMutexUnlock(ps->lock);
+    return pd ? pd->data : NULL;
+}
+
+/*
+ *  SNAPSHOT_SHARED()
+ *
+ *  TRUE if pevent and at least one later subscription will be
+ *  posted the same field, so a snapshot of it would be shared.
+ *  Others keep reading the record at delivery.
+ */
+static int snapshot_shared (struct evSubscrip *pevent, unsigned caEventMask)
+{
+    void *pfield = dbChannelField(pevent->chan);
+    int n = 0;
+
+    for (; pevent; pevent = (struct evSubscrip *) pevent->node.next) {
+        if (dbChannelField(pevent->chan) == pfield &&
+            (caEventMask & pevent->select) && ++n > 1)
+            return TRUE;
+    }
+    return FALSE;
 }
 
 /*
@@ -819,6 +1528,9 @@ unsigned int    caEventMask
 {
     struct dbCommon   * const prec = (struct dbCommon *) pRecord;
     struct evSubscrip *pevent;
+    dbEventSnapshot *pSnap = NULL;
+    void *snapField = NULL;
+    long snapElements = 0;
 
     if (prec->mlis.count == 0) return DB_EVENT_OK;       /* no monitors set */
 
@@ -833,12 +1545,34 @@ unsigned int    caEventMask
          */
         if ( (dbChannelField(pevent->chan) == (void *)pField || pField==NULL) &&
             (caEventMask & pevent->select)) {
+            struct dbChannel *chan = pevent->chan;
             db_field_log *pLog = db_create_event_log(pevent);
-            pLog = dbChannelRunPreChain(pevent->chan, pLog);
+            if (!pLog) {
+                pevent->ndropped++;
+                continue;
+            }
+            /* array subscribers and their filters share one copy */
+            if (pLog->type == dbfl_type_rec && dbEventSnapshotBytes > 0) {
+                if (snapField != dbChannelField(chan)) {
+                    if (pSnap) {
+                        db_snapshot_decr(pSnap);
+                        pSnap = NULL;
+                    }
+                    snapField = dbChannelField(chan);
+                    if (snapshot_shared(pevent, caEventMask))
+                        pSnap = snapshot_create(chan, &snapElements);
+                }
+                if (pSnap)
+                    snapshot_log(pLog, chan, pSnap, snapElements);
+            }
+            pLog = dbChannelRunPreChain(chan, pLog);
             if (pLog) db_queue_event_log(pevent, pLog);
         }
     }
 
+    if (pSnap)
+        db_snapshot_decr(pSnap);
+
     UNLOCKREC (prec);
     return DB_EVENT_OK;
 
@@ -862,6 +1596,126 @@ void db_post_single_event (dbEventSubscription event)
     dbScanUnlock (prec);
 }
 
+/*
+ * event_get_lf()
+ * event queue lock _must_ be applied
+ * remove the next event from a lock free ring, FALSE when it is empty
+ * or the next event is being replaced by a producer, which then wakes
+ * the event task when it is done
+ */
+static int event_get_lf ( struct event_que *ev_que,
+    struct evSubscrip **ppevent, db_field_log **ppfl )
+{
+    while ( TRUE ) {
+        size_t const pos = ev_que->lfGetix;
+        struct event_slot * const pslot =
+            &ev_que->slots[pos & ( ev_que->size - 1u )];
+        struct evSubscrip *pevent;
+        size_t seq;
+
+        /*
+         * Don't spin on a slot claimed by a producer, which may be a
+         * preempted lower priority thread
+         */
+        seq = epicsAtomicCmpAndSwapSizeT ( &pslot->seq, pos + 1u, pos + 2u );
+        if ( seq != pos + 1u ) {
+            return FALSE;
+        }
+        epicsAtomicReadMemoryBarrier ();
+        pevent = pslot->pevent;
+        *ppfl = pslot->pfl;
+        epicsAtomicWriteMemoryBarrier ();
+        epicsAtomicSetSizeT ( &pslot->seq, pos + ev_que->size );
+        /* a full barrier, see db_queue_event_log_lf() */
+        epicsAtomicIncrSizeT ( &ev_que->lfGetix );
+
+        if ( pevent == &canceledEvent ) {
+            assert ( ev_que->nCanceled > 0 );
+            ev_que->nCanceled--;
+            db_delete_field_log ( *ppfl );
+            continue;
+        }
+        if ( epicsAtomicDecrSizeT ( &pevent->npend ) > 0u ) {
+            epicsAtomicDecrIntT ( &ev_que->lfDuplicates );
+        }
+        *ppevent = pevent;
+        return TRUE;
+    }
+}
+
+/*
+ * event_pending_lf()
+ * TRUE if another event is waiting on a lock free ring
+ */
+static int event_pending_lf ( struct event_que *ev_que )
+{
+    size_t const pos = ev_que->lfGetix;
+    size_t const seq = epicsAtomicGetSizeT (
+        &ev_que->slots[pos & ( ev_que->size - 1u )].seq );
+
+    return seq == pos + 1u || seq == pos + 2u;
+}
+
+/*
+ * event_deliver()
+ * event queue lock _must_ be applied, it is released during the callback
+ */
+static void event_deliver ( struct event_que *ev_que,
+    struct evSubscrip *pevent, EVENTFUNC *user_sub,
+    int eventsRemaining, db_field_log *pfl )
+{
+    /*
+     * Next event pointer can be used by event tasks to determine
+     * if more events are waiting in the queue
+     *
+     * Must remove the lock here so that we dont deadlock if
+     * this calls dbGetField() and blocks on the record lock,
+     * dbPutField() is in progress in another task, it has the
+     * record lock, and it is calling db_post_events() waiting
+     * for the event queue lock (which this thread now has).
+     */
+
+    /*
+     * This provides a way to test to see if an event is in use
+     * despite the fact that the event queue does not point to
+     * it.
+     */
+    pevent->callBackInProgress = TRUE;
+    epicsAtomicIncrSizeT ( &ev_que->evUser->nEvents );
+    UNLOCKEVQUE (ev_que);
+    /* Run post-event-queue filter chain */
+    if (ellCount(&pevent->chan->post_chain)) {
+        pfl = dbChannelRunPostChain(pevent->chan, pfl);
+    }
+    if (pfl) {
+        /* Issue user callback */
+        ( *user_sub ) ( pevent->user_arg, pevent->chan,
+                        eventsRemaining, pfl );
+    }
+    LOCKEVQUE (ev_que);
+
+    /*
+     * check to see if this event has been canceled each
+     * time that the callBackInProgress flag is set to false
+     * while we have the event queue lock, and post the flush
+     * complete sem if there are no longer any events on the
+     * queue
+     */
+    if ( ev_que->evUser->pSuicideEvent == pevent ) {
+        ev_que->evUser->pSuicideEvent = NULL;
+    }
+    else {
+        if ( pevent->user_sub==NULL && pevent->npend==0u ) {
+            pevent->callBackInProgress = FALSE;
+            epicsEventSignal ( ev_que->evUser->pflush_sem );
+        }
+        else {
+            pevent->callBackInProgress = FALSE;
+        }
+    }
+    db_delete_field_log(pfl);
+}
+
 /*
  * EVENT_READ()
  */
@@ -882,12 +1736,31 @@ static int event_read ( struct event_que *ev_que )
      * suspend processing events until flow control
      * mode is over
      */
-    if ( ev_que->evUser->flowCtrlMode && ev_que->nDuplicates == 0u ) {
+    if ( ev_que->evUser->flowCtrlMode && ev_que->nDuplicates == 0u &&
+            epicsAtomicGetIntT ( &ev_que->lfDuplicates ) == 0 ) {
         UNLOCKEVQUE (ev_que);
         return DB_EVENT_OK;
     }
 
-    while ( ev_que->evque[ev_que->getix] != EVENTQEMPTY ) {
+    while ( ev_que->slots ) {
+        struct evSubscrip *pevent;
+        int eventsRemaining;
+
+        if ( ! event_get_lf ( ev_que, &pevent, &pfl ) ) {
+            break;
+        }
+        user_sub = pevent->user_sub;
+        if ( user_sub ) {
+            eventsRemaining = event_pending_lf ( ev_que );
+            event_deliver ( ev_que, pevent, user_sub, eventsRemaining, pfl );
+        }
+        else {
+            db_delete_field_log ( pfl );
+        }
+    }
+
+    while ( ! ev_que->slots &&
+            ev_que->evque[ev_que->getix] != EVENTQEMPTY ) {
         struct evSubscrip *pevent = ev_que->evque[ev_que->getix];
 
         pfl = ev_que->valque[ev_que->getix];
@@ -897,7 +1770,7 @@ static int event_read ( struct event_que *ev_que )
                 db_delete_field_log(ev_que->valque[ev_que->getix]);
                 ev_que->valque[ev_que->getix] = NULL;
             }
-            ev_que->getix = RNGINC ( ev_que->getix );
+            ev_que->getix = RNGINC ( ev_que, ev_que->getix );
             assert ( ev_que->nCanceled > 0 );
             ev_que->nCanceled--;
             continue;
@@ -910,7 +1783,7 @@ static int event_read ( struct event_que *ev_que )
          */
 
         event_remove ( ev_que, ev_que->getix, EVENTQEMPTY );
-        ev_que->getix = RNGINC ( ev_que->getix );
+        ev_que->getix = RNGINC ( ev_que, ev_que->getix );
 
         /*
          * create a local copy of the call back parameters while
@@ -918,56 +1791,15 @@ static int event_read ( struct event_que *ev_que )
          */
         user_sub = pevent->user_sub;
 
-        /*
-         * Next event pointer can be used by event tasks to determine
-         * if more events are waiting in the queue
-         *
-         * Must remove the lock here so that we dont deadlock if
-         * this calls dbGetField() and blocks on the record lock,
-         * dbPutField() is in progress in another task, it has the
-         * record lock, and it is calling db_post_events() waiting
-         * for the event queue lock (which this thread now has).
-         */
         if ( user_sub ) {
-            /*
-             * This provides a way to test to see if an event is in use
-             * despite the fact that the event queue does not point to
-             * it.
-             */
-            pevent->callBackInProgress = TRUE;
-            UNLOCKEVQUE (ev_que);
-            /* Run post-event-queue filter chain */
-            if (ellCount(&pevent->chan->post_chain)) {
-                pfl = dbChannelRunPostChain(pevent->chan, pfl);
-            }
-            if (pfl) {
-                /* Issue user callback */
-                ( *user_sub ) ( pevent->user_arg, pevent->chan,
-                                ev_que->evque[ev_que->getix] != EVENTQEMPTY, pfl );
-            }
-            LOCKEVQUE (ev_que);
+            int eventsRemaining =
+                ev_que->evque[ev_que->getix] != EVENTQEMPTY;
 
-            /*
-             * check to see if this event has been canceled each
-             * time that the callBackInProgress flag is set to false
-             * while we have the event queue lock, and post the flush
-             * complete sem if there are no longer any events on the
-             * queue
-             */
-            if ( ev_que->evUser->pSuicideEvent == pevent ) {
-                ev_que->evUser->pSuicideEvent = NULL;
-            }
-            else {
-                if ( pevent->user_sub==NULL && pevent->npend==0u ) {
-                    pevent->callBackInProgress = FALSE;
-                    epicsEventSignal ( ev_que->evUser->pflush_sem );
-                }
-                else {
-                    pevent->callBackInProgress = FALSE;
-                }
-            }
+            event_deliver ( ev_que, pevent, user_sub, eventsRemaining, pfl );
+        }
+        else {
+            db_delete_field_log(pfl);
         }
-        db_delete_field_log(pfl);
     }
 
     UNLOCKEVQUE (ev_que);
@@ -975,14 +1807,115 @@ static int event_read ( struct event_que *ev_que )
     return DB_EVENT_OK;
 }
 
+/*
+ * event_wait()
+ *
+ * Yield a few times before blocking so that events posted just
+ * after the queues were drained are picked up without a sleep and
+ * wakeup, then optionally wait a little longer so that more events
+ * accumulate and are delivered in one batch.
+ */
+static void event_wait ( struct event_user * const evUser )
+{
+    unsigned i;
+    int ready = FALSE;
+
+    for ( i = 0u; i < evUser->spinYields && ! ready; i++ ) {
+        ready = epicsEventTryWait ( evUser->ppendsem ) == epicsEventOK;
+        if ( ! ready ) {
+            epicsThreadSleep ( 0.0 );
+        }
+    }
+    if ( ! ready ) {
+        epicsEventMustWait ( evUser->ppendsem );
+    }
+    if ( evUser->batchDelay > 0.0 && ! evUser->pendexit ) {
+        epicsThreadSleep ( evUser->batchDelay );
+    }
+    epicsAtomicIncrSizeT ( &evUser->nWakeups );
+}
+
+/*
+ * EVENT_PASS()
+ *
+ * Run the extra labor and deliver the queued events once, returns
+ * TRUE when the event user is exiting.
+ */
+static int event_pass ( struct event_user * const evUser )
+{
+    struct event_que * ev_que;
+    unsigned char pendexit;
+    void (*pExtraLaborSub) (void *);
+    void *pExtraLaborArg;
+
+    /*
+     * check to see if the caller has offloaded
+     * labor to this task
+     */
+    epicsMutexMustLock ( evUser->lock );
+    evUser->extraLaborBusy = TRUE;
+    if ( evUser->extra_labor && evUser->extralabor_sub ) {
+        evUser->extra_labor = FALSE;
+        pExtraLaborSub = evUser->extralabor_sub;
+        pExtraLaborArg = evUser->extralabor_arg;
+    }
+    else {
+        pExtraLaborSub = NULL;
+        pExtraLaborArg = NULL;
+    }
+    if ( pExtraLaborSub ) {
+        epicsMutexUnlock ( evUser->lock );
+        (*pExtraLaborSub)(pExtraLaborArg);
+        epicsMutexMustLock ( evUser->lock );
+    }
+    evUser->extraLaborBusy = FALSE;
+
+    for ( ev_que = &evUser->firstque; ev_que;
+            ev_que = ev_que->nextque ) {
+        epicsMutexUnlock ( evUser->lock );
+        event_read (ev_que);
+        epicsMutexMustLock ( evUser->lock );
+    }
+    pendexit = evUser->pendexit;
+    epicsMutexUnlock ( evUser->lock );
+
+    return pendexit;
+}
+
+/*
+ * EVENT_USER_FREE()
+ */
+static void event_user_free ( struct event_user * const evUser )
+{
+    struct event_que    *ev_que, *nextque;
+
+    epicsMutexDestroy(evUser->firstque.writelock);
+    free(evUser->firstque.evque);
+    free(evUser->firstque.valque);
+    free(evUser->firstque.slots);
+
+    ev_que = evUser->firstque.nextque;
+    while (ev_que) {
+        nextque = ev_que->nextque;
+        epicsMutexDestroy(ev_que->writelock);
+        free(ev_que->slots);
+        free(ev_que);
+        ev_que = nextque;
+    }
+
+    epicsEventDestroy(evUser->ppendsem);
+    epicsEventDestroy(evUser->pflush_sem);
+    epicsMutexDestroy(evUser->lock);
+
+    freeListFree(dbevEventUserFreeList, evUser);
+}
+
 /*
  * EVENT_TASK()
  */
 static void event_task (void *pParm)
 {
     struct event_user * const evUser = (struct event_user *) pParm;
-    struct event_que * ev_que;
-    unsigned char pendexit;
 
     /* init hook */
     if (evUser->init_func) {
@@ -992,66 +1925,216 @@ static void event_task (void *pParm)
     taskwdInsert ( epicsThreadGetIdSelf(), NULL, NULL );
 
     do {
-        void (*pExtraLaborSub) (void *);
-        void *pExtraLaborArg;
-        epicsEventMustWait(evUser->ppendsem);
+        event_wait ( evUser );
+    } while( ! event_pass ( evUser ) );
 
-        /*
-         * check to see if the caller has offloaded
-         * labor to this task
-         */
-        epicsMutexMustLock ( evUser->lock );
-        evUser->extraLaborBusy = TRUE;
-        if ( evUser->extra_labor && evUser->extralabor_sub ) {
-            evUser->extra_labor = FALSE;
-            pExtraLaborSub = evUser->extralabor_sub;
-            pExtraLaborArg = evUser->extralabor_arg;
-        }
-        else {
-            pExtraLaborSub = NULL;
-            pExtraLaborArg = NULL;
+    event_user_free ( evUser );
+
+    taskwdRemove(epicsThreadGetIdSelf());
+
+    return;
+}
+
+/*
+ * EVENT_POOL_TASK()
+ */
+static void event_pool_task (void *pParm)
+{
+    taskwdInsert ( epicsThreadGetIdSelf(), NULL, NULL );
+
+    while ( TRUE ) {
+        struct event_user *evUser;
+        ELLNODE *pNode;
+        int more;
+
+        epicsMutexMustLock ( eventPool.lock );
+        while ( ! ( pNode = ellGet ( &eventPool.ready ) ) ) {
+            if ( eventPool.exiting ) {
+                epicsMutexUnlock ( eventPool.lock );
+                /* pass the wakeup on to the next thread to exit */
+                epicsEventSignal ( eventPool.wakeup );
+                taskwdRemove ( epicsThreadGetIdSelf() );
+                return;
+            }
+            epicsMutexUnlock ( eventPool.lock );
+            epicsEventMustWait ( eventPool.wakeup );
+            epicsMutexMustLock ( eventPool.lock );
         }
-        if ( pExtraLaborSub ) {
-            epicsMutexUnlock ( evUser->lock );
-            (*pExtraLaborSub)(pExtraLaborArg);
-            epicsMutexMustLock ( evUser->lock );
+        evUser = CONTAINER ( pNode, struct event_user, poolNode );
+        evUser->scheduled = FALSE;
+        evUser->running = TRUE;
+        more = ellCount ( &eventPool.ready ) > 0;
+        epicsMutexUnlock ( eventPool.lock );
+
+        /* pass the wakeup on while there is more to do */
+        if ( more ) {
+            epicsEventSignal ( eventPool.wakeup );
         }
-        evUser->extraLaborBusy = FALSE;
 
-        for ( ev_que = &evUser->firstque; ev_que;
-                ev_que = ev_que->nextque ) {
-            epicsMutexUnlock ( evUser->lock );
-            event_read (ev_que);
-            epicsMutexMustLock ( evUser->lock );
+        /* db_cancel_event() compares this with the calling thread */
+        evUser->taskid = epicsThreadGetIdSelf ();
+        epicsAtomicIncrSizeT ( &evUser->nWakeups );
+        if ( event_pass ( evUser ) ) {
+            evUser->taskid = NULL;
+            /* db_close_events() frees evUser */
+            epicsEventSignal ( evUser->ppendsem );
+            continue;
         }
-        pendexit = evUser->pendexit;
-        epicsMutexUnlock ( evUser->lock );
+        evUser->taskid = NULL;
+
+        epicsMutexMustLock ( eventPool.lock );
+        evUser->running = FALSE;
+        more = evUser->rerun;
+        if ( more ) {
+            evUser->rerun = FALSE;
+            evUser->scheduled = TRUE;
+            ellAdd ( &eventPool.ready, &evUser->poolNode );
+        }
+        epicsMutexUnlock ( eventPool.lock );
+        if ( more ) {
+            epicsEventSignal ( eventPool.wakeup );
+        }
+    }
+}
 
-    } while( ! pendexit );
+static void event_pool_init ( void *arg )
+{
+    eventPool.lock = epicsMutexMustCreate ();
+    eventPool.startStop = epicsMutexMustCreate ();
+    eventPool.wakeup = epicsEventMustCreate ( epicsEventEmpty );
+    ellInit ( &eventPool.ready );
+}
 
-    epicsMutexDestroy(evUser->firstque.writelock);
+/*
+ * EVENT_POOL_START()
+ *
+ * Start the pool threads, eventPool.startStop must be held.
+ * Returns the number started.
+ */
+static unsigned event_pool_start ( unsigned osiPriority )
+{
+    epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    unsigned n = dbEventPoolThreads > 0 ?
+        (unsigned) dbEventPoolThreads : (unsigned) epicsThreadGetCPUs ();
+    unsigned i;
+
+    if ( n < 2u ) {
+        n = 2u;
+    }
+    eventPool.threads = calloc ( n, sizeof ( epicsThreadId ) );
+    if ( ! eventPool.threads ) {
+        return 0u;
+    }
 
-    {
-        struct event_que    *nextque;
+    opts.stackSize = epicsThreadGetStackSize ( epicsThreadStackMedium );
+    opts.priority = osiPriority;
+    opts.joinable = 1;
+    for ( i = 0u; i < n; i++ ) {
+        char name[20];
 
-        ev_que = evUser->firstque.nextque;
-        while (ev_que) {
-            nextque = ev_que->nextque;
-            epicsMutexDestroy(ev_que->writelock);
-            freeListFree(dbevEventQueueFreeList, ev_que);
-            ev_que = nextque;
+        epicsSnprintf ( name, sizeof ( name ), "dbEventPool-%u", i );
+        eventPool.threads[i] = epicsThreadCreateOpt ( name,
+            event_pool_task, NULL, &opts );
+        if ( ! eventPool.threads[i] ) {
+            break;
         }
     }
+    eventPool.nThreads = i;
+    if ( i == 0u ) {
+        free ( eventPool.threads );
+        eventPool.threads = NULL;
+    }
+    return i;
+}
 
-    epicsEventDestroy(evUser->ppendsem);
-    epicsEventDestroy(evUser->pflush_sem);
-    epicsMutexDestroy(evUser->lock);
+/*
+ * EVENT_POOL_STOP()
+ *
+ * Join the pool threads once no pooled user is left,
+ * eventPool.startStop must be held.
+ */
+static void event_pool_stop ( void )
+{
+    unsigned i;
 
-    freeListFree(dbevEventUserFreeList, evUser);
+    epicsMutexMustLock ( eventPool.lock );
+    eventPool.exiting = TRUE;
+    epicsMutexUnlock ( eventPool.lock );
+    epicsEventSignal ( eventPool.wakeup );
 
-    taskwdRemove(epicsThreadGetIdSelf());
+    for ( i = 0u; i < eventPool.nThreads; i++ ) {
+        epicsThreadMustJoin ( eventPool.threads[i] );
+    }
+    free ( eventPool.threads );
+    eventPool.threads = NULL;
+    eventPool.nThreads = 0u;
+    eventPool.exiting = FALSE;
+}
 
-    return;
+/*
+ * EVENT_SIGNAL()
+ *
+ * Wake up the task serving this event user
+ */
+static void event_signal ( struct event_user * const evUser )
+{
+    int wakeup = FALSE;
+
+    if ( ! evUser->pooled ) {
+        epicsEventSignal ( evUser->ppendsem );
+        return;
+    }
+    epicsMutexMustLock ( eventPool.lock );
+    if ( evUser->running ) {
+        evUser->rerun = TRUE;
+    }
+    else if ( ! evUser->scheduled ) {
+        evUser->scheduled = TRUE;
+        ellAdd ( &eventPool.ready, &evUser->poolNode );
+        wakeup = TRUE;
+    }
+    epicsMutexUnlock ( eventPool.lock );
+    if ( wakeup ) {
+        epicsEventSignal ( eventPool.wakeup );
+    }
+}
+
+/*
+ * DB_START_EVENTS_POOLED()
+ *
+ * Serve the event user from a pool of threads shared with other
+ * event users, instead of a thread of its own.  The pool threads are
+ * started at the priority given by the first caller, and joined when
+ * the last of these event users is closed.
+ */
+int db_start_events_pooled ( dbEventCtx ctx, unsigned osiPriority )
+{
+    struct event_user * const evUser = (struct event_user *) ctx;
+
+    epicsThreadOnce ( &eventPoolOnce, event_pool_init, NULL );
+
+    epicsMutexMustLock ( evUser->lock );
+    if ( evUser->taskid || evUser->pooled ) {
+        epicsMutexUnlock ( evUser->lock );
+        return DB_EVENT_OK;
+    }
+    evUser->pooled = TRUE;
+    epicsMutexUnlock ( evUser->lock );
+
+    epicsMutexMustLock ( eventPool.startStop );
+    if ( eventPool.nThreads == 0u && event_pool_start ( osiPriority ) == 0u ) {
+        epicsMutexUnlock ( eventPool.startStop );
+        epicsMutexMustLock ( evUser->lock );
+        evUser->pooled = FALSE;
+        epicsMutexUnlock ( evUser->lock );
+        return DB_EVENT_ERROR;
+    }
+    eventPool.nUsers++;
+    epicsMutexUnlock ( eventPool.startStop );
+
+    /* pick up anything queued before now */
+    event_signal ( evUser );
+    return DB_EVENT_OK;
 }
 
 /*
@@ -1094,6 +2177,72 @@ int db_start_events (
      return DB_EVENT_OK;
 }
 
+/*
+ * db_event_set_batching()
+ */
+void db_event_set_batching ( dbEventCtx ctx, unsigned spinYields,
+                             double minBatchDelay )
+{
+    struct event_user * const evUser = ( struct event_user * ) ctx;
+
+    epicsMutexMustLock ( evUser->lock );
+    evUser->spinYields = spinYields;
+    evUser->batchDelay = minBatchDelay;
+    epicsMutexUnlock ( evUser->lock );
+}
+
+/* shorter intervals repeat the previous result */
+#define DB_EVENT_STATS_MIN_INTERVAL 1.0 /* sec */
+
+/*
+ * db_event_stats()
+ *
+ * Wakeup rate and events per wakeup over the interval since the
+ * previous call, or since the context was created.  A call within
+ * a second of the previous one, e.g. from dbel listing several
+ * subscriptions, returns the same result again.
+ */
+void db_event_stats ( dbEventCtx ctx, double *pWakeupRate,
+                      double *pEventsPerWakeup )
+{
+    struct event_user * const evUser = ( struct event_user * ) ctx;
+    epicsTimeStamp now;
+    double elapsed, wakeupRate, eventsPerWakeup;
+
+    epicsTimeGetMonotonic ( &now );
+    epicsMutexMustLock ( evUser->lock );
+    elapsed = epicsTimeDiffInSeconds ( &now, &evUser->statsStart );
+    if ( elapsed < DB_EVENT_STATS_MIN_INTERVAL && evUser->statsValid ) {
+        wakeupRate = evUser->wakeupRate;
+        eventsPerWakeup = evUser->eventsPerWakeup;
+    }
+    else {
+        size_t nWakeups = epicsAtomicGetSizeT ( &evUser->nWakeups );
+        size_t nEvents = epicsAtomicGetSizeT ( &evUser->nEvents );
+        size_t dWakeups = nWakeups - evUser->statsWakeups;
+        size_t dEvents = nEvents - evUser->statsEvents;
+
+        wakeupRate = elapsed > 0.0 ? dWakeups / elapsed : 0.0;
+        eventsPerWakeup = dWakeups ? (double) dEvents / dWakeups : 0.0;
+        if ( elapsed >= DB_EVENT_STATS_MIN_INTERVAL ) {
+            evUser->statsStart = now;
+            evUser->statsWakeups = nWakeups;
+            evUser->statsEvents = nEvents;
+            evUser->wakeupRate = wakeupRate;
+            evUser->eventsPerWakeup = eventsPerWakeup;
+            evUser->statsValid = TRUE;
+        }
+    }
+    epicsMutexUnlock ( evUser->lock );
+
+    if ( pWakeupRate ) {
+        *pWakeupRate = wakeupRate;
+    }
+    if ( pEventsPerWakeup ) {
+        *pEventsPerWakeup = eventsPerWakeup;
+    }
+}
+
 /*
  * db_event_change_priority()
  */
@@ -1101,7 +2250,10 @@ void db_event_change_priority ( dbEventCtx ctx,
                                         unsigned epicsPriority )
 {
     struct event_user * const evUser = ( struct event_user * ) ctx;
-    epicsThreadSetPriority ( evUser->taskid, epicsPriority );
+    /* pool threads are shared, so their priority is left alone */
+    if ( ! evUser->pooled ) {
+        epicsThreadSetPriority ( evUser->taskid, epicsPriority );
+    }
 }
 
 /*
@@ -1117,7 +2269,7 @@ void db_event_flow_ctrl_mode_on (dbEventCtx ctx)
     /*
      * notify the event handler task
      */
-    epicsEventSignal(evUser->ppendsem);
+    event_signal ( evUser );
 #ifdef DEBUG
     printf("fc on %lu\n", tickGet());
 #endif
@@ -1136,7 +2288,7 @@ void db_event_flow_ctrl_mode_off (dbEventCtx ctx)
     /*
      * notify the event handler task
      */
-    epicsEventSignal (evUser->ppendsem);
+    event_signal ( evUser );
 #ifdef DEBUG
     printf("fc off %lu\n", tickGet());
 #endif
@@ -19,6 +19,8 @@
 #ifndef INCLdbEventh
 #define INCLdbEventh
 
+#include <stddef.h>
+
 #ifdef epicsExportSharedSymbols
 #   undef epicsExportSharedSymbols
 #   define INCLdbEventhExporting
@@ -51,9 +53,12 @@ typedef void * dbEventCtx;
 
 typedef void EXTRALABORFUNC (void *extralabor_arg);
 epicsShareFunc dbEventCtx db_init_events (void);
+epicsShareFunc dbEventCtx db_init_events_type (int queType);
 epicsShareFunc int db_start_events (
     dbEventCtx ctx, const char *taskname, void (*init_func)(void *),
     void *init_func_arg, unsigned osiPriority );
+epicsShareFunc int db_start_events_pooled (
+    dbEventCtx ctx, unsigned osiPriority );
 epicsShareFunc void db_close_events (dbEventCtx ctx);
 epicsShareFunc void db_event_flow_ctrl_mode_on (dbEventCtx ctx);
 epicsShareFunc void db_event_flow_ctrl_mode_off (dbEventCtx ctx);
@@ -62,11 +67,47 @@ epicsShareFunc int db_add_extra_labor_event (
 epicsShareFunc void db_flush_extra_labor_event (dbEventCtx);
 epicsShareFunc int db_post_extra_labor (dbEventCtx ctx);
 epicsShareFunc void db_event_change_priority ( dbEventCtx ctx, unsigned epicsPriority );
+epicsShareFunc void db_event_set_batching ( dbEventCtx ctx,
+    unsigned spinYields, double minBatchDelay );
+epicsShareFunc void db_event_stats ( dbEventCtx ctx,
+    double *pWakeupRate, double *pEventsPerWakeup );
 
 #ifdef EPICS_PRIVATE_API
 epicsShareFunc void db_cleanup_events(void);
 #endif
 
+/* Event queue entries reserved for each subscription, read by db_init_events() */
+epicsShareExtern int dbEventQueueDepth;
+/* Non-zero to have db_init_events() create lock free queues */
+epicsShareExtern int dbEventQueueLockFree;
+
+/* Defaults for db_event_set_batching(), read by db_init_events() */
+epicsShareExtern int dbEventSpinYields;
+epicsShareExtern double dbEventBatchDelay;
+/* Threads serving db_start_events_pooled() contexts, 0 for one per CPU */
+epicsShareExtern int dbEventPoolThreads;
+
+/* Smallest array field posted as a shared snapshot, 0 to disable */
+epicsShareExtern int dbEventSnapshotBytes;
+
+/* Array snapshots shared by the field logs of one db_post_events() call,
+ * and by the filters on them */
+typedef struct dbEventSnapshot dbEventSnapshot;
+typedef int dbSnapshotFillFunc (void *pbuf, size_t size, void *arg);
+epicsShareFunc dbEventSnapshot * db_field_log_snapshot (
+    const struct db_field_log *pfl);
+epicsShareFunc int db_field_log_view (struct db_field_log *pfl,
+    long offset, long count);
+epicsShareFunc void db_snapshot_incr (dbEventSnapshot *ps);
+epicsShareFunc void db_snapshot_decr (dbEventSnapshot *ps);
+epicsShareFunc const void * db_snapshot_derived (dbEventSnapshot *ps,
+    int dbrType, long count, size_t size,
+    dbSnapshotFillFunc *fill, void *arg);
+
+/* queType arguments for db_init_events_type() */
+#define DB_EVENT_QUE_LOCKED     0   /* posting threads lock the queue */
+#define DB_EVENT_QUE_LOCKFREE   1   /* multi-producer lock free ring */
+
 typedef void EVENTFUNC (void *user_arg, struct dbChannel *chan,
 	int eventsRemaining, struct db_field_log *pfl);
 
@@ -52,6 +52,40 @@ static void dbLoadRecordsCallFunc(const iocshArgBuf *args)
     iocshSetError(dbLoadRecords(args[0].sval,args[1].sval));
 }
 
+/* dbLoadRecordsBegin */
+static const iocshArg dbLoadRecordsBeginArg0 = { "threads",iocshArgInt};
+static const iocshArg * const dbLoadRecordsBeginArgs[1] = {&dbLoadRecordsBeginArg0};
+static const iocshFuncDef dbLoadRecordsBeginFuncDef = {"dbLoadRecordsBegin",1,dbLoadRecordsBeginArgs};
+static void dbLoadRecordsBeginCallFunc(const iocshArgBuf *args)
+{
+    iocshSetError(dbLoadRecordsBegin(args[0].ival));
+}
+
+/* dbLoadRecordsEnd */
+static const iocshFuncDef dbLoadRecordsEndFuncDef = {"dbLoadRecordsEnd",0,0};
+static void dbLoadRecordsEndCallFunc(const iocshArgBuf *args)
+{
+    iocshSetError(dbLoadRecordsEnd());
+}
+
+/* dbLoadSnapshot */
+static const iocshArg dbLoadSnapshotArg0 = { "file name",iocshArgString};
+static const iocshArg * const dbLoadSnapshotArgs[1] = {&dbLoadSnapshotArg0};
+static const iocshFuncDef dbLoadSnapshotFuncDef = {"dbLoadSnapshot",1,dbLoadSnapshotArgs};
+static void dbLoadSnapshotCallFunc(const iocshArgBuf *args)
+{
+    iocshSetError(dbLoadSnapshot(args[0].sval));
+}
+
+/* dbSaveSnapshot */
+static const iocshArg dbSaveSnapshotArg0 = { "file name",iocshArgString};
+static const iocshArg * const dbSaveSnapshotArgs[1] = {&dbSaveSnapshotArg0};
+static const iocshFuncDef dbSaveSnapshotFuncDef = {"dbSaveSnapshot",1,dbSaveSnapshotArgs};
+static void dbSaveSnapshotCallFunc(const iocshArgBuf *args)
+{
+    iocshSetError(dbSaveSnapshot(args[0].sval));
+}
+
 /* dbb */
 static const iocshArg dbbArg0 = { "record name",iocshArgString};
 static const iocshArg * const dbbArgs[1] = {&dbbArg0};
@@ -314,6 +348,16 @@ static const iocshFuncDef scanpplFuncDef = {"scanppl",1,scanpplArgs};
 static void scanpplCallFunc(const iocshArgBuf *args)
 { scanppl(args[0].dval);}
 
+/* scanPeriodicThreads */
+static const iocshArg scanPeriodicThreadsArg0 = { "no of threads",iocshArgInt};
+static const iocshArg scanPeriodicThreadsArg1 = { "rate",iocshArgDouble};
+static const iocshArg * const scanPeriodicThreadsArgs[2] =
+    {&scanPeriodicThreadsArg0,&scanPeriodicThreadsArg1};
+static const iocshFuncDef scanPeriodicThreadsFuncDef =
+    {"scanPeriodicThreads",2,scanPeriodicThreadsArgs};
+static void scanPeriodicThreadsCallFunc(const iocshArgBuf *args)
+{ scanPeriodicThreads(args[0].ival, args[1].dval);}
+
 /* scanpel */
 static const iocshArg scanpelArg0 = { "event name",iocshArgString};
 static const iocshArg * const scanpelArgs[1] = {&scanpelArg0};
@@ -438,6 +482,10 @@ void dbIocRegister(void)
 
     iocshRegister(&dbLoadDatabaseFuncDef,dbLoadDatabaseCallFunc);
     iocshRegister(&dbLoadRecordsFuncDef,dbLoadRecordsCallFunc);
+    iocshRegister(&dbLoadRecordsBeginFuncDef,dbLoadRecordsBeginCallFunc);
+    iocshRegister(&dbLoadRecordsEndFuncDef,dbLoadRecordsEndCallFunc);
+    iocshRegister(&dbLoadSnapshotFuncDef,dbLoadSnapshotCallFunc);
+    iocshRegister(&dbSaveSnapshotFuncDef,dbSaveSnapshotCallFunc);
 
     iocshRegister(&dbaFuncDef,dbaCallFunc);
     iocshRegister(&dblFuncDef,dblCallFunc);
@@ -465,6 +513,7 @@ void dbIocRegister(void)
     iocshRegister(&scanOnceSetQueueSizeFuncDef,scanOnceSetQueueSizeCallFunc);
     iocshRegister(&scanOnceQueueShowFuncDef,scanOnceQueueShowCallFunc);
     iocshRegister(&scanpplFuncDef,scanpplCallFunc);
+    iocshRegister(&scanPeriodicThreadsFuncDef,scanPeriodicThreadsCallFunc);
     iocshRegister(&scanpelFuncDef,scanpelCallFunc);
     iocshRegister(&postEventFuncDef,postEventCallFunc);
     iocshRegister(&scanpiolFuncDef,scanpiolCallFunc);
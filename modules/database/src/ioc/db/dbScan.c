@@ -87,6 +87,23 @@ typedef struct scan_element{
 
 #define OVERRUN_REPORT_DELAY 10.0   /* Time between initial reports */
 #define OVERRUN_REPORT_MAX 3600.0   /* Maximum time between reports */
+
+/* A periodic list may be divided between several worker threads.
+ * Each pass the records are partitioned by lockset, so all records of
+ * a lockset are processed by one worker, in scan list order.
+ */
+typedef struct periodic_worker {
+    struct periodic_scan_list *ppsl;
+    int                 index;
+    epicsEventId        startEvent;
+    struct dbCommon     **precs;    /* records for this pass */
+    int                 nrecs;
+    int                 maxrecs;
+    double              busy;       /* seconds spent in the last pass */
+    double              busyMax;
+    unsigned long       overruns;   /* passes longer than the period */
+} periodic_worker;
+
 typedef struct periodic_scan_list {
     scan_list           scan_list;
     double              period;
@@ -94,12 +111,26 @@ typedef struct periodic_scan_list {
     unsigned long       overruns;
     volatile enum ctl   scanCtl;
     epicsEventId        loopEvent;
+    int                 nWorkers;
+    periodic_worker     *workers;
+    epicsEventId        doneEvent;
+    int                 pending;    /* workers still busy, use atomic */
+    volatile int        workersExit;
 } periodic_scan_list;
 
 static int nPeriodic = 0;
 static periodic_scan_list **papPeriodic; /* pointer to array of pointers */
 static epicsThreadId *periodicTaskId;    /* array of thread ids */
 
+/* scanPeriodicThreads() settings, applied by initPeriodic() */
+typedef struct periodic_threads {
+    ELLNODE             node;
+    double              period;
+    int                 count;
+} periodic_threads;
+static ELLLIST periodicThreads = ELLLIST_INIT;
+static int periodicThreadsDefault = 1;
+
 
 static char *priorityName[NUM_CALLBACK_PRIORITIES] = {
     "Low", "Medium", "High"
@@ -138,6 +169,8 @@ static epicsMutexId ioscan_lock;
 static void onceTask(void *);
 static void initOnce(void);
 static void periodicTask(void *arg);
+static void periodicWorkerTask(void *arg);
+static void scanListParallel(periodic_scan_list *ppsl);
 static void initPeriodic(void);
 static void deletePeriodic(void);
 static void spawnPeriodic(int ind);
@@ -184,6 +217,9 @@ void scanCleanup(void)
     free(periodicTaskId);
     papPeriodic = NULL;
     periodicTaskId = NULL;
+
+    ellFree(&periodicThreads);
+    periodicThreadsDefault = 1;
 }
 
 long scanInit(void)
@@ -400,7 +436,54 @@ int scanppl(double period)      /* print periodic scan list(s) */
         sprintf(message, "Records with SCAN = '%s' (%lu over-runs):",
             ppsl->name, ppsl->overruns);
         printList(&ppsl->scan_list, message);
+
+        if (ppsl->nWorkers > 1) {
+            int j;
+
+            printf("  %d scan threads:\n", ppsl->nWorkers);
+            for (j = 0; j < ppsl->nWorkers; j++) {
+                periodic_worker *pw = &ppsl->workers[j];
+
+                printf("    #%d: %d records, %lu over-runs, "
+                    "last %.3f sec, max %.3f sec\n", j, pw->nrecs,
+                    pw->overruns, pw->busy, pw->busyMax);
+            }
+        }
+    }
+    return 0;
+}
+
+int scanPeriodicThreads(int count, double period)
+{
+    periodic_threads *ppt;
+
+    if (scanCtl == ctlPause || scanCtl == ctlRun) {
+        fprintf(stderr, "scanPeriodicThreads: Scan tasks already started\n");
+        return -1;
+    }
+
+    if (count < 0)
+        count = epicsThreadGetCPUs() + count;
+    else if (count == 0)
+        count = epicsThreadGetCPUs();
+    if (count < 1) count = 1;
+
+    if (period <= 0.0) {
+        periodicThreadsDefault = count;
+        return 0;
+    }
+
+    for (ppt = (periodic_threads *)ellFirst(&periodicThreads); ppt;
+         ppt = (periodic_threads *)ellNext(&ppt->node)) {
+        if (fabs(period - ppt->period) <= 0.05)
+            break;
+    }
+    if (!ppt) {
+        ppt = dbCalloc(1, sizeof(periodic_threads));
+        ppt->period = period;
+        ellAdd(&periodicThreads, &ppt->node);
     }
+    ppt->count = count;
     return 0;
 }
 
@@ -794,8 +877,12 @@ static void periodicTask(void *arg)
         double delay;
         epicsTimeStamp now;
 
-        if (ppsl->scanCtl == ctlRun)
-            scanList(&ppsl->scan_list);
+        if (ppsl->scanCtl == ctlRun) {
+            if (ppsl->nWorkers > 1)
+                scanListParallel(ppsl);
+            else
+                scanList(&ppsl->scan_list);
+        }
 
         epicsTimeAddSeconds(&next, ppsl->period);
         epicsTimeGetMonotonic(&now);
@@ -840,15 +927,122 @@ static void periodicTask(void *arg)
         epicsEventWaitWithTimeout(ppsl->loopEvent, delay);
     }
 
+    if (ppsl->nWorkers > 1) {
+        int i;
+
+        ppsl->workersExit = TRUE;
+        for (i = 1; i < ppsl->nWorkers; i++) {
+            epicsEventMustTrigger(ppsl->workers[i].startEvent);
+            epicsEventMustWait(ppsl->doneEvent);
+        }
+    }
+
     taskwdRemove(0);
     epicsEventSignal(startStopEvent);
 }
 
+/* Process the records of one worker's partition */
+static void periodicWorkerScan(periodic_worker *pw)
+{
+    periodic_scan_list *ppsl = pw->ppsl;
+    scan_list *psl = &ppsl->scan_list;
+    epicsTimeStamp start, end;
+    int i;
+
+    epicsTimeGetMonotonic(&start);
+    for (i = 0; i < pw->nrecs; i++) {
+        struct dbCommon *precord = pw->precs[i];
+        scan_element *pse;
+        int onList;
+
+        /* skip records which left this list since the pass started */
+        epicsMutexMustLock(psl->lock);
+        pse = precord->spvt;
+        onList = pse && pse->pscan_list == psl;
+        epicsMutexUnlock(psl->lock);
+        if (!onList)
+            continue;
+
+        dbScanLock(precord);
+        dbProcess(precord);
+        dbScanUnlock(precord);
+    }
+    epicsTimeGetMonotonic(&end);
+
+    pw->busy = epicsTimeDiffInSeconds(&end, &start);
+    if (pw->busy > pw->busyMax)
+        pw->busyMax = pw->busy;
+    if (pw->busy > ppsl->period)
+        pw->overruns++;
+}
+
+static void periodicWorkerTask(void *arg)
+{
+    periodic_worker *pw = (periodic_worker *)arg;
+    periodic_scan_list *ppsl = pw->ppsl;
+
+    taskwdInsert(0, NULL, NULL);
+    epicsEventSignal(startStopEvent);
+
+    while (TRUE) {
+        epicsEventMustWait(pw->startEvent);
+        if (ppsl->workersExit)
+            break;
+
+        periodicWorkerScan(pw);
+        if (!epicsAtomicDecrIntT(&ppsl->pending))
+            epicsEventMustTrigger(ppsl->doneEvent);
+    }
+
+    taskwdRemove(0);
+    epicsEventMustTrigger(ppsl->doneEvent);
+}
+
+/* Partition the list by lockset, then run all workers and wait for them */
+static void scanListParallel(periodic_scan_list *ppsl)
+{
+    scan_list *psl = &ppsl->scan_list;
+    scan_element *pse;
+    int nrecs;
+    int i;
+
+    epicsMutexMustLock(psl->lock);
+    nrecs = ellCount(&psl->list);
+    for (i = 0; i < ppsl->nWorkers; i++) {
+        periodic_worker *pw = &ppsl->workers[i];
+
+        if (pw->maxrecs < nrecs) {
+            free(pw->precs);
+            pw->precs = dbCalloc(nrecs, sizeof(struct dbCommon *));
+            pw->maxrecs = nrecs;
+        }
+        pw->nrecs = 0;
+    }
+    for (pse = (scan_element *)ellFirst(&psl->list); pse;
+         pse = (scan_element *)ellNext(&pse->node)) {
+        periodic_worker *pw = &ppsl->workers[
+            dbLockGetLockId(pse->precord) % ppsl->nWorkers];
+
+        pw->precs[pw->nrecs++] = pse->precord;
+    }
+    psl->modified = FALSE;
+    epicsMutexUnlock(psl->lock);
+
+    epicsAtomicSetIntT(&ppsl->pending, ppsl->nWorkers - 1);
+    for (i = 1; i < ppsl->nWorkers; i++)
+        epicsEventMustTrigger(ppsl->workers[i].startEvent);
+
+    periodicWorkerScan(&ppsl->workers[0]);
+
+    epicsEventMustWait(ppsl->doneEvent);
+}
+
 
 static void initPeriodic(void)
 {
     dbMenu *pmenu = dbFindMenu(pdbbase, "menuScan");
     double quantum = epicsThreadSleepQuantum();
+    periodic_threads *ppt;
     int i;
 
     if (!pmenu) {
@@ -899,6 +1093,25 @@ static void initPeriodic(void)
         ppsl->scanCtl = ctlPause;
         ppsl->loopEvent = epicsEventMustCreate(epicsEventEmpty);
 
+        ppsl->nWorkers = periodicThreadsDefault;
+        for (ppt = (periodic_threads *)ellFirst(&periodicThreads); ppt;
+             ppt = (periodic_threads *)ellNext(&ppt->node)) {
+            if (fabs(ppsl->period - ppt->period) <= 0.05)
+                ppsl->nWorkers = ppt->count;
+        }
+        if (ppsl->nWorkers > 1) {
+            int j;
+
+            ppsl->workers = dbCalloc(ppsl->nWorkers, sizeof(periodic_worker));
+            for (j = 0; j < ppsl->nWorkers; j++) {
+                ppsl->workers[j].ppsl = ppsl;
+                ppsl->workers[j].index = j;
+                ppsl->workers[j].startEvent =
+                    epicsEventMustCreate(epicsEventEmpty);
+            }
+            ppsl->doneEvent = epicsEventMustCreate(epicsEventEmpty);
+        }
+
         number = ppsl->period / quantum;
         if ((ppsl->period < 2 * quantum) ||
             (number / floor(number) > 1.1)) {
@@ -918,6 +1131,16 @@ static void deletePeriodic(void)
         periodic_scan_list *ppsl = papPeriodic[i];
 
         if (!ppsl) continue;
+        if (ppsl->nWorkers > 1) {
+            int j;
+
+            for (j = 0; j < ppsl->nWorkers; j++) {
+                epicsEventDestroy(ppsl->workers[j].startEvent);
+                free(ppsl->workers[j].precs);
+            }
+            free(ppsl->workers);
+            epicsEventDestroy(ppsl->doneEvent);
+        }
         ellFree(&ppsl->scan_list.list);
         epicsEventDestroy(ppsl->loopEvent);
         epicsMutexDestroy(ppsl->scan_list.lock);
@@ -931,10 +1154,21 @@ static void deletePeriodic(void)
 static void spawnPeriodic(int ind)
 {
     periodic_scan_list *ppsl = papPeriodic[ind];
-    char taskName[20];
+    char taskName[32];
+    int i;
 
     if (!ppsl) return;
 
+    /* worker 0 is the periodic task itself */
+    for (i = 1; i < ppsl->nWorkers; i++) {
+        sprintf(taskName, "scan-%g-%d", ppsl->period, i);
+        if (!epicsThreadCreate(taskName, epicsThreadPriorityScanLow + ind,
+                epicsThreadGetStackSize(epicsThreadStackBig),
+                periodicWorkerTask, (void *)&ppsl->workers[i]))
+            cantProceed("Failed to spawn scan thread %s\n", taskName);
+        epicsEventWait(startStopEvent);
+    }
+
     sprintf(taskName, "scan-%g", ppsl->period);
     periodicTaskId[ind] = epicsThreadCreate(
         taskName, epicsThreadPriorityScanLow + ind,
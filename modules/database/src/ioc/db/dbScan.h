@@ -70,6 +70,9 @@ epicsShareFunc void scanOnceQueueShow(const int reset);
 /*print periodic lists*/
 epicsShareFunc int scanppl(double rate);
 
+/*divide periodic lists between threads, before iocInit*/
+epicsShareFunc int scanPeriodicThreads(int count, double rate);
+
 /*print event lists*/
 epicsShareFunc int scanpel(const char *event_name);
 
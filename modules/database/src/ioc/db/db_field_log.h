@@ -76,6 +76,8 @@ struct dbfl_val {
 };
 
 /* External data reference.
+ * The data may be shared with other field logs, so it must not be
+ * modified.
  * If dtor is provided then it should be called when the referenced
  * data is no longer needed.  This is done automatically by
  * db_delete_field_log().  Any code which changes a dbfl_type_ref
@@ -20,9 +20,15 @@
 #include "dbDefs.h"
 #include "dbmf.h"
 #include "ellLib.h"
+#include "epicsEvent.h"
+#include "epicsMutex.h"
 #include "epicsPrint.h"
 #include "epicsString.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
 #include "errMdef.h"
+#include "osiFileName.h"
+#include "osiUnistd.h"
 #include "freeList.h"
 #include "gpHash.h"
 #include "macLib.h"
@@ -101,6 +107,7 @@ typedef struct inputFile{
 	char		*path;
 	char		*filename;
 	FILE		*fp;
+	const char	*text;	/* prefetched lines, used instead of fp */
 	int		line_num;
 }inputFile;
 static ELLLIST inputFileList = ELLLIST_INIT;
@@ -116,6 +123,7 @@ typedef struct tempListNode {
 static ELLLIST tempList = ELLLIST_INIT;
 static void *freeListPvt = NULL;
 static int duplicate = FALSE;
+static long recordsCreated = 0;
 
 static void yyerrorAbort(char *str)
 {
@@ -190,7 +198,7 @@ static void freeInputFileList(void)
     inputFile *pinputFileNow;
 
     while((pinputFileNow=(inputFile *)ellFirst(&inputFileList))) {
-	if(fclose(pinputFileNow->fp))
+	if(pinputFileNow->fp && fclose(pinputFileNow->fp))
 	    errPrintf(0,__FILE__, __LINE__,
 			"Closing file %s",pinputFileNow->filename);
 	free((void *)pinputFileNow->filename);
@@ -208,20 +216,10 @@ int cmp_dbRecordNode(const ELLNODE *lhs, const ELLNODE *rhs)
     return strcmp(LHS->recordname, RHS->recordname);
 }
 
-static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
-	const char *path,const char *substitutions)
+static void dbReadSetPath(const char *path)
 {
-    long	status;
-    inputFile	*pinputFile = NULL;
     char	*penv;
-    char	**macPairs;
-
-    if(ellCount(&tempList)) {
-        epicsPrintf("dbReadCOM: Parser stack dirty %d\n", ellCount(&tempList));
-    }
 
-    if(*ppdbbase == 0) *ppdbbase = dbAllocBase();
-    pdbbase = *ppdbbase;
     if(path && strlen(path)>0) {
 	dbPath(pdbbase,path);
     } else {
@@ -232,25 +230,117 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
 	    dbPath(pdbbase,".");
 	}
     }
+}
+
+static MAC_HANDLE *dbReadMacros(const char *substitutions, long *pstatus)
+{
+    MAC_HANDLE	*handle = NULL;
+    char	**macPairs;
+
+    *pstatus = 0;
+    if(!substitutions) return NULL;
+    if(macCreateHandle(&handle,NULL)) {
+	epicsPrintf("macCreateHandle error\n");
+	*pstatus = -1;
+	return NULL;
+    }
+    macParseDefns(handle,(char *)substitutions,&macPairs);
+    if(macPairs ==NULL) {
+	macDeleteHandle(handle);
+	return NULL;
+    }
+    macInstallMacros(handle,macPairs);
+    free((void *)macPairs);
+    macSuppressWarning(handle,dbQuietMacroWarnings);
+    return handle;
+}
+
+/* Parse pinputFile with macHandle, releasing both afterwards */
+static long dbReadParse(inputFile *pinputFile)
+{
+    long	status;
+
     my_buffer = dbCalloc(MY_BUFFER_SIZE,sizeof(char));
     freeListInitPvt(&freeListPvt,sizeof(tempListNode),100);
-    if(substitutions) {
-	if(macCreateHandle(&macHandle,NULL)) {
-	    epicsPrintf("macCreateHandle error\n");
-            status = -1;
-	    goto cleanup;
+    if(macHandle)
+	mac_input_buffer = dbCalloc(MY_BUFFER_SIZE,sizeof(char));
+    pinputFile->line_num = 0;
+    pinputFileNow = pinputFile;
+    my_buffer[0] = '\0';
+    my_buffer_ptr = my_buffer;
+    ellAdd(&inputFileList,&pinputFile->node);
+    status = pvt_yy_parse();
+
+    if (ellCount(&tempList) && !yyAbort)
+        epicsPrintf("dbReadCOM: Parser stack dirty w/o error. %d\n", ellCount(&tempList));
+    while (ellCount(&tempList))
+        popFirstTemp(); /* Memory leak on parser failure */
+
+    if(macHandle) macDeleteHandle(macHandle);
+    macHandle = NULL;
+    if(mac_input_buffer) free((void *)mac_input_buffer);
+    mac_input_buffer = NULL;
+    if(freeListPvt) freeListCleanup(freeListPvt);
+    freeListPvt = NULL;
+    if(my_buffer) free((void *)my_buffer);
+    my_buffer = NULL;
+    freeInputFileList();
+    return(status);
+}
+
+/*add RTYP and VERS as an attribute */
+static void dbReadAttributes(void)
+{
+    DBENTRY	dbEntry;
+    DBENTRY	*pdbEntry = &dbEntry;
+    long	localStatus;
+
+    dbInitEntry(pdbbase,pdbEntry);
+    localStatus = dbFirstRecordType(pdbEntry);
+    while(!localStatus) {
+	localStatus = dbPutRecordAttribute(pdbEntry,"RTYP",
+	    dbGetRecordTypeName(pdbEntry));
+	if(!localStatus)  {
+	    localStatus = dbPutRecordAttribute(pdbEntry,"VERS",
+		"none specified");
 	}
-	macParseDefns(macHandle,(char *)substitutions,&macPairs);
-	if(macPairs ==NULL) {
-	    macDeleteHandle(macHandle);
-	    macHandle = NULL;
+	if(localStatus) {
+	    fprintf(stderr,"dbPutRecordAttribute status %ld\n",localStatus);
 	} else {
-	    macInstallMacros(macHandle,macPairs);
-	    free((void *)macPairs);
-	    mac_input_buffer = dbCalloc(MY_BUFFER_SIZE,sizeof(char));
+	    localStatus = dbNextRecordType(pdbEntry);
 	}
-        macSuppressWarning(macHandle,dbQuietMacroWarnings);
     }
+    dbFinishEntry(pdbEntry);
+}
+
+static void dbReadSort(void)
+{
+    if(dbRecordsAbcSorted) {
+        ELLNODE *cur;
+        for(cur = ellFirst(&pdbbase->recordTypeList); cur; cur=ellNext(cur))
+        {
+            dbRecordType *rtype = CONTAINER(cur, dbRecordType, node);
+
+            ellSortStable(&rtype->recList, &cmp_dbRecordNode);
+        }
+    }
+}
+
+static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
+	const char *path,const char *substitutions)
+{
+    long	status;
+    inputFile	*pinputFile = NULL;
+
+    if(ellCount(&tempList)) {
+        epicsPrintf("dbReadCOM: Parser stack dirty %d\n", ellCount(&tempList));
+    }
+
+    if(*ppdbbase == 0) *ppdbbase = dbAllocBase();
+    pdbbase = *ppdbbase;
+    dbReadSetPath(path);
+    macHandle = dbReadMacros(substitutions, &status);
+    if(status) goto cleanup;
     pinputFile = dbCalloc(1,sizeof(inputFile));
     if (filename) {
         pinputFile->filename = macEnvExpand(filename);
@@ -272,60 +362,14 @@ static long dbReadCOM(DBBASE **ppdbbase,const char *filename, FILE *fp,
     } else {
         pinputFile->fp = fp;
     }
-    pinputFile->line_num = 0;
-    pinputFileNow = pinputFile;
-    my_buffer[0] = '\0';
-    my_buffer_ptr = my_buffer;
-    ellAdd(&inputFileList,&pinputFile->node);
-    status = pvt_yy_parse();
-
-    if (ellCount(&tempList) && !yyAbort)
-        epicsPrintf("dbReadCOM: Parser stack dirty w/o error. %d\n", ellCount(&tempList));
-    while (ellCount(&tempList))
-        popFirstTemp(); /* Memory leak on parser failure */
+    status = dbReadParse(pinputFile);
 
     dbFreePath(pdbbase);
-    if(!status) { /*add RTYP and VERS as an attribute */
-	DBENTRY	dbEntry;
-	DBENTRY	*pdbEntry = &dbEntry;
-	long	localStatus;
-
-	dbInitEntry(pdbbase,pdbEntry);
-	localStatus = dbFirstRecordType(pdbEntry);
-	while(!localStatus) {
-	    localStatus = dbPutRecordAttribute(pdbEntry,"RTYP",
-		dbGetRecordTypeName(pdbEntry));
-	    if(!localStatus)  {
-		localStatus = dbPutRecordAttribute(pdbEntry,"VERS",
-		    "none specified");
-	    }
-	    if(localStatus) {
-		fprintf(stderr,"dbPutRecordAttribute status %ld\n",status);
-	    } else {
-	        localStatus = dbNextRecordType(pdbEntry);
-	    }
-	}
-	dbFinishEntry(pdbEntry);
-    }
+    if(!status) dbReadAttributes();
 cleanup:
-    if(dbRecordsAbcSorted) {
-        ELLNODE *cur;
-        for(cur = ellFirst(&pdbbase->recordTypeList); cur; cur=ellNext(cur))
-        {
-            dbRecordType *rtype = CONTAINER(cur, dbRecordType, node);
-
-            ellSortStable(&rtype->recList, &cmp_dbRecordNode);
-        }
-    }
+    dbReadSort();
     if(macHandle) macDeleteHandle(macHandle);
     macHandle = NULL;
-    if(mac_input_buffer) free((void *)mac_input_buffer);
-    mac_input_buffer = NULL;
-    if(freeListPvt) freeListCleanup(freeListPvt);
-    freeListPvt = NULL;
-    if(my_buffer) free((void *)my_buffer);
-    my_buffer = NULL;
-    freeInputFileList();
     return(status);
 }
 
@@ -336,7 +380,468 @@ long dbReadDatabase(DBBASE **ppdbbase,const char *filename,
 long dbReadDatabaseFP(DBBASE **ppdbbase,FILE *fp,
 	const char *path,const char *substitutions)
 {return (dbReadCOM(ppdbbase,0,fp,path,substitutions));}
-
+
+/* Batch reading
+ *
+ * dbReadListAdd() finds each file when it is added, just as
+ * dbReadDatabase() would have opened it, and keeps its name and the
+ * include path with the working directory prefixed, so later changes of
+ * directory or environment don't matter.  dbReadListRead() parses the
+ * substitutions on the calling thread, then worker threads read and
+ * macro-expand the files into memory while the caller parses them in the
+ * order they were added.  The parser is not reentrant, so only the
+ * expansion runs in parallel; records are created exactly as a sequence
+ * of dbReadDatabase() calls would.
+ */
+
+#define DB_READ_TEXT_SIZE 65536
+
+typedef struct dbReadItem {
+    char	*filename;	/* as given */
+    char	*substitutions;
+    char	*name;		/* after environment expansion */
+    char	*fullname;	/* including the directory it was found in */
+    char	*directory;
+    char	*path;		/* include path, from the working directory */
+    MAC_HANDLE	*handle;
+    char	*text;		/* prefetched lines, see dbPrefetchGets() */
+    size_t	len;
+    size_t	size;
+    double	seconds;	/* taken to read and expand */
+    long	status;
+    int		ready;
+} dbReadItem;
+
+struct dbReadList {
+    dbReadItem	*items;
+    int		count;
+    int		size;
+    int		next;		/* next item for a worker to expand */
+    int		running;	/* worker threads */
+    epicsMutexId lock;
+    epicsEventId readyEvent;
+    /* Statistics of the last dbReadListRead() */
+    int		threads;
+    int		failed;
+    long	records;
+    double	expand;
+    double	wait;
+    double	parse;
+    double	finish;
+    double	total;
+};
+
+static void *dbReadRealloc(void *ptr, size_t size)
+{
+    void *pnew = realloc(ptr, size);
+
+    if (!pnew)
+        cantProceed("dbReadList: realloc of %lu bytes failed\n",
+            (unsigned long) size);
+    return pnew;
+}
+
+static int dbReadIsAbsolute(const char *name)
+{
+    const char *pcolon = strchr(name, ':');
+
+    /* a drive or device name counts as absolute */
+    return name[0] == '/' || name[0] == '\\' ||
+        (pcolon && (size_t) (pcolon - name) == strcspn(name, "/\\"));
+}
+
+/* name relative to cwd, which may be NULL */
+static char *dbReadAbsolute(const char *cwd, const char *name)
+{
+    char *full;
+
+    if (!cwd || dbReadIsAbsolute(name))
+        return epicsStrDup(name);
+    full = dbMalloc(strlen(cwd) + strlen(name) + 2);
+    strcpy(full, cwd);
+    strcat(full, "/");
+    strcat(full, name);
+    return full;
+}
+
+/* The current path of pdbbase relative to cwd */
+static char *dbReadAbsolutePath(const char *cwd)
+{
+    ELLLIST	*ppathList = (ELLLIST *)pdbbase->pathPvt;
+    dbPathNode	*pdbPathNode;
+    char	*path = NULL;
+    size_t	len = 0;
+
+    if (!ppathList)
+        return NULL;
+    for (pdbPathNode = (dbPathNode *)ellFirst(ppathList); pdbPathNode;
+         pdbPathNode = (dbPathNode *)ellNext(&pdbPathNode->node)) {
+        char *dir = dbReadAbsolute(cwd, pdbPathNode->directory);
+
+        path = dbReadRealloc(path, len + strlen(dir) +
+            strlen(OSI_PATH_LIST_SEPARATOR) + 1);
+        if (len) {
+            strcpy(path + len, OSI_PATH_LIST_SEPARATOR);
+            len += strlen(OSI_PATH_LIST_SEPARATOR);
+        }
+        strcpy(path + len, dir);
+        len += strlen(dir);
+        free(dir);
+    }
+    return path;
+}
+
+dbReadList * dbReadListCreate(void)
+{
+    dbReadList *plist = dbCalloc(1, sizeof(dbReadList));
+
+    plist->lock = epicsMutexMustCreate();
+    plist->readyEvent = epicsEventMustCreate(epicsEventEmpty);
+    return plist;
+}
+
+/* Find the file now, like dbReadDatabase() would */
+static void dbReadItemResolve(dbReadItem *pitem, const char *path)
+{
+    char cwdbuf[1024];
+    const char *cwd = getcwd(cwdbuf, sizeof(cwdbuf));
+    FILE *fp = NULL;
+    char *directory = NULL;
+
+    dbReadSetPath(path);
+    pitem->path = dbReadAbsolutePath(cwd);
+    pitem->name = macEnvExpand(pitem->filename);
+    if (pitem->name)
+        directory = dbOpenFile(pdbbase, pitem->name, &fp);
+    if (!pitem->name || !fp) {
+        errPrintf(0, __FILE__, __LINE__,
+            "dbRead opening file %s", pitem->name);
+        pitem->status = -1;
+    }
+    else {
+        fclose(fp);
+        if (directory) {
+            char *dir = dbReadAbsolute(cwd, directory);
+
+            pitem->directory = epicsStrDup(directory);
+            pitem->fullname = dbMalloc(strlen(dir) +
+                strlen(pitem->name) + 2);
+            strcpy(pitem->fullname, dir);
+            strcat(pitem->fullname, "/");
+            strcat(pitem->fullname, pitem->name);
+            free(dir);
+        }
+        else
+            pitem->fullname = dbReadAbsolute(cwd, pitem->name);
+    }
+    dbFreePath(pdbbase);
+}
+
+void dbReadListAdd(DBBASE **ppdbbase, dbReadList *plist,
+    const char *filename, const char *path, const char *substitutions)
+{
+    dbReadItem *pitem;
+
+    if (plist->count == plist->size) {
+        plist->size = plist->size ? 2 * plist->size : 16;
+        plist->items = dbReadRealloc(plist->items,
+            plist->size * sizeof(dbReadItem));
+    }
+    pitem = &plist->items[plist->count++];
+    memset(pitem, 0, sizeof(dbReadItem));
+    pitem->filename = epicsStrDup(filename);
+    if (substitutions)
+        pitem->substitutions = epicsStrDup(substitutions);
+    if (*ppdbbase == 0) *ppdbbase = dbAllocBase();
+    pdbbase = *ppdbbase;
+    dbReadItemResolve(pitem, path);
+}
+
+int dbReadListCount(const dbReadList *plist)
+{
+    return plist->count;
+}
+
+static void dbReadItemClear(dbReadItem *pitem)
+{
+    if (pitem->handle)
+        macDeleteHandle(pitem->handle);
+    free(pitem->name);
+    free(pitem->fullname);
+    free(pitem->directory);
+    free(pitem->path);
+    free(pitem->text);
+    pitem->handle = NULL;
+    pitem->name = pitem->fullname = pitem->directory = pitem->text = NULL;
+    pitem->path = NULL;
+    pitem->len = pitem->size = 0;
+}
+
+void dbReadListFree(dbReadList *plist)
+{
+    int i;
+
+    if (!plist)
+        return;
+    for (i = 0; i < plist->count; i++) {
+        dbReadItemClear(&plist->items[i]);
+        free(plist->items[i].filename);
+        free(plist->items[i].substitutions);
+    }
+    free(plist->items);
+    epicsEventDestroy(plist->readyEvent);
+    epicsMutexDestroy(plist->lock);
+    free(plist);
+}
+
+static void dbReadItemAppend(dbReadItem *pitem, const char *str, size_t len)
+{
+    if (pitem->len + len > pitem->size) {
+        while (pitem->len + len > pitem->size)
+            pitem->size = pitem->size ? 2 * pitem->size : DB_READ_TEXT_SIZE;
+        pitem->text = dbReadRealloc(pitem->text, pitem->size);
+    }
+    memcpy(pitem->text + pitem->len, str, len);
+    pitem->len += len;
+}
+
+/* Read and expand the file into pitem->text, on any thread */
+static void dbReadItemExpand(dbReadItem *pitem)
+{
+    char raw[MY_BUFFER_SIZE];
+    char expanded[MY_BUFFER_SIZE];
+    epicsTimeStamp start, stop;
+    FILE *fp;
+
+    epicsTimeGetCurrent(&start);
+    fp = fopen(pitem->fullname, "r");
+    if (!fp) {
+        pitem->status = -1;
+        return;
+    }
+    if (pitem->handle)
+        macSuppressWarning(pitem->handle, TRUE);
+    while (fgets(raw, MY_BUFFER_SIZE, fp)) {
+        if (pitem->handle) {
+            int exp = macExpandString(pitem->handle, raw, expanded,
+                MY_BUFFER_SIZE);
+
+            if (exp < 0) {
+                dbReadItemAppend(pitem, "W", 1);
+                dbReadItemAppend(pitem, raw, strlen(raw) + 1);
+            }
+            else {
+                dbReadItemAppend(pitem, " ", 1);
+                dbReadItemAppend(pitem, expanded, strlen(expanded) + 1);
+            }
+        }
+        else {
+            dbReadItemAppend(pitem, " ", 1);
+            dbReadItemAppend(pitem, raw, strlen(raw) + 1);
+        }
+    }
+    dbReadItemAppend(pitem, "", 1);
+    fclose(fp);
+    if (pitem->handle)
+        macSuppressWarning(pitem->handle, dbQuietMacroWarnings);
+    epicsTimeGetCurrent(&stop);
+    pitem->seconds = epicsTimeDiffInSeconds(&stop, &start);
+}
+
+static void dbReadWorker(void *arg)
+{
+    dbReadList *plist = (dbReadList *) arg;
+
+    while (TRUE) {
+        dbReadItem *pitem;
+
+        epicsMutexMustLock(plist->lock);
+        while (plist->next < plist->count &&
+               plist->items[plist->next].status)
+            plist->items[plist->next++].ready = TRUE;
+        if (plist->next >= plist->count) {
+            epicsMutexUnlock(plist->lock);
+            break;
+        }
+        pitem = &plist->items[plist->next++];
+        epicsMutexUnlock(plist->lock);
+
+        dbReadItemExpand(pitem);
+
+        epicsMutexMustLock(plist->lock);
+        pitem->ready = TRUE;
+        epicsMutexUnlock(plist->lock);
+        epicsEventMustTrigger(plist->readyEvent);
+    }
+    /* plist may be freed as soon as the lock is released */
+    epicsMutexMustLock(plist->lock);
+    plist->running--;
+    epicsEventMustTrigger(plist->readyEvent);
+    epicsMutexUnlock(plist->lock);
+}
+
+static long dbReadItemParse(dbReadItem *pitem)
+{
+    inputFile *pinputFile;
+
+    if(ellCount(&tempList)) {
+        epicsPrintf("dbReadCOM: Parser stack dirty %d\n", ellCount(&tempList));
+    }
+    dbReadSetPath(pitem->path);
+    macHandle = pitem->handle;
+    pitem->handle = NULL;
+    pinputFile = dbCalloc(1, sizeof(inputFile));
+    pinputFile->filename = pitem->name;
+    pinputFile->path = pitem->directory;
+    pinputFile->text = pitem->text;
+    pitem->name = NULL;
+    return dbReadParse(pinputFile);
+}
+
+long dbReadListRead(DBBASE **ppdbbase, dbReadList *plist,
+    int nThreads, DB_READ_LIST_DONE done)
+{
+    epicsTimeStamp start, t0, t1;
+    long status = 0;
+    long created = recordsCreated;
+    int parsed = 0;
+    int i;
+
+    epicsTimeGetCurrent(&start);
+    if (*ppdbbase == 0) *ppdbbase = dbAllocBase();
+    pdbbase = *ppdbbase;
+    for (i = 0; i < plist->count; i++) {
+        dbReadItem *pitem = &plist->items[i];
+
+        pitem->ready = FALSE;
+        pitem->seconds = 0;
+        if (!pitem->status)
+            pitem->handle = dbReadMacros(pitem->substitutions,
+                &pitem->status);
+    }
+    plist->next = 0;
+    plist->failed = 0;
+    plist->expand = plist->wait = plist->parse = 0;
+
+    if (nThreads <= 0)
+        nThreads = epicsThreadGetCPUs();
+    if (nThreads > plist->count)
+        nThreads = plist->count;
+    plist->threads = 0;
+    plist->running = 0;
+    while (plist->threads < nThreads) {
+        char name[20];
+
+        sprintf(name, "dbRead%d", plist->threads);
+        epicsMutexMustLock(plist->lock);
+        plist->running++;
+        epicsMutexUnlock(plist->lock);
+        if (!epicsThreadCreate(name, epicsThreadGetPrioritySelf(),
+                epicsThreadGetStackSize(epicsThreadStackMedium),
+                dbReadWorker, plist)) {
+            epicsMutexMustLock(plist->lock);
+            plist->running--;
+            epicsMutexUnlock(plist->lock);
+            break;
+        }
+        plist->threads++;
+    }
+
+    for (i = 0; i < plist->count; i++) {
+        dbReadItem *pitem = &plist->items[i];
+
+        epicsTimeGetCurrent(&t0);
+        if (!plist->threads) {
+            if (!pitem->status)
+                dbReadItemExpand(pitem);
+        }
+        else {
+            epicsMutexMustLock(plist->lock);
+            while (!pitem->ready) {
+                epicsMutexUnlock(plist->lock);
+                epicsEventMustWait(plist->readyEvent);
+                epicsMutexMustLock(plist->lock);
+            }
+            epicsMutexUnlock(plist->lock);
+        }
+        epicsTimeGetCurrent(&t1);
+        plist->wait += epicsTimeDiffInSeconds(&t1, &t0);
+
+        if (!pitem->status)
+            pitem->status = dbReadItemParse(pitem);
+        if (pitem->status) {
+            plist->failed++;
+            status = pitem->status;
+        }
+        else {
+            parsed++;
+            if (done)
+                done(pitem->filename, pitem->substitutions);
+        }
+        plist->expand += pitem->seconds;
+        dbReadItemClear(pitem);
+        epicsTimeGetCurrent(&t0);
+        plist->parse += epicsTimeDiffInSeconds(&t0, &t1);
+    }
+    epicsMutexMustLock(plist->lock);
+    while (plist->running) {
+        epicsMutexUnlock(plist->lock);
+        epicsEventMustWait(plist->readyEvent);
+        epicsMutexMustLock(plist->lock);
+    }
+    epicsMutexUnlock(plist->lock);
+    if (!plist->threads)
+        plist->wait -= plist->expand;
+
+    epicsTimeGetCurrent(&t0);
+    dbFreePath(pdbbase);
+    if (parsed)
+        dbReadAttributes();
+    dbReadSort();
+    epicsTimeGetCurrent(&t1);
+    plist->finish = epicsTimeDiffInSeconds(&t1, &t0);
+    plist->total = epicsTimeDiffInSeconds(&t1, &start);
+    plist->records = recordsCreated - created;
+    return status;
+}
+
+void dbReadListReport(const dbReadList *plist)
+{
+    printf("Read %d file%s with %d thread%s, %ld new records in %.3f sec\n",
+        plist->count, plist->count == 1 ? "" : "s",
+        plist->threads, plist->threads == 1 ? "" : "s",
+        plist->records, plist->total);
+    printf("    expand %.3f, wait %.3f, parse %.3f, finish %.3f sec\n",
+        plist->expand, plist->wait, plist->parse, plist->finish);
+    if (plist->failed)
+        printf("    %d file%s failed to load\n",
+            plist->failed, plist->failed == 1 ? "" : "s");
+}
+
+/* A prefetched file holds one entry per input line: a flag character,
+ * then the expanded line and its nil.  Lines flagged 'W' had undefined
+ * macros and hold the original line instead, which is expanded again here
+ * so the warnings come out in order.  A nil flag ends the file.
+ */
+static char *dbPrefetchGets(inputFile *pinputFile)
+{
+    const char	*line = pinputFile->text;
+    char	flag = *line++;
+    size_t	len;
+
+    if(!flag) return NULL;
+    len = strlen(line) + 1;
+    if(flag == 'W') {
+	macExpandString(macHandle,line,my_buffer,MY_BUFFER_SIZE);
+	fprintf(stderr, "Warning: '%s' line %d has undefined macros\n",
+	    pinputFile->filename, pinputFile->line_num+1);
+    } else {
+	memcpy(my_buffer,line,len);
+    }
+    pinputFile->text = line + len;
+    return my_buffer;
+}
+
 static int db_yyinput(char *buf, int max_size)
 {
     size_t  l,n;
@@ -345,7 +850,9 @@ static int db_yyinput(char *buf, int max_size)
     if(yyAbort) return(0);
     if(*my_buffer_ptr==0) {
 	while(TRUE) { /*until we get some input*/
-	    if(macHandle) {
+	    if(pinputFileNow->text) {
+		fgetsRtn = dbPrefetchGets(pinputFileNow);
+	    } else if(macHandle) {
 		fgetsRtn = fgets(mac_input_buffer,MY_BUFFER_SIZE,
 			pinputFileNow->fp);
 		if(fgetsRtn) {
@@ -360,7 +867,7 @@ static int db_yyinput(char *buf, int max_size)
 		fgetsRtn = fgets(my_buffer,MY_BUFFER_SIZE,pinputFileNow->fp);
 	    }
 	    if(fgetsRtn) break;
-	    if(fclose(pinputFileNow->fp))
+	    if(pinputFileNow->fp && fclose(pinputFileNow->fp))
 		errPrintf(0,__FILE__, __LINE__,
 			"Closing file %s",pinputFileNow->filename);
 	    free((void *)pinputFileNow->filename);
@@ -1097,6 +1604,8 @@ static void dbRecordHead(char *recordType, char *name, int visible)
                      name, recordType);
         yyerrorAbort(NULL);
     }
+    else
+        recordsCreated++;
 
     if (visible)
         dbVisibleRecord(pdbentry);
@@ -16,6 +16,7 @@
 
 #include "dbDefs.h"
 #include "ellLib.h"
+#include "epicsAtomic.h"
 #include "epicsMutex.h"
 #include "epicsStdio.h"
 #include "epicsString.h"
@@ -25,22 +26,50 @@
 #include "dbStaticLib.h"
 #include "dbStaticPvt.h"
 
+/* The directory is an open addressing hash table with linear probing.
+ * Each slot holds the full hash of the record name, so a probe only
+ * compares names when the hashes match.
+ *
+ * Lookups take no lock.  Writers are serialized by the directory lock,
+ * and fill in a slot's hash before publishing its entry.  When the table
+ * gets too full it is copied into a new table which is then published;
+ * the old table stays allocated (on the retired list) until the directory
+ * is freed, as a concurrent reader may still be probing it.  Doubling
+ * keeps the retired tables smaller than the current one.
+ *
+ * For the same reason a deleted entry is not freed but moved to the
+ * deleted list, and lookups compare the entry's own copy of the record
+ * name, since the record node is freed as soon as it has been deleted.
+ */
+
 typedef struct {
-    ELLLIST      list;
-    epicsMutexId lock;
-} dbPvdBucket;
+    unsigned int hash;
+    PVDENTRY     *pentry;   /* NULL for empty, PVD_DELETED after delete */
+} dbPvdSlot;
 
-typedef struct dbPvd {
+typedef struct dbPvdTable {
     unsigned int size;
     unsigned int mask;
-    dbPvdBucket **buckets;
+    struct dbPvdTable *retired;
+    dbPvdSlot    slots[1];  /* actually size */
+} dbPvdTable;
+
+typedef struct dbPvd {
+    dbPvdTable   *table;    /* use atomic */
+    epicsMutexId lock;
+    ELLLIST      deleted;   /* PVDENTRYs retired by dbPvdDelete */
+    unsigned int count;     /* live entries */
+    unsigned int used;      /* live and deleted slots */
+    unsigned int resizes;
 } dbPvd;
 
+static PVDENTRY pvdDeleted;
+#define PVD_DELETED (&pvdDeleted)
+
 unsigned int dbPvdHashTableSize = 0;
 
 #define MIN_SIZE 256
 #define DEFAULT_SIZE 512
-#define MAX_SIZE 65536
 
 
 int dbPvdTableSize(int size)
@@ -53,13 +82,93 @@ int dbPvdTableSize(int size)
     if (size < MIN_SIZE)
         size = MIN_SIZE;
 
-    if (size > MAX_SIZE)
-        size = MAX_SIZE;
-
     dbPvdHashTableSize = size;
     return 0;
 }
 
+static dbPvdTable *pvdTableCreate(unsigned int size)
+{
+    dbPvdTable *ptable = dbCalloc(1,
+        sizeof(dbPvdTable) + (size - 1) * sizeof(dbPvdSlot));
+
+    ptable->size = size;
+    ptable->mask = size - 1;
+    return ptable;
+}
+
+static dbPvdTable *pvdTableGet(dbPvd *ppvd)
+{
+    dbPvdTable *ptable = epicsAtomicGetPtrT((EpicsAtomicPtrT *) &ppvd->table);
+
+    epicsAtomicReadMemoryBarrier();
+    return ptable;
+}
+
+static PVDENTRY *pvdSlotGet(dbPvdSlot *pslot)
+{
+    PVDENTRY *pentry = epicsAtomicGetPtrT((EpicsAtomicPtrT *) &pslot->pentry);
+
+    epicsAtomicReadMemoryBarrier();
+    return pentry;
+}
+
+static void pvdSlotSet(dbPvdSlot *pslot, unsigned int hash, PVDENTRY *pentry)
+{
+    pslot->hash = hash;
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *) &pslot->pentry, pentry);
+}
+
+/* Find the slot holding name, caller holds the lock */
+static dbPvdSlot *pvdTableLookup(dbPvdTable *ptable, unsigned int hash,
+    const char *name)
+{
+    unsigned int h = hash & ptable->mask;
+
+    for (;; h = (h + 1) & ptable->mask) {
+        dbPvdSlot *pslot = &ptable->slots[h];
+
+        if (!pslot->pentry)
+            return NULL;
+        if (pslot->pentry != PVD_DELETED && pslot->hash == hash &&
+            strcmp(name, pslot->pentry->name) == 0)
+            return pslot;
+    }
+}
+
+/* Copy live entries into a new table, which is then published.
+ * Caller holds the lock.
+ */
+static void pvdResize(dbPvd *ppvd)
+{
+    dbPvdTable *pold = ppvd->table;
+    unsigned int size = pold->size;
+    dbPvdTable *pnew;
+    unsigned int i;
+
+    /* grow while at least a quarter full, else just purge deleted slots */
+    if (ppvd->count * 4 >= size)
+        size *= 2;
+    pnew = pvdTableCreate(size);
+
+    for (i = 0; i < pold->size; i++) {
+        dbPvdSlot *pslot = &pold->slots[i];
+        unsigned int h;
+
+        if (!pslot->pentry || pslot->pentry == PVD_DELETED)
+            continue;
+        for (h = pslot->hash & pnew->mask; pnew->slots[h].pentry;
+             h = (h + 1) & pnew->mask);
+        pnew->slots[h] = *pslot;
+    }
+
+    pnew->retired = pold;
+    ppvd->used = ppvd->count;
+    ppvd->resizes++;
+    epicsAtomicWriteMemoryBarrier();
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *) &ppvd->table, pnew);
+}
+
 void dbPvdInitPvt(dbBase *pdbbase)
 {
     dbPvd *ppvd;
@@ -70,10 +179,9 @@ void dbPvdInitPvt(dbBase *pdbbase)
         dbPvdHashTableSize = DEFAULT_SIZE;
     }
 
-    ppvd = (dbPvd *)dbMalloc(sizeof(dbPvd));
-    ppvd->size    = dbPvdHashTableSize;
-    ppvd->mask    = dbPvdHashTableSize - 1;
-    ppvd->buckets = dbCalloc(ppvd->size, sizeof(dbPvdBucket *));
+    ppvd = (dbPvd *)dbCalloc(1, sizeof(dbPvd));
+    ppvd->table = pvdTableCreate(dbPvdHashTableSize);
+    ppvd->lock  = epicsMutexMustCreate();
 
     pdbbase->ppvd = ppvd;
     return;
@@ -81,119 +189,121 @@ void dbPvdInitPvt(dbBase *pdbbase)
 
 PVDENTRY *dbPvdFind(dbBase *pdbbase, const char *name, size_t lenName)
 {
-    dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
-    PVDENTRY *ppvdNode;
-    
-    pbucket = ppvd->buckets[epicsMemHash(name, lenName, 0) & ppvd->mask];
-    if (pbucket == NULL) return NULL;
+    dbPvdTable *ptable = pvdTableGet(pdbbase->ppvd);
+    unsigned int hash = epicsMemHash(name, lenName, 0);
+    unsigned int h = hash & ptable->mask;
 
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        const char *recordname = ppvdNode->precnode->recordname;
+    for (;; h = (h + 1) & ptable->mask) {
+        dbPvdSlot *pslot = &ptable->slots[h];
+        PVDENTRY *ppvdNode = pvdSlotGet(pslot);
+        const char *recordname;
 
+        if (!ppvdNode)
+            return NULL;
+        if (ppvdNode == PVD_DELETED || pslot->hash != hash)
+            continue;
+
+        recordname = ppvdNode->name;
         if (strncmp(name, recordname, lenName) == 0 &&
-            strlen(recordname) == lenName)
-            break;
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+            recordname[lenName] == '\0')
+            return ppvdNode;
     }
-    epicsMutexUnlock(pbucket->lock);
-    return ppvdNode;
 }
-
+
 PVDENTRY *dbPvdAdd(dbBase *pdbbase, dbRecordType *precordType,
     dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
+    dbPvdTable *ptable;
     PVDENTRY *ppvdNode;
     char *name = precnode->recordname;
+    unsigned int hash = epicsStrHash(name, 0);
     unsigned int h;
 
-    h = epicsStrHash(name, 0) & ppvd->mask;
-    pbucket = ppvd->buckets[h];
-    if (pbucket == NULL) {
-        pbucket = dbCalloc(1, sizeof(dbPvdBucket));
-        ellInit(&pbucket->list);
-        pbucket->lock = epicsMutexCreate();
-        ppvd->buckets[h] = pbucket;
+    epicsMutexMustLock(ppvd->lock);
+    ptable = ppvd->table;
+    if (pvdTableLookup(ptable, hash, name)) {
+        epicsMutexUnlock(ppvd->lock);
+        return NULL;
     }
 
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            epicsMutexUnlock(pbucket->lock);
-            return NULL;
-        }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+    /* keep at least half the slots empty */
+    if ((ppvd->used + 1) * 2 > ptable->size) {
+        pvdResize(ppvd);
+        ptable = ppvd->table;
     }
-    ppvdNode = dbCalloc(1, sizeof(PVDENTRY));
+
+    ppvdNode = dbCalloc(1, sizeof(PVDENTRY) + strlen(name) + 1);
     ppvdNode->precordType = precordType;
     ppvdNode->precnode = precnode;
-    ellAdd(&pbucket->list, (ELLNODE *)ppvdNode);
-    epicsMutexUnlock(pbucket->lock);
+    ppvdNode->name = strcpy((char *) (ppvdNode + 1), name);
+
+    /* re-use the first deleted slot, which cannot be beyond an empty one */
+    for (h = hash & ptable->mask; ptable->slots[h].pentry &&
+         ptable->slots[h].pentry != PVD_DELETED;
+         h = (h + 1) & ptable->mask);
+    if (!ptable->slots[h].pentry)
+        ppvd->used++;
+    pvdSlotSet(&ptable->slots[h], hash, ppvdNode);
+    ppvd->count++;
+
+    epicsMutexUnlock(ppvd->lock);
     return ppvdNode;
 }
 
 void dbPvdDelete(dbBase *pdbbase, dbRecordNode *precnode)
 {
     dbPvd *ppvd = pdbbase->ppvd;
-    dbPvdBucket *pbucket;
-    PVDENTRY *ppvdNode;
+    dbPvdSlot *pslot;
     char *name = precnode->recordname;
 
-    pbucket = ppvd->buckets[epicsStrHash(name, 0) & ppvd->mask];
-    if (pbucket == NULL) return;
+    if (!name) return;
 
-    epicsMutexMustLock(pbucket->lock);
-    ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-    while (ppvdNode) {
-        if (ppvdNode->precnode &&
-            ppvdNode->precnode->recordname &&
-            strcmp(name, ppvdNode->precnode->recordname) == 0) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
-            free(ppvdNode);
-            break;
-        }
-        ppvdNode = (PVDENTRY *) ellNext((ELLNODE *)ppvdNode);
+    epicsMutexMustLock(ppvd->lock);
+    pslot = pvdTableLookup(ppvd->table, epicsStrHash(name, 0), name);
+    if (pslot) {
+        PVDENTRY *ppvdNode = pslot->pentry;
+
+        epicsAtomicSetPtrT((EpicsAtomicPtrT *) &pslot->pentry, PVD_DELETED);
+        ppvd->count--;
+        ellAdd(&ppvd->deleted, &ppvdNode->node);
     }
-    epicsMutexUnlock(pbucket->lock);
+    epicsMutexUnlock(ppvd->lock);
     return;
 }
 
 void dbPvdFreeMem(dbBase *pdbbase)
 {
     dbPvd *ppvd = pdbbase->ppvd;
+    dbPvdTable *ptable;
     unsigned int h;
 
     if (ppvd == NULL) return;
     pdbbase->ppvd = NULL;
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
+    ptable = ppvd->table;
+    for (h = 0; h < ptable->size; h++) {
+        PVDENTRY *ppvdNode = ptable->slots[h].pentry;
 
-        if (pbucket == NULL) continue;
-        epicsMutexMustLock(pbucket->lock);
-        ppvd->buckets[h] = NULL;
-        while ((ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list))) {
-            ellDelete(&pbucket->list, (ELLNODE *)ppvdNode);
+        if (ppvdNode && ppvdNode != PVD_DELETED)
             free(ppvdNode);
-        }
-        epicsMutexUnlock(pbucket->lock);
-        epicsMutexDestroy(pbucket->lock);
-        free(pbucket);
     }
-    free(ppvd->buckets);
+    ellFree(&ppvd->deleted);
+    while (ptable) {
+        dbPvdTable *pnext = ptable->retired;
+
+        free(ptable);
+        ptable = pnext;
+    }
+    epicsMutexDestroy(ppvd->lock);
     free(ppvd);
 }
 
 void dbPvdDump(dbBase *pdbbase, int verbose)
 {
-    unsigned int empty = 0;
+    unsigned int deleted = 0, probes = 0, maxProbe = 0;
     dbPvd *ppvd;
+    dbPvdTable *ptable;
     unsigned int h;
 
     if (!pdbbase) {
@@ -203,27 +313,32 @@ void dbPvdDump(dbBase *pdbbase, int verbose)
     ppvd = pdbbase->ppvd;
     if (ppvd == NULL) return;
 
-    printf("Process Variable Directory has %u buckets", ppvd->size);
+    epicsMutexMustLock(ppvd->lock);
+    ptable = ppvd->table;
+    printf("Process Variable Directory has %u entries in %u slots, "
+        "resized %u times\n", ppvd->count, ptable->size, ppvd->resizes);
 
-    for (h = 0; h < ppvd->size; h++) {
-        dbPvdBucket *pbucket = ppvd->buckets[h];
-        PVDENTRY *ppvdNode;
-        int i = 1;
+    for (h = 0; h < ptable->size; h++) {
+        PVDENTRY *ppvdNode = ptable->slots[h].pentry;
+        unsigned int probe;
 
-        if (pbucket == NULL) {
-            empty++;
+        if (!ppvdNode)
+            continue;
+        if (ppvdNode == PVD_DELETED) {
+            deleted++;
             continue;
         }
-        epicsMutexMustLock(pbucket->lock);
-        ppvdNode = (PVDENTRY *) ellFirst(&pbucket->list);
-        printf("\n [%4u] %4d  ", h, ellCount(&pbucket->list));
-        while (ppvdNode && verbose) {
-            if (!(++i % 4))
-                printf("\n         ");
-            printf("  %s", ppvdNode->precnode->recordname);
-            ppvdNode = (PVDENTRY *) ellNext((ELLNODE*)ppvdNode);
-        }
-        epicsMutexUnlock(pbucket->lock);
+        probe = ((h - ptable->slots[h].hash) & ptable->mask) + 1;
+        probes += probe;
+        if (probe > maxProbe)
+            maxProbe = probe;
+        if (verbose)
+            printf(" [%6u] %3u  %s\n", h, probe,
+                ppvdNode->precnode->recordname);
     }
-    printf("\n%u buckets empty.\n", empty);
+    epicsMutexUnlock(ppvd->lock);
+
+    printf("%u slots deleted, probe length %.2f average, %u maximum.\n",
+        deleted, ppvd->count ? (double) probes / ppvd->count : 0.0,
+        maxProbe);
 }
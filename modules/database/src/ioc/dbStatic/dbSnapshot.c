@@ -0,0 +1,550 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Database snapshots: a binary image of the records in a dbBase, with
+ * their field values in the form the IOC holds them, that loads without
+ * any parsing or string conversion.
+ *
+ * The image is a dbSnapshotHeader followed by a body of entries that hold
+ * no pointers, so it could equally be mapped into memory.  Every entry
+ * starts with a tag byte, a flags byte and the 16-bit index of its record
+ * type, then the record name and its nil:
+ *   'R' (record) then for each field that differs from the record type's
+ *       default the 16-bit field index and its value, ending with index 0.
+ *       DBF_STRING values and link texts are nil-terminated, others are
+ *       the field's own bytes.  Then info name and value string pairs,
+ *       ending with an empty name.
+ *   'A' (alias) then the name of the aliased record.
+ * All records are written before any alias, so every alias follows its
+ * record even when dbRecordsAbcSorted has put it first in the list.
+ * A nil tag ends the body.  Integers are in the writer's byte order, and
+ * dbdHash covers everything in the DBD that the body depends on, so a
+ * snapshot only loads into an IOC built from the same DBD.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cantProceed.h"
+#include "dbDefs.h"
+#include "ellLib.h"
+#include "epicsPrint.h"
+#include "epicsString.h"
+#include "epicsTypes.h"
+#include "errlog.h"
+
+#include "epicsExport.h" /* #define epicsExportSharedSymbols */
+#include "dbBase.h"
+#include "dbStaticLib.h"
+#include "dbStaticPvt.h"
+#include "devSup.h"
+#include "link.h"
+
+#define DB_SNAPSHOT_MAGIC "EPICSDBS"
+#define DB_SNAPSHOT_VERSION 1
+#define DB_SNAPSHOT_ORDER 0x01020304
+
+typedef struct dbSnapshotHeader {
+    char        magic[8];
+    epicsUInt32 version;
+    epicsUInt32 byteOrder;
+    epicsUInt32 dbdHash;
+    epicsUInt32 bodyHash;
+    epicsUInt32 bodySize;
+    epicsUInt32 records;
+    epicsUInt32 aliases;
+    epicsUInt32 reserved;
+} dbSnapshotHeader;
+
+typedef struct snapBuffer {
+    char   *data;
+    size_t len;
+    size_t size;
+} snapBuffer;
+
+static void snapPut(snapBuffer *pbuf, const void *pdata, size_t len)
+{
+    if (pbuf->len + len > pbuf->size) {
+        char *pnew;
+
+        while (pbuf->len + len > pbuf->size)
+            pbuf->size = pbuf->size ? 2 * pbuf->size : 1 << 20;
+        pnew = realloc(pbuf->data, pbuf->size);
+        if (!pnew)
+            cantProceed("dbWriteSnapshot: realloc of %lu bytes failed\n",
+                (unsigned long) pbuf->size);
+        pbuf->data = pnew;
+    }
+    memcpy(pbuf->data + pbuf->len, pdata, len);
+    pbuf->len += len;
+}
+
+static void snapPutString(snapBuffer *pbuf, const char *str)
+{
+    snapPut(pbuf, str ? str : "", str ? strlen(str) + 1 : 1);
+}
+
+static void snapPutHead(snapBuffer *pbuf, char tag, char flags,
+    epicsUInt16 type, const char *name)
+{
+    snapPut(pbuf, &tag, 1);
+    snapPut(pbuf, &flags, 1);
+    snapPut(pbuf, &type, sizeof(type));
+    snapPutString(pbuf, name);
+}
+
+static unsigned int hashInt(unsigned int hash, epicsUInt32 val)
+{
+    return epicsMemHash((const char *) &val, sizeof(val), hash);
+}
+
+static unsigned int hashString(unsigned int hash, const char *str)
+{
+    return epicsStrHash(str ? str : "", hashInt(hash, str ? 1 : 0));
+}
+
+/* Covers every property of the DBD a snapshot depends on.  Only fields
+ * that differ from their defaults are written, so the defaults and what
+ * they are converted with count too.
+ */
+static epicsUInt32 dbdHash(DBBASE *pdbbase)
+{
+    unsigned int hash = DB_SNAPSHOT_VERSION;
+    dbRecordType *prt;
+    dbMenu *pmenu;
+
+    for (pmenu = (dbMenu *) ellFirst(&pdbbase->menuList); pmenu;
+         pmenu = (dbMenu *) ellNext(&pmenu->node)) {
+        int i;
+
+        hash = hashString(hash, pmenu->name);
+        hash = hashInt(hash, pmenu->nChoice);
+        for (i = 0; i < pmenu->nChoice; i++)
+            hash = hashString(hash, pmenu->papChoiceValue[i]);
+    }
+    for (prt = (dbRecordType *) ellFirst(&pdbbase->recordTypeList); prt;
+         prt = (dbRecordType *) ellNext(&prt->node)) {
+        devSup *pdevSup;
+        int i;
+
+        hash = hashString(hash, prt->name);
+        hash = hashInt(hash, prt->rec_size);
+        hash = hashInt(hash, prt->no_fields);
+        for (i = 0; i < prt->no_fields; i++) {
+            dbFldDes *pflddes = prt->papFldDes[i];
+
+            if (!pflddes)
+                continue;
+            hash = hashString(hash, pflddes->name);
+            hash = hashInt(hash, pflddes->field_type);
+            hash = hashInt(hash, pflddes->size);
+            hash = hashInt(hash, pflddes->offset);
+            hash = hashInt(hash, pflddes->base);
+            hash = hashString(hash, pflddes->initial);
+            if (pflddes->field_type == DBF_MENU)
+                hash = hashString(hash, pflddes->ftPvt ?
+                    ((dbMenu *) pflddes->ftPvt)->name : NULL);
+        }
+        for (pdevSup = (devSup *) ellFirst(&prt->devList); pdevSup;
+             pdevSup = (devSup *) ellNext(&pdevSup->node))
+            hash = hashString(hash, pdevSup->choice);
+    }
+    return hash;
+}
+
+static int isLink(const dbFldDes *pflddes)
+{
+    return pflddes->field_type == DBF_INLINK ||
+        pflddes->field_type == DBF_OUTLINK ||
+        pflddes->field_type == DBF_FWDLINK;
+}
+
+/* A record of the given type with only default field values */
+static void * snapPrototype(DBBASE *pdbbase, dbRecordType *prt,
+    dbRecordNode *pnode)
+{
+    DBENTRY dbentry;
+
+    dbInitEntry(pdbbase, &dbentry);
+    memset(pnode, 0, sizeof(dbRecordNode));
+    dbentry.precordType = prt;
+    dbentry.precnode = pnode;
+    if (dbAllocRecord(&dbentry, "")) {
+        dbFinishEntry(&dbentry);
+        return NULL;
+    }
+    dbFinishEntry(&dbentry);
+    return pnode->precord;
+}
+
+static void snapFreePrototype(DBBASE *pdbbase, dbRecordType *prt,
+    dbRecordNode *pnode)
+{
+    DBENTRY dbentry;
+    int i;
+
+    if (!pnode->precord)
+        return;
+    for (i = 1; i < prt->no_fields; i++) {
+        dbFldDes *pflddes = prt->papFldDes[i];
+
+        if (pflddes && isLink(pflddes)) {
+            DBLINK *plink = (DBLINK *)((char *) pnode->precord +
+                pflddes->offset);
+
+            free(plink->text);
+        }
+    }
+    dbInitEntry(pdbbase, &dbentry);
+    dbentry.precordType = prt;
+    dbentry.precnode = pnode;
+    dbFreeRecord(&dbentry);
+    dbFinishEntry(&dbentry);
+}
+
+static long snapPutRecord(snapBuffer *pbuf, dbRecordType *prt,
+    epicsUInt16 type, dbRecordNode *pnode, const char *pproto)
+{
+    const char *precord = (const char *) pnode->precord;
+    dbInfoNode *pinfo;
+    epicsUInt16 i;
+
+    snapPutHead(pbuf, 'R', pnode->flags & DBRN_FLAGS_VISIBLE, type,
+        pnode->recordname);
+    for (i = 1; i < prt->no_fields; i++) {
+        dbFldDes *pflddes = prt->papFldDes[i];
+        const char *pfield, *pdefault;
+
+        if (!pflddes)
+            continue;
+        pfield = precord + pflddes->offset;
+        pdefault = pproto + pflddes->offset;
+        if (isLink(pflddes)) {
+            const DBLINK *plink = (const DBLINK *) pfield;
+            const DBLINK *pdlink = (const DBLINK *) pdefault;
+
+            if (plink->type != CONSTANT || plink->value.constantStr) {
+                errlogPrintf("dbWriteSnapshot: Record \"%s\" has been "
+                    "initialized, save snapshots before iocInit\n",
+                    pnode->recordname);
+                return -1;
+            }
+            if (!plink->text ? !pdlink->text :
+                pdlink->text && !strcmp(plink->text, pdlink->text))
+                continue;
+            snapPut(pbuf, &i, sizeof(i));
+            snapPutString(pbuf, plink->text);
+        }
+        else if (pflddes->field_type == DBF_STRING) {
+            if (!strcmp(pfield, pdefault))
+                continue;
+            snapPut(pbuf, &i, sizeof(i));
+            snapPutString(pbuf, pfield);
+        }
+        else if (pflddes->field_type != DBF_NOACCESS) {
+            if (!memcmp(pfield, pdefault, pflddes->size))
+                continue;
+            snapPut(pbuf, &i, sizeof(i));
+            snapPut(pbuf, pfield, pflddes->size);
+        }
+    }
+    i = 0;
+    snapPut(pbuf, &i, sizeof(i));
+    for (pinfo = (dbInfoNode *) ellFirst(&pnode->infoList); pinfo;
+         pinfo = (dbInfoNode *) ellNext(&pinfo->node)) {
+        if (!pinfo->name[0])
+            continue;
+        snapPutString(pbuf, pinfo->name);
+        snapPutString(pbuf, pinfo->string);
+    }
+    snapPutString(pbuf, "");
+    return 0;
+}
+
+long dbWriteSnapshot(DBBASE *pdbbase, const char *filename)
+{
+    dbSnapshotHeader header;
+    snapBuffer body = {NULL, 0, 0};
+    dbRecordType *prt;
+    epicsUInt16 type = 0;
+    long status = 0;
+    FILE *fp;
+
+    if (!pdbbase || !filename)
+        return -1;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DB_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = DB_SNAPSHOT_VERSION;
+    header.byteOrder = DB_SNAPSHOT_ORDER;
+    header.dbdHash = dbdHash(pdbbase);
+
+    for (prt = (dbRecordType *) ellFirst(&pdbbase->recordTypeList);
+         prt && !status;
+         prt = (dbRecordType *) ellNext(&prt->node), type++) {
+        dbRecordNode proto;
+        dbRecordNode *pnode;
+
+        if (!ellCount(&prt->recList))
+            continue;
+        if (!snapPrototype(pdbbase, prt, &proto)) {
+            status = -1;
+            break;
+        }
+        for (pnode = (dbRecordNode *) ellFirst(&prt->recList);
+             pnode && !status;
+             pnode = (dbRecordNode *) ellNext(&pnode->node)) {
+            if (pnode->flags & DBRN_FLAGS_ISALIAS)
+                continue;
+            status = snapPutRecord(&body, prt, type, pnode,
+                (const char *) proto.precord);
+            header.records++;
+        }
+        snapFreePrototype(pdbbase, prt, &proto);
+    }
+    type = 0;
+    for (prt = (dbRecordType *) ellFirst(&pdbbase->recordTypeList);
+         prt && !status;
+         prt = (dbRecordType *) ellNext(&prt->node), type++) {
+        dbRecordNode *pnode;
+
+        for (pnode = (dbRecordNode *) ellFirst(&prt->recList); pnode;
+             pnode = (dbRecordNode *) ellNext(&pnode->node)) {
+            if (!(pnode->flags & DBRN_FLAGS_ISALIAS))
+                continue;
+            snapPutHead(&body, 'A', 0, type, pnode->recordname);
+            snapPutString(&body, pnode->aliasedRecnode->recordname);
+            header.aliases++;
+        }
+    }
+    if (status) {
+        free(body.data);
+        return status;
+    }
+    snapPut(&body, "", 1);
+    header.bodySize = body.len;
+    header.bodyHash = epicsMemHash(body.data, body.len, 0);
+
+    fp = fopen(filename, "wb");
+    if (!fp) {
+        errlogPrintf("dbWriteSnapshot: Can't create \"%s\"\n", filename);
+        free(body.data);
+        return -1;
+    }
+    if (fwrite(&header, sizeof(header), 1, fp) != 1 ||
+        fwrite(body.data, body.len, 1, fp) != 1) {
+        errlogPrintf("dbWriteSnapshot: Error writing \"%s\"\n", filename);
+        status = -1;
+    }
+    if (fclose(fp)) {
+        errlogPrintf("dbWriteSnapshot: Error closing \"%s\"\n", filename);
+        status = -1;
+    }
+    free(body.data);
+    return status;
+}
+
+typedef struct snapReader {
+    const char *pos;
+    const char *end;
+} snapReader;
+
+static const char * snapGetString(snapReader *prd)
+{
+    const char *str = prd->pos;
+    const char *nil = memchr(str, 0, prd->end - str);
+
+    if (!nil)
+        return NULL;
+    prd->pos = nil + 1;
+    return str;
+}
+
+static int snapGet(snapReader *prd, void *pdata, size_t len)
+{
+    if ((size_t)(prd->end - prd->pos) < len)
+        return -1;
+    memcpy(pdata, prd->pos, len);
+    prd->pos += len;
+    return 0;
+}
+
+static long snapGetFields(snapReader *prd, dbRecordType *prt,
+    DBENTRY *pdbentry)
+{
+    char *precord = (char *) pdbentry->precnode->precord;
+
+    while (TRUE) {
+        epicsUInt16 i;
+        dbFldDes *pflddes;
+        char *pfield;
+
+        if (snapGet(prd, &i, sizeof(i)) || i >= prt->no_fields)
+            return -1;
+        if (!i)
+            return 0;
+        pflddes = prt->papFldDes[i];
+        if (!pflddes)
+            return -1;
+        pfield = precord + pflddes->offset;
+        if (isLink(pflddes)) {
+            DBLINK *plink = (DBLINK *) pfield;
+            const char *text = snapGetString(prd);
+
+            if (!text)
+                return -1;
+            free(plink->text);
+            plink->text = epicsStrDup(text);
+        }
+        else if (pflddes->field_type == DBF_STRING) {
+            const char *str = snapGetString(prd);
+
+            if (!str || strlen(str) >= (size_t) pflddes->size)
+                return -1;
+            strcpy(pfield, str);
+        }
+        else if (pflddes->field_type == DBF_NOACCESS ||
+                 snapGet(prd, pfield, pflddes->size))
+            return -1;
+    }
+}
+
+static long snapGetInfo(snapReader *prd, DBENTRY *pdbentry)
+{
+    while (TRUE) {
+        const char *name = snapGetString(prd);
+        const char *value;
+
+        if (!name)
+            return -1;
+        if (!*name)
+            return 0;
+        value = snapGetString(prd);
+        if (!value || dbPutInfo(pdbentry, name, value))
+            return -1;
+    }
+}
+
+static long snapGetEntry(snapReader *prd, dbRecordType **ptypes,
+    epicsUInt16 ntypes, DBENTRY *pdbentry)
+{
+    char tag, flags;
+    epicsUInt16 type;
+    const char *name;
+    long status;
+
+    if (snapGet(prd, &tag, 1))
+        return -1;
+    if (!tag)
+        return 1;
+    if (snapGet(prd, &flags, 1) || snapGet(prd, &type, sizeof(type)) ||
+        type >= ntypes || !(name = snapGetString(prd)))
+        return -1;
+
+    if (tag == 'A') {
+        const char *target = snapGetString(prd);
+
+        if (!target || dbFindRecord(pdbentry, target))
+            return -1;
+        if (dbCreateAlias(pdbentry, name)) {
+            errlogPrintf("dbReadSnapshot: Can't create alias \"%s\"\n", name);
+            return -1;
+        }
+        return 0;
+    }
+    if (tag != 'R')
+        return -1;
+
+    pdbentry->precordType = ptypes[type];
+    status = dbCreateRecord(pdbentry, name);
+    if (status == S_dbLib_recExists) {
+        /* Like dbLoadRecords, an existing record of the same type */
+        if (dbFindRecord(pdbentry, name) ||
+            pdbentry->precordType != ptypes[type]) {
+            errlogPrintf("dbReadSnapshot: Record \"%s\" exists with a "
+                "different type\n", name);
+            return -1;
+        }
+    }
+    else if (status) {
+        errlogPrintf("dbReadSnapshot: Can't create record \"%s\"\n", name);
+        return -1;
+    }
+    if (flags & DBRN_FLAGS_VISIBLE)
+        dbVisibleRecord(pdbentry);
+    if (snapGetFields(prd, ptypes[type], pdbentry) ||
+        snapGetInfo(prd, pdbentry))
+        return -1;
+    return 0;
+}
+
+long dbReadSnapshot(DBBASE *pdbbase, const char *filename)
+{
+    dbSnapshotHeader header;
+    dbRecordType **ptypes = NULL;
+    dbRecordType *prt;
+    epicsUInt16 ntypes = 0;
+    snapReader reader;
+    char *body = NULL;
+    DBENTRY dbentry;
+    long status = -1;
+    FILE *fp;
+
+    if (!pdbbase || !filename)
+        return -1;
+    fp = fopen(filename, "rb");
+    if (!fp) {
+        errlogPrintf("dbReadSnapshot: Can't open \"%s\"\n", filename);
+        return -1;
+    }
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, DB_SNAPSHOT_MAGIC, sizeof(header.magic))) {
+        errlogPrintf("dbReadSnapshot: \"%s\" is not a database snapshot\n",
+            filename);
+        goto done;
+    }
+    if (header.version != DB_SNAPSHOT_VERSION ||
+        header.byteOrder != DB_SNAPSHOT_ORDER) {
+        errlogPrintf("dbReadSnapshot: \"%s\" was written by an incompatible "
+            "IOC\n", filename);
+        goto done;
+    }
+    if (header.dbdHash != dbdHash(pdbbase)) {
+        errlogPrintf("dbReadSnapshot: \"%s\" was written with a different "
+            "DBD\n", filename);
+        goto done;
+    }
+    body = malloc(header.bodySize);
+    if (!body || fread(body, 1, header.bodySize, fp) != header.bodySize ||
+        epicsMemHash(body, header.bodySize, 0) != header.bodyHash) {
+        errlogPrintf("dbReadSnapshot: \"%s\" is corrupt\n", filename);
+        goto done;
+    }
+
+    ptypes = dbCalloc(ellCount(&pdbbase->recordTypeList) + 1,
+        sizeof(dbRecordType *));
+    for (prt = (dbRecordType *) ellFirst(&pdbbase->recordTypeList); prt;
+         prt = (dbRecordType *) ellNext(&prt->node))
+        ptypes[ntypes++] = prt;
+
+    reader.pos = body;
+    reader.end = body + header.bodySize;
+    dbInitEntry(pdbbase, &dbentry);
+    while (!(status = snapGetEntry(&reader, ptypes, ntypes, &dbentry)))
+        ;
+    dbFinishEntry(&dbentry);
+    if (status < 0)
+        errlogPrintf("dbReadSnapshot: Error loading \"%s\"\n", filename);
+    else
+        status = 0;
+
+done:
+    fclose(fp);
+    free(body);
+    free(ptypes);
+    return status;
+}
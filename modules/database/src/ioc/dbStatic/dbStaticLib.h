@@ -60,6 +60,29 @@ epicsShareFunc long dbReadDatabase(DBBASE **ppdbbase,
     const char *filename, const char *path, const char *substitutions);
 epicsShareFunc long dbReadDatabaseFP(DBBASE **ppdbbase,
     FILE *fp, const char *path, const char *substitutions);
+
+/* Read a list of files like a series of dbReadDatabase() calls, with
+ * nThreads worker threads (0 for one per CPU) reading and expanding the
+ * files ahead of the parser.  dbReadListAdd() finds the file straight
+ * away, so it is the working directory and environment at that time which
+ * apply.  done is called for each file loaded.
+ */
+typedef struct dbReadList dbReadList;
+typedef void (*DB_READ_LIST_DONE)(const char *filename,
+    const char *substitutions);
+epicsShareFunc dbReadList * dbReadListCreate(void);
+epicsShareFunc void dbReadListAdd(DBBASE **ppdbbase, dbReadList *plist,
+    const char *filename, const char *path, const char *substitutions);
+epicsShareFunc int dbReadListCount(const dbReadList *plist);
+epicsShareFunc long dbReadListRead(DBBASE **ppdbbase, dbReadList *plist,
+    int nThreads, DB_READ_LIST_DONE done);
+epicsShareFunc void dbReadListReport(const dbReadList *plist);
+epicsShareFunc void dbReadListFree(dbReadList *plist);
+
+/* Binary images of the records in a database, see dbSnapshot.c */
+epicsShareFunc long dbWriteSnapshot(DBBASE *pdbbase, const char *filename);
+epicsShareFunc long dbReadSnapshot(DBBASE *pdbbase, const char *filename);
+
 epicsShareFunc long dbPath(DBBASE *pdbbase, const char *path);
 epicsShareFunc long dbAddPath(DBBASE *pdbbase, const char *path);
 epicsShareFunc char * dbGetPromptGroupNameFromKey(DBBASE *pdbbase,
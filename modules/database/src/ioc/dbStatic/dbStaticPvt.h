@@ -96,14 +96,16 @@ typedef struct{
 	ELLNODE		node;
 	dbRecordType	*precordType;
 	dbRecordNode	*precnode;
+	const char	*name;	/* copy of the record name, for lookups */
 }PVDENTRY;
 epicsShareFunc int dbPvdTableSize(int size);
 extern int dbStaticDebug;
-void	dbPvdInitPvt(DBBASE *pdbbase);
-PVDENTRY *dbPvdFind(DBBASE *pdbbase,const char *name,size_t lenname);
-PVDENTRY *dbPvdAdd(DBBASE *pdbbase,dbRecordType *precordType,dbRecordNode *precnode);
-void dbPvdDelete(DBBASE *pdbbase,dbRecordNode *precnode);
-void dbPvdFreeMem(DBBASE *pdbbase);
+/* These are exported for dbPvdBench */
+epicsShareFunc void dbPvdInitPvt(DBBASE *pdbbase);
+epicsShareFunc PVDENTRY *dbPvdFind(DBBASE *pdbbase,const char *name,size_t lenname);
+epicsShareFunc PVDENTRY *dbPvdAdd(DBBASE *pdbbase,dbRecordType *precordType,dbRecordNode *precnode);
+epicsShareFunc void dbPvdDelete(DBBASE *pdbbase,dbRecordNode *precnode);
+epicsShareFunc void dbPvdFreeMem(DBBASE *pdbbase);
 
 #ifdef __cplusplus
 }
@@ -31,7 +31,9 @@
 #include "epicsSignal.h"
 #include "epicsThread.h"
 #include "errMdef.h"
+#include "gpHash.h"
 #include "iocsh.h"
+#include "registry.h"
 #include "taskwd.h"
 
 #include "caeventmask.h"
@@ -121,6 +123,7 @@ static int iocBuild_1(void)
     }
 
     errlogPrintf("Starting iocInit\n");
+    dbLoadRecordsEnd();     /* in case dbLoadRecordsBegin was left open */
     if (checkDatabase(pdbbase)) {
         errlogPrintf("iocBuild: Aborting, bad database definition (DBD)!\n");
         return -1;
@@ -185,6 +188,10 @@ static int iocBuild_3(void)
 {
     initHookAnnounce(initHookAfterCaServerInit);
 
+    /* Names are rarely added after this, let lookups run lock-free */
+    gphFreeze(pdbbase->pgpHash);
+    registryFreeze();
+
     iocState = iocBuilt;
     initHookAnnounce(initHookAfterIocBuilt);
     return 0;
@@ -479,6 +479,80 @@ static void no_read_access_event ( struct client *pClient,
     }
 }
 
+struct shared_reply {
+    struct dbChannel    *dbch;
+    db_field_log        *pfl;
+    int                 dataType;
+    long                count;
+};
+
+/*
+ * shared_reply_fill ()
+ *
+ * Convert a snapshot to the network format of one DBR type, once
+ * for all of the clients which asked for it
+ */
+static int shared_reply_fill ( void *pbuf, size_t size, void *arg )
+{
+    struct shared_reply *pArg = arg;
+    long item_count = pArg->count;
+    int status;
+
+    memset ( pbuf, 0, size );
+    status = dbChannel_get_count ( pArg->dbch, pArg->dataType,
+                  pbuf, &item_count, pArg->pfl );
+    if ( status < 0 || item_count != pArg->count ) {
+        return -1;
+    }
+    if ( caNetConvert ( pArg->dataType, pbuf, pbuf,
+            TRUE /* host -> net format */, item_count ) != ECA_NORMAL ) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * shared_reply ()
+ *
+ * Queue a subscription update from a shared array snapshot by
+ * reference, returns FALSE if the caller must copy it instead.
+ * The send lock must be held.
+ */
+static int shared_reply ( struct event_ext *pevext, struct dbChannel *dbch,
+                          db_field_log *pfl )
+{
+    struct client *pClient = pevext->pciu->client;
+    dbEventSnapshot *pSnap = db_field_log_snapshot ( pfl );
+    struct shared_reply arg;
+    const void *pPayload;
+    ca_uint32_t payload_size;
+
+    if ( ! pSnap || pevext->msg.m_count > (ca_uint32_t) pfl->no_elements ) {
+        return FALSE;
+    }
+
+    arg.dbch = dbch;
+    arg.pfl = pfl;
+    arg.dataType = pevext->msg.m_dataType;
+    arg.count = pevext->msg.m_count ? pevext->msg.m_count : pfl->no_elements;
+    payload_size = CA_MESSAGE_ALIGN ( dbr_size_n ( arg.dataType, arg.count ) );
+
+    /* the same threshold as for taking the snapshot */
+    if ( payload_size < (ca_uint32_t) dbEventSnapshotBytes ||
+            ! cas_send_ref_ok ( pClient, payload_size, arg.count ) ) {
+        return FALSE;
+    }
+
+    pPayload = db_snapshot_derived ( pSnap, arg.dataType, arg.count,
+        payload_size, shared_reply_fill, &arg );
+    if ( ! pPayload ) {
+        return FALSE;
+    }
+    return cas_copy_in_header_ref ( pClient, pevext->msg.m_cmmd,
+        payload_size, arg.dataType, arg.count, ECA_NORMAL,
+        pevext->msg.m_available, pPayload, pSnap ) == ECA_NORMAL;
+}
+
 /*
  *  read_reply()
  */
@@ -500,6 +574,14 @@ static void read_reply ( void *pArg, struct dbChannel *dbch,
 
     SEND_LOCK ( pClient );
 
+    /* large array updates are shared rather than copied per client */
+    if ( readAccess && shared_reply ( pevext, dbch, pfl ) ) {
+        if ( ! eventsRemaining )
+            cas_send_bs_msg ( pClient, FALSE );
+        SEND_UNLOCK ( pClient );
+        return;
+    }
+
     cid = ECA_NORMAL;
 
     /* If the client has requested a zero element count we interpret this as a
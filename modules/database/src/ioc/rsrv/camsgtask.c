@@ -20,7 +20,13 @@
 #include <string.h>
 #include <errno.h>
 
+#if defined(__linux__)
+#   include <sys/epoll.h>
+#   define CAS_IO_POOL
+#endif
+
 #include "dbDefs.h"
+#include "epicsSignal.h"
 #include "epicsStdio.h"
 #include "epicsTime.h"
 #include "errlog.h"
@@ -34,6 +40,105 @@
 #include "rsrv.h"
 #include "server.h"
 
+/*
+ *  camsgReceive()
+ *
+ *  Receive and process whatever the client has sent, returns
+ *  RSRV_ERROR when the circuit should be disconnected
+ */
+static int camsgReceive ( struct client *client, int flags )
+{
+    long nchars;
+    int status;
+
+    client->recv.stk = 0;
+    assert ( client->recv.maxstk >= client->recv.cnt );
+    nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt], 
+            (int) ( client->recv.maxstk - client->recv.cnt ), flags );
+    if ( nchars == 0 ){
+        if ( CASDEBUG > 0 ) {
+            /* convert to u long so that %lu works on both 32 and 64 bit archs */
+            unsigned long cnt = sizeof ( client->recv.buf ) - client->recv.cnt;
+            errlogPrintf ( "CAS: nill message disconnect ( %lu bytes request )\n",
+                cnt );
+        }
+        return RSRV_ERROR;
+    }
+    else if ( nchars < 0 ) {
+        int anerrno = SOCKERRNO;
+
+        if ( anerrno == SOCK_EINTR || anerrno == SOCK_EWOULDBLOCK ) {
+            return RSRV_OK;
+        }
+
+        if ( anerrno == SOCK_ENOBUFS ) {
+            errlogPrintf (
+                "CAS: Out of network buffers, retring receive in 15 seconds\n" );
+            epicsThreadSleep ( 15.0 );
+            return RSRV_OK;
+        }
+
+        /*
+         * normal conn lost conditions
+         */
+        if (    ( anerrno != SOCK_ECONNABORTED &&
+            anerrno != SOCK_ECONNRESET &&
+            anerrno != SOCK_ETIMEDOUT ) ||
+            CASDEBUG > 2 ) {
+            char sockErrBuf[64];
+
+            epicsSocketConvertErrorToString(
+                sockErrBuf, sizeof ( sockErrBuf ), anerrno);
+            errlogPrintf ( "CAS: Client disconnected - %s\n",
+                sockErrBuf );
+        }
+        return RSRV_ERROR;
+    }
+
+    epicsTimeGetCurrent ( &client->time_at_last_recv );
+    client->recv.cnt += ( unsigned ) nchars;
+
+    status = camessage ( client );
+    if (status == 0) {
+        /*
+         * if there is a partial message
+         * align it with the start of the buffer
+         */
+        if (client->recv.cnt > client->recv.stk) {
+            unsigned bytes_left;
+
+            bytes_left = client->recv.cnt - client->recv.stk;
+
+            /*
+             * overlapping regions handled
+             * properly by memmove 
+             */
+            memmove (client->recv.buf, 
+                &client->recv.buf[client->recv.stk], bytes_left);
+            client->recv.cnt = bytes_left;
+        }
+        else {
+            client->recv.cnt = 0ul;
+        }
+    }
+    else {
+        char buf[64];
+
+        /* flush any queued messages before shutdown */
+        cas_send_bs_msg(client, 1);
+        
+        client->recv.cnt = 0ul;
+        
+        /*
+         * disconnect when there are severe message errors
+         */
+        ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
+        epicsPrintf ("CAS: forcing disconnect from %s\n", buf);
+        return RSRV_ERROR;
+    }
+    return RSRV_OK;
+}
+
 /*
  *  camsgtask()
  *
@@ -47,7 +152,6 @@ void camsgtask ( void *pParm )
 
     while (castcp_ctl == ctlRun && !client->disconnect) {
         osiSockIoctl_t check_nchars;
-        long nchars;
         int status;
 
         /*
@@ -67,93 +171,91 @@ void camsgtask ( void *pParm )
             cas_send_bs_msg(client, TRUE);
         }
 
-        client->recv.stk = 0;
-        assert ( client->recv.maxstk >= client->recv.cnt );
-        nchars = recv ( client->sock, &client->recv.buf[client->recv.cnt], 
-                (int) ( client->recv.maxstk - client->recv.cnt ), 0 );
-        if ( nchars == 0 ){
-            if ( CASDEBUG > 0 ) {
-                /* convert to u long so that %lu works on both 32 and 64 bit archs */
-                unsigned long cnt = sizeof ( client->recv.buf ) - client->recv.cnt;
-                errlogPrintf ( "CAS: nill message disconnect ( %lu bytes request )\n",
-                    cnt );
-            }
+        if ( camsgReceive ( client, 0 ) != RSRV_OK ) {
             break;
         }
-        else if ( nchars < 0 ) {
-            int anerrno = SOCKERRNO;
+    }
 
-            if ( anerrno == SOCK_EINTR ) {
-                continue;
-            }
+    LOCK_CLIENTQ;
+    ellDelete ( &clientQ, &client->node );
+    UNLOCK_CLIENTQ;
 
-            if ( anerrno == SOCK_ENOBUFS ) {
-                errlogPrintf (
-                    "CAS: Out of network buffers, retring receive in 15 seconds\n" );
-                epicsThreadSleep ( 15.0 );
-                continue;
-            }
+    destroy_tcp_client ( client );
+}
 
-            /*
-             * normal conn lost conditions
-             */
-            if (    ( anerrno != SOCK_ECONNABORTED &&
-                anerrno != SOCK_ECONNRESET &&
-                anerrno != SOCK_ETIMEDOUT ) ||
-                CASDEBUG > 2 ) {
-                char sockErrBuf[64];
-
-                epicsSocketConvertErrorToString(
-                    sockErrBuf, sizeof ( sockErrBuf ), anerrno);
-                errlogPrintf ( "CAS: Client disconnected - %s\n",
-                    sockErrBuf );
-            }
+#ifdef CAS_IO_POOL
+
+/*
+ * The optional I/O pool replaces the thread per client with a few
+ * threads waiting on one epoll set.  Each client socket is armed one
+ * shot, so only one pool thread at a time ever reads from a client.
+ * These clients' event users share the database event pool.  A send
+ * to a client which stops reading blocks the pool thread sending it,
+ * unless rsrvIoSendTimeout is set, in which case a client accepting
+ * nothing for that long is disconnected instead.
+ * A pool thread waiting for a put callback is still unavailable to
+ * the others until it returns.
+ */
+
+/* receive passes on one client before giving the others a turn */
+#define CAS_IO_POOL_BURST 16
+
+static int casIoPoolFd = -1;
+static unsigned casIoPoolThreads;
+
+static void casIoPoolService ( struct client *client )
+{
+    unsigned n;
+
+    epicsThreadPrivateSet ( rsrvCurrentClient, client );
+
+    for ( n = 0u; n < CAS_IO_POOL_BURST; n++ ) {
+        osiSockIoctl_t check_nchars = 0;
+
+        if ( castcp_ctl != ctlRun || client->disconnect ||
+                camsgReceive ( client, MSG_DONTWAIT ) != RSRV_OK ) {
             break;
         }
 
-        epicsTimeGetCurrent ( &client->time_at_last_recv );
-        client->recv.cnt += ( unsigned ) nchars;
+        /*
+         * allow message to batch up if more are comming
+         */
+        if ( socket_ioctl ( client->sock, FIONREAD, &check_nchars ) < 0 ||
+                check_nchars <= 0 ) {
+            struct epoll_event ev;
+
+            cas_send_bs_msg ( client, TRUE );
 
-        status = camessage ( client );
-        if (status == 0) {
-            /*
-             * if there is a partial message
-             * align it with the start of the buffer
-             */
-            if (client->recv.cnt > client->recv.stk) {
-                unsigned bytes_left;
-
-                bytes_left = client->recv.cnt - client->recv.stk;
-
-                /*
-                 * overlapping regions handled
-                 * properly by memmove 
-                 */
-                memmove (client->recv.buf, 
-                    &client->recv.buf[client->recv.stk], bytes_left);
-                client->recv.cnt = bytes_left;
-            }
-            else {
-                client->recv.cnt = 0ul;
+            ev.events = EPOLLIN | EPOLLONESHOT;
+            ev.data.ptr = client;
+            if ( epoll_ctl ( casIoPoolFd, EPOLL_CTL_MOD,
+                    client->sock, &ev ) == 0 ) {
+                epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+                return;
             }
+            break;
         }
-        else {
-            char buf[64];
+    }
 
-            /* flush any queued messages before shutdown */
-            cas_send_bs_msg(client, 1);
-            
-            client->recv.cnt = 0ul;
-            
-            /*
-             * disconnect when there are severe message errors
-             */
-            ipAddrToDottedIP (&client->addr, buf, sizeof(buf));
-            epicsPrintf ("CAS: forcing disconnect from %s\n", buf);
-                break;
+    if ( n == CAS_IO_POOL_BURST ) {
+        struct epoll_event ev;
+
+        /* still busy, flush and requeue behind the other clients */
+        cas_send_bs_msg ( client, TRUE );
+        ev.events = EPOLLIN | EPOLLONESHOT;
+        ev.data.ptr = client;
+        if ( epoll_ctl ( casIoPoolFd, EPOLL_CTL_MOD,
+                client->sock, &ev ) == 0 ) {
+            epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+            return;
         }
     }
 
+    if ( client->sock != INVALID_SOCKET ) {
+        epoll_ctl ( casIoPoolFd, EPOLL_CTL_DEL, client->sock, NULL );
+    }
+    epicsThreadPrivateSet ( rsrvCurrentClient, NULL );
+
     LOCK_CLIENTQ;
     ellDelete ( &clientQ, &client->node );
     UNLOCK_CLIENTQ;
@@ -161,6 +263,121 @@ void camsgtask ( void *pParm )
     destroy_tcp_client ( client );
 }
 
+static void casIoPoolTask ( void *pParm )
+{
+    epicsSignalInstallSigAlarmIgnore ();
+    epicsSignalInstallSigPipeIgnore ();
+    taskwdInsert ( epicsThreadGetIdSelf (), NULL, NULL );
+
+    while ( TRUE ) {
+        struct epoll_event ev;
+        int n = epoll_wait ( casIoPoolFd, &ev, 1, -1 );
+
+        if ( n == 1 ) {
+            casIoPoolService ( ( struct client * ) ev.data.ptr );
+        }
+        else if ( n < 0 && errno != EINTR ) {
+            char sockErrBuf[64];
+
+            epicsSocketConvertErrnoToString (
+                sockErrBuf, sizeof ( sockErrBuf ) );
+            errlogPrintf ( "CAS: I/O pool wait error: %s\n", sockErrBuf );
+            epicsThreadSleep ( 1.0 );
+        }
+    }
+}
+
+/*
+ *  casIoPoolStart()
+ *
+ *  Start nThreads threads serving all TCP clients, returns
+ *  the number started
+ */
+unsigned casIoPoolStart ( unsigned nThreads )
+{
+    unsigned i;
+
+    casIoPoolFd = epoll_create1 ( EPOLL_CLOEXEC );
+    if ( casIoPoolFd < 0 ) {
+        errlogPrintf ( "CAS: I/O pool unavailable, using a thread per client\n" );
+        return 0u;
+    }
+    for ( i = 0u; i < nThreads; i++ ) {
+        epicsThreadId id = epicsThreadCreate ( "CAS-io",
+            epicsThreadPriorityCAServerLow,
+            epicsThreadGetStackSize ( epicsThreadStackBig ),
+            casIoPoolTask, NULL );
+        if ( ! id ) {
+            break;
+        }
+    }
+    casIoPoolThreads = i;
+    return i;
+}
+
+/*
+ *  casIoPoolAdd()
+ *
+ *  Hand a new TCP client to the I/O pool, returns RSRV_ERROR if
+ *  the caller must give the client its own thread
+ */
+int casIoPoolAdd ( struct client *client )
+{
+    struct epoll_event ev;
+    struct timeval tmo;
+
+    if ( casIoPoolThreads == 0u ) {
+        return RSRV_ERROR;
+    }
+
+    if ( rsrvIoSendTimeout > 0.0 ) {
+        tmo.tv_sec = ( time_t ) rsrvIoSendTimeout;
+        tmo.tv_usec = ( long ) ( ( rsrvIoSendTimeout - tmo.tv_sec ) * 1e6 );
+        if ( tmo.tv_sec == 0 && tmo.tv_usec == 0 ) {
+            tmo.tv_usec = 1;
+        }
+        if ( setsockopt ( client->sock, SOL_SOCKET, SO_SNDTIMEO,
+                ( char * ) &tmo, sizeof ( tmo ) ) < 0 ) {
+            return RSRV_ERROR;
+        }
+    }
+
+    /* the version reply queued by create_tcp_client() */
+    cas_send_bs_msg ( client, TRUE );
+
+    ev.events = EPOLLIN | EPOLLONESHOT;
+    ev.data.ptr = client;
+    if ( epoll_ctl ( casIoPoolFd, EPOLL_CTL_ADD, client->sock, &ev ) != 0 ) {
+        return RSRV_ERROR;
+    }
+    return RSRV_OK;
+}
+
+unsigned casIoPoolCount ( void )
+{
+    return casIoPoolThreads;
+}
+
+#else /* CAS_IO_POOL */
+
+unsigned casIoPoolStart ( unsigned nThreads )
+{
+    errlogPrintf ( "CAS: I/O pool not supported here, using a thread per client\n" );
+    return 0u;
+}
+
+int casIoPoolAdd ( struct client *client )
+{
+    return RSRV_ERROR;
+}
+
+unsigned casIoPoolCount ( void )
+{
+    return 0u;
+}
+
+#endif /* CAS_IO_POOL */
+
 
 int casClientInitiatingCurrentThread ( char * pBuf, size_t bufSize )
 {
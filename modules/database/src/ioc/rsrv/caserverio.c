@@ -27,12 +27,104 @@
 #include "errlog.h"
 #include "osiSock.h"
 
+#if !defined(_WIN32)
+#   include <sys/uio.h>
+#   define CAS_SEND_REFS
+#endif
+
 #include "caerr.h"
 #include "net_convert.h"
 
 #define epicsExportSharedSymbols
+#include "dbEvent.h"
 #include "server.h"
 
+/*
+ *  cas_release_send_refs()
+ *
+ *  Drop the payloads queued by reference, send lock must be held
+ */
+void cas_release_send_refs ( struct client *pclient )
+{
+    unsigned i;
+
+    for ( i = 0u; i < pclient->nSendRefs; i++ ) {
+        db_snapshot_decr ( pclient->sendRefs[i].pSnap );
+    }
+    pclient->nSendRefs = 0u;
+}
+
+#ifdef CAS_SEND_REFS
+/*
+ *  cas_send_gather()
+ *
+ *  Send the send buffer interleaved with the payloads queued by
+ *  reference.  Returns 0 when all is sent, or -1 with the socket
+ *  error unchanged.
+ */
+static int cas_send_gather ( struct client *pclient )
+{
+    struct iovec iov[2u * RSRV_SEND_REFS + 1u];
+    struct iovec *piov = iov;
+    unsigned niov = 0u;
+    unsigned offset = 0u;
+    unsigned i;
+
+    for ( i = 0u; i < pclient->nSendRefs; i++ ) {
+        struct send_ref *pref = &pclient->sendRefs[i];
+        if ( pref->offset > offset ) {
+            iov[niov].iov_base = &pclient->send.buf[offset];
+            iov[niov].iov_len = pref->offset - offset;
+            niov++;
+        }
+        iov[niov].iov_base = ( void * ) pref->pPayload;
+        iov[niov].iov_len = pref->size;
+        niov++;
+        offset = pref->offset;
+    }
+    if ( pclient->send.stk > offset ) {
+        iov[niov].iov_base = &pclient->send.buf[offset];
+        iov[niov].iov_len = pclient->send.stk - offset;
+        niov++;
+    }
+
+    while ( niov ) {
+        ssize_t status = writev ( pclient->sock, piov, (int) niov );
+        size_t sent;
+
+        if ( status < 0 ) {
+            int anerrno = SOCKERRNO;
+            if ( pclient->disconnect ) {
+                return -1;
+            }
+            if ( anerrno == SOCK_EINTR ) {
+                continue;
+            }
+            if ( anerrno == SOCK_ENOBUFS ) {
+                errlogPrintf (
+                    "CAS: Out of network buffers, retrying send in 15 seconds\n" );
+                epicsThreadSleep ( 15.0 );
+                continue;
+            }
+            return -1;
+        }
+
+        /* step over what was sent and resume part way into an iovec */
+        sent = ( size_t ) status;
+        while ( niov && sent >= piov->iov_len ) {
+            sent -= piov->iov_len;
+            piov++;
+            niov--;
+        }
+        if ( niov ) {
+            piov->iov_base = ( char * ) piov->iov_base + sent;
+            piov->iov_len -= sent;
+        }
+    }
+    return 0;
+}
+#endif /* CAS_SEND_REFS */
+
 /*
  *  cas_send_bs_msg()
  *
@@ -59,12 +151,25 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                 (int)pclient->sock, (unsigned) pclient->addr.sin_addr.s_addr );
         }
         pclient->send.stk = 0u;
+        cas_release_send_refs ( pclient );
         if(lock_needed)
             SEND_UNLOCK(pclient);
         return;
     }
 
     while ( pclient->send.stk && ! pclient->disconnect ) {
+#ifdef CAS_SEND_REFS
+        if ( pclient->nSendRefs ) {
+            status = cas_send_gather ( pclient );
+            if ( status == 0 ) {
+                pclient->send.stk = 0;
+                cas_release_send_refs ( pclient );
+                epicsTimeGetCurrent ( &pclient->time_at_last_send );
+                break;
+            }
+        }
+        else
+#endif
         status = send ( pclient->sock, pclient->send.buf, pclient->send.stk, 0 );
         if ( status >= 0 ) {
             unsigned transferSize = (unsigned) status;
@@ -87,6 +192,7 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
 
             if ( pclient->disconnect ) {
                 pclient->send.stk = 0u;
+                cas_release_send_refs ( pclient );
                 break;
             }
 
@@ -110,6 +216,11 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
                 anerrno == SOCK_ETIMEDOUT ) {
                 causeWasSocketHangup = 1;
             }
+            else if ( anerrno == SOCK_EWOULDBLOCK ) {
+                /* rsrvIoSendTimeout expired, see casIoPoolAdd() */
+                errlogPrintf ( "CAS: TCP send to %s timed out, disconnecting\n",
+                    buf );
+            }
             else {
                 char sockErrBuf[64];
                 epicsSocketConvertErrnoToString ( 
@@ -119,6 +230,7 @@ void cas_send_bs_msg ( struct client *pclient, int lock_needed )
             }
             pclient->disconnect = TRUE;
             pclient->send.stk = 0u;
+            cas_release_send_refs ( pclient );
 
             /*
              * wakeup the receive thread
@@ -281,6 +393,7 @@ int cas_copy_in_header (
     if ( pclient->send.stk > pclient->send.maxstk - msgSize ) {
         if ( pclient->disconnect ) {
             pclient->send.stk = 0;
+            cas_release_send_refs ( pclient );
         }
         else{
             if ( pclient->proto == IPPROTO_TCP) {
@@ -326,6 +439,98 @@ int cas_copy_in_header (
     return ECA_NORMAL;
 }
 
+/*
+ *  cas_send_ref_ok()
+ *
+ *  TRUE if a message with this payload can be queued for the client
+ *  by cas_copy_in_header_ref()
+ */
+int cas_send_ref_ok ( struct client *pclient, ca_uint32_t payloadSize,
+    ca_uint32_t nElem )
+{
+#ifdef CAS_SEND_REFS
+    if ( pclient->proto != IPPROTO_TCP ||
+        payloadSize != CA_MESSAGE_ALIGN ( payloadSize ) ) {
+        return FALSE;
+    }
+    if ( ( payloadSize >= 0xffff || nElem >= 0xffff ) &&
+        ! CA_V49 ( pclient->minor_version_number ) ) {
+        return FALSE;
+    }
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+/*
+ *  cas_copy_in_header_ref()
+ *
+ *  Queue a message whose payload is sent from a shared snapshot
+ *  instead of being copied into the send buffer.  payloadSize must
+ *  already be aligned and include any padding.  A reference to the
+ *  snapshot is held until the message is sent.
+ *
+ *  send lock must be on while in this routine
+ */
+int cas_copy_in_header_ref (
+    struct client *pclient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, const void *pPayload,
+    dbEventSnapshot *pSnap )
+{
+#ifdef CAS_SEND_REFS
+    int large = payloadSize >= 0xffff || nElem >= 0xffff;
+    unsigned hdrSize = sizeof ( caHdr ) +
+        ( large ? 2 * sizeof ( ca_uint32_t ) : 0u );
+    caHdr *pMsg;
+
+    if ( ! cas_send_ref_ok ( pclient, payloadSize, nElem ) ) {
+        return ECA_INTERNAL;
+    }
+
+    if ( pclient->nSendRefs >= RSRV_SEND_REFS ||
+        pclient->send.stk > pclient->send.maxstk - hdrSize ) {
+        if ( pclient->disconnect ) {
+            pclient->send.stk = 0;
+            cas_release_send_refs ( pclient );
+        }
+        else {
+            cas_send_bs_msg ( pclient, FALSE );
+        }
+    }
+
+    pMsg = (caHdr *) &pclient->send.buf[pclient->send.stk];
+    pMsg->m_cmmd = htons ( response );
+    pMsg->m_dataType = htons ( dataType );
+    pMsg->m_cid = htonl ( cid );
+    pMsg->m_available = htonl ( responseSpecific );
+    if ( large ) {
+        ca_uint32_t *pW32 = (ca_uint32_t *) ( pMsg + 1 );
+        pMsg->m_postsize = htons ( 0xffff );
+        pMsg->m_count = htons ( 0u );
+        pW32[0] = htonl ( payloadSize );
+        pW32[1] = htonl ( nElem );
+    }
+    else {
+        pMsg->m_postsize = htons ( ( ca_uint16_t ) payloadSize );
+        pMsg->m_count = htons ( ( ca_uint16_t ) nElem );
+    }
+    pclient->send.stk += hdrSize;
+
+    db_snapshot_incr ( pSnap );
+    pclient->sendRefs[pclient->nSendRefs].offset = pclient->send.stk;
+    pclient->sendRefs[pclient->nSendRefs].size = payloadSize;
+    pclient->sendRefs[pclient->nSendRefs].pPayload = pPayload;
+    pclient->sendRefs[pclient->nSendRefs].pSnap = pSnap;
+    pclient->nSendRefs++;
+
+    return ECA_NORMAL;
+#else
+    return ECA_INTERNAL;
+#endif
+}
+
 void cas_set_header_cid ( struct client *pClient, ca_uint32_t cid )
 {
     caHdr *pMsg = ( caHdr * ) &pClient->send.buf[pClient->send.stk];
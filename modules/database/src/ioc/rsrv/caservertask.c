@@ -117,6 +117,10 @@ static void req_server (void *pParm)
             ellAdd ( &clientQ, &pClient->node );
             UNLOCK_CLIENTQ;
 
+            if ( casIoPoolAdd ( pClient ) == RSRV_OK ) {
+                continue;
+            }
+
             id = epicsThreadCreate ( "CAS-client", epicsThreadPriorityCAServerLow,
                     epicsThreadGetStackSize ( epicsThreadStackBig ),
                     camsgtask, pClient );
@@ -495,6 +499,10 @@ void rsrv_init (void)
 
     rsrvCurrentClient = epicsThreadPrivateCreate ();
 
+    if ( rsrvIoThreads > 0 ) {
+        casIoPoolStart ( (unsigned) rsrvIoThreads );
+    }
+
     if ( envGetConfigParamPtr ( &EPICS_CAS_SERVER_PORT ) ) {
         ca_server_port = envGetInetPortConfigParam ( &EPICS_CAS_SERVER_PORT,
             (unsigned short) CA_SERVER_PORT );
@@ -860,8 +868,14 @@ static void log_one_client (struct client *client, unsigned level)
         send_delay = epicsTimeDiffInSeconds(&current,&client->time_at_last_send);
         recv_delay = epicsTimeDiffInSeconds(&current,&client->time_at_last_recv);
 
-        printf ("\tTask Id = %p, Socket FD = %d\n",
-            (void *) client->tid, (int)client->sock);
+        if ( client->proto == IPPROTO_TCP && client->tid == 0 ) {
+            printf ("\tServed by the I/O pool, Socket FD = %d\n",
+                (int)client->sock);
+        }
+        else {
+            printf ("\tTask Id = %p, Socket FD = %d\n",
+                (void *) client->tid, (int)client->sock);
+        }
         printf(
         "\t%.2f secs since last send, %.2f secs since last receive\n",
             send_delay, recv_delay);
@@ -874,6 +888,13 @@ static void log_one_client (struct client *client, unsigned level)
             state[client->disconnect?1:0],
             client->send.type == mbtLargeTCP ? " jumbo-send-buf" : "",
             client->recv.type == mbtLargeTCP ? " jumbo-recv-buf" : "");
+        if ( client->evuser ) {
+            double wakeupRate, eventsPerWakeup;
+            db_event_stats ( client->evuser, &wakeupRate, &eventsPerWakeup );
+            printf(
+            "\tEvent task %.1f wakeups/sec, %.1f events/wakeup\n",
+                wakeupRate, eventsPerWakeup );
+        }
     }
 
     if ( level >= 1u ) {
@@ -917,6 +938,10 @@ void casr (unsigned level)
     printf ("Channel Access Server V%s\n",
         CA_VERSION_STRING ( CA_MINOR_PROTOCOL_REVISION ) );
 
+    if ( casIoPoolCount () ) {
+        printf ( "Clients served by %u I/O threads\n", casIoPoolCount () );
+    }
+
     LOCK_CLIENTQ
     n = ellCount ( &clientQ );
     if (n == 0) {
@@ -1070,6 +1095,7 @@ void destroy_client ( struct client *client )
     }
 
     if ( client->proto == IPPROTO_TCP ) {
+        cas_release_send_refs ( client );
         if ( client->send.buf ) {
             if ( client->send.type == mbtSmallTCP ) {
                 freeListFree ( rsrvSmallBufFreeListTCP,  client->send.buf );
@@ -1302,6 +1328,7 @@ struct client * create_client ( SOCKET sock, int proto )
     }
     client->send.stk = 0u;
     client->send.cnt = 0u;
+    client->nSendRefs = 0u;
     client->recv.stk = 0u;
     client->recv.cnt = 0u;
     client->evuser = NULL;
@@ -1513,8 +1540,13 @@ struct client *create_tcp_client (SOCKET sock , const osiSockAddr *peerAddr)
         }
     }
 
-    status = db_start_events ( client->evuser, "CAS-event",
-                NULL, NULL, priorityOfEvents );
+    if ( casIoPoolCount () ) {
+        status = db_start_events_pooled ( client->evuser, priorityOfEvents );
+    }
+    else {
+        status = db_start_events ( client->evuser, "CAS-event",
+                    NULL, NULL, priorityOfEvents );
+    }
     if ( status != DB_EVENT_OK ) {
         errlogPrintf ( "CAS: unable to start the event facility\n" );
         destroy_tcp_client ( client );
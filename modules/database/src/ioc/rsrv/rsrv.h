@@ -27,6 +27,11 @@
 extern "C" {
 #endif
 
+/* I/O threads serving all TCP clients, 0 for a thread per client */
+epicsShareExtern int rsrvIoThreads;
+/* Longest an I/O thread blocks sending to one client (sec), 0 for no limit */
+epicsShareExtern double rsrvIoSendTimeout;
+
 epicsShareFunc void rsrv_register_server(void);
 
 epicsShareFunc void casr (unsigned level);
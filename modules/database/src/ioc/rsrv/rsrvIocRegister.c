@@ -15,6 +15,8 @@
 #include "server.h"
 #include "epicsExport.h"
 
+epicsShareDef int rsrvIoThreads = 0;
+epicsShareDef double rsrvIoSendTimeout = 0.0;
 
 /* casr */
 static const iocshArg casrArg0 = { "level",iocshArgInt};
@@ -33,4 +35,6 @@ void rsrvRegistrar(void)
 }
 
 epicsExportAddress(int, CASDEBUG);
+epicsExportAddress(int, rsrvIoThreads);
+epicsExportAddress(double, rsrvIoSendTimeout);
 epicsExportRegistrar(rsrvRegistrar);
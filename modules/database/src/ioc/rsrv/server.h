@@ -71,12 +71,27 @@ struct message_buffer {
   enum messageBufferType    type;
 };
 
+/*
+ * A payload sent by reference from a shared snapshot, it follows
+ * the first offset bytes of the send buffer.
+ */
+#define RSRV_SEND_REFS 32
+struct send_ref {
+  unsigned                  offset;
+  ca_uint32_t               size;
+  const void                *pPayload;
+  struct dbEventSnapshot    *pSnap;
+};
+
 extern epicsThreadPrivateId rsrvCurrentClient;
 
 typedef struct client {
   ELLNODE               node;
   /*! guarded by SEND_LOCK()  aka. client::lock */
   struct message_buffer send;
+  /*! guarded by SEND_LOCK(), payloads interleaved with send */
+  struct send_ref       sendRefs[RSRV_SEND_REFS];
+  unsigned              nSendRefs;
   /*! accessed by receive thread w/o locks cf. camsgtask() */
   struct message_buffer recv;
   epicsMutexId          lock;
@@ -224,6 +239,9 @@ GLBLTYPE unsigned int       threadPrios[5];
 #define UNLOCK_CLIENTQ  epicsMutexUnlock (clientQlock);
 
 void camsgtask (void *client);
+unsigned casIoPoolStart ( unsigned nThreads );
+int casIoPoolAdd ( struct client *client );
+unsigned casIoPoolCount ( void );
 void cas_send_bs_msg ( struct client *pclient, int lock_needed );
 void cas_send_dg_msg ( struct client *pclient );
 void rsrv_online_notify_task (void *);
@@ -255,6 +273,14 @@ int cas_copy_in_header (
     struct client *pClient, ca_uint16_t response, ca_uint32_t payloadSize,
     ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
     ca_uint32_t responseSpecific, void **pPayload );
+int cas_send_ref_ok ( struct client *pClient, ca_uint32_t payloadSize,
+    ca_uint32_t nElem );
+int cas_copy_in_header_ref (
+    struct client *pClient, ca_uint16_t response, ca_uint32_t payloadSize,
+    ca_uint16_t dataType, ca_uint32_t nElem, ca_uint32_t cid,
+    ca_uint32_t responseSpecific, const void *pPayload,
+    struct dbEventSnapshot *pSnap );
+void cas_release_send_refs ( struct client *pClient );
 void cas_set_header_cid ( struct client *pClient, ca_uint32_t );
 void cas_set_header_count (struct client *pClient, ca_uint32_t count);
 void cas_commit_msg ( struct client *pClient, ca_uint32_t size );
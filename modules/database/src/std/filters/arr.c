@@ -14,6 +14,7 @@
 
 #include <freeList.h>
 #include <dbAccess.h>
+#include <dbEvent.h>
 #include <dbExtractArray.h>
 #include <db_field_log.h>
 #include <dbLock.h>
@@ -148,6 +149,9 @@ static db_field_log* filter(void* pvt, dbChannel *chan, db_field_log *pfl)
         pdst = NULL;
         nSource = pfl->no_elements;
         nTarget = wrapArrayIndices(&start, my->incr, &end, nSource);
+        /* A contiguous slice of a shared snapshot needs no copy */
+        if (my->incr == 1 && !db_field_log_view(pfl, start, nTarget))
+            break;
         pfl->no_elements = nTarget;
         if (nTarget) {
             /* Copy the data out */
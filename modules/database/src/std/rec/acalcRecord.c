@@ -0,0 +1,449 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Record Support Routines for Array Calculation records */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dbDefs.h"
+#include "errlog.h"
+#include "alarm.h"
+#include "cantProceed.h"
+#include "dbAccess.h"
+#include "dbEvent.h"
+#include "dbFldTypes.h"
+#include "epicsMath.h"
+#include "errMdef.h"
+#include "recSup.h"
+#include "recGbl.h"
+#include "special.h"
+
+#define GEN_SIZE_OFFSET
+#include "acalcRecord.h"
+#undef  GEN_SIZE_OFFSET
+#include "epicsExport.h"
+
+/* Create RSET - Record Support Entry Table */
+
+#define report NULL
+#define initialize NULL
+static long init_record(struct dbCommon *prec, int pass);
+static long process(struct dbCommon *prec);
+static long special(DBADDR *paddr, int after);
+#define get_value NULL
+static long cvt_dbaddr(DBADDR *paddr);
+static long get_array_info(DBADDR *paddr, long *no_elements, long *offset);
+static long put_array_info(DBADDR *paddr, long nNew);
+static long get_units(DBADDR *paddr, char *units);
+static long get_precision(const DBADDR *paddr, long *precision);
+#define get_enum_str NULL
+#define get_enum_strs NULL
+#define put_enum_str NULL
+static long get_graphic_double(DBADDR *paddr, struct dbr_grDouble *pgd);
+static long get_control_double(DBADDR *paddr, struct dbr_ctrlDouble *pcd);
+#define get_alarm_double NULL
+
+rset acalcRSET={
+    RSETNUMBER,
+    report,
+    initialize,
+    init_record,
+    process,
+    special,
+    get_value,
+    cvt_dbaddr,
+    get_array_info,
+    put_array_info,
+    get_units,
+    get_precision,
+    get_enum_str,
+    get_enum_strs,
+    put_enum_str,
+    get_graphic_double,
+    get_control_double,
+    get_alarm_double
+};
+epicsExportAddress(rset, acalcRSET);
+
+static long convert(acalcRecord *prec);
+static void reduce(acalcRecord *prec);
+static void monitor(acalcRecord *prec, epicsUInt32 nord);
+static long fetch_values(acalcRecord *prec);
+
+
+static long init_record(struct dbCommon *pcommon, int pass)
+{
+    struct acalcRecord *prec = (struct acalcRecord *)pcommon;
+    int i;
+
+    if (pass == 0) {
+        if (prec->nelm == 0)
+            prec->nelm = 1;
+        prec->val = callocMustSucceed(prec->nelm, sizeof(double),
+            "acalc: VAL");
+        for (i = 0; i < CALCPERFORM_NARGS; i++) {
+            epicsUInt32 *pno = &prec->noa + i;
+
+            if (*pno == 0)
+                *pno = 1;
+            (&prec->a)[i] = callocMustSucceed(*pno, sizeof(double),
+                "acalc: A-L");
+        }
+        return 0;
+    }
+
+    for (i = 0; i < CALCPERFORM_NARGS; i++) {
+        long n = (&prec->noa)[i];
+
+        dbLoadLinkArray(&prec->inpa + i, DBR_DOUBLE, (&prec->a)[i], &n);
+        if (n > 0)
+            (&prec->nea)[i] = n;
+    }
+    convert(prec);
+    return 0;
+}
+
+static long process(struct dbCommon *pcommon)
+{
+    struct acalcRecord *prec = (struct acalcRecord *)pcommon;
+    const double *pargs[CALCPERFORM_NARGS];
+    epicsUInt32 nargs[CALCPERFORM_NARGS];
+    epicsUInt32 nord = prec->nord;
+    unsigned long inputs = 0, stores;
+    int i;
+
+    prec->pact = TRUE;
+    if (fetch_values(prec) == 0) {
+        /* Array inputs used by the expression limit the element count */
+        calcArgUsage(prec->rpcl, &inputs, &stores);
+        prec->nord = prec->nelm;
+        for (i = 0; i < CALCPERFORM_NARGS; i++) {
+            pargs[i] = (&prec->a)[i];
+            nargs[i] = 1;
+            if ((&prec->noa)[i] > 1 && (inputs & (1 << i))) {
+                nargs[i] = (&prec->nea)[i];
+                if (prec->nord > nargs[i])
+                    prec->nord = nargs[i];
+            }
+        }
+
+        if (!prec->work ||
+            calcPerformArray(pargs, nargs, prec->val, prec->nord,
+                prec->rpcl, prec->work)) {
+            recGblSetSevr(prec, CALC_ALARM, INVALID_ALARM);
+        } else {
+            prec->udf = FALSE;
+            reduce(prec);
+        }
+    }
+
+    recGblGetTimeStamp(prec);
+    if (prec->udf)
+        recGblSetSevr(prec, UDF_ALARM, prec->udfs);
+    /* check event list */
+    monitor(prec, nord);
+    /* process the forward scan link record */
+    recGblFwdLink(prec);
+    prec->pact = FALSE;
+    return 0;
+}
+
+static long special(DBADDR *paddr, int after)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+
+    if (!after) return 0;
+    if (paddr->special == SPC_CALC)
+        return convert(prec);
+    recGblDbaddrError(S_db_badChoice, paddr, "acalc::special - bad special value!");
+    return S_db_badChoice;
+}
+
+#define indexof(field) acalcRecord##field
+
+static long get_linkNumber(int fieldIndex) {
+    if (fieldIndex >= indexof(A) && fieldIndex <= indexof(L))
+        return fieldIndex - indexof(A);
+    return -1;
+}
+
+static long cvt_dbaddr(DBADDR *paddr)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+    int linkNumber = get_linkNumber(fieldIndex);
+
+    if (linkNumber >= 0) {
+        paddr->pfield      = (&prec->a)[linkNumber];
+        paddr->no_elements = (&prec->noa)[linkNumber];
+    }
+    else if (fieldIndex == indexof(VAL)) {
+        paddr->pfield      = prec->val;
+        paddr->no_elements = prec->nelm;
+    }
+    else {
+        errlogPrintf("acalcRecord::cvt_dbaddr called for %s.%s\n",
+            prec->name, paddr->pfldDes->name);
+        return 0;
+    }
+    paddr->field_type     = DBF_DOUBLE;
+    paddr->dbr_field_type = DBR_DOUBLE;
+    paddr->field_size     = sizeof(double);
+    return 0;
+}
+
+static long get_array_info(DBADDR *paddr, long *no_elements, long *offset)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int linkNumber = get_linkNumber(dbGetFieldIndex(paddr));
+
+    if (linkNumber >= 0)
+        *no_elements = (&prec->nea)[linkNumber];
+    else
+        *no_elements = prec->nord;
+    *offset = 0;
+    return 0;
+}
+
+static long put_array_info(DBADDR *paddr, long nNew)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int linkNumber = get_linkNumber(dbGetFieldIndex(paddr));
+
+    if (linkNumber >= 0)
+        (&prec->nea)[linkNumber] = nNew;
+    else
+        prec->nord = nNew;
+    return 0;
+}
+
+static long get_units(DBADDR *paddr, char *units)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+    int linkNumber = get_linkNumber(fieldIndex);
+
+    if (linkNumber >= 0)
+        dbGetUnits(&prec->inpa + linkNumber, units, DB_UNITS_SIZE);
+    else if (fieldIndex == indexof(VAL) ||
+             paddr->pfldDes->field_type == DBF_DOUBLE)
+        strncpy(units, prec->egu, DB_UNITS_SIZE);
+    return 0;
+}
+
+static long get_precision(const DBADDR *paddr, long *pprecision)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+    int linkNumber;
+
+    *pprecision = prec->prec;
+    if (fieldIndex == indexof(VAL) || fieldIndex == indexof(RES))
+        return 0;
+
+    linkNumber = get_linkNumber(fieldIndex);
+    if (linkNumber >= 0) {
+        short precision;
+
+        if (dbGetPrecision(&prec->inpa + linkNumber, &precision) == 0)
+            *pprecision = precision;
+    } else
+        recGblGetPrec(paddr, pprecision);
+    return 0;
+}
+
+static long get_graphic_double(DBADDR *paddr, struct dbr_grDouble *pgd)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+    int fieldIndex = dbGetFieldIndex(paddr);
+    int linkNumber;
+
+    switch (fieldIndex) {
+        case indexof(VAL):
+        case indexof(RES):
+        case indexof(ALST):
+        case indexof(MLST):
+            pgd->lower_disp_limit = prec->lopr;
+            pgd->upper_disp_limit = prec->hopr;
+            break;
+        case indexof(NORD):
+            pgd->lower_disp_limit = 0;
+            pgd->upper_disp_limit = prec->nelm;
+            break;
+        default:
+            linkNumber = get_linkNumber(fieldIndex);
+            if (linkNumber >= 0) {
+                dbGetGraphicLimits(&prec->inpa + linkNumber,
+                    &pgd->lower_disp_limit,
+                    &pgd->upper_disp_limit);
+            } else
+                recGblGetGraphicDouble(paddr,pgd);
+    }
+    return 0;
+}
+
+static long get_control_double(DBADDR *paddr, struct dbr_ctrlDouble *pcd)
+{
+    acalcRecord *prec = (acalcRecord *)paddr->precord;
+
+    switch (dbGetFieldIndex(paddr)) {
+        case indexof(VAL):
+        case indexof(RES):
+        case indexof(ALST):
+        case indexof(MLST):
+            pcd->lower_ctrl_limit = prec->lopr;
+            pcd->upper_ctrl_limit = prec->hopr;
+            break;
+        default:
+            recGblGetControlDouble(paddr,pcd);
+    }
+    return 0;
+}
+
+/* Convert CALC and allocate the work space to evaluate it */
+static long convert(acalcRecord *prec)
+{
+    short error_number;
+    size_t size;
+
+    free(prec->work);
+    prec->work = NULL;
+    if (postfix(prec->calc, prec->rpcl, &error_number)) {
+        recGblRecordError(S_db_badField, (void *)prec,
+                          "acalc: Illegal CALC field");
+        errlogPrintf("%s.CALC: %s in expression \"%s\"\n",
+                     prec->name, calcErrorStr(error_number), prec->calc);
+        return S_db_badField;
+    }
+    size = calcArrayWorkSize(prec->rpcl);
+    if (size)
+        prec->work = mallocMustSucceed(size * sizeof(double),
+            "acalc: work space");
+    return 0;
+}
+
+/* The reductions use several partial results so the compiler can keep
+ * them in vector registers. A NaN is only taken by Min and Max when the
+ * partial result is also NaN, so they ignore NaN values.
+ */
+static double sum(const double *p, epicsUInt32 n)
+{
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    epicsUInt32 i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        s0 += p[i];
+        s1 += p[i + 1];
+        s2 += p[i + 2];
+        s3 += p[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += p[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+#define MIN_OF(m, x) ((x) < (m) || (m) != (m) ? (x) : (m))
+#define MAX_OF(m, x) ((x) > (m) || (m) != (m) ? (x) : (m))
+
+static double minimum(const double *p, epicsUInt32 n)
+{
+    double m0 = p[0], m1 = p[0], m2 = p[0], m3 = p[0];
+    epicsUInt32 i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        m0 = MIN_OF(m0, p[i]);
+        m1 = MIN_OF(m1, p[i + 1]);
+        m2 = MIN_OF(m2, p[i + 2]);
+        m3 = MIN_OF(m3, p[i + 3]);
+    }
+    for (; i < n; i++)
+        m0 = MIN_OF(m0, p[i]);
+    m0 = MIN_OF(m0, m1);
+    m2 = MIN_OF(m2, m3);
+    return MIN_OF(m0, m2);
+}
+
+static double maximum(const double *p, epicsUInt32 n)
+{
+    double m0 = p[0], m1 = p[0], m2 = p[0], m3 = p[0];
+    epicsUInt32 i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        m0 = MAX_OF(m0, p[i]);
+        m1 = MAX_OF(m1, p[i + 1]);
+        m2 = MAX_OF(m2, p[i + 2]);
+        m3 = MAX_OF(m3, p[i + 3]);
+    }
+    for (; i < n; i++)
+        m0 = MAX_OF(m0, p[i]);
+    m0 = MAX_OF(m0, m1);
+    m2 = MAX_OF(m2, m3);
+    return MAX_OF(m0, m2);
+}
+
+static void reduce(acalcRecord *prec)
+{
+    const double *pval = prec->val;
+    epicsUInt32 n = prec->nord;
+
+    if (n == 0 || prec->red == acalcRED_None)
+        return;
+
+    switch (prec->red) {
+    case acalcRED_Sum:
+        prec->res = sum(pval, n);
+        break;
+    case acalcRED_Min:
+        prec->res = minimum(pval, n);
+        break;
+    case acalcRED_Max:
+        prec->res = maximum(pval, n);
+        break;
+    case acalcRED_Mean:
+        prec->res = sum(pval, n) / n;
+        break;
+    }
+}
+
+static void monitor(acalcRecord *prec, epicsUInt32 nord)
+{
+    unsigned monitor_mask = recGblResetAlarms(prec);
+    unsigned res_mask = monitor_mask;
+
+    /* check for value change */
+    recGblCheckDeadband(&prec->mlst, prec->res, prec->mdel, &res_mask, DBE_VALUE);
+
+    /* check for archive change */
+    recGblCheckDeadband(&prec->alst, prec->res, prec->adel, &res_mask, DBE_ARCHIVE);
+
+    if (res_mask)
+        db_post_events(prec, &prec->res, res_mask);
+
+    /* VAL is sent every time */
+    db_post_events(prec, prec->val, monitor_mask | DBE_VALUE | DBE_LOG);
+    if (nord != prec->nord)
+        db_post_events(prec, &prec->nord, monitor_mask | DBE_VALUE | DBE_LOG);
+}
+
+static long fetch_values(acalcRecord *prec)
+{
+    long status = 0;
+    int i;
+
+    for (i = 0; i < CALCPERFORM_NARGS; i++) {
+        long nRequest = (&prec->noa)[i];
+        long newStatus = dbGetLink(&prec->inpa + i, DBR_DOUBLE,
+            (&prec->a)[i], 0, &nRequest);
+
+        if (nRequest > 0)
+            (&prec->nea)[i] = nRequest;
+        if (status == 0)
+            status = newStatus;
+    }
+    return status;
+}
@@ -86,6 +86,7 @@ static void reset(compressRecord *prec)
     prec->off = 0;
     prec->inx = 0;
     prec->cvb = 0.0;
+    prec->cvs = 0.0;
     prec->res = 0;
     /* allocate memory for the summing buffer for conversions requiring it */
     if (prec->alg == compressALG_Average && prec->sptr == NULL) {
@@ -119,16 +120,42 @@ static void put_value(compressRecord *prec, double *psource, int n)
     if (nuse > nsam)
         nuse = nsam;
 
-    while (n--) {
-        /* for LIFO, pre-decrement modulo nsam */
-        if (!fifo)
-            offset = (offset + nsam - 1) % nsam;
+    /* only the last nsam values will remain */
+    if ((epicsUInt32) n > nsam) {
+        epicsUInt32 skip = (n - nsam) % nsam;
 
-        prec->bptr[offset] = *psource++;
+        offset = fifo ? (offset + skip) % nsam : (offset + nsam - skip) % nsam;
+        psource += n - nsam;
+        n = nsam;
+    }
+
+    /* copy in runs which end at the end (FIFO) or start (LIFO) of bptr */
+    while (n > 0) {
+        epicsUInt32 run;
 
-        /* for FIFO, post-increment modulo nsam */
-        if (fifo)
-            offset = (offset + 1) % nsam;
+        if (fifo) {
+            run = nsam - offset;
+            if (run > (epicsUInt32) n)
+                run = n;
+            memcpy(&prec->bptr[offset], psource, run * sizeof(double));
+            offset = (offset + run) % nsam;
+        }
+        else {
+            double *pdest;
+            epicsUInt32 i;
+
+            if (offset == 0)
+                offset = nsam;
+            run = offset;
+            if (run > (epicsUInt32) n)
+                run = n;
+            pdest = &prec->bptr[offset - 1];
+            for (i = 0; i < run; i++)
+                *pdest-- = psource[i];
+            offset -= run;
+        }
+        psource += run;
+        n -= run;
     }
 
     prec->off = offset;
@@ -147,13 +174,201 @@ static int compare(const void *arg1, const void *arg2)
     else               return  1;
 }
 
+/* Partially reorder a[0..n-1] so that a[k] holds the value it would have
+ * if the array were sorted, and return it. This is Hoare's selection with
+ * a median of three pivot, falling back to sorting if it fails to make
+ * progress, so it takes O(n) time.
+ */
+static double select_kth(double *a, epicsInt32 n, epicsInt32 k)
+{
+    epicsInt32 lo = 0;
+    epicsInt32 hi = n - 1;
+    int limit = 2;
+
+    while (n >>= 1)
+        limit += 2;
+
+    while (lo < hi) {
+        double x, p1 = a[lo], p2 = a[lo + (hi - lo) / 2], p3 = a[hi];
+        epicsInt32 i = lo;
+        epicsInt32 j = hi;
+
+        if (--limit < 0) {
+            qsort(&a[lo], hi - lo + 1, sizeof(double), compare);
+            break;
+        }
+        if (p1 < p2)
+            x = p2 < p3 ? p2 : (p1 < p3 ? p3 : p1);
+        else
+            x = p1 < p3 ? p1 : (p2 < p3 ? p3 : p2);
+        do {
+            while (a[i] < x)
+                i++;
+            while (x < a[j])
+                j--;
+            if (i <= j) {
+                double t = a[i];
+
+                a[i++] = a[j];
+                a[j--] = t;
+            }
+        } while (i <= j);
+        if (j < k)
+            lo = i;
+        if (k < i)
+            hi = j;
+    }
+    return a[k];
+}
+
+/* The block reductions keep four independent partial results, so the
+ * loops are free of branches and of long dependency chains, and the
+ * compiler can use vector instructions for them.
+ */
+static double block_min(const double *p, epicsInt32 n)
+{
+    double m0 = p[0], m1 = p[0], m2 = p[0], m3 = p[0];
+    epicsInt32 i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        m0 = p[i] < m0 ? p[i] : m0;
+        m1 = p[i + 1] < m1 ? p[i + 1] : m1;
+        m2 = p[i + 2] < m2 ? p[i + 2] : m2;
+        m3 = p[i + 3] < m3 ? p[i + 3] : m3;
+    }
+    for (; i < n; i++)
+        m0 = p[i] < m0 ? p[i] : m0;
+    m0 = m1 < m0 ? m1 : m0;
+    m2 = m3 < m2 ? m3 : m2;
+    return m2 < m0 ? m2 : m0;
+}
+
+static double block_max(const double *p, epicsInt32 n)
+{
+    double m0 = p[0], m1 = p[0], m2 = p[0], m3 = p[0];
+    epicsInt32 i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        m0 = p[i] > m0 ? p[i] : m0;
+        m1 = p[i + 1] > m1 ? p[i + 1] : m1;
+        m2 = p[i + 2] > m2 ? p[i + 2] : m2;
+        m3 = p[i + 3] > m3 ? p[i + 3] : m3;
+    }
+    for (; i < n; i++)
+        m0 = p[i] > m0 ? p[i] : m0;
+    m0 = m1 > m0 ? m1 : m0;
+    m2 = m3 > m2 ? m3 : m2;
+    return m2 > m0 ? m2 : m0;
+}
+
+static void block_min_max(const double *p, epicsInt32 n,
+    double *pmin, double *pmax)
+{
+    double l0 = p[0], l1 = p[0], h0 = p[0], h1 = p[0];
+    epicsInt32 i;
+
+    for (i = 0; i + 2 <= n; i += 2) {
+        l0 = p[i] < l0 ? p[i] : l0;
+        l1 = p[i + 1] < l1 ? p[i + 1] : l1;
+        h0 = p[i] > h0 ? p[i] : h0;
+        h1 = p[i + 1] > h1 ? p[i + 1] : h1;
+    }
+    if (i < n) {
+        l0 = p[i] < l0 ? p[i] : l0;
+        h0 = p[i] > h0 ? p[i] : h0;
+    }
+    *pmin = l1 < l0 ? l1 : l0;
+    *pmax = h1 > h0 ? h1 : h0;
+}
+
+static double block_sum(const double *p, epicsInt32 n)
+{
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    epicsInt32 i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        s0 += p[i];
+        s1 += p[i + 1];
+        s2 += p[i + 2];
+        s3 += p[i + 3];
+    }
+    for (; i < n; i++)
+        s0 += p[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+/* Sums of (p[i] - shift) and of its square. Shifting by a sample keeps
+ * the variance accurate for signals with a large constant offset.
+ */
+static void block_sums(const double *p, epicsInt32 n, double shift,
+    double *psum, double *psumsq)
+{
+    double s0 = 0.0, s1 = 0.0, q0 = 0.0, q1 = 0.0;
+    epicsInt32 i;
+
+    for (i = 0; i + 2 <= n; i += 2) {
+        double d0 = p[i] - shift;
+        double d1 = p[i + 1] - shift;
+
+        s0 += d0;
+        s1 += d1;
+        q0 += d0 * d0;
+        q1 += d1 * d1;
+    }
+    if (i < n) {
+        double d0 = p[i] - shift;
+
+        s0 += d0;
+        q0 += d0 * d0;
+    }
+    *psum = s0 + s1;
+    *psumsq = q0 + q1;
+}
+
+/* Compress one block of n input values, returns the number of results */
+static int compress_block(int alg, double *psource, epicsInt32 n,
+    double *presult)
+{
+    double sum, sumsq, var;
+
+    switch (alg) {
+    case compressALG_N_to_1_Low_Value:
+        presult[0] = block_min(psource, n);
+        return 1;
+    case compressALG_N_to_1_High_Value:
+        presult[0] = block_max(psource, n);
+        return 1;
+    case compressALG_N_to_1_Min_Max:
+        block_min_max(psource, n, &presult[0], &presult[1]);
+        return 2;
+    case compressALG_N_to_1_Average:
+        presult[0] = block_sum(psource, n) / n;
+        return 1;
+    case compressALG_N_to_1_RMS:
+        block_sums(psource, n, 0.0, &sum, &sumsq);
+        presult[0] = sqrt(sumsq / n);
+        return 1;
+    case compressALG_N_to_1_Std_Dev:
+        block_sums(psource, n, psource[0], &sum, &sumsq);
+        var = (sumsq - sum * sum / n) / n;
+        presult[0] = var > 0 ? sqrt(var) : 0.0;
+        return 1;
+    case compressALG_N_to_1_Median:
+        /* note: reorders source array (OK; it's a work pointer) */
+        presult[0] = select_kth(psource, n, n / 2);
+        return 1;
+    }
+    return 0;
+}
+
 static int compress_array(compressRecord *prec,
     double *psource, int no_elements)
 {
-    epicsInt32 i,j;
-    epicsInt32 n, nnew;
+    epicsInt32 i;
+    epicsInt32 n, nnew, nmax, perBlock;
     epicsInt32 nsam = prec->nsam;
-    double value;
+    double result[64];
+    int nres = 0;
 
     /* skip out of limit data */
     if (prec->ilil < prec->ihil) {
@@ -170,55 +385,24 @@ static int compress_array(compressRecord *prec,
         return 1; /*dont do anything*/
 
     /* determine number of samples to take */
-    if (no_elements < nsam * n)
+    perBlock = (prec->alg == compressALG_N_to_1_Min_Max) ? 2 : 1;
+    nmax = nsam / perBlock;
+    if (nmax < 1)
+        nmax = 1;
+    if (no_elements < nmax * n)
         nnew = (no_elements / n);
-    else nnew = nsam;
-
-    /* compress according to specified algorithm */
-    switch (prec->alg){
-    case compressALG_N_to_1_Low_Value:
-        /* compress N to 1 keeping the lowest value */
-        for (i = 0; i < nnew; i++) {
-            value = *psource++;
-            for (j = 1; j < n; j++, psource++) {
-                if (value > *psource)
-                    value = *psource;
-            }
-            put_value(prec, &value, 1);
-        }
-        break;
-    case compressALG_N_to_1_High_Value:
-        /* compress N to 1 keeping the highest value */
-        for (i = 0; i < nnew; i++){
-            value = *psource++;
-            for (j = 1; j < n; j++, psource++) {
-                if (value < *psource)
-                    value = *psource;
-            }
-            put_value(prec, &value, 1);
-        }
-        break;
-    case compressALG_N_to_1_Average:
-        /* compress N to 1 keeping the average value */
-        for (i = 0; i < nnew; i++) {
-            value = 0;
-            for (j = 0; j < n; j++, psource++)
-                value += *psource;
-            value /= n;
-            put_value(prec, &value, 1);
+    else nnew = nmax;
+
+    /* compress according to specified algorithm, passing the results
+     * to put_value() in batches */
+    for (i = 0; i < nnew; i++, psource += n) {
+        nres += compress_block(prec->alg, psource, n, &result[nres]);
+        if (nres > NELEMENTS(result) - 2) {
+            put_value(prec, result, nres);
+            nres = 0;
         }
-        break;
-
-    case compressALG_N_to_1_Median:
-        /* compress N to 1 keeping the median value */
-        /* note: sorts source array (OK; it's a work pointer) */
-        for (i = 0; i < nnew; i++, psource += nnew) {
-            qsort(psource, n, sizeof(double), compare);
-            value = psource[n / 2];
-            put_value(prec, &value, 1);
-        }
-        break;
     }
+    put_value(prec, result, nres);
     return 0;
 }
 
@@ -288,6 +472,13 @@ static int compress_scalar(struct compressRecord *prec,double *psource)
         if ((value > *pdest) || (inx == 0))
             *pdest = value;
         break;
+    case (compressALG_N_to_1_Min_Max):
+        /* CVB holds the lowest and CVS the highest value */
+        if ((value < *pdest) || (inx == 0))
+            *pdest = value;
+        if ((value > prec->cvs) || (inx == 0))
+            prec->cvs = value;
+        break;
     /* for scalars, Median not implemented => use average */
     case (compressALG_N_to_1_Average):
     case (compressALG_N_to_1_Median):
@@ -299,10 +490,43 @@ static int compress_scalar(struct compressRecord *prec,double *psource)
                 *pdest = *pdest / (inx + 1);
         }
         break;
+    case (compressALG_N_to_1_RMS):
+        if (inx == 0)
+            *pdest = value * value;
+        else
+            *pdest += value * value;
+        if (inx + 1 >= prec->n)
+            *pdest = sqrt(*pdest / (inx + 1));
+        break;
+    case (compressALG_N_to_1_Std_Dev):
+        /* Welford's method, CVB holds the mean and CVS the sum of
+         * squared differences from it */
+        if (inx == 0) {
+            *pdest = value;
+            prec->cvs = 0.0;
+        }
+        else {
+            double delta = value - *pdest;
+
+            *pdest += delta / (inx + 1);
+            prec->cvs += delta * (value - *pdest);
+        }
+        break;
     }
     inx++;
     if (inx >= prec->n) {
-        put_value(prec,pdest,1);
+        if (prec->alg == compressALG_N_to_1_Min_Max) {
+            double pair[2];
+
+            pair[0] = *pdest;
+            pair[1] = prec->cvs;
+            put_value(prec, pair, 2);
+        }
+        else {
+            if (prec->alg == compressALG_N_to_1_Std_Dev)
+                *pdest = sqrt(prec->cvs / inx);
+            put_value(prec, pdest, 1);
+        }
         prec->inx = 0;
         return 0;
     } else {
@@ -2,12 +2,14 @@
 * Copyright (c) 2013 Brookhaven Science Assoc, as Operator of Brookhaven
 *     National Laboratory.
 \*************************************************************************/
-#include "string.h"
+#include <stdio.h>
+#include <string.h>
 
 #include "cantProceed.h"
 #include "dbAddr.h"
 #include "dbConvert.h"
 #include "dbDefs.h"
+#include "dbFldTypes.h"
 #include "epicsTime.h"
 #include "epicsMath.h"
 #include "epicsAssert.h"
@@ -109,9 +111,81 @@ done:
     free(tdat.output);
 }
 
+/* Numeric types, where DBF_x and DBR_x have the same value */
+static const struct {
+    const char *name;
+    short type;
+    short size;
+} numTypes[] = {
+    {"CHAR",   DBF_CHAR,   sizeof(epicsInt8)},
+    {"UCHAR",  DBF_UCHAR,  sizeof(epicsUInt8)},
+    {"SHORT",  DBF_SHORT,  sizeof(epicsInt16)},
+    {"USHORT", DBF_USHORT, sizeof(epicsUInt16)},
+    {"LONG",   DBF_LONG,   sizeof(epicsInt32)},
+    {"ULONG",  DBF_ULONG,  sizeof(epicsUInt32)},
+    {"INT64",  DBF_INT64,  sizeof(epicsInt64)},
+    {"UINT64", DBF_UINT64, sizeof(epicsUInt64)},
+    {"FLOAT",  DBF_FLOAT,  sizeof(epicsFloat32)},
+    {"DOUBLE", DBF_DOUBLE, sizeof(epicsFloat64)},
+    {"ENUM",   DBF_ENUM,   sizeof(epicsEnum16)},
+};
+
+/* Print a table of the rate in Melements/s of each numeric conversion */
+static void benchPairs(size_t nelem, size_t niter)
+{
+    void *field = callocMustSucceed(nelem, sizeof(epicsFloat64), "benchPairs");
+    void *buf = callocMustSucceed(nelem, sizeof(epicsFloat64), "benchPairs");
+    char line[160];
+    size_t f, r, i;
+    int put;
+    DBADDR addr;
+
+    for (put = 0; put < 2; put++) {
+        int n = sprintf(line, "%-7s", put ? "put" : "get");
+
+        testDiag("%s %lu elements, Melem/s, rows are the field type",
+                 put ? "dbPut" : "dbGet", (unsigned long) nelem);
+        for (r = 0; r < NELEMENTS(numTypes); r++)
+            n += sprintf(line + n, " %6.6s", numTypes[r].name);
+        testDiag("%s", line);
+
+        for (f = 0; f < NELEMENTS(numTypes); f++) {
+            memset(&addr, 0, sizeof(addr));
+            addr.field_type = numTypes[f].type;
+            addr.field_size = numTypes[f].size;
+            addr.no_elements = nelem;
+            addr.pfield = field;
+            n = sprintf(line, "%-7s", numTypes[f].name);
+
+            for (r = 0; r < NELEMENTS(numTypes); r++) {
+                epicsTimeStamp start, stop;
+                double elapsed;
+
+                epicsTimeGetCurrent(&start);
+                for (i = 0; i < niter; i++) {
+                    if (put)
+                        dbPutConvertRoutine[numTypes[r].type]
+                            [numTypes[f].type](&addr, buf, nelem, nelem, 0);
+                    else
+                        dbGetConvertRoutine[numTypes[f].type]
+                            [numTypes[r].type](&addr, buf, nelem, nelem, 0);
+                }
+                epicsTimeGetCurrent(&stop);
+                elapsed = epicsTimeDiffInSeconds(&stop, &start);
+                n += sprintf(line + n, " %6.0f",
+                             elapsed > 0 ? nelem * niter / elapsed / 1e6 : 0);
+            }
+            testDiag("%s", line);
+        }
+    }
+    free(buf);
+    free(field);
+}
+
 MAIN(benchdbConvert)
 {
     testPlan(0);
+    benchPairs(1000000, 10);
     runBench(1, 10000000, 10);
     runBench(2,  5000000, 10);
     runBench(10, 1000000, 10);
@@ -0,0 +1,165 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Checks that parallel callback threads take work queued for a thread
+ * which is busy, and that the queue statistics add up over the queues
+ * of all threads of a priority.
+ */
+
+#include <stdio.h>
+
+#include "callback.h"
+#include "dbAccessDefs.h"
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NTHREADS 4
+#define NQUICK 8
+#define QUEUE_SIZE 100
+
+static epicsCallback blockers[NTHREADS];
+static epicsEventId release[NTHREADS];
+static int started;
+
+static epicsCallback quick[QUEUE_SIZE + 1];
+static int ran;
+static epicsEventId done;
+
+static void blockCallback(epicsCallback *pcb)
+{
+    int i = (int)(pcb - blockers);
+
+    epicsAtomicIncrIntT(&started);
+    epicsEventMustWait(release[i]);
+}
+
+static void quickCallback(epicsCallback *pcb)
+{
+    epicsAtomicIncrIntT(&ran);
+    epicsEventMustTrigger(done);
+}
+
+/* Occupy every thread with a blocking callback, any queued on a
+ * thread which is already busy are taken by an idle one */
+static int blockAll(void)
+{
+    int i, n;
+
+    epicsAtomicSetIntT(&started, 0);
+    for (i = 0; i < NTHREADS; i++) {
+        callbackSetCallback(blockCallback, &blockers[i]);
+        callbackSetPriority(priorityLow, &blockers[i]);
+        callbackRequest(&blockers[i]);
+    }
+    for (n = 0; n < 100 && epicsAtomicGetIntT(&started) < NTHREADS; n++)
+        epicsThreadSleep(0.05);
+    return epicsAtomicGetIntT(&started);
+}
+
+static int waitRan(int count)
+{
+    while (epicsAtomicGetIntT(&ran) < count) {
+        if (epicsEventWaitWithTimeout(done, 10.0) != epicsEventWaitOK)
+            break;
+    }
+    return epicsAtomicGetIntT(&ran);
+}
+
+static void testSteal(void)
+{
+    int i, n;
+
+    testDiag("Callbacks queued for a busy thread are taken by others");
+
+    n = blockAll();
+    testOk(n == NTHREADS, "%d of %d threads blocked", n, NTHREADS);
+
+    /* all threads are busy, so these are spread over their queues */
+    epicsAtomicSetIntT(&ran, 0);
+    for (i = 0; i < NQUICK; i++) {
+        callbackSetCallback(quickCallback, &quick[i]);
+        callbackSetPriority(priorityLow, &quick[i]);
+        callbackRequest(&quick[i]);
+    }
+
+    /* keep one thread blocked with work on its queue */
+    for (i = 1; i < NTHREADS; i++)
+        epicsEventMustTrigger(release[i]);
+    n = waitRan(NQUICK);
+    testOk(n == NQUICK, "%d of %d callbacks ran while one thread was blocked",
+           n, NQUICK);
+    epicsEventMustTrigger(release[0]);
+}
+
+static void testStats(void)
+{
+    callbackQueueStats stats;
+    int i, n, pushed = 0;
+
+    testDiag("Queue statistics of parallel callback threads");
+
+    n = blockAll();
+    testOk(n == NTHREADS, "%d of %d threads blocked", n, NTHREADS);
+    callbackQueueStatus(1, NULL);
+
+    epicsAtomicSetIntT(&ran, 0);
+    for (i = 0; i < QUEUE_SIZE + 1; i++) {
+        callbackSetCallback(quickCallback, &quick[i]);
+        callbackSetPriority(priorityLow, &quick[i]);
+        if (callbackRequest(&quick[i]) == S_db_bufFull)
+            break;
+        pushed++;
+    }
+    testOk(pushed == QUEUE_SIZE, "%d callbacks queued before overflow",
+           pushed);
+
+    testOk1(callbackQueueStatus(0, &stats) == 0);
+    testOk(stats.size == QUEUE_SIZE, "size %d is the total capacity",
+           stats.size);
+    testOk(stats.numUsed[priorityLow] == pushed,
+           "%d callbacks queued over all threads",
+           stats.numUsed[priorityLow]);
+    testOk(stats.maxUsed[priorityLow] == pushed,
+           "high-water mark %d over all threads",
+           stats.maxUsed[priorityLow]);
+    testOk(stats.numOverflow[priorityLow] == 1, "%d overflow",
+           stats.numOverflow[priorityLow]);
+
+    for (i = 0; i < NTHREADS; i++)
+        epicsEventMustTrigger(release[i]);
+    testOk(waitRan(pushed) == pushed, "all queued callbacks ran");
+}
+
+MAIN(callbackStealTest)
+{
+    int i;
+
+    testPlan(10);
+
+    for (i = 0; i < NTHREADS; i++)
+        release[i] = epicsEventMustCreate(epicsEventEmpty);
+    done = epicsEventMustCreate(epicsEventEmpty);
+
+    callbackSetQueueSize(QUEUE_SIZE);
+    callbackParallelThreads(NTHREADS, "");
+    callbackInit();
+
+    testSteal();
+    testStats();
+
+    callbackStop();
+    callbackCleanup();
+    callbackSetQueueSize(2000);     /* the default */
+
+    for (i = 0; i < NTHREADS; i++)
+        epicsEventDestroy(release[i]);
+    epicsEventDestroy(done);
+
+    return testDone();
+}
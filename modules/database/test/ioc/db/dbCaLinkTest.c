@@ -615,9 +615,81 @@ static void testCAC(void)
     free(buftarg2);
 }
 
+#define NPOOL 40
+
+static void testWorkerPool(void)
+{
+    xRecord *psrc[NPOOL], *ptarg[NPOOL];
+    struct dbCaWorker *used[NPOOL];
+    caLink *pca;
+    int i, j, nconn = 0, nput = 0, nused = 0;
+    int workers = dbCaWorkers;
+
+    testDiag("Links shared between 4 dbCa workers");
+    dbCaWorkers = 4;
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    for (i = 0; i < NPOOL; i++) {
+        char buf[40];
+
+        epicsSnprintf(buf, sizeof(buf), "N=%d", i);
+        testdbReadDatabase("dbCaLinkTest4.db", NULL, buf);
+    }
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    for (i = 0; i < NPOOL; i++) {
+        char name[20];
+
+        epicsSnprintf(name, sizeof(name), "source%d", i);
+        psrc[i] = (xRecord *)testdbRecordPtr(name);
+        epicsSnprintf(name, sizeof(name), "target%d", i);
+        ptarg[i] = (xRecord *)testdbRecordPtr(name);
+        waitForUpdateN(&psrc[i]->lnk, 1);
+    }
+
+    for (i = 0; i < NPOOL; i++) {
+        epicsInt32 val = 100 + i;
+
+        dbScanLock((dbCommon *)psrc[i]);
+        pca = (caLink *)psrc[i]->lnk.value.pv_link.pvt;
+        for (j = 0; j < nused && used[j] != pca->worker; j++)
+            ;
+        if (j == nused)
+            used[nused++] = pca->worker;
+        if (dbCaIsLinkConnected(&psrc[i]->lnk))
+            nconn++;
+        dbPutLink(&psrc[i]->lnk, DBR_LONG, &val, 1);
+        dbScanUnlock((dbCommon *)psrc[i]);
+    }
+    dbCaSync();
+
+    for (i = 0; i < NPOOL; i++) {
+        dbScanLock((dbCommon *)ptarg[i]);
+        if (ptarg[i]->val == 100 + i)
+            nput++;
+        dbScanUnlock((dbCommon *)ptarg[i]);
+    }
+    testOk(nconn == NPOOL, "%d of %d links connected", nconn, NPOOL);
+    testOk(nused > 1, "links served by %d distinct workers", nused);
+    testOk(nput == NPOOL, "%d of %d puts arrived after dbCaSync()",
+        nput, NPOOL);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+    dbCaWorkers = workers;
+}
+
 MAIN(dbCaLinkTest)
 {
-    testPlan(101);
+    testPlan(104);
     testNativeLink();
     testStringLink();
     testCP();
@@ -627,5 +699,6 @@ MAIN(dbCaLinkTest)
     testArrayLink(10,10);
     testreTargetTypeChange();
     testCAC();
+    testWorkerPool();
     return testDone();
 }
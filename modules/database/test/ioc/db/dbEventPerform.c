@@ -0,0 +1,166 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Compare db_post_events() throughput into locked and lock free
+ * event queues with several posting threads.
+ */
+
+#include <stdio.h>
+
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "dbLock.h"
+#include "dbUnitTest.h"
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "errlog.h"
+#include "testMain.h"
+#include "epicsUnitTest.h"
+
+#define NPRODUCERS  8   /* records, one per posting thread */
+#define NSUBSCR     4   /* subscriptions per record */
+#define NPOSTS      100000
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+typedef struct {
+    dbCommon *prec;
+    unsigned nposts;
+    epicsEventId start;
+    epicsEventId done;
+} producer;
+
+static void noopEvent(void *user_arg, struct dbChannel *chan,
+                      int eventsRemaining, struct db_field_log *pfl)
+{
+    epicsAtomicIncrSizeT((size_t *) user_arg);
+}
+
+static void postTask(void *arg)
+{
+    producer *prod = arg;
+    unsigned i;
+
+    epicsEventMustWait(prod->start);
+    for (i = 0; i < prod->nposts; i++) {
+        dbScanLock(prod->prec);
+        db_post_events(prod->prec, NULL, DBE_VALUE);
+        dbScanUnlock(prod->prec);
+    }
+    epicsEventMustTrigger(prod->done);
+}
+
+static void runBench(int queType, unsigned nthreads)
+{
+    producer prod[NPRODUCERS];
+    dbChannel *chan[NPRODUCERS][NSUBSCR];
+    evSubscrip *sub[NPRODUCERS][NSUBSCR];
+    dbEventCtx ctx;
+    size_t ndelivered = 0;
+    size_t nposted = (size_t) nthreads * NSUBSCR * NPOSTS;
+    size_t naccounted;
+    epicsTimeStamp start, stop;
+    double dt;
+    unsigned i, j;
+
+    ctx = db_init_events_type(queType);
+    if (!ctx || db_start_events(ctx, "benchEvents", NULL, NULL,
+                                epicsThreadPriorityLow) != DB_EVENT_OK)
+        testAbort("Failed to create event context");
+
+    for (i = 0; i < nthreads; i++) {
+        char name[8];
+
+        sprintf(name, "r%u", i);
+        for (j = 0; j < NSUBSCR; j++) {
+            chan[i][j] = dbChannelCreate(name);
+            if (!chan[i][j] || dbChannelOpen(chan[i][j]))
+                testAbort("Failed to open channel %s", name);
+            sub[i][j] = db_add_event(ctx, chan[i][j], noopEvent,
+                                     &ndelivered, DBE_VALUE);
+            db_event_enable(sub[i][j]);
+        }
+        prod[i].prec = testdbRecordPtr(name);
+        prod[i].nposts = NPOSTS;
+        prod[i].start = epicsEventMustCreate(epicsEventEmpty);
+        prod[i].done = epicsEventMustCreate(epicsEventEmpty);
+        epicsThreadMustCreate(name, epicsThreadPriorityMedium,
+                              epicsThreadGetStackSize(epicsThreadStackSmall),
+                              postTask, &prod[i]);
+    }
+
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < nthreads; i++)
+        epicsEventMustTrigger(prod[i].start);
+    for (i = 0; i < nthreads; i++)
+        epicsEventMustWait(prod[i].done);
+    epicsTimeGetCurrent(&stop);
+    dt = epicsTimeDiffInSeconds(&stop, &start);
+
+    /* wait for the event task to catch up */
+    do {
+        naccounted = epicsAtomicGetSizeT(&ndelivered);
+        for (i = 0; i < nthreads; i++)
+            for (j = 0; j < NSUBSCR; j++)
+                naccounted += sub[i][j]->ndropped + sub[i][j]->ncoalesced;
+        if (naccounted < nposted)
+            epicsThreadSleep(0.01);
+    } while (naccounted < nposted);
+
+    testOk(naccounted == nposted,
+           "%-9s %u threads: %.0f events/s posted, %lu delivered",
+           queType == DB_EVENT_QUE_LOCKFREE ? "lock free" : "locked",
+           nthreads, nposted / dt, (unsigned long) ndelivered);
+
+    for (i = 0; i < nthreads; i++) {
+        for (j = 0; j < NSUBSCR; j++) {
+            db_event_disable(sub[i][j]);
+            db_cancel_event(sub[i][j]);
+            dbChannelDelete(chan[i][j]);
+        }
+        epicsEventDestroy(prod[i].start);
+        epicsEventDestroy(prod[i].done);
+    }
+    db_close_events(ctx);
+}
+
+MAIN(dbEventPerform)
+{
+    unsigned i, nthreads;
+
+    testPlan(8);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    for (i = 0; i < NPRODUCERS; i++) {
+        char macros[16];
+
+        sprintf(macros, "N=r%u", i);
+        testdbReadDatabase("dbEventPerform.db", NULL, macros);
+    }
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    for (nthreads = 1; nthreads <= NPRODUCERS; nthreads *= 2) {
+        runBench(DB_EVENT_QUE_LOCKED, nthreads);
+        runBench(DB_EVENT_QUE_LOCKFREE, nthreads);
+    }
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    return testDone();
+}
@@ -0,0 +1,448 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Event queue sizing and drop accounting tests
+ */
+
+#include <string.h>
+
+#include "dbAccess.h"
+#include "dbChannel.h"
+#include "dbEvent.h"
+#include "db_field_log.h"
+#include "dbUnitTest.h"
+#include "epicsEvent.h"
+#include "epicsMutex.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "testMain.h"
+#include "epicsUnitTest.h"
+
+#include "arrRecord.h"
+
+/* More than the 35 subscriptions which fitted in the old fixed queue */
+#define NMONITORS 200
+/* Large enough to be posted as a shared snapshot */
+#define NSNAP 4096
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static epicsMutexId lock;
+static epicsEventId delivered;
+static unsigned count;
+static epicsInt32 lastValue;
+
+static void countEvents(void *user_arg, struct dbChannel *chan,
+                        int eventsRemaining, struct db_field_log *pfl)
+{
+    epicsMutexMustLock(lock);
+    count++;
+    if (pfl->type == dbfl_type_val)
+        lastValue = pfl->u.v.field.dbf_long;
+    epicsMutexUnlock(lock);
+    epicsEventMustTrigger(delivered);
+}
+
+static void testManySubscriptions(void)
+{
+    testMonitor *mon[NMONITORS];
+    unsigned i, ok;
+
+    testDiag("Test %u subscriptions on one event context", NMONITORS);
+
+    for (i = 0; i < NMONITORS; i++)
+        mon[i] = testMonitorCreate("x.VAL", DBE_VALUE, 0);
+
+    testdbPutFieldOk("x.VAL", DBF_LONG, 1);
+
+    for (i = 0, ok = 0; i < NMONITORS; i++) {
+        testMonitorWait(mon[i]);
+        ok += testMonitorCount(mon[i], 1) == 1;
+    }
+    testOk(ok == NMONITORS, "all %u subscriptions saw one event (%u)",
+           NMONITORS, ok);
+
+    /* remove most subscriptions, the queue shrinks behind them */
+    for (i = 1; i < NMONITORS; i++)
+        testMonitorDestroy(mon[i]);
+
+    testdbPutFieldOk("x.VAL", DBF_LONG, 2);
+    testMonitorWait(mon[0]);
+    testOk1(testMonitorCount(mon[0], 1) == 1);
+
+    testMonitorDestroy(mon[0]);
+}
+
+static void testManyLockFree(void)
+{
+    dbEventCtx ctx;
+    dbChannel *chan[NMONITORS];
+    dbEventSubscription sub[NMONITORS];
+    unsigned i, n = 0;
+
+    testDiag("Test %u subscriptions on one lock free event context", NMONITORS);
+
+    lock = epicsMutexMustCreate();
+    delivered = epicsEventMustCreate(epicsEventEmpty);
+    count = 0;
+
+    ctx = db_init_events_type(DB_EVENT_QUE_LOCKFREE);
+    testOk1(ctx != NULL);
+    testOk1(db_start_events(ctx, "testEvents", NULL, NULL,
+                            epicsThreadPriorityLow) == DB_EVENT_OK);
+
+    for (i = 0; i < NMONITORS; i++) {
+        chan[i] = dbChannelCreate("x.VAL");
+        dbChannelOpen(chan[i]);
+        sub[i] = db_add_event(ctx, chan[i], countEvents, NULL, DBE_VALUE);
+        n += sub[i] != NULL;
+        db_event_enable(sub[i]);
+    }
+    testOk(n == NMONITORS, "added %u subscriptions", n);
+
+    testdbPutFieldOk("x.VAL", DBF_LONG, 3);
+
+    while (TRUE) {
+        epicsMutexMustLock(lock);
+        n = count;
+        epicsMutexUnlock(lock);
+        if (n >= NMONITORS)
+            break;
+        epicsEventMustWait(delivered);
+    }
+    testOk(n == NMONITORS, "all subscriptions saw one event (%u)", n);
+
+    for (i = 0; i < NMONITORS; i++) {
+        db_event_disable(sub[i]);
+        db_cancel_event(sub[i]);
+        dbChannelDelete(chan[i]);
+    }
+    db_close_events(ctx);
+
+    epicsEventDestroy(delivered);
+    epicsMutexDestroy(lock);
+}
+
+static void testDropCount(int queType)
+{
+    dbEventCtx ctx;
+    dbChannel *chan;
+    evSubscrip *sub;
+
+    testDiag("Test dropped event accounting in flow control mode (%s)",
+             queType == DB_EVENT_QUE_LOCKFREE ? "lock free" : "locked");
+
+    lock = epicsMutexMustCreate();
+    delivered = epicsEventMustCreate(epicsEventEmpty);
+    count = 0;
+
+    ctx = db_init_events_type(queType);
+    testOk1(ctx != NULL);
+    testOk1(db_start_events(ctx, "testEvents", NULL, NULL,
+                            epicsThreadPriorityLow) == DB_EVENT_OK);
+
+    chan = dbChannelCreate("x.VAL");
+    testOk1(chan && !dbChannelOpen(chan));
+
+    sub = (evSubscrip *) db_add_event(ctx, chan, countEvents, NULL, DBE_VALUE);
+    testOk1(sub != NULL);
+    db_event_enable(sub);
+
+    db_event_flow_ctrl_mode_on(ctx);
+
+    testdbPutFieldOk("x.VAL", DBF_LONG, 10);
+    testdbPutFieldOk("x.VAL", DBF_LONG, 11);
+    testdbPutFieldOk("x.VAL", DBF_LONG, 12);
+
+    testOk(sub->ndropped == 2, "two values dropped (%lu)", sub->ndropped);
+    testOk(sub->ncoalesced == 0, "none coalesced (%lu)", sub->ncoalesced);
+
+    db_event_flow_ctrl_mode_off(ctx);
+
+    epicsEventMustWait(delivered);
+    epicsMutexMustLock(lock);
+    testOk(count == 1, "one event delivered (%u)", count);
+    testOk(lastValue == 12, "latest value delivered (%d)", (int) lastValue);
+    epicsMutexUnlock(lock);
+
+    db_event_disable(sub);
+    db_cancel_event(sub);
+    dbChannelDelete(chan);
+    db_close_events(ctx);
+
+    epicsEventDestroy(delivered);
+    epicsMutexDestroy(lock);
+}
+
+static void testBatching(void)
+{
+    dbEventCtx ctx;
+    dbChannel *chan;
+    dbEventSubscription sub;
+    double wakeupRate, eventsPerWakeup;
+
+    testDiag("Test batched event delivery");
+
+    lock = epicsMutexMustCreate();
+    delivered = epicsEventMustCreate(epicsEventEmpty);
+    count = 0;
+
+    ctx = db_init_events();
+    db_event_set_batching(ctx, 10, 0.2);
+    testOk1(db_start_events(ctx, "testEvents", NULL, NULL,
+                            epicsThreadPriorityLow) == DB_EVENT_OK);
+
+    chan = dbChannelCreate("x.VAL");
+    dbChannelOpen(chan);
+    sub = db_add_event(ctx, chan, countEvents, NULL, DBE_VALUE);
+    db_event_enable(sub);
+
+    testdbPutFieldOk("x.VAL", DBF_LONG, 20);
+    testdbPutFieldOk("x.VAL", DBF_LONG, 21);
+    testdbPutFieldOk("x.VAL", DBF_LONG, 22);
+
+    while (TRUE) {
+        unsigned n;
+        epicsMutexMustLock(lock);
+        n = count;
+        epicsMutexUnlock(lock);
+        if (n >= 3)
+            break;
+        epicsEventMustWait(delivered);
+    }
+
+    db_event_stats(ctx, &wakeupRate, &eventsPerWakeup);
+    testOk(wakeupRate > 0.0, "wakeup rate %.2f/s", wakeupRate);
+    testOk(eventsPerWakeup > 1.0, "%.1f events per wakeup", eventsPerWakeup);
+
+    /* start a new interval, then deliver one event in it */
+    epicsThreadSleep(1.05);
+    db_event_stats(ctx, &wakeupRate, &eventsPerWakeup);
+    epicsMutexMustLock(lock);
+    count = 0;
+    epicsMutexUnlock(lock);
+    testdbPutFieldOk("x.VAL", DBF_LONG, 23);
+    while (TRUE) {
+        unsigned n;
+        epicsMutexMustLock(lock);
+        n = count;
+        epicsMutexUnlock(lock);
+        if (n >= 1)
+            break;
+        epicsEventMustWait(delivered);
+    }
+    epicsThreadSleep(1.05);
+    db_event_stats(ctx, &wakeupRate, &eventsPerWakeup);
+    testOk(eventsPerWakeup <= 1.0,
+           "%.1f events per wakeup since the previous call", eventsPerWakeup);
+
+    db_event_disable(sub);
+    db_cancel_event(sub);
+    dbChannelDelete(chan);
+    db_close_events(ctx);
+
+    epicsEventDestroy(delivered);
+    epicsMutexDestroy(lock);
+}
+
+static void testPooled(void)
+{
+    dbEventCtx ctx[4];
+    dbChannel *chan[4];
+    dbEventSubscription sub[4];
+    unsigned i, n;
+
+    testDiag("Test event contexts served by the event pool");
+
+    lock = epicsMutexMustCreate();
+    delivered = epicsEventMustCreate(epicsEventEmpty);
+    count = 0;
+
+    for (i = 0; i < 4; i++) {
+        ctx[i] = db_init_events();
+        testOk1(db_start_events_pooled(ctx[i],
+                                       epicsThreadPriorityLow) == DB_EVENT_OK);
+        chan[i] = dbChannelCreate("x.VAL");
+        dbChannelOpen(chan[i]);
+        sub[i] = db_add_event(ctx[i], chan[i], countEvents, NULL, DBE_VALUE);
+        db_event_enable(sub[i]);
+    }
+
+    testdbPutFieldOk("x.VAL", DBF_LONG, 30);
+
+    while (TRUE) {
+        epicsMutexMustLock(lock);
+        n = count;
+        epicsMutexUnlock(lock);
+        if (n >= 4)
+            break;
+        epicsEventMustWait(delivered);
+    }
+    testOk(n == 4, "all pooled contexts saw one event (%u)", n);
+    testOk1(epicsThreadGetId("dbEventPool-0") != NULL);
+
+    for (i = 0; i < 4; i++) {
+        db_event_disable(sub[i]);
+        db_cancel_event(sub[i]);
+        dbChannelDelete(chan[i]);
+        db_close_events(ctx[i]);
+    }
+    testPass("pooled contexts closed");
+    testOk(epicsThreadGetId("dbEventPool-0") == NULL,
+           "pool threads joined with the last pooled context");
+
+    epicsEventDestroy(delivered);
+    epicsMutexDestroy(lock);
+}
+
+static dbEventSnapshot *snaps[2];
+static unsigned nFills;
+
+static int fillCopy(void *pbuf, size_t size, void *arg)
+{
+    nFills++;
+    memcpy(pbuf, arg, size);
+    return 0;
+}
+
+static void snapEvents(void *user_arg, struct dbChannel *chan,
+                       int eventsRemaining, struct db_field_log *pfl)
+{
+    int i = *(int *)user_arg;
+
+    epicsMutexMustLock(lock);
+    snaps[i] = db_field_log_snapshot(pfl);
+    if (snaps[i]) {
+        const double *pval = pfl->u.r.field;
+        const void *pd1, *pd2;
+
+        /* the first subscriber fills, the second finds it cached */
+        pd1 = db_snapshot_derived(snaps[i], DBR_DOUBLE, 2,
+                                  2 * sizeof(double), fillCopy, (void *)pval);
+        pd2 = db_snapshot_derived(snaps[i], DBR_DOUBLE, 2,
+                                  2 * sizeof(double), fillCopy, (void *)pval);
+        if (pd1 != pd2 || pfl->no_elements != NSNAP ||
+            pval[0] != 1.0 || pval[NSNAP - 1] != NSNAP)
+            snaps[i] = NULL;
+    }
+    count++;
+    epicsMutexUnlock(lock);
+    epicsEventMustTrigger(delivered);
+}
+
+static void testSnapshot(void)
+{
+    static const int index[2] = {0, 1};
+    static double buf[NSNAP];
+    dbEventCtx ctx;
+    dbChannel *chan[2];
+    dbEventSubscription sub[2];
+    dbCommon *prec = testdbRecordPtr("arr");
+    unsigned i, n;
+
+    testDiag("Test large arrays posted as shared snapshots");
+    testOk1(dbEventSnapshotBytes == 0);
+    dbEventSnapshotBytes = 16384;
+
+    lock = epicsMutexMustCreate();
+    delivered = epicsEventMustCreate(epicsEventEmpty);
+    count = 0;
+    nFills = 0;
+    snaps[0] = snaps[1] = NULL;
+
+    for (i = 0; i < NSNAP; i++)
+        buf[i] = i + 1;
+    testdbPutArrFieldOk("arr", DBR_DOUBLE, NSNAP, buf);
+
+    ctx = db_init_events();
+    testOk1(db_start_events(ctx, "testEvents", NULL, NULL,
+                            epicsThreadPriorityLow) == DB_EVENT_OK);
+    for (i = 0; i < 2; i++) {
+        chan[i] = dbChannelCreate("arr");
+        dbChannelOpen(chan[i]);
+        sub[i] = db_add_event(ctx, chan[i], snapEvents, (void *)&index[i],
+                              DBE_VALUE);
+        db_event_enable(sub[i]);
+    }
+
+    dbScanLock(prec);
+    db_post_events(prec, ((struct arrRecord *)prec)->bptr, DBE_VALUE);
+    dbScanUnlock(prec);
+
+    while (TRUE) {
+        epicsMutexMustLock(lock);
+        n = count;
+        epicsMutexUnlock(lock);
+        if (n >= 2)
+            break;
+        epicsEventMustWait(delivered);
+    }
+    testOk(snaps[0] != NULL, "update was posted as a snapshot");
+    testOk(snaps[0] == snaps[1], "both subscriptions share it");
+    testOk(nFills == 1, "derived data was filled once (%u)", nFills);
+
+    /* nothing to share with one subscription */
+    db_event_disable(sub[1]);
+    epicsMutexMustLock(lock);
+    count = 0;
+    epicsMutexUnlock(lock);
+    snaps[0] = NULL;
+    dbScanLock(prec);
+    db_post_events(prec, ((struct arrRecord *)prec)->bptr, DBE_VALUE);
+    dbScanUnlock(prec);
+    while (TRUE) {
+        epicsMutexMustLock(lock);
+        n = count;
+        epicsMutexUnlock(lock);
+        if (n >= 1)
+            break;
+        epicsEventMustWait(delivered);
+    }
+    testOk(snaps[0] == NULL, "a single subscription reads the record");
+
+    for (i = 0; i < 2; i++) {
+        db_event_disable(sub[i]);
+        db_cancel_event(sub[i]);
+        dbChannelDelete(chan[i]);
+    }
+    db_close_events(ctx);
+    dbEventSnapshotBytes = 0;
+
+    epicsEventDestroy(delivered);
+    epicsMutexDestroy(lock);
+}
+
+MAIN(dbEventTest)
+{
+    testPlan(55);
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    testdbReadDatabase("xRecord.db", NULL, NULL);
+    testdbReadDatabase("dbEventTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testManySubscriptions();
+    testManyLockFree();
+    testDropCount(DB_EVENT_QUE_LOCKED);
+    testDropCount(DB_EVENT_QUE_LOCKFREE);
+    testBatching();
+    testPooled();
+    testSnapshot();
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+
+    return testDone();
+}
@@ -0,0 +1,178 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure process variable directory lookup rates
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cantProceed.h"
+#include "dbBase.h"
+#include "dbStaticLib.h"
+#include "dbStaticPvt.h"
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsString.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NLOOKUPS 2000000
+#define MAXTHREADS 4
+
+typedef struct {
+    dbBase *pdbbase;
+    char **names;
+    size_t *lens;
+    unsigned nrecs;
+    unsigned start;
+    unsigned found;
+} lookupJob;
+
+static epicsEventId jobDone;
+static int jobsRunning;
+
+static void lookupRun(lookupJob *job)
+{
+    unsigned i, j = job->start, nfound = 0;
+
+    for (i = 0; i < NLOOKUPS; i++) {
+        nfound += dbPvdFind(job->pdbbase, job->names[j], job->lens[j]) != NULL;
+        /* stride through the names to defeat the cache */
+        j = (j + 7919) % job->nrecs;
+    }
+    job->found = nfound;
+}
+
+static void lookupThread(void *arg)
+{
+    lookupRun((lookupJob *)arg);
+    if (!epicsAtomicDecrIntT(&jobsRunning))
+        epicsEventMustTrigger(jobDone);
+}
+
+static double runLookups(dbBase *pdbbase, char **names, size_t *lens,
+    unsigned nrecs, int nthreads)
+{
+    lookupJob job[MAXTHREADS];
+    epicsTimeStamp start, end;
+    int i;
+
+    for (i = 0; i < nthreads; i++) {
+        job[i].pdbbase = pdbbase;
+        job[i].names = names;
+        job[i].lens = lens;
+        job[i].nrecs = nrecs;
+        job[i].start = (nrecs / nthreads) * i;
+        job[i].found = 0;
+    }
+
+    epicsTimeGetCurrent(&start);
+    if (nthreads == 1) {
+        lookupRun(&job[0]);
+    }
+    else {
+        epicsAtomicSetIntT(&jobsRunning, nthreads);
+        for (i = 0; i < nthreads; i++)
+            epicsThreadMustCreate("pvdLookup", epicsThreadPriorityMedium,
+                epicsThreadGetStackSize(epicsThreadStackSmall),
+                lookupThread, &job[i]);
+        epicsEventMustWait(jobDone);
+    }
+    epicsTimeGetCurrent(&end);
+
+    for (i = 0; i < nthreads; i++) {
+        if (job[i].found != NLOOKUPS)
+            testDiag("thread %d found %u of %u", i, job[i].found, NLOOKUPS);
+    }
+    return nthreads * (double) NLOOKUPS / epicsTimeDiffInSeconds(&end, &start);
+}
+
+static void runBench(unsigned nrecs)
+{
+    dbBase *pdbbase = callocMustSucceed(1, sizeof(dbBase), "runBench");
+    dbRecordNode *nodes = callocMustSucceed(nrecs, sizeof(dbRecordNode),
+        "runBench");
+    char **names = callocMustSucceed(nrecs, sizeof(char *), "runBench");
+    size_t *lens = callocMustSucceed(nrecs, sizeof(size_t), "runBench");
+    epicsTimeStamp start, end;
+    unsigned i, nadded = 0, nfound = 0;
+    int nthreads;
+
+    testDiag("Directory with %u records", nrecs);
+
+    for (i = 0; i < nrecs; i++) {
+        char buf[40];
+
+        sprintf(buf, "BENCH:SECT%02u:DEV%04u:SIG%u", i % 97, i / 97, i);
+        names[i] = epicsStrDup(buf);
+        lens[i] = strlen(buf);
+        nodes[i].recordname = names[i];
+    }
+
+    dbPvdInitPvt(pdbbase);
+
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < nrecs; i++)
+        nadded += dbPvdAdd(pdbbase, NULL, &nodes[i]) != NULL;
+    epicsTimeGetCurrent(&end);
+    testOk(nadded == nrecs, "Added %u records in %.3f sec",
+        nadded, epicsTimeDiffInSeconds(&end, &start));
+
+    for (i = 0; i < nrecs; i++) {
+        PVDENTRY *ppvd = dbPvdFind(pdbbase, names[i], lens[i]);
+
+        nfound += ppvd && ppvd->precnode == &nodes[i];
+    }
+    testOk(nfound == nrecs, "Found %u records", nfound);
+    testOk1(!dbPvdFind(pdbbase, "BENCH:NONE", 10));
+
+    for (nthreads = 1; nthreads <= MAXTHREADS; nthreads *= 2)
+        testDiag("%d thread%s: %.3g lookups/sec", nthreads,
+            nthreads > 1 ? "s" : "",
+            runLookups(pdbbase, names, lens, nrecs, nthreads));
+
+    if (nrecs <= 1000) {
+        testDiag("Delete and re-add every other record");
+        for (i = 0; i < nrecs; i += 2)
+            dbPvdDelete(pdbbase, &nodes[i]);
+        for (i = 0, nfound = 0; i < nrecs; i++)
+            nfound += dbPvdFind(pdbbase, names[i], lens[i]) != NULL;
+        testOk(nfound == nrecs / 2, "Found %u records after delete", nfound);
+        for (i = 0, nadded = 0; i < nrecs; i += 2)
+            nadded += dbPvdAdd(pdbbase, NULL, &nodes[i]) != NULL;
+        testOk(nadded == nrecs / 2, "Re-added %u records", nadded);
+    }
+
+    dbPvdDump(pdbbase, 0);
+    dbPvdFreeMem(pdbbase);
+
+    for (i = 0; i < nrecs; i++)
+        free(names[i]);
+    free(lens);
+    free(names);
+    free(nodes);
+    free(pdbbase);
+}
+
+MAIN(dbPvdBench)
+{
+    testPlan(11);
+
+    jobDone = epicsEventMustCreate(epicsEventEmpty);
+
+    runBench(1000);
+    runBench(100000);
+    runBench(1000000);
+
+    epicsEventDestroy(jobDone);
+
+    return testDone();
+}
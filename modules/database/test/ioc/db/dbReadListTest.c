@@ -0,0 +1,183 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Check that dbLoadRecords() calls queued by dbLoadRecordsBegin() load
+ * the same records in the same order as unqueued calls.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <errlog.h>
+#include <envDefs.h>
+#include <osiUnistd.h>
+#include <dbAccess.h>
+#include <dbStaticLib.h>
+#include <dbUnitTest.h>
+#include <testMain.h>
+
+#define NFILES 40
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static char expected[NFILES + 1][80];
+static int nexpected;
+static int hookCalls;
+static int hookOrdered;
+
+static void hook(const char *file, const char *subs)
+{
+    if (hookCalls >= nexpected || strcmp(subs + 4, expected[hookCalls]))
+        hookOrdered = 0;
+    hookCalls++;
+}
+
+static void load(const char *prefix)
+{
+    char subs[80];
+    int i;
+
+    nexpected = 0;
+    hookCalls = 0;
+    hookOrdered = 1;
+    for (i = 0; i < NFILES; i++) {
+        sprintf(subs, "P=%s,N=%d,M=%d,D=desc %d", prefix, i,
+            (i + 1) % NFILES, i);
+        strcpy(expected[nexpected++], subs + 4);
+        dbLoadRecords("dbReadListTest.db", subs);
+    }
+    sprintf(subs, "P=%s,N=i,D=included", prefix);
+    strcpy(expected[nexpected++], subs + 4);
+    dbLoadRecords("dbReadListInc.db", subs);
+    sprintf(subs, "P=%s,N=u", prefix);
+    dbLoadRecords("dbReadListMissing.db", subs);
+    /* Fails on the undefined macro in DESC, after creating the record */
+    dbLoadRecords("dbReadListTest.db", subs);
+}
+
+static void getField(const char *rec, const char *field, char *buf)
+{
+    DBENTRY entry;
+
+    dbInitEntry(pdbbase, &entry);
+    buf[0] = '\0';
+    if (!dbFindRecord(&entry, rec) && !dbFindField(&entry, field))
+        strcpy(buf, dbGetString(&entry));
+    dbFinishEntry(&entry);
+}
+
+static void testSame(void)
+{
+    DBENTRY entry;
+    char sname[NFILES + 4][40], bname[NFILES + 4][40];
+    int ns = 0, nb = 0, ordered = 1;
+    long status;
+    int i;
+
+    dbInitEntry(pdbbase, &entry);
+    dbFindRecordType(&entry, "x");
+    for (status = dbFirstRecord(&entry); !status;
+         status = dbNextRecord(&entry)) {
+        const char *name = dbGetRecordName(&entry);
+
+        if (strncmp(name, "s:", 2) == 0 && ns < NFILES + 4)
+            strcpy(sname[ns++], name + 2);
+        else if (strncmp(name, "b:", 2) == 0 && nb < NFILES + 4)
+            strcpy(bname[nb++], name + 2);
+    }
+    dbFinishEntry(&entry);
+
+    testOk(ns == NFILES + 3 && nb == ns, "Loaded %d and %d records", ns, nb);
+    for (i = 0; i < ns && i < nb; i++)
+        if (strcmp(sname[i], bname[i]))
+            ordered = 0;
+    testOk(ordered, "Records created in the same order");
+
+    for (i = 0; i < ns; i++) {
+        char srec[44], brec[44], sdesc[80], bdesc[80], sinp[80], binp[80];
+
+        sprintf(srec, "s:%.40s", sname[i]);
+        sprintf(brec, "b:%.40s", sname[i]);
+        getField(srec, "DESC", sdesc);
+        getField(brec, "DESC", bdesc);
+        getField(srec, "INP", sinp);
+        getField(brec, "INP", binp);
+        testOk(strcmp(sdesc, bdesc) == 0 && strlen(sinp) == strlen(binp) &&
+               strcmp(sinp + !!sinp[0], binp + !!binp[0]) == 0,
+               "%s DESC \"%s\" INP \"%s\"", brec, bdesc, binp);
+    }
+}
+
+MAIN(dbReadListTest)
+{
+    char desc[80];
+    char dir[1024];
+
+    testPlan(NFILES + 23);
+    testdbPrepare();
+    epicsEnvSet("EPICS_DB_INCLUDE_PATH", ".:..");
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    dbLoadRecordsHook = hook;
+
+    testDiag("Unqueued");
+    load("s:");
+    testOk(hookCalls == nexpected && hookOrdered,
+        "Hook called for %d files in order", hookCalls);
+
+    testDiag("Queued");
+    testOk(dbLoadRecordsBegin(3) == 0, "dbLoadRecordsBegin(3)");
+    testOk(dbLoadRecordsBegin(3) != 0, "dbLoadRecordsBegin() again fails");
+    load("b:");
+    testOk(hookCalls == 0, "Nothing loaded before dbLoadRecordsEnd()");
+    testOk(dbLoadRecordsEnd() != 0, "dbLoadRecordsEnd() reports failures");
+    testOk(hookCalls == nexpected && hookOrdered,
+        "Hook called for %d files in order", hookCalls);
+    testOk(dbLoadRecordsEnd() == 0, "dbLoadRecordsEnd() again does nothing");
+
+    testSame();
+    getField("b:rec3", "DESC", desc);
+    testOk(strcmp(desc, "desc 3") == 0, "b:rec3.DESC is \"%s\"", desc);
+
+    testDiag("Environment and directory changed while queued");
+    dbLoadRecordsHook = NULL;
+    testOk(dbLoadRecordsBegin(2) == 0, "dbLoadRecordsBegin(2)");
+    epicsEnvSet("DBRL_FILE", "dbReadListTest.db");
+    dbLoadRecords("$(DBRL_FILE)", "P=e:,N=1,D=first");
+    epicsEnvSet("DBRL_FILE", "dbReadListInc.db");
+    dbLoadRecords("$(DBRL_FILE)", "P=e:,N=2,D=second");
+    /* Neither file can be found from there */
+    testOk(getcwd(dir, sizeof(dir)) && chdir("../..") == 0,
+        "Changed directory to ../..");
+    testOk(dbLoadRecordsEnd() == 0, "dbLoadRecordsEnd()");
+    if (chdir(dir))
+        testAbort("Can't change back to %s", dir);
+    getField("e:rec1", "DESC", desc);
+    testOk(strcmp(desc, "first") == 0, "e:rec1.DESC is \"%s\"", desc);
+    getField("e:rec2", "DESC", desc);
+    testOk(strcmp(desc, "second") == 0, "e:rec2.DESC is \"%s\"", desc);
+    getField("e:inc", "DESC", desc);
+    testOk(strcmp(desc, "second") == 0, "e:inc.DESC is \"%s\"", desc);
+
+    testDiag("Queue left open at iocInit");
+    testOk(dbLoadRecordsBegin(0) == 0, "dbLoadRecordsBegin(0)");
+    dbLoadRecords("dbReadListTest.db", "P=i:,N=0,D=init");
+    getField("i:rec0", "DESC", desc);
+    testOk(desc[0] == '\0', "i:rec0 not yet loaded");
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+    getField("i:rec0", "DESC", desc);
+    testOk(strcmp(desc, "init") == 0, "iocInit loaded i:rec0, DESC \"%s\"",
+        desc);
+    testOk(testdbRecordPtr("b:inc") != NULL, "b:inc from include file");
+
+    testIocShutdownOk();
+    testdbCleanup();
+    return testDone();
+}
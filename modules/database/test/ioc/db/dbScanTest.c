@@ -12,13 +12,16 @@
 #include <string.h>
 
 #include "dbScan.h"
+#include "dbLock.h"
 #include "epicsEvent.h"
+#include "epicsThread.h"
 
 #include "dbUnitTest.h"
 #include "testMain.h"
 
 #include "dbAccess.h"
 #include "errlog.h"
+#include "xRecord.h"
 
 void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
 
@@ -65,9 +68,91 @@ static void testOnce(void)
     epicsEventDestroy(waiter);
 }
 
+#define NPERIODIC 6
+
+static const char *periodicNames[NPERIODIC] = {"a1", "a2", "b", "c", "d", "e"};
+static xRecord *periodicRecs[NPERIODIC];
+static epicsThreadId periodicThread[NPERIODIC];
+static int periodicCount[NPERIODIC];
+static int orderErrors;
+
+static void periodicProcess(xRecord *prec)
+{
+    int i;
+
+    for (i = 0; i < NPERIODIC; i++) {
+        if (prec == periodicRecs[i]) {
+            if (periodicThread[i] && periodicThread[i] != epicsThreadGetIdSelf())
+                testDiag("%s processed by a different thread", prec->name);
+            periodicThread[i] = epicsThreadGetIdSelf();
+            periodicCount[i]++;
+        }
+    }
+    /* a1 and a2 are in one lockset, a1 comes first in each pass */
+    if (prec == periodicRecs[1] && periodicCount[0] != periodicCount[1])
+        orderErrors++;
+}
+
+static void testPeriodicThreads(void)
+{
+    int i, processed = 0, threads = 0;
+
+    testDiag("check periodic scan divided between threads");
+
+    testdbPrepare();
+
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("dbScanTest.db", NULL, NULL);
+
+    testOk1(scanPeriodicThreads(3, 0.1) == 0);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testOk1(scanPeriodicThreads(2, 0.1) == -1);
+
+    for (i = 0; i < NPERIODIC; i++) {
+        periodicRecs[i] = (xRecord *)testdbRecordPtr(periodicNames[i]);
+    }
+    testOk1(dbLockGetLockId((dbCommon *)periodicRecs[0]) ==
+            dbLockGetLockId((dbCommon *)periodicRecs[1]));
+    /* locking a1 also locks a2 */
+    for (i = 1; i < NPERIODIC; i++) {
+        dbScanLock((dbCommon *)periodicRecs[i]);
+        periodicRecs[i]->clbk = periodicProcess;
+        if (i == 1)
+            periodicRecs[0]->clbk = periodicProcess;
+        dbScanUnlock((dbCommon *)periodicRecs[i]);
+    }
+
+    epicsThreadSleep(0.55);
+    scanppl(0.1);
+
+    testIocShutdownOk();
+
+    for (i = 0; i < NPERIODIC; i++) {
+        int j;
+
+        processed += periodicCount[i] > 0;
+        for (j = 0; j < i && periodicThread[j] != periodicThread[i]; j++) ;
+        threads += j == i;
+    }
+    testOk(processed == NPERIODIC, "%d of %d records processed",
+           processed, NPERIODIC);
+    testOk(periodicThread[0] == periodicThread[1],
+           "records of one lockset processed by one thread");
+    testOk(orderErrors == 0, "%d lockset order errors", orderErrors);
+    testOk(threads > 1, "records processed by %d threads", threads);
+
+    testdbCleanup();
+}
+
 MAIN(dbScanTest)
 {
-    testPlan(3);
+    testPlan(10);
     testOnce();
+    testPeriodicThreads();
     return testDone();
 }
@@ -0,0 +1,183 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Check that a database snapshot reloads the same records, aliases, field
+ * values and info items, and that bad snapshots are rejected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <errlog.h>
+#include <epicsString.h>
+#include <dbAccess.h>
+#include <dbStaticLib.h>
+#include <dbUnitTest.h>
+#include <testMain.h>
+
+#define SNAPFILE "dbSnapshotTest.snap"
+#define BADFILE "dbSnapshotTestBad.snap"
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+epicsShareExtern int dbRecordsAbcSorted;
+
+static void prepare(int changeDbd)
+{
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    if (changeDbd)
+        testdbReadDatabase("dbSnapshotTest.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+}
+
+static void testField(const char *rec, const char *field, const char *value)
+{
+    DBENTRY entry;
+    const char *str = "<none>";
+
+    dbInitEntry(pdbbase, &entry);
+    if (!dbFindRecord(&entry, rec) && !dbFindField(&entry, field))
+        str = dbGetString(&entry);
+    testOk(str && strcmp(str, value) == 0, "%s.%s is \"%s\"", rec, field,
+        str ? str : "(null)");
+    dbFinishEntry(&entry);
+}
+
+static void testRecords(void)
+{
+    DBENTRY entry;
+    const char *info = NULL;
+
+    testField("snap:a", "DESC", "first record");
+    testField("snap:a", "VAL", "42");
+    testField("snap:a", "SCAN", "1 second");
+    testField("snap:a", "PHAS", "3");
+    testField("snap:a", "INP", "snap:b.VAL CP MS");
+    testField("snap:b", "LNK", "5");
+    testField("snap:b", "TPRO", "1");
+    testField("snap:c", "DESC", "");
+    testField("snap:c", "SCAN", "Passive");
+    testField("snap:alias", "DESC", "first record");
+    testField("snap:balias", "TPRO", "1");
+
+    dbInitEntry(pdbbase, &entry);
+    if (!dbFindRecord(&entry, "snap:a") &&
+        !dbFindInfo(&entry, "snapInfo"))
+        info = dbGetInfoString(&entry);
+    testOk(info && strcmp(info, "some value") == 0, "snap:a info \"%s\"",
+        info ? info : "(null)");
+    testOk(!dbFindRecord(&entry, "snap:alias") && dbIsAlias(&entry),
+        "snap:alias is an alias");
+    testOk(!dbFindRecord(&entry, "snap:0c") && dbIsAlias(&entry),
+        "snap:0c is an alias");
+    dbFinishEntry(&entry);
+}
+
+/* As if the DBD gave x.DESC another initial value */
+static void changeInitial(void)
+{
+    DBENTRY entry;
+    long status;
+
+    dbInitEntry(pdbbase, &entry);
+    if (dbFindRecordType(&entry, "x"))
+        testAbort("No record type x");
+    for (status = dbFirstField(&entry, 0); !status &&
+         strcmp(dbGetFieldName(&entry), "DESC");
+         status = dbNextField(&entry, 0));
+    if (status)
+        testAbort("No x.DESC field");
+    free(entry.pflddes->initial);
+    entry.pflddes->initial = epicsStrDup("changed");
+    dbFinishEntry(&entry);
+}
+
+/* Copy the snapshot, changing the byte at offset, or truncating it */
+static void copyBad(long offset, int truncate)
+{
+    FILE *in = fopen(SNAPFILE, "rb");
+    FILE *out = fopen(BADFILE, "wb");
+    long pos = 0;
+    int c;
+
+    if (!in || !out)
+        testAbort("Can't copy " SNAPFILE);
+    while ((c = getc(in)) != EOF) {
+        if (pos == offset) {
+            if (truncate)
+                break;
+            c ^= 0x20;
+        }
+        putc(c, out);
+        pos++;
+    }
+    fclose(in);
+    fclose(out);
+}
+
+MAIN(dbSnapshotTest)
+{
+    testPlan(25);
+
+    testDiag("Save");
+    prepare(0);
+    /* so the alias snap:0c comes before its record */
+    dbRecordsAbcSorted = 1;
+    testdbReadDatabase("dbSnapshotTest.db", NULL, NULL);
+    dbRecordsAbcSorted = 0;
+    testOk(dbWriteSnapshot(pdbbase, SNAPFILE) == 0, "dbWriteSnapshot()");
+    testdbCleanup();
+
+    testDiag("Load");
+    prepare(0);
+    testOk(dbReadSnapshot(pdbbase, SNAPFILE) == 0, "dbReadSnapshot()");
+    testRecords();
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+    testdbGetFieldEqual("snap:a.DESC", DBR_STRING, "first record");
+    testdbGetFieldEqual("snap:balias.VAL", DBR_LONG, 0);
+    eltc(0);
+    testOk(dbWriteSnapshot(pdbbase, BADFILE) != 0,
+        "dbWriteSnapshot() fails after iocInit");
+    eltc(1);
+    testIocShutdownOk();
+    testdbCleanup();
+
+    testDiag("Rejected snapshots");
+    prepare(0);
+    eltc(0);
+    testOk(dbReadSnapshot(pdbbase, "dbSnapshotTestMissing.snap") != 0,
+        "Missing file");
+    copyBad(0, 0);
+    testOk(dbReadSnapshot(pdbbase, BADFILE) != 0, "Bad magic");
+    copyBad(60, 0);
+    testOk(dbReadSnapshot(pdbbase, BADFILE) != 0, "Corrupt body");
+    copyBad(60, 1);
+    testOk(dbReadSnapshot(pdbbase, BADFILE) != 0, "Truncated body");
+    eltc(1);
+    testdbCleanup();
+
+    prepare(1);
+    eltc(0);
+    testOk(dbReadSnapshot(pdbbase, SNAPFILE) != 0, "Different DBD");
+    eltc(1);
+    testdbCleanup();
+
+    prepare(0);
+    changeInitial();
+    eltc(0);
+    testOk(dbReadSnapshot(pdbbase, SNAPFILE) != 0,
+        "Different field initial value");
+    eltc(1);
+    testdbCleanup();
+
+    remove(BADFILE);
+    remove(SNAPFILE);
+    return testDone();
+}
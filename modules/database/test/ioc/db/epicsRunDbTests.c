@@ -19,6 +19,7 @@
 int testdbConvert(void);
 int callbackTest(void);
 int callbackParallelTest(void);
+int callbackStealTest(void);
 int dbStateTest(void);
 int dbServerTest(void);
 int dbCaStatsTest(void);
@@ -28,8 +29,11 @@ int scanIoTest(void);
 int dbLockTest(void);
 int dbPutLinkTest(void);
 int dbStaticTest(void);
+int dbReadListTest(void);
+int dbSnapshotTest(void);
 int dbCaLinkTest(void);
 int testDbChannel(void);
+int dbEventTest(void);
 int chfPluginTest(void);
 int arrShorthandTest(void);
 int recGblCheckDeadbandTest(void);
@@ -41,6 +45,7 @@ void epicsRunDbTests(void)
     runTest(testdbConvert);
     runTest(callbackTest);
     runTest(callbackParallelTest);
+    runTest(callbackStealTest);
     runTest(dbStateTest);
     runTest(dbServerTest);
     runTest(dbCaStatsTest);
@@ -50,8 +55,11 @@ void epicsRunDbTests(void)
     runTest(dbLockTest);
     runTest(dbPutLinkTest);
     runTest(dbStaticTest);
+    runTest(dbReadListTest);
+    runTest(dbSnapshotTest);
     runTest(dbCaLinkTest);
     runTest(testDbChannel);
+    runTest(dbEventTest);
     runTest(arrShorthandTest);
     runTest(recGblCheckDeadbandTest);
     runTest(chfPluginTest);
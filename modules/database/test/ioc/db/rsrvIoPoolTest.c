@@ -0,0 +1,129 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Runs the CA server with rsrvIoThreads > 0 and checks that a client
+ * served by the I/O thread pool can get, put and monitor a record.
+ */
+
+#include <string.h>
+
+#include "cadef.h"
+#include "dbUnitTest.h"
+#include "envDefs.h"
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "errlog.h"
+#include "iocInit.h"
+#include "rsrv.h"
+#include "testMain.h"
+
+#define CA_SERVER_PORT "65533"
+
+struct dbBase;
+
+/* From dbAccessDefs.h, which can't be included with cadef.h */
+epicsShareExtern struct dbBase *pdbbase;
+
+void dbTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static epicsEventId update;
+static int lastValue; /* set by monitorCallback() */
+
+static void monitorCallback(struct event_handler_args args)
+{
+    if (args.status == ECA_NORMAL && args.type == DBR_LONG)
+        lastValue = *(const dbr_long_t *) args.dbr;
+    epicsEventMustTrigger(update);
+}
+
+static int waitValue(int value)
+{
+    while (lastValue != value) {
+        if (epicsEventWaitWithTimeout(update, 10.0) != epicsEventWaitOK)
+            break;
+    }
+    return lastValue;
+}
+
+MAIN(rsrvIoPoolTest)
+{
+    chid chan;
+    evid mon;
+    dbr_long_t val = 0;
+    unsigned nChan, nConn;
+
+    testPlan(10);
+
+    update = epicsEventMustCreate(epicsEventEmpty);
+
+    epicsEnvSet("EPICS_CA_SERVER_PORT", CA_SERVER_PORT);
+    epicsEnvSet("EPICS_CAS_INTF_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_ADDR_LIST", "127.0.0.1");
+    epicsEnvSet("EPICS_CA_AUTO_ADDR_LIST", "NO");
+
+    /* Created before iocInit() installs the database CA service, so this
+     * client reaches the records through the server */
+    testOk1(ca_context_create(ca_enable_preemptive_callback) == ECA_NORMAL);
+
+    testOk(rsrvIoSendTimeout == 0.0, "send timeout is off by default");
+    rsrvIoThreads = 2;
+
+    testdbPrepare();
+    testdbReadDatabase("dbTestIoc.dbd", NULL, NULL);
+    dbTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("xRecord.db", NULL, NULL);
+    rsrv_register_server();
+
+    eltc(0);
+    testOk1(iocInit() == 0);
+    eltc(1);
+
+#ifdef __linux__
+    testOk(epicsThreadGetId("CAS-io") != NULL, "I/O pool threads started");
+#else
+    testSkip(1, "I/O pool is only available on Linux");
+#endif
+
+    testOk1(ca_create_channel("x", NULL, NULL, CA_PRIORITY_DEFAULT, &chan)
+        == ECA_NORMAL && ca_pend_io(10.0) == ECA_NORMAL);
+
+    val = 42;
+    ca_put(DBR_LONG, chan, &val);
+    val = 0;
+    ca_get(DBR_LONG, chan, &val);
+    ca_pend_io(10.0);
+    testOk(val == 42, "got %d back after a put of 42", (int) val);
+
+    testOk1(ca_create_subscription(DBR_LONG, 1, chan, DBE_VALUE,
+        monitorCallback, NULL, &mon) == ECA_NORMAL);
+    ca_flush_io();
+    testOk(waitValue(42) == 42, "initial update %d", lastValue);
+
+    val = 7;
+    ca_put(DBR_LONG, chan, &val);
+    ca_flush_io();
+    testOk(waitValue(7) == 7, "update %d after a put of 7", lastValue);
+
+    casStatsFetch(&nChan, &nConn);
+#ifdef __linux__
+    testOk(nConn == 1 && nChan == 1 && !epicsThreadGetId("CAS-client"),
+        "%u client with %u channel served by the pool", nConn, nChan);
+#else
+    testOk(nConn == 1 && nChan == 1, "%u client with %u channel",
+        nConn, nChan);
+#endif
+
+    ca_clear_subscription(mon);
+    ca_clear_channel(chan);
+    ca_context_destroy();
+
+    /* the CA server can't be stopped, so leave the database loaded */
+    iocShutdown();
+
+    epicsEventDestroy(update);
+
+    return testDone();
+}
@@ -5,13 +5,35 @@
 #include "string.h"
 
 #include "cantProceed.h"
+#include "dbAddr.h"
 #include "dbConvert.h"
 #include "dbDefs.h"
+#include "dbFldTypes.h"
 #include "epicsAssert.h"
+#include "epicsTypes.h"
 
 #include "epicsUnitTest.h"
 #include "testMain.h"
 
+/* Numeric types, where DBF_x and DBR_x have the same value */
+static const struct {
+    const char *name;
+    short type;
+    short size;
+} numTypes[] = {
+    {"CHAR",   DBF_CHAR,   sizeof(epicsInt8)},
+    {"UCHAR",  DBF_UCHAR,  sizeof(epicsUInt8)},
+    {"SHORT",  DBF_SHORT,  sizeof(epicsInt16)},
+    {"USHORT", DBF_USHORT, sizeof(epicsUInt16)},
+    {"LONG",   DBF_LONG,   sizeof(epicsInt32)},
+    {"ULONG",  DBF_ULONG,  sizeof(epicsUInt32)},
+    {"INT64",  DBF_INT64,  sizeof(epicsInt64)},
+    {"UINT64", DBF_UINT64, sizeof(epicsUInt64)},
+    {"FLOAT",  DBF_FLOAT,  sizeof(epicsFloat32)},
+    {"DOUBLE", DBF_DOUBLE, sizeof(epicsFloat64)},
+    {"ENUM",   DBF_ENUM,   sizeof(epicsEnum16)},
+};
+
 static const short s_input[] = {-1,0,1,2,3,4,5};
 static const long s_input_len = NELEMENTS(s_input);
 
@@ -143,13 +165,117 @@ static void testBasicPut(void)
         memset(scratch, 0x42, sizeof(s_input));
     }
 
+    {
+        testDiag("Copy in w/ offset");
+
+        putter(&addr, s_input, 2, s_input_len, 1);
+
+        testOk1(scratch[1]==s_input[0] && scratch[2]==s_input[1]);
+        testOk1(scratch[0]==0x4242 && scratch[3]==0x4242);
+
+        memset(scratch, 0x42, sizeof(s_input));
+    }
+
+    {
+        testDiag("Copy in with wrap");
+
+        putter(&addr, s_input, 2, s_input_len, s_input_len-1);
+
+        testOk1(scratch[6]==s_input[0] && scratch[0]==s_input[1]);
+        testOk1(scratch[1]==0x4242);
+
+        memset(scratch, 0x42, sizeof(s_input));
+    }
+
     free(scratch);
 }
 
+static void setValue(short type, void *pbuf, size_t i, int value)
+{
+    switch (type) {
+    case DBF_CHAR:   ((epicsInt8 *) pbuf)[i] = value; break;
+    case DBF_UCHAR:  ((epicsUInt8 *) pbuf)[i] = value; break;
+    case DBF_SHORT:  ((epicsInt16 *) pbuf)[i] = value; break;
+    case DBF_USHORT: ((epicsUInt16 *) pbuf)[i] = value; break;
+    case DBF_LONG:   ((epicsInt32 *) pbuf)[i] = value; break;
+    case DBF_ULONG:  ((epicsUInt32 *) pbuf)[i] = value; break;
+    case DBF_INT64:  ((epicsInt64 *) pbuf)[i] = value; break;
+    case DBF_UINT64: ((epicsUInt64 *) pbuf)[i] = value; break;
+    case DBF_FLOAT:  ((epicsFloat32 *) pbuf)[i] = value; break;
+    case DBF_DOUBLE: ((epicsFloat64 *) pbuf)[i] = value; break;
+    case DBF_ENUM:   ((epicsEnum16 *) pbuf)[i] = value; break;
+    }
+}
+
+static int getValue(short type, const void *pbuf, size_t i)
+{
+    switch (type) {
+    case DBF_CHAR:   return ((const epicsInt8 *) pbuf)[i];
+    case DBF_UCHAR:  return ((const epicsUInt8 *) pbuf)[i];
+    case DBF_SHORT:  return ((const epicsInt16 *) pbuf)[i];
+    case DBF_USHORT: return ((const epicsUInt16 *) pbuf)[i];
+    case DBF_LONG:   return ((const epicsInt32 *) pbuf)[i];
+    case DBF_ULONG:  return ((const epicsUInt32 *) pbuf)[i];
+    case DBF_INT64:  return (int) ((const epicsInt64 *) pbuf)[i];
+    case DBF_UINT64: return (int) ((const epicsUInt64 *) pbuf)[i];
+    case DBF_FLOAT:  return (int) ((const epicsFloat32 *) pbuf)[i];
+    case DBF_DOUBLE: return (int) ((const epicsFloat64 *) pbuf)[i];
+    case DBF_ENUM:   return ((const epicsEnum16 *) pbuf)[i];
+    }
+    return -1;
+}
+
+/* Get and put every numeric pair through a circular buffer which wraps
+ * half way through the request.
+ */
+static void checkWrap(size_t nelem)
+{
+    size_t half = nelem / 2;
+    void *field = callocMustSucceed(nelem, sizeof(epicsFloat64), "checkWrap");
+    void *buf = callocMustSucceed(nelem, sizeof(epicsFloat64), "checkWrap");
+    unsigned badGet = 0, badPut = 0;
+    size_t f, r, i;
+    DBADDR addr;
+
+    for (f = 0; f < NELEMENTS(numTypes); f++) {
+        memset(&addr, 0, sizeof(addr));
+        addr.field_type = numTypes[f].type;
+        addr.field_size = numTypes[f].size;
+        addr.no_elements = nelem;
+        addr.pfield = field;
+
+        for (r = 0; r < NELEMENTS(numTypes); r++) {
+            for (i = 0; i < nelem; i++)
+                setValue(numTypes[f].type, field, i, i % 100);
+            dbGetConvertRoutine[numTypes[f].type][numTypes[r].type](&addr,
+                buf, nelem, nelem, half);
+            for (i = 0; i < nelem; i++)
+                badGet += getValue(numTypes[r].type, buf, i) !=
+                    (int) ((i + half) % nelem % 100);
+
+            for (i = 0; i < nelem; i++)
+                setValue(numTypes[r].type, buf, i, i % 100);
+            dbPutConvertRoutine[numTypes[r].type][numTypes[f].type](&addr,
+                buf, nelem, nelem, half);
+            for (i = 0; i < nelem; i++)
+                badPut += getValue(numTypes[f].type, field, (i + half) % nelem)
+                    != (int) (i % 100);
+        }
+    }
+    testOk(badGet == 0, "%lu element wrapped get of all pairs (%u wrong)",
+           (unsigned long) nelem, badGet);
+    testOk(badPut == 0, "%lu element wrapped put of all pairs (%u wrong)",
+           (unsigned long) nelem, badPut);
+    free(buf);
+    free(field);
+}
+
 MAIN(testdbConvert)
 {
-    testPlan(15);
+    testPlan(23);
     testBasicGet();
     testBasicPut();
+    checkWrap(1001);
+    checkWrap(65537);
     return testDone();
 }
@@ -24,6 +24,7 @@
 
 #include "registryFunction.h"
 #include "epicsThread.h"
+#include "epicsEvent.h"
 #include "epicsExit.h"
 #include "epicsStdio.h"
 #include "envDefs.h"
@@ -37,6 +38,7 @@
 #include "iocInit.h"
 #include "iocsh.h"
 #include "dbChannel.h"
+#include "dbEvent.h"
 #include "epicsUnitTest.h"
 #include "dbUnitTest.h"
 #include "testMain.h"
@@ -292,13 +294,101 @@ static void check(short dbr_type) {
     TEST5B(3, -8, -4, "both sides from-end");
 }
 
+/* Subscriptions sharing one snapshot of x.VAL */
+
+typedef struct snapSub {
+    const char *json;
+    const void *field;
+    long no_elements;
+    int whole;
+    epicsInt32 val[10];
+    epicsEventId done;
+} snapSub;
+
+static void snapEvent(void *user_arg, struct dbChannel *chan,
+                      int eventsRemaining, struct db_field_log *pfl)
+{
+    snapSub *sub = (snapSub *) user_arg;
+
+    sub->field = NULL;
+    sub->no_elements = pfl->no_elements;
+    sub->whole = !!db_field_log_snapshot(pfl);
+    if (pfl->type == dbfl_type_ref && pfl->u.r.field && pfl->no_elements <= 10) {
+        sub->field = pfl->u.r.field;
+        memcpy(sub->val, sub->field, pfl->no_elements * sizeof(epicsInt32));
+    }
+    epicsEventMustTrigger(sub->done);
+}
+
+static void testSnapshot(void)
+{
+    snapSub sub[3] = {
+        {""}, {"{\"arr\":{\"s\":2,\"e\":6}}"}, {"{\"arr\":{\"s\":2,\"e\":6,\"i\":2}}"}
+    };
+    dbEventSubscription es[3];
+    dbChannel *pch[3];
+    dbEventCtx ctx;
+    epicsInt32 ar[10] = {10,11,12,13,14,15,16,17,18,19};
+    epicsInt32 off = 0;
+    int bytes = dbEventSnapshotBytes;
+    struct arrRecord *prec = (struct arrRecord *) testdbRecordPtr("x");
+    int i;
+
+    testHead("Filtered subscriptions share the posted snapshot");
+    dbEventSnapshotBytes = 1;
+    testdbPutFieldOk("x.OFF", DBR_LONG, off);
+    testdbPutArrFieldOk("x.VAL", DBR_LONG, 10, ar);
+
+    ctx = db_init_events();
+    testOk1(db_start_events(ctx, "arrSnap", NULL, NULL,
+                            epicsThreadPriorityLow) == DB_EVENT_OK);
+    for (i = 0; i < 3; i++) {
+        char name[80];
+
+        sprintf(name, "x.VAL%s", sub[i].json);
+        sub[i].done = epicsEventMustCreate(epicsEventEmpty);
+        pch[i] = dbChannelCreate(name);
+        dbChannelOpen(pch[i]);
+        es[i] = db_add_event(ctx, pch[i], snapEvent, &sub[i], DBE_VALUE);
+        db_event_enable(es[i]);
+    }
+
+    dbScanLock((dbCommon *) prec);
+    db_post_events(prec, prec->bptr, DBE_VALUE);
+    dbScanUnlock((dbCommon *) prec);
+    for (i = 0; i < 3; i++)
+        epicsEventMustWait(sub[i].done);
+
+    testOk(sub[0].whole && sub[0].no_elements == 10 && sub[0].val[9] == 19,
+           "unfiltered update is the whole snapshot");
+    testOk(sub[1].no_elements == 5 && sub[1].val[0] == 12 &&
+           sub[1].val[4] == 16, "slice has 5 elements from 12");
+    testOk(!sub[1].whole &&
+           sub[1].field == (const char *) sub[0].field + 2 * sizeof(epicsInt32),
+           "slice is a view into the snapshot");
+    testOk(sub[2].no_elements == 3 && sub[2].val[0] == 12 &&
+           sub[2].val[1] == 14 && sub[2].val[2] == 16,
+           "increment 2 has 3 elements 12, 14, 16");
+    testOk(sub[2].field && !sub[2].whole && sub[2].field != sub[1].field,
+           "increment 2 is a copy");
+
+    for (i = 0; i < 3; i++) {
+        db_event_disable(es[i]);
+        db_cancel_event(es[i]);
+        dbChannelDelete(pch[i]);
+        epicsEventDestroy(sub[i].done);
+    }
+    db_close_events(ctx);
+    dbEventSnapshotBytes = bytes;
+}
+
 MAIN(arrTest)
 {
     dbEventCtx evtctx;
     const chFilterPlugin *plug;
     char arr[] = "arr";
 
-    testPlan(1402);
+    testPlan(1410);
 
     /* Prepare the IOC */
 
@@ -326,6 +416,8 @@ MAIN(arrTest)
     check(DBR_DOUBLE);
     check(DBR_STRING);
 
+    testSnapshot();
+
     db_close_events(evtctx);
 
     testIocShutdownOk();
@@ -0,0 +1,98 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+#include "dbAccess.h"
+#include "errlog.h"
+#include "alarm.h"
+#include "epicsMath.h"
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static void testArrays(void)
+{
+    static const double a[] = {1, 2, 3, 4};
+    static const epicsInt32 b[] = {10, 20, 30, 40, 50};
+    static const double expect[] = {12, 24, 36, 48};
+    static const double ramp[] = {13, 25, 37, 49, 1, 1, 1, 1};
+    static const double cond[] = {-1, 0, 0, 0};
+
+    testDiag("Array and scalar inputs");
+
+    testdbPutArrFieldOk("wfa", DBR_DOUBLE, NELEMENTS(a), a);
+    testdbPutArrFieldOk("wfb", DBR_LONG, NELEMENTS(b), b);
+    testdbPutFieldOk("k", DBR_DOUBLE, 2.0);
+    testdbPutFieldOk("ac.PROC", DBR_LONG, 1);
+
+    /* The shortest array input gives the element count */
+    testdbGetFieldEqual("ac.NORD", DBR_LONG, 4);
+    testdbGetArrFieldEqual("ac", DBR_DOUBLE, 8, NELEMENTS(expect), expect);
+    testdbGetFieldEqual("ac.RES", DBR_DOUBLE, 120.0);
+    testdbGetFieldEqual("ac.SEVR", DBR_LONG, NO_ALARM);
+
+    testdbPutFieldOk("ac.RED", DBR_STRING, "Min");
+    testdbGetFieldEqual("ac.RES", DBR_DOUBLE, 12.0);
+    testdbPutFieldOk("ac.RED", DBR_STRING, "Max");
+    testdbGetFieldEqual("ac.RES", DBR_DOUBLE, 48.0);
+    testdbPutFieldOk("ac.RED", DBR_STRING, "Mean");
+    testdbGetFieldEqual("ac.RES", DBR_DOUBLE, 30.0);
+
+    /* Without array inputs all NELM elements are calculated */
+    testdbPutFieldOk("ac.CALC", DBR_STRING, "VAL+1");
+    testdbGetFieldEqual("ac.NORD", DBR_LONG, 8);
+    testdbGetArrFieldEqual("ac", DBR_DOUBLE, 8, NELEMENTS(ramp), ramp);
+
+    /* Min and Max ignore NaN results */
+    testdbPutFieldOk("ac.CALC", DBR_STRING, "A<3?NAN:A");
+    testdbPutFieldOk("ac.RED", DBR_STRING, "Min");
+    testdbGetFieldEqual("ac.RES", DBR_DOUBLE, 3.0);
+    testdbPutFieldOk("ac.RED", DBR_STRING, "Max");
+    testdbGetFieldEqual("ac.RES", DBR_DOUBLE, 4.0);
+    testdbPutFieldOk("ac.CALC", DBR_STRING, "A>1?A-B/10:-1");
+    testdbGetArrFieldEqual("ac", DBR_DOUBLE, 8, NELEMENTS(cond), cond);
+
+    /* A bad expression can't be evaluated */
+    testdbPutFieldOk("ac.CALC", DBR_STRING, "A+");
+    testdbGetFieldEqual("ac.SEVR", DBR_LONG, INVALID_ALARM);
+}
+
+static void testConstants(void)
+{
+    static const double first[] = {-1, 20, 30};
+    static const double second[] = {-2, 20, 30};
+
+    testDiag("Constant input links");
+
+    testdbGetFieldEqual("const.NEA", DBR_LONG, 3);
+    testdbPutFieldOk("const.PROC", DBR_LONG, 1);
+    testdbGetArrFieldEqual("const", DBR_DOUBLE, 5, NELEMENTS(first), first);
+    testdbPutFieldOk("const.PROC", DBR_LONG, 1);
+    testdbGetArrFieldEqual("const", DBR_DOUBLE, 5, NELEMENTS(second), second);
+    testdbGetFieldEqual("const.RES", DBR_DOUBLE, 30.0);
+    testdbGetFieldEqual("const.UDF", DBR_LONG, 0);
+}
+
+MAIN(acalcTest)
+{
+    testPlan(33);
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    testdbReadDatabase("acalcTest.db", NULL, NULL);
+
+    eltc(0);
+    testIocInitOk();
+
+    testArrays();
+    testConstants();
+    eltc(1);
+
+    testIocShutdownOk();
+    testdbCleanup();
+
+    return testDone();
+}
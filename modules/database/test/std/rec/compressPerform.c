@@ -0,0 +1,97 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure how long a compress record takes to reduce a large input
+ * array with each N to 1 algorithm, for several N and NSAM.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dbUnitTest.h"
+#include "testMain.h"
+#include "dbLock.h"
+#include "dbAccess.h"
+#include "errlog.h"
+#include "epicsMath.h"
+#include "epicsTime.h"
+
+#include "compressRecord.h"
+#include "waveformRecord.h"
+
+#define NINPUT 100000   /* 100 kHz turn-by-turn, one second */
+#define NREPEAT 200
+
+void recTestIoc_registerRecordDeviceDriver(struct dbBase *);
+
+static const char * const algs[] = {
+    "N to 1 Low Value",
+    "N to 1 High Value",
+    "N to 1 Average",
+    "N to 1 Median",
+    "N to 1 RMS",
+    "N to 1 Std Dev",
+    "N to 1 Min Max",
+};
+
+static void measure(int n, const char *alg)
+{
+    char macros[80];
+    waveformRecord *wrec;
+    compressRecord *crec;
+    double *pin;
+    epicsTimeStamp start, stop;
+    double elapsed;
+    int i;
+
+    testdbPrepare();
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+    sprintf(macros, "ALG=%s,N=%d,NSAM=%d,NELM=%d", alg, n, NINPUT / n,
+            NINPUT);
+    testdbReadDatabase("compressArrTest.db", NULL, macros);
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    wrec = (waveformRecord *) testdbRecordPtr("wf");
+    crec = (compressRecord *) testdbRecordPtr("comp");
+
+    srand(1);
+    pin = wrec->bptr;
+    for (i = 0; i < NINPUT; i++)
+        pin[i] = 1000.0 + sin(i * 0.01) + rand() * 1e-3 / RAND_MAX;
+    wrec->nord = NINPUT;
+
+    dbScanLock((dbCommon *) crec);
+    epicsTimeGetCurrent(&start);
+    for (i = 0; i < NREPEAT; i++)
+        dbProcess((dbCommon *) crec);
+    epicsTimeGetCurrent(&stop);
+    dbScanUnlock((dbCommon *) crec);
+
+    elapsed = epicsTimeDiffInSeconds(&stop, &start) / NREPEAT;
+    testOk(crec->nuse == crec->nsam, "%s N=%d fills NSAM=%u",
+           alg, n, crec->nsam);
+    testDiag("%-18s N=%-5d NSAM=%-6u %8.3f ms %8.1f Melem/s", alg, n,
+             crec->nsam, elapsed * 1e3, NINPUT / elapsed / 1e6);
+
+    testIocShutdownOk();
+    testdbCleanup();
+}
+
+MAIN(compressPerform)
+{
+    static const int ns[] = {4, 100, 1000};
+    unsigned i, j;
+
+    testPlan(NELEMENTS(ns) * NELEMENTS(algs));
+    for (i = 0; i < NELEMENTS(algs); i++)
+        for (j = 0; j < NELEMENTS(ns); j++)
+            measure(ns[j], algs[i]);
+    return testDone();
+}
@@ -4,6 +4,8 @@
 * in file LICENSE that is included with this distribution.
 \*************************************************************************/
 
+#include <stdio.h>
+
 #include "dbUnitTest.h"
 #include "testMain.h"
 #include "dbLock.h"
@@ -345,10 +347,112 @@ void testLIFOCirc(void)
     testdbCleanup();
 }
 
+static
+void pushArray(const char *alg, const double *pin, unsigned long nin)
+{
+    compressRecord *crec = (compressRecord*)testdbRecordPtr("comp");
+
+    testDiag("Compress array with %s", alg);
+    testdbPutFieldOk("comp.ALG", DBF_STRING, alg);
+    testdbPutArrFieldOk("wf", DBF_DOUBLE, nin, pin);
+
+    dbScanLock((dbCommon*)crec);
+    dbProcess((dbCommon*)crec);
+    dbScanUnlock((dbCommon*)crec);
+}
+
+static
+void testArrayAlgs(void)
+{
+    /* two blocks of N=4 */
+    static const double input[] = {1, 7, 3, 5, 2, 2, 2, 2};
+
+    testDiag("Test N to 1 algorithms on array input");
+
+    testdbPrepare();
+
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    testdbReadDatabase("compressArrTest.db", NULL,
+        "ALG=N to 1 Average,N=4,NSAM=4,NELM=8");
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    pushArray("N to 1 Low Value", input, NELEMENTS(input));
+    checkArrD("comp", 2, 1, 2, 0, 0);
+    pushArray("N to 1 High Value", input, NELEMENTS(input));
+    checkArrD("comp", 2, 7, 2, 0, 0);
+    pushArray("N to 1 Average", input, NELEMENTS(input));
+    checkArrD("comp", 2, 4, 2, 0, 0);
+    pushArray("N to 1 Median", input, NELEMENTS(input));
+    checkArrD("comp", 2, 5, 2, 0, 0);
+    pushArray("N to 1 RMS", input, NELEMENTS(input));
+    checkArrD("comp", 2, sqrt(21.0), 2, 0, 0);
+    pushArray("N to 1 Std Dev", input, NELEMENTS(input));
+    checkArrD("comp", 2, sqrt(5.0), 0, 0, 0);
+    pushArray("N to 1 Min Max", input, NELEMENTS(input));
+    checkArrD("comp", 4, 1, 7, 2, 2);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
+static
+void testScalarAlg(const char *alg, long nexpect, double a, double b)
+{
+    static const double input[] = {1, 7, 3, 5};
+    char macros[64];
+    aiRecord *vrec;
+    compressRecord *crec;
+    unsigned i;
+
+    testDiag("Compress scalars with %s", alg);
+
+    testdbPrepare();
+
+    testdbReadDatabase("recTestIoc.dbd", NULL, NULL);
+
+    recTestIoc_registerRecordDeviceDriver(pdbbase);
+
+    sprintf(macros, "ALG=%s,BALG=FIFO Buffer,NSAM=4", alg);
+    testdbReadDatabase("compressTest.db", NULL, macros);
+
+    vrec = (aiRecord*)testdbRecordPtr("val");
+    crec = (compressRecord*)testdbRecordPtr("comp");
+
+    eltc(0);
+    testIocInitOk();
+    eltc(1);
+
+    testdbPutFieldOk("comp.N", DBF_LONG, NELEMENTS(input));
+
+    dbScanLock((dbCommon*)crec);
+    for (i = 0; i < NELEMENTS(input); i++) {
+        vrec->val = input[i];
+        dbProcess((dbCommon*)crec);
+    }
+    checkArrD("comp", nexpect, a, b, 0, 0);
+    dbScanUnlock((dbCommon*)crec);
+
+    testIocShutdownOk();
+
+    testdbCleanup();
+}
+
 MAIN(compressTest)
 {
-    testPlan(116);
+    testPlan(145);
     testFIFOCirc();
     testLIFOCirc();
+    testArrayAlgs();
+    testScalarAlg("N to 1 Average", 1, 4, 0);
+    testScalarAlg("N to 1 RMS", 1, sqrt(21.0), 0);
+    testScalarAlg("N to 1 Std Dev", 1, sqrt(5.0), 0);
+    testScalarAlg("N to 1 Min Max", 2, 1, 7);
     return testDone();
 }
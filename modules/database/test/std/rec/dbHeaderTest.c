@@ -10,6 +10,7 @@
 
 #include <aaiRecord.h>
 #include <aaoRecord.h>
+#include <acalcRecord.h>
 #include <addrList.h>
 #include <adjustment.h>
 #include <aiRecord.h>
@@ -25,7 +25,6 @@
 #include "postfix.h"
 #include "postfixPvt.h"
 
-static double calcRandom(void);
 static int cond_search(const char **ppinst, int match);
 
 #ifndef PI
@@ -37,6 +36,27 @@ static int cond_search(const char **ppinst, int match);
 #  pragma optimize("g", off)
 #endif
 
+/* With GCC and clang the evaluator jumps directly from the end of one
+ * opcode to the code for the next one through a table of label addresses.
+ * Each opcode then has its own indirect branch, which the CPU predicts
+ * much better than the single branch of the switch. Both forms execute
+ * exactly the same code for each opcode.
+ */
+#if defined(__GNUC__)
+#  define CALC_THREADED
+#endif
+
+#ifdef CALC_THREADED
+#  ifdef __clang__
+#    pragma clang diagnostic ignored "-Winitializer-overrides"
+#  endif
+#  define OPCODE(name) op_##name:
+#  define NEXT_OP goto *dispatch[op = (unsigned char) *pinst++]
+#else
+#  define OPCODE(name) case name:
+#  define NEXT_OP break
+#endif
+
 /* calcPerform
  *
  * Evalutate the postfix expression
@@ -51,196 +71,278 @@ epicsShareFunc long
     epicsUInt32 utop;			/* unsigned integer from top of stack */
     int op;
     int nargs;
+#ifdef CALC_THREADED
+    /* Unused opcode values go to op_bad, so no bounds check is needed */
+    static const void * const dispatch[256] = {
+	[0 ... 255] = &&op_bad,
+	[END_EXPRESSION] = &&op_END_EXPRESSION,
+	[LITERAL_DOUBLE] = &&op_LITERAL_DOUBLE,
+	[LITERAL_INT] = &&op_LITERAL_INT,
+	[FETCH_VAL] = &&op_FETCH_VAL,
+	[FETCH_A] = &&op_FETCH_A, [FETCH_B] = &&op_FETCH_B,
+	[FETCH_C] = &&op_FETCH_C, [FETCH_D] = &&op_FETCH_D,
+	[FETCH_E] = &&op_FETCH_E, [FETCH_F] = &&op_FETCH_F,
+	[FETCH_G] = &&op_FETCH_G, [FETCH_H] = &&op_FETCH_H,
+	[FETCH_I] = &&op_FETCH_I, [FETCH_J] = &&op_FETCH_J,
+	[FETCH_K] = &&op_FETCH_K, [FETCH_L] = &&op_FETCH_L,
+	[STORE_A] = &&op_STORE_A, [STORE_B] = &&op_STORE_B,
+	[STORE_C] = &&op_STORE_C, [STORE_D] = &&op_STORE_D,
+	[STORE_E] = &&op_STORE_E, [STORE_F] = &&op_STORE_F,
+	[STORE_G] = &&op_STORE_G, [STORE_H] = &&op_STORE_H,
+	[STORE_I] = &&op_STORE_I, [STORE_J] = &&op_STORE_J,
+	[STORE_K] = &&op_STORE_K, [STORE_L] = &&op_STORE_L,
+	[CONST_PI] = &&op_CONST_PI,
+	[CONST_D2R] = &&op_CONST_D2R,
+	[CONST_R2D] = &&op_CONST_R2D,
+	[UNARY_NEG] = &&op_UNARY_NEG,
+	[ADD] = &&op_ADD,
+	[SUB] = &&op_SUB,
+	[MULT] = &&op_MULT,
+	[DIV] = &&op_DIV,
+	[MODULO] = &&op_MODULO,
+	[POWER] = &&op_POWER,
+	[ABS_VAL] = &&op_ABS_VAL,
+	[EXP] = &&op_EXP,
+	[LOG_10] = &&op_LOG_10,
+	[LOG_E] = &&op_LOG_E,
+	[MAX] = &&op_MAX,
+	[MIN] = &&op_MIN,
+	[SQU_RT] = &&op_SQU_RT,
+	[ACOS] = &&op_ACOS,
+	[ASIN] = &&op_ASIN,
+	[ATAN] = &&op_ATAN,
+	[ATAN2] = &&op_ATAN2,
+	[COS] = &&op_COS,
+	[COSH] = &&op_COSH,
+	[SIN] = &&op_SIN,
+	[SINH] = &&op_SINH,
+	[TAN] = &&op_TAN,
+	[TANH] = &&op_TANH,
+	[CEIL] = &&op_CEIL,
+	[FLOOR] = &&op_FLOOR,
+	[FINITE] = &&op_FINITE,
+	[ISINF] = &&op_ISINF,
+	[ISNAN] = &&op_ISNAN,
+	[NINT] = &&op_NINT,
+	[RANDOM] = &&op_RANDOM,
+	[REL_OR] = &&op_REL_OR,
+	[REL_AND] = &&op_REL_AND,
+	[REL_NOT] = &&op_REL_NOT,
+	[BIT_OR] = &&op_BIT_OR,
+	[BIT_AND] = &&op_BIT_AND,
+	[BIT_EXCL_OR] = &&op_BIT_EXCL_OR,
+	[BIT_NOT] = &&op_BIT_NOT,
+	[RIGHT_SHIFT] = &&op_RIGHT_SHIFT,
+	[LEFT_SHIFT] = &&op_LEFT_SHIFT,
+	[NOT_EQ] = &&op_NOT_EQ,
+	[LESS_THAN] = &&op_LESS_THAN,
+	[LESS_OR_EQ] = &&op_LESS_OR_EQ,
+	[EQUAL] = &&op_EQUAL,
+	[GR_OR_EQ] = &&op_GR_OR_EQ,
+	[GR_THAN] = &&op_GR_THAN,
+	[COND_IF] = &&op_COND_IF,
+	[COND_ELSE] = &&op_COND_ELSE,
+	[COND_END] = &&op_COND_END,
+	[COND_IF_JUMP] = &&op_COND_IF_JUMP,
+	[COND_ELSE_JUMP] = &&op_COND_ELSE_JUMP,
+    };
+#endif
 
     /* initialize */
     ptop = stack;
 
     /* RPN evaluation loop */
-    while ((op = *pinst++) != END_EXPRESSION){
-	switch (op){
+#ifdef CALC_THREADED
+    NEXT_OP;
+#else
+    for (;;) switch (op = *pinst++) {
+#endif
 
-	case LITERAL_DOUBLE:
+	OPCODE(END_EXPRESSION)
+	    goto done;
+
+	OPCODE(LITERAL_DOUBLE)
 	    memcpy(++ptop, pinst, sizeof(double));
 	    pinst += sizeof(double);
-	    break;
+	    NEXT_OP;
 
-	case LITERAL_INT:
+	OPCODE(LITERAL_INT)
 	    memcpy(&itop, pinst, sizeof(epicsInt32));
 	    *++ptop = itop;
 	    pinst += sizeof(epicsInt32);
-	    break;
+	    NEXT_OP;
 
-	case FETCH_VAL:
+	OPCODE(FETCH_VAL)
 	    *++ptop = *presult;
-	    break;
-
-	case FETCH_A:
-	case FETCH_B:
-	case FETCH_C:
-	case FETCH_D:
-	case FETCH_E:
-	case FETCH_F:
-	case FETCH_G:
-	case FETCH_H:
-	case FETCH_I:
-	case FETCH_J:
-	case FETCH_K:
-	case FETCH_L:
+	    NEXT_OP;
+
+	OPCODE(FETCH_A)
+	OPCODE(FETCH_B)
+	OPCODE(FETCH_C)
+	OPCODE(FETCH_D)
+	OPCODE(FETCH_E)
+	OPCODE(FETCH_F)
+	OPCODE(FETCH_G)
+	OPCODE(FETCH_H)
+	OPCODE(FETCH_I)
+	OPCODE(FETCH_J)
+	OPCODE(FETCH_K)
+	OPCODE(FETCH_L)
 	    *++ptop = parg[op - FETCH_A];
-	    break;
-
-	case STORE_A:
-	case STORE_B:
-	case STORE_C:
-	case STORE_D:
-	case STORE_E:
-	case STORE_F:
-	case STORE_G:
-	case STORE_H:
-	case STORE_I:
-	case STORE_J:
-	case STORE_K:
-	case STORE_L:
+	    NEXT_OP;
+
+	OPCODE(STORE_A)
+	OPCODE(STORE_B)
+	OPCODE(STORE_C)
+	OPCODE(STORE_D)
+	OPCODE(STORE_E)
+	OPCODE(STORE_F)
+	OPCODE(STORE_G)
+	OPCODE(STORE_H)
+	OPCODE(STORE_I)
+	OPCODE(STORE_J)
+	OPCODE(STORE_K)
+	OPCODE(STORE_L)
 	    parg[op - STORE_A] = *ptop--;
-	    break;
+	    NEXT_OP;
 
-	case CONST_PI:
+	OPCODE(CONST_PI)
 	    *++ptop = PI;
-	    break;
+	    NEXT_OP;
 
-	case CONST_D2R:
+	OPCODE(CONST_D2R)
 	    *++ptop = PI/180.;
-	    break;
+	    NEXT_OP;
 
-	case CONST_R2D:
+	OPCODE(CONST_R2D)
 	    *++ptop = 180./PI;
-	    break;
+	    NEXT_OP;
 
-	case UNARY_NEG:
+	OPCODE(UNARY_NEG)
 	    *ptop = - *ptop;
-	    break;
+	    NEXT_OP;
 
-	case ADD:
+	OPCODE(ADD)
 	    top = *ptop--;
 	    *ptop += top;
-	    break;
+	    NEXT_OP;
 
-	case SUB:
+	OPCODE(SUB)
 	    top = *ptop--;
 	    *ptop -= top;
-	    break;
+	    NEXT_OP;
 
-	case MULT:
+	OPCODE(MULT)
 	    top = *ptop--;
 	    *ptop *= top;
-	    break;
+	    NEXT_OP;
 
-	case DIV:
+	OPCODE(DIV)
 	    top = *ptop--;
 	    *ptop /= top;
-	    break;
+	    NEXT_OP;
 
-	case MODULO:
+	OPCODE(MODULO)
 	    itop = (epicsInt32) *ptop--;
 	    if (itop)
 		*ptop = (epicsInt32) *ptop % itop;
 	    else
 		*ptop = epicsNAN;
-	    break;
+	    NEXT_OP;
 
-	case POWER:
+	OPCODE(POWER)
 	    top = *ptop--;
 	    *ptop = pow(*ptop, top);
-	    break;
+	    NEXT_OP;
 
-	case ABS_VAL:
+	OPCODE(ABS_VAL)
 	    *ptop = fabs(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case EXP:
+	OPCODE(EXP)
 	    *ptop = exp(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case LOG_10:
+	OPCODE(LOG_10)
 	    *ptop = log10(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case LOG_E:
+	OPCODE(LOG_E)
 	    *ptop = log(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case MAX:
+	OPCODE(MAX)
 	    nargs = *pinst++;
 	    while (--nargs) {
 		top = *ptop--;
 		if (*ptop < top || isnan(top))
 		    *ptop = top;
 	    }
-	    break;
+	    NEXT_OP;
 
-	case MIN:
+	OPCODE(MIN)
 	    nargs = *pinst++;
 	    while (--nargs) {
 		top = *ptop--;
 		if (*ptop > top || isnan(top))
 		    *ptop = top;
 	    }
-	    break;
+	    NEXT_OP;
 
-	case SQU_RT:
+	OPCODE(SQU_RT)
 	    *ptop = sqrt(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case ACOS:
+	OPCODE(ACOS)
 	    *ptop = acos(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case ASIN:
+	OPCODE(ASIN)
 	    *ptop = asin(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case ATAN:
+	OPCODE(ATAN)
 	    *ptop = atan(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case ATAN2:
+	OPCODE(ATAN2)
 	    top = *ptop--;
 	    *ptop = atan2(top, *ptop);	/* Ouch!: Args backwards! */
-	    break;
+	    NEXT_OP;
 
-	case COS:
+	OPCODE(COS)
 	    *ptop = cos(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case SIN:
+	OPCODE(SIN)
 	    *ptop = sin(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case TAN:
+	OPCODE(TAN)
 	    *ptop = tan(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case COSH:
+	OPCODE(COSH)
 	    *ptop = cosh(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case SINH:
+	OPCODE(SINH)
 	    *ptop = sinh(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case TANH:
+	OPCODE(TANH)
 	    *ptop = tanh(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case CEIL:
+	OPCODE(CEIL)
 	    *ptop = ceil(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case FLOOR:
+	OPCODE(FLOOR)
 	    *ptop = floor(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case FINITE:
+	OPCODE(FINITE)
 	    nargs = *pinst++;
 	    top = finite(*ptop);
 	    while (--nargs) {
@@ -248,13 +350,13 @@ epicsShareFunc long
 		top = top && finite(*ptop);
 	    }
 	    *ptop = top;
-	    break;
+	    NEXT_OP;
 
-	case ISINF:
+	OPCODE(ISINF)
 	    *ptop = isinf(*ptop);
-	    break;
+	    NEXT_OP;
 
-	case ISNAN:
+	OPCODE(ISNAN)
 	    nargs = *pinst++;
 	    top = isnan(*ptop);
 	    while (--nargs) {
@@ -262,30 +364,30 @@ epicsShareFunc long
 		top = top || isnan(*ptop);
 	    }
 	    *ptop = top;
-	    break;
+	    NEXT_OP;
 
-	case NINT:
+	OPCODE(NINT)
 	    top = *ptop;
 	    *ptop = (epicsInt32) (top >= 0 ? top + 0.5 : top - 0.5);
-	    break;
+	    NEXT_OP;
 
-	case RANDOM:
-	    *++ptop = calcRandom();
-	    break;
+	OPCODE(RANDOM)
+	    *++ptop = epicsCalcRandom();
+	    NEXT_OP;
 
-	case REL_OR:
+	OPCODE(REL_OR)
 	    top = *ptop--;
 	    *ptop = *ptop || top;
-	    break;
+	    NEXT_OP;
 
-	case REL_AND:
+	OPCODE(REL_AND)
 	    top = *ptop--;
 	    *ptop = *ptop && top;
-	    break;
+	    NEXT_OP;
 
-	case REL_NOT:
+	OPCODE(REL_NOT)
 	    *ptop = ! *ptop;
-	    break;
+	    NEXT_OP;
 
         /* For bitwise operations on values with bit 31 set, double values
          * must first be cast to unsigned to correctly set that bit; the
@@ -293,89 +395,105 @@ epicsShareFunc long
          * cast to a signed integer before converting to the double result.
          */
 
-	case BIT_OR:
+	OPCODE(BIT_OR)
 	    utop = *ptop--;
 	    *ptop = (epicsInt32) ((epicsUInt32) *ptop | utop);
-	    break;
+	    NEXT_OP;
 
-	case BIT_AND:
+	OPCODE(BIT_AND)
 	    utop = *ptop--;
 	    *ptop = (epicsInt32) ((epicsUInt32) *ptop & utop);
-	    break;
+	    NEXT_OP;
 
-	case BIT_EXCL_OR:
+	OPCODE(BIT_EXCL_OR)
 	    utop = *ptop--;
 	    *ptop = (epicsInt32) ((epicsUInt32) *ptop ^ utop);
-	    break;
+	    NEXT_OP;
 
-	case BIT_NOT:
+	OPCODE(BIT_NOT)
 	    utop = *ptop;
 	    *ptop = (epicsInt32) ~utop;
-	    break;
+	    NEXT_OP;
 
         /* The shift operators use signed integers, so a right-shift will
          * extend the sign bit into the left-hand end of the value. The
          * double-casting through unsigned here is important, see above.
          */
 
-	case RIGHT_SHIFT:
+	OPCODE(RIGHT_SHIFT)
 	    utop = *ptop--;
 	    *ptop = ((epicsInt32) (epicsUInt32) *ptop) >> (utop & 31);
-	    break;
+	    NEXT_OP;
 
-	case LEFT_SHIFT:
+	OPCODE(LEFT_SHIFT)
 	    utop = *ptop--;
 	    *ptop = ((epicsInt32) (epicsUInt32) *ptop) << (utop & 31);
-	    break;
+	    NEXT_OP;
 
-	case NOT_EQ:
+	OPCODE(NOT_EQ)
 	    top = *ptop--;
 	    *ptop = *ptop != top;
-	    break;
+	    NEXT_OP;
 
-	case LESS_THAN:
+	OPCODE(LESS_THAN)
 	    top = *ptop--;
 	    *ptop = *ptop < top;
-	    break;
+	    NEXT_OP;
 
-	case LESS_OR_EQ:
+	OPCODE(LESS_OR_EQ)
 	    top = *ptop--;
 	    *ptop = *ptop <= top;
-	    break;
+	    NEXT_OP;
 
-	case EQUAL:
+	OPCODE(EQUAL)
 	    top = *ptop--;
 	    *ptop = *ptop == top;
-	    break;
+	    NEXT_OP;
 
-	case GR_OR_EQ:
+	OPCODE(GR_OR_EQ)
 	    top = *ptop--;
 	    *ptop = *ptop >= top;
-	    break;
+	    NEXT_OP;
 
-	case GR_THAN:
+	OPCODE(GR_THAN)
 	    top = *ptop--;
 	    *ptop = *ptop > top;
-	    break;
+	    NEXT_OP;
 
-	case COND_IF:
+	OPCODE(COND_IF)
 	    if (*ptop-- == 0.0 &&
 		cond_search(&pinst, COND_ELSE)) return -1;
-	    break;
+	    NEXT_OP;
 
-	case COND_ELSE:
+	OPCODE(COND_ELSE)
 	    if (cond_search(&pinst, COND_END)) return -1;
-	    break;
+	    NEXT_OP;
 
-	case COND_END:
-	    break;
+	OPCODE(COND_END)
+	    NEXT_OP;
 
+	OPCODE(COND_IF_JUMP)
+	    if (*ptop-- == 0.0)
+		pinst += (unsigned char) *pinst;
+	    pinst++;
+	    NEXT_OP;
+
+	OPCODE(COND_ELSE_JUMP)
+	    pinst += (unsigned char) *pinst + 1;
+	    NEXT_OP;
+
+#ifdef CALC_THREADED
+op_bad:
+#else
 	default:
+#endif
 	    errlogPrintf("calcPerform: Bad Opcode %d at %p\n", op, pinst-1);
 	    return -1;
-	}
+#ifndef CALC_THREADED
     }
+#endif
 
+done:
     /* The stack should now have one item on it, the expression value */
     if (ptop != stack + 1)
 	return -1;
@@ -406,6 +524,8 @@ calcArgUsage(const char *pinst, unsigned long *pinputs, unsigned long *pstores)
 	case MAX:
 	case FINITE:
 	case ISNAN:
+	case COND_IF_JUMP:
+	case COND_ELSE_JUMP:
 	    pinst++;
 	    break;
 
@@ -459,7 +579,7 @@ static unsigned short seed = 0xa3bf;
 static unsigned short multy = 191 * 8 + 5;  /* 191 % 8 == 5 */
 static unsigned short addy = 0x3141;
 
-static double calcRandom(void)
+double epicsCalcRandom(void)
 {
     seed = (seed * multy) + addy;
 
@@ -493,6 +613,8 @@ static int cond_search(const char **ppinst, int match)
 	case MAX:
 	case FINITE:
 	case ISNAN:
+	case COND_IF_JUMP:
+	case COND_ELSE_JUMP:
 	    pinst++;
 	    break;
 	case COND_IF:
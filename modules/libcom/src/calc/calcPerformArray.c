@@ -0,0 +1,656 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/* Element-wise evaluation of postfix expressions over arrays
+ *
+ * The instructions are interpreted once for each block of up to
+ * CALC_BLOCK elements. Each stack entry holds the values for the whole
+ * block, so every opcode runs a short loop the compiler can vectorize,
+ * and the interpreter overhead is shared by all elements in the block.
+ * The loops use exactly the same arithmetic as calcPerform(), so each
+ * element of the result is bit-for-bit what calcPerform() would return.
+ *
+ * Both branches of a conditional are evaluated and the result for each
+ * element is selected afterwards; the extra work can't have any side
+ * effects as assignments aren't allowed inside a conditional, but the
+ * RNDM values returned will differ from those of calcPerform().
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#define epicsExportSharedSymbols
+#include "dbDefs.h"
+#include "epicsMath.h"
+#include "epicsTypes.h"
+#include "postfix.h"
+#include "postfixPvt.h"
+
+#define CALC_BLOCK 64
+
+#ifndef PI
+#define PI 3.14159265358979323
+#endif
+
+static size_t calc_inst_size(const char *pinst)
+{
+    switch (*pinst) {
+    case LITERAL_DOUBLE:
+	return 1 + sizeof(double);
+    case LITERAL_INT:
+	return 1 + sizeof(epicsInt32);
+    case MIN:
+    case MAX:
+    case FINITE:
+    case ISNAN:
+    case COND_IF_JUMP:
+    case COND_ELSE_JUMP:
+	return 2;
+    default:
+	return 1;
+    }
+}
+
+/* The block stack holds the condition and the true result of each
+ * conditional until the end of its false branch, where the result for
+ * each element is selected. A false branch ends at the COND_END of that
+ * conditional, unless it's in the true branch of an enclosing conditional
+ * which gives the COND_END order in note 5 of postfixPvt.h, so it ends at
+ * the enclosing COND_ELSE and its COND_END comes after the enclosing one.
+ * With jumps the false branch ends at the COND_ELSE_JUMP target instead.
+ */
+typedef struct {
+    const char *pend;	/* end of the false branch, for COND_ELSE_JUMP */
+    int inFalse;	/* now evaluating the false branch */
+    int owed;		/* COND_ENDs of conditionals that ended at COND_ELSE */
+} calc_cond;
+
+typedef struct {
+    calc_cond cond[CALCPERFORM_STACK];
+    int ncond;
+    int skip;		/* COND_ENDs to ignore */
+} calc_conds;
+
+static int cond_if(calc_conds *pc)
+{
+    calc_cond *pcond;
+
+    if (pc->ncond == NELEMENTS(pc->cond))
+	return -1;
+    pcond = &pc->cond[pc->ncond++];
+    pcond->pend = NULL;
+    pcond->inFalse = FALSE;
+    pcond->owed = 0;
+    return 0;
+}
+
+/* Returns the number of conditionals that end here, or -1 */
+static int cond_else(calc_conds *pc, const char *pend)
+{
+    int n = pc->ncond;
+    int owed = 0;
+
+    while (n && pc->cond[n - 1].inFalse) {
+	n--;
+	owed += 1 + pc->cond[n].owed;
+    }
+    if (n == 0)
+	return -1;
+    pc->cond[n - 1].inFalse = TRUE;
+    pc->cond[n - 1].pend = pend;
+    pc->cond[n - 1].owed += owed;
+    owed = pc->ncond - n;
+    pc->ncond = n;
+    return owed;
+}
+
+static int cond_end(calc_conds *pc)
+{
+    calc_cond *pcond;
+
+    if (pc->skip) {
+	pc->skip--;
+	return 0;
+    }
+    if (pc->ncond == 0)
+	return 0;
+    pcond = &pc->cond[pc->ncond - 1];
+    if (!pcond->inFalse || pcond->pend)
+	return 0;
+    pc->skip = pcond->owed;
+    pc->ncond--;
+    return 1;
+}
+
+/* Returns the number of jump targets at pinst */
+static int cond_reached(calc_conds *pc, const char *pinst)
+{
+    int n = 0;
+
+    while (pc->ncond && pc->cond[pc->ncond - 1].pend == pinst) {
+	pc->ncond--;
+	n++;
+    }
+    return n;
+}
+
+/* Stack depth needed for the block stack */
+static int calc_array_depth(const char *pinst)
+{
+    calc_conds conds;
+    int depth = 0, max = 0;
+    int op, n;
+
+    conds.ncond = conds.skip = 0;
+    for (;;) {
+	depth -= 2 * cond_reached(&conds, pinst);
+	if ((op = *pinst) == END_EXPRESSION)
+	    break;
+	switch (op) {
+	case LITERAL_DOUBLE:
+	case LITERAL_INT:
+	case FETCH_VAL:
+	case FETCH_A: case FETCH_B: case FETCH_C: case FETCH_D:
+	case FETCH_E: case FETCH_F: case FETCH_G: case FETCH_H:
+	case FETCH_I: case FETCH_J: case FETCH_K: case FETCH_L:
+	case CONST_PI:
+	case CONST_D2R:
+	case CONST_R2D:
+	case RANDOM:
+	    depth++;
+	    break;
+	case STORE_A: case STORE_B: case STORE_C: case STORE_D:
+	case STORE_E: case STORE_F: case STORE_G: case STORE_H:
+	case STORE_I: case STORE_J: case STORE_K: case STORE_L:
+	    depth--;
+	    break;
+	case MIN:
+	case MAX:
+	case FINITE:
+	case ISNAN:
+	    depth -= pinst[1] - 1;
+	    break;
+	case ADD: case SUB: case MULT: case DIV: case MODULO: case POWER:
+	case ATAN2:
+	case REL_OR: case REL_AND:
+	case BIT_OR: case BIT_AND: case BIT_EXCL_OR:
+	case RIGHT_SHIFT: case LEFT_SHIFT:
+	case NOT_EQ: case LESS_THAN: case LESS_OR_EQ:
+	case EQUAL: case GR_OR_EQ: case GR_THAN:
+	    depth--;
+	    break;
+	case COND_IF:
+	case COND_IF_JUMP:
+	    if (cond_if(&conds))
+		return -1;
+	    break;
+	case COND_ELSE:
+	case COND_ELSE_JUMP:
+	    n = cond_else(&conds, op == COND_ELSE ? NULL :
+		pinst + 2 + (unsigned char) pinst[1]);
+	    if (n < 0)
+		return -1;
+	    depth -= 2 * n;
+	    break;
+	case COND_END:
+	    depth -= 2 * cond_end(&conds);
+	    break;
+	default:
+	    break;
+	}
+	if (depth > max)
+	    max = depth;
+	pinst += calc_inst_size(pinst);
+    }
+    if (conds.ncond || depth != 1)
+	return -1;
+    return max;
+}
+
+epicsShareFunc size_t
+    calcArrayWorkSize(const char *pinst)
+{
+    int depth = calc_array_depth(pinst);
+
+    if (depth < 0)
+	return 0;
+    return (CALCPERFORM_NARGS + depth + 1) * CALC_BLOCK;
+}
+
+/* Loops over the elements in a block for the different operator types */
+
+#define UNARY(expr) \
+    for (i = 0; i < n; i++) { \
+	double x = ptop[i]; \
+	ptop[i] = (expr); \
+    }
+
+#define BINARY(expr) \
+    ptop -= CALC_BLOCK; \
+    for (i = 0; i < n; i++) { \
+	double x = ptop[i]; \
+	double y = ptop[i + CALC_BLOCK]; \
+	ptop[i] = (expr); \
+    }
+
+#define PUSH(expr) \
+    ptop += CALC_BLOCK; \
+    for (i = 0; i < n; i++) \
+	ptop[i] = (expr);
+
+/* Select the results of nsel conditionals */
+#define SELECT(nsel) \
+    for (k = nsel; k > 0; k--) { \
+	ptop -= 2 * CALC_BLOCK; \
+	for (i = 0; i < n; i++) \
+	    ptop[i] = ptop[i] == 0.0 ? ptop[i + 2 * CALC_BLOCK] : \
+		ptop[i + CALC_BLOCK]; \
+    }
+
+/* Evaluate one block of n elements, starting at element base */
+static long calc_block(const double * const *pparg, const epicsUInt32 *pnarg,
+    double *presult, epicsUInt32 base, int n, const char *pinst,
+    double *pwork)
+{
+    const double *pvar[CALCPERFORM_NARGS];
+    double *pstack = pwork + CALCPERFORM_NARGS * CALC_BLOCK;
+    double *ptop = pstack;
+    calc_conds conds;
+    epicsInt32 itop;
+    epicsUInt32 utop;
+    double top;
+    int op, nargs, nsel, i, k;
+
+    conds.ncond = conds.skip = 0;
+
+    /* Scalar arguments have a NULL pvar */
+    for (k = 0; k < CALCPERFORM_NARGS; k++)
+	pvar[k] = pnarg[k] == 1 ? NULL : pparg[k] + base;
+
+    for (;;) {
+	nsel = cond_reached(&conds, pinst);
+	SELECT(nsel);
+	if ((op = *pinst++) == END_EXPRESSION)
+	    break;
+
+	switch (op) {
+
+	case LITERAL_DOUBLE:
+	    memcpy(&top, pinst, sizeof(double));
+	    pinst += sizeof(double);
+	    PUSH(top);
+	    break;
+
+	case LITERAL_INT:
+	    memcpy(&itop, pinst, sizeof(epicsInt32));
+	    pinst += sizeof(epicsInt32);
+	    top = itop;
+	    PUSH(top);
+	    break;
+
+	case FETCH_VAL:
+	    ptop += CALC_BLOCK;
+	    memcpy(ptop, presult + base, n * sizeof(double));
+	    break;
+
+	case FETCH_A:
+	case FETCH_B:
+	case FETCH_C:
+	case FETCH_D:
+	case FETCH_E:
+	case FETCH_F:
+	case FETCH_G:
+	case FETCH_H:
+	case FETCH_I:
+	case FETCH_J:
+	case FETCH_K:
+	case FETCH_L:
+	    k = op - FETCH_A;
+	    if (pvar[k]) {
+		ptop += CALC_BLOCK;
+		memcpy(ptop, pvar[k], n * sizeof(double));
+	    } else {
+		top = pparg[k][0];
+		PUSH(top);
+	    }
+	    break;
+
+	case STORE_A:
+	case STORE_B:
+	case STORE_C:
+	case STORE_D:
+	case STORE_E:
+	case STORE_F:
+	case STORE_G:
+	case STORE_H:
+	case STORE_I:
+	case STORE_J:
+	case STORE_K:
+	case STORE_L:
+	    /* assignments are local to the evaluation */
+	    k = op - STORE_A;
+	    memcpy(pwork + k * CALC_BLOCK, ptop, n * sizeof(double));
+	    pvar[k] = pwork + k * CALC_BLOCK;
+	    ptop -= CALC_BLOCK;
+	    break;
+
+	case CONST_PI:
+	    PUSH(PI);
+	    break;
+
+	case CONST_D2R:
+	    PUSH(PI/180.);
+	    break;
+
+	case CONST_R2D:
+	    PUSH(180./PI);
+	    break;
+
+	case UNARY_NEG:
+	    UNARY(- x);
+	    break;
+
+	case ADD:
+	    BINARY(x + y);
+	    break;
+
+	case SUB:
+	    BINARY(x - y);
+	    break;
+
+	case MULT:
+	    BINARY(x * y);
+	    break;
+
+	case DIV:
+	    BINARY(x / y);
+	    break;
+
+	case MODULO:
+	    ptop -= CALC_BLOCK;
+	    for (i = 0; i < n; i++) {
+		itop = (epicsInt32) ptop[i + CALC_BLOCK];
+		if (itop)
+		    ptop[i] = (epicsInt32) ptop[i] % itop;
+		else
+		    ptop[i] = epicsNAN;
+	    }
+	    break;
+
+	case POWER:
+	    BINARY(pow(x, y));
+	    break;
+
+	case ABS_VAL:
+	    UNARY(fabs(x));
+	    break;
+
+	case EXP:
+	    UNARY(exp(x));
+	    break;
+
+	case LOG_10:
+	    UNARY(log10(x));
+	    break;
+
+	case LOG_E:
+	    UNARY(log(x));
+	    break;
+
+	case MAX:
+	    nargs = *pinst++;
+	    while (--nargs) {
+		BINARY(x < y || isnan(y) ? y : x);
+	    }
+	    break;
+
+	case MIN:
+	    nargs = *pinst++;
+	    while (--nargs) {
+		BINARY(x > y || isnan(y) ? y : x);
+	    }
+	    break;
+
+	case SQU_RT:
+	    UNARY(sqrt(x));
+	    break;
+
+	case ACOS:
+	    UNARY(acos(x));
+	    break;
+
+	case ASIN:
+	    UNARY(asin(x));
+	    break;
+
+	case ATAN:
+	    UNARY(atan(x));
+	    break;
+
+	case ATAN2:
+	    BINARY(atan2(y, x));	/* Ouch!: Args backwards! */
+	    break;
+
+	case COS:
+	    UNARY(cos(x));
+	    break;
+
+	case SIN:
+	    UNARY(sin(x));
+	    break;
+
+	case TAN:
+	    UNARY(tan(x));
+	    break;
+
+	case COSH:
+	    UNARY(cosh(x));
+	    break;
+
+	case SINH:
+	    UNARY(sinh(x));
+	    break;
+
+	case TANH:
+	    UNARY(tanh(x));
+	    break;
+
+	case CEIL:
+	    UNARY(ceil(x));
+	    break;
+
+	case FLOOR:
+	    UNARY(floor(x));
+	    break;
+
+	case FINITE:
+	    nargs = *pinst++;
+	    ptop -= (nargs - 1) * CALC_BLOCK;
+	    for (i = 0; i < n; i++) {
+		top = finite(ptop[i + (nargs - 1) * CALC_BLOCK]);
+		for (k = nargs - 2; k >= 0; k--)
+		    top = top && finite(ptop[i + k * CALC_BLOCK]);
+		ptop[i] = top;
+	    }
+	    break;
+
+	case ISINF:
+	    UNARY(isinf(x));
+	    break;
+
+	case ISNAN:
+	    nargs = *pinst++;
+	    ptop -= (nargs - 1) * CALC_BLOCK;
+	    for (i = 0; i < n; i++) {
+		top = isnan(ptop[i + (nargs - 1) * CALC_BLOCK]);
+		for (k = nargs - 2; k >= 0; k--)
+		    top = top || isnan(ptop[i + k * CALC_BLOCK]);
+		ptop[i] = top;
+	    }
+	    break;
+
+	case NINT:
+	    UNARY((epicsInt32) (x >= 0 ? x + 0.5 : x - 0.5));
+	    break;
+
+	case RANDOM:
+	    PUSH(epicsCalcRandom());
+	    break;
+
+	case REL_OR:
+	    BINARY(x || y);
+	    break;
+
+	case REL_AND:
+	    BINARY(x && y);
+	    break;
+
+	case REL_NOT:
+	    UNARY(! x);
+	    break;
+
+	/* The bitwise operators convert values exactly as calcPerform() */
+
+	case BIT_OR:
+	    ptop -= CALC_BLOCK;
+	    for (i = 0; i < n; i++) {
+		utop = ptop[i + CALC_BLOCK];
+		ptop[i] = (epicsInt32) ((epicsUInt32) ptop[i] | utop);
+	    }
+	    break;
+
+	case BIT_AND:
+	    ptop -= CALC_BLOCK;
+	    for (i = 0; i < n; i++) {
+		utop = ptop[i + CALC_BLOCK];
+		ptop[i] = (epicsInt32) ((epicsUInt32) ptop[i] & utop);
+	    }
+	    break;
+
+	case BIT_EXCL_OR:
+	    ptop -= CALC_BLOCK;
+	    for (i = 0; i < n; i++) {
+		utop = ptop[i + CALC_BLOCK];
+		ptop[i] = (epicsInt32) ((epicsUInt32) ptop[i] ^ utop);
+	    }
+	    break;
+
+	case BIT_NOT:
+	    for (i = 0; i < n; i++) {
+		utop = ptop[i];
+		ptop[i] = (epicsInt32) ~utop;
+	    }
+	    break;
+
+	case RIGHT_SHIFT:
+	    ptop -= CALC_BLOCK;
+	    for (i = 0; i < n; i++) {
+		utop = ptop[i + CALC_BLOCK];
+		ptop[i] = ((epicsInt32) (epicsUInt32) ptop[i]) >> (utop & 31);
+	    }
+	    break;
+
+	case LEFT_SHIFT:
+	    ptop -= CALC_BLOCK;
+	    for (i = 0; i < n; i++) {
+		utop = ptop[i + CALC_BLOCK];
+		ptop[i] = ((epicsInt32) (epicsUInt32) ptop[i]) << (utop & 31);
+	    }
+	    break;
+
+	case NOT_EQ:
+	    BINARY(x != y);
+	    break;
+
+	case LESS_THAN:
+	    BINARY(x < y);
+	    break;
+
+	case LESS_OR_EQ:
+	    BINARY(x <= y);
+	    break;
+
+	case EQUAL:
+	    BINARY(x == y);
+	    break;
+
+	case GR_OR_EQ:
+	    BINARY(x >= y);
+	    break;
+
+	case GR_THAN:
+	    BINARY(x > y);
+	    break;
+
+	/* The condition and the true result stay on the stack */
+
+	case COND_IF:
+	    if (cond_if(&conds))
+		return -1;
+	    break;
+
+	case COND_IF_JUMP:
+	    if (cond_if(&conds))
+		return -1;
+	    pinst++;
+	    break;
+
+	case COND_ELSE:
+	    nsel = cond_else(&conds, NULL);
+	    if (nsel < 0)
+		return -1;
+	    SELECT(nsel);
+	    break;
+
+	case COND_ELSE_JUMP:
+	    nsel = cond_else(&conds, pinst + 1 + (unsigned char) *pinst);
+	    if (nsel < 0)
+		return -1;
+	    SELECT(nsel);
+	    pinst++;
+	    break;
+
+	case COND_END:
+	    nsel = cond_end(&conds);
+	    SELECT(nsel);
+	    break;
+
+	default:
+	    return -1;
+	}
+    }
+
+    /* The stack should now have one block on it, the expression values */
+    if (ptop != pstack + CALC_BLOCK)
+	return -1;
+    memcpy(presult + base, ptop, n * sizeof(double));
+    return 0;
+}
+
+/* calcPerformArray
+ *
+ * Evaluate the postfix expression for each of nelem elements
+ */
+epicsShareFunc long
+    calcPerformArray(const double * const *pparg, const epicsUInt32 *pnarg,
+	double *presult, epicsUInt32 nelem, const char *pinst, double *pwork)
+{
+    epicsUInt32 base;
+    int k;
+
+    for (k = 0; k < CALCPERFORM_NARGS; k++) {
+	if (pnarg[k] != 1 && pnarg[k] < nelem)
+	    return -1;
+    }
+
+    for (base = 0; base < nelem; base += CALC_BLOCK) {
+	int n = nelem - base < CALC_BLOCK ? nelem - base : CALC_BLOCK;
+
+	if (calc_block(pparg, pnarg, presult, base, n, pinst, pwork))
+	    return -1;
+    }
+    return 0;
+}
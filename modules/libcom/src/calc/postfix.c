@@ -14,6 +14,7 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
@@ -26,7 +27,11 @@
 #include "postfix.h"
 #include "postfixPvt.h"
 #include "shareLib.h"
+#include "epicsExport.h"
 
+/* Set to 0 to have postfix() emit the instructions without optimizing */
+int postfixOptimize = 1;
+epicsExportAddress(int, postfixOptimize);
 
 /* declarations for postfix */
 
@@ -201,6 +206,370 @@ static int
 }
 
 
+/* Optimizer
+ *
+ * After the expression has been converted, sub-expressions that only use
+ * literal values and constants are evaluated by calcPerform() and replaced
+ * by a single literal, so the result at runtime is bit-for-bit the same.
+ * A conditional with a constant condition is reduced to the branch that
+ * would be taken, provided the other branch doesn't fetch or store any
+ * of the arguments A-L so calcArgUsage() gives the same results.
+ * Finally the conditionals are given their jump distances so calcPerform()
+ * doesn't have to search for the matching COND_ELSE or COND_END.
+ *
+ * The optimized instructions never need more space than the postfix
+ * buffer size for the input expression given by INFIX_TO_POSTFIX_SIZE().
+ */
+
+typedef struct {
+    char *pstart;	/* first instruction computing this value */
+    int literal;	/* value only depends on literals and constants */
+} opt_value;
+
+static size_t inst_size(const char *pinst)
+{
+    switch (*pinst) {
+    case LITERAL_DOUBLE:
+	return 1 + sizeof(double);
+    case LITERAL_INT:
+	return 1 + sizeof(epicsInt32);
+    case MIN:
+    case MAX:
+    case FINITE:
+    case ISNAN:
+    case COND_IF_JUMP:
+    case COND_ELSE_JUMP:
+	return 2;
+    default:
+	return 1;
+    }
+}
+
+/* Number of stack values an operator replaces with its result */
+static int inst_args(const char *pinst)
+{
+    switch (*pinst) {
+    case MIN:
+    case MAX:
+    case FINITE:
+    case ISNAN:
+	return pinst[1];
+    case ADD: case SUB: case MULT: case DIV: case MODULO: case POWER:
+    case ATAN2:
+    case REL_OR: case REL_AND:
+    case BIT_OR: case BIT_AND: case BIT_EXCL_OR:
+    case RIGHT_SHIFT: case LEFT_SHIFT:
+    case NOT_EQ: case LESS_THAN: case LESS_OR_EQ:
+    case EQUAL: case GR_OR_EQ: case GR_THAN:
+	return 2;
+    default:
+	return 1;
+    }
+}
+
+/* Find the matching conditional instruction, like cond_search() */
+static char * opt_match(char *pinst, int match)
+{
+    int count = 1;
+
+    while (*pinst != END_EXPRESSION) {
+	if (*pinst == match && --count == 0)
+	    return pinst;
+	if (*pinst == COND_IF)
+	    count++;
+	pinst += inst_size(pinst);
+    }
+    return NULL;
+}
+
+/* Find where the false branch starting at pinst ends. A conditional in
+ * the true branch of another one has its COND_END after the outer one's
+ * COND_END, so its false branch ends at the outer COND_ELSE instead.
+ * Returns NULL unless the branch ends at its own COND_END.
+ */
+static char * opt_branch_end(char *pinst)
+{
+    int depth = 0;
+
+    while (*pinst != END_EXPRESSION) {
+	switch (*pinst) {
+	case COND_IF:
+	    depth++;
+	    break;
+	case COND_ELSE:
+	    if (depth == 0)
+		return NULL;
+	    break;
+	case COND_END:
+	    if (depth-- == 0)
+		return pinst;
+	    break;
+	}
+	pinst += inst_size(pinst);
+    }
+    return NULL;
+}
+
+/* Does every conditional from pinst up to pend have its COND_END there? */
+static int opt_balanced(const char *pinst, const char *pend)
+{
+    int depth = 0;
+
+    while (pinst < pend) {
+	if (*pinst == COND_IF)
+	    depth++;
+	else if (*pinst == COND_END)
+	    depth--;
+	pinst += inst_size(pinst);
+    }
+    return depth == 0;
+}
+
+static int opt_uses_args(const char *pinst, const char *pend)
+{
+    while (pinst < pend) {
+	if (*pinst >= FETCH_A && *pinst <= STORE_L)
+	    return TRUE;
+	pinst += inst_size(pinst);
+    }
+    return FALSE;
+}
+
+/* Evaluate the literal instructions from pstart up to pend */
+static int opt_evaluate(const char *pstart, const char *pend,
+    char *pscratch, double *presult)
+{
+    double args[CALCPERFORM_NARGS] = {0.0};
+
+    memcpy(pscratch, pstart, pend - pstart);
+    pscratch[pend - pstart] = END_EXPRESSION;
+    *presult = 0.0;
+    return calcPerform(args, presult, pscratch) == 0;
+}
+
+static size_t opt_literal(double value, char *pout)
+{
+    static const double zero = 0.0;
+    epicsInt32 lit_i;
+
+    /* Use the shorter integer form if it converts back to exactly the
+     * same double, which excludes NaN and -0.0
+     */
+    if (value >= -2147483648.0 && value <= 2147483647.0) {
+	lit_i = (epicsInt32) value;
+	if ((double) lit_i == value &&
+	    (lit_i != 0 || memcmp(&value, &zero, sizeof(double)) == 0)) {
+	    *pout++ = LITERAL_INT;
+	    memcpy(pout, &lit_i, sizeof(epicsInt32));
+	    return 1 + sizeof(epicsInt32);
+	}
+    }
+    *pout++ = LITERAL_DOUBLE;
+    memcpy(pout, &value, sizeof(double));
+    return 1 + sizeof(double);
+}
+
+/* Replace the instructions from pstart up to pend with len bytes from pnew,
+ * moving the rest of the expression up to *ppexprend.
+ */
+static void opt_replace(char *pstart, char *pend, char **ppexprend,
+    const char *pnew, size_t len)
+{
+    memmove(pstart + len, pend, *ppexprend - pend);
+    if (len)
+	memcpy(pstart, pnew, len);
+    *ppexprend += len - (pend - pstart);
+}
+
+static void opt_fold(char * const pbase, size_t size, char *pscratch)
+{
+    opt_value stack[CALCPERFORM_STACK+1];
+    opt_value *ptop = stack;
+    char *pinst = pbase;
+    char *pexprend = pbase;
+    char *pnext;
+    char lit[1 + sizeof(double)];
+    size_t len;
+    double value;
+    int nargs, i;
+
+    while (*pexprend != END_EXPRESSION)
+	pexprend += inst_size(pexprend);
+    pexprend++;
+
+    while (*pinst != END_EXPRESSION) {
+	pnext = pinst + inst_size(pinst);
+
+	switch (*pinst) {
+	case LITERAL_DOUBLE:
+	case LITERAL_INT:
+	case CONST_PI:
+	case CONST_D2R:
+	case CONST_R2D:
+	    ++ptop;
+	    ptop->pstart = pinst;
+	    ptop->literal = TRUE;
+	    break;
+
+	case FETCH_VAL:
+	case FETCH_A: case FETCH_B: case FETCH_C: case FETCH_D:
+	case FETCH_E: case FETCH_F: case FETCH_G: case FETCH_H:
+	case FETCH_I: case FETCH_J: case FETCH_K: case FETCH_L:
+	case RANDOM:
+	    ++ptop;
+	    ptop->pstart = pinst;
+	    ptop->literal = FALSE;
+	    break;
+
+	case STORE_A: case STORE_B: case STORE_C: case STORE_D:
+	case STORE_E: case STORE_F: case STORE_G: case STORE_H:
+	case STORE_I: case STORE_J: case STORE_K: case STORE_L:
+	case COND_ELSE:
+	    --ptop;
+	    break;
+
+	case COND_IF:
+	    if (ptop->literal) {
+		char *pstart = ptop->pstart;
+		char *pelse = opt_match(pnext, COND_ELSE);
+		char *pend = pelse ? opt_branch_end(pelse + 1) : NULL;
+
+		if (pend && opt_balanced(pnext, pelse) &&
+		    opt_evaluate(pstart, pinst, pscratch, &value)) {
+		    /* Continue with the branch that is kept */
+		    if (value != 0.0 && !opt_uses_args(pelse, pend)) {
+			opt_replace(pelse, pend + 1, &pexprend, NULL, 0);
+			opt_replace(pstart, pnext, &pexprend, NULL, 0);
+			pnext = pstart;
+		    }
+		    else if (value == 0.0 && !opt_uses_args(pnext, pelse)) {
+			opt_replace(pend, pend + 1, &pexprend, NULL, 0);
+			opt_replace(pstart, pelse + 1, &pexprend, NULL, 0);
+			pnext = pstart;
+		    }
+		}
+	    }
+	    --ptop;
+	    break;
+
+	case COND_END:
+	    ptop->literal = FALSE;
+	    break;
+
+	default:
+	    /* An operator, its result replaces the first argument */
+	    nargs = inst_args(pinst);
+	    ptop -= nargs - 1;
+	    for (i = 0; i < nargs && ptop[i].literal; i++)
+		;
+	    if (i < nargs ||
+		!opt_evaluate(ptop->pstart, pnext, pscratch, &value)) {
+		ptop->literal = FALSE;
+		break;
+	    }
+	    len = opt_literal(value, lit);
+	    /* A longer literal is used only if there's space for it */
+	    if ((pexprend - pbase) + len - (pnext - ptop->pstart) <= size) {
+		opt_replace(ptop->pstart, pnext, &pexprend, lit, len);
+		pnext = ptop->pstart + len;
+	    }
+	    break;
+	}
+	pinst = pnext;
+    }
+}
+
+static int opt_patch(char *poffset, const char *ptarget)
+{
+    ptrdiff_t distance = ptarget - (poffset + 1);
+
+    if (distance > 255)
+	return FALSE;
+    *poffset = (char) distance;
+    return TRUE;
+}
+
+/* Convert the conditionals to jumps, unless that doesn't fit. Each jump
+ * goes to the same place cond_search() in calcPerform() would find: a
+ * COND_IF to the instruction after its COND_ELSE, and a COND_ELSE to the
+ * instruction after the first COND_END not taken by a later COND_IF.
+ */
+static void opt_jumps(char * const pbase, size_t size, char *pscratch)
+{
+    char *pif[CALCPERFORM_STACK];
+    char *pelse[CALCPERFORM_STACK];
+    int count[CALCPERFORM_STACK];
+    int nif = 0, nelse = 0;
+    const char *pinst = pbase;
+    char *pout = pscratch;
+    size_t len;
+    int i, j;
+
+    for (;;) {
+	switch (*pinst) {
+	case COND_IF:
+	    if (nif == NELEMENTS(pif) ||
+		(size_t) (pout + 2 - pscratch) > size)
+		return;
+	    for (i = 0; i < nelse; i++)
+		count[i]++;
+	    *pout++ = COND_IF_JUMP;
+	    pif[nif++] = pout++;
+	    break;
+
+	case COND_ELSE:
+	    /* The false branch starts after the COND_ELSE_JUMP */
+	    if (nif == 0 || nelse == NELEMENTS(pelse) ||
+		(size_t) (pout + 2 - pscratch) > size ||
+		!opt_patch(pif[--nif], pout + 2))
+		return;
+	    *pout++ = COND_ELSE_JUMP;
+	    count[nelse] = 1;
+	    pelse[nelse++] = pout++;
+	    break;
+
+	case COND_END:
+	    for (i = j = 0; i < nelse; i++) {
+		if (--count[i] == 0) {
+		    if (!opt_patch(pelse[i], pout))
+			return;
+		}
+		else {
+		    count[j] = count[i];
+		    pelse[j++] = pelse[i];
+		}
+	    }
+	    nelse = j;
+	    break;
+
+	default:
+	    len = inst_size(pinst);
+	    if ((size_t) (pout + len - pscratch) > size)
+		return;
+	    memcpy(pout, pinst, len);
+	    pout += len;
+	}
+	if (*pinst == END_EXPRESSION)
+	    break;
+	pinst += inst_size(pinst);
+    }
+    if (nif || nelse)
+	return;
+    memcpy(pbase, pscratch, pout - pscratch);
+}
+
+static void optimize(char *pinst, size_t size)
+{
+    char *pscratch = malloc(size);
+
+    if (!pscratch)
+	return;
+    opt_fold(pinst, size, pscratch);
+    opt_jumps(pinst, size, pscratch);
+    free(pscratch);
+}
+
+
 /* postfix
  *
  * convert an infix expression to a postfix expression
@@ -216,6 +585,7 @@ epicsShareFunc long
     int cond_count = 0;
     char * const pdest = pout;
     char *pnext;
+    size_t size;
 
     if (psrc == NULL || *psrc == '\0' ||
 	pout == NULL || perror == NULL) {
@@ -223,6 +593,7 @@ epicsShareFunc long
 	if (pout) *pout = END_EXPRESSION;
 	return -1;
     }
+    size = INFIX_TO_POSTFIX_SIZE(strlen(psrc) + 1);
 
     /* place the expression elements into postfix */
     *pout = END_EXPRESSION;
@@ -477,6 +848,8 @@ epicsShareFunc long
 	*perror = CALC_ERR_INCOMPLETE;
 	goto bad;
     }
+    if (postfixOptimize)
+	optimize(pdest, size);
     return 0;
 
 bad:
@@ -592,6 +965,8 @@ epicsShareFunc void
 	"COND_IF",
 	"COND_ELSE",
 	"COND_END",
+	"COND_IF_JUMP",
+	"COND_ELSE_JUMP",
     /* Misc */
 	"NOT_GENERATED"
     };
@@ -618,6 +993,11 @@ epicsShareFunc void
 	    printf("\t%s, %d arg(s)\n", opcodes[(int) op], *++pinst);
 	    pinst++;
 	    break;
+	case COND_IF_JUMP:
+	case COND_ELSE_JUMP:
+	    printf("\t%s +%d\n", opcodes[(int) op], (unsigned char) *++pinst);
+	    pinst++;
+	    break;
 	default:
 	    printf("\t%s\n", opcodes[(int) op]);
 	    pinst++;
@@ -14,7 +14,10 @@
 #ifndef INCpostfixh
 #define INCpostfixh
 
+#include <stddef.h>
+
 #include "shareLib.h"
+#include "epicsTypes.h"
 
 #define CALCPERFORM_NARGS 12
 #define CALCPERFORM_STACK 80
@@ -67,12 +70,32 @@
 extern "C" {
 #endif
 
+/* postfix() folds constant sub-expressions and pre-decodes conditionals
+ * unless this is set to 0.
+ */
+epicsShareExtern int postfixOptimize;
+
 epicsShareFunc long
     postfix(const char *pinfix, char *ppostfix, short *perror);
 
 epicsShareFunc long
     calcPerform(double *parg, double *presult, const char *ppostfix);
 
+/* calcPerformArray() evaluates the expression element by element over
+ * nelem elements. Argument k points to pnarg[k] values; a single value is
+ * used for every element, otherwise there must be at least nelem of them.
+ * presult holds the previous values which VAL fetches, and pwork must
+ * point to calcArrayWorkSize() doubles. calcArrayWorkSize() returns 0 if
+ * the expression can't be evaluated this way.
+ */
+epicsShareFunc size_t
+    calcArrayWorkSize(const char *ppostfix);
+
+epicsShareFunc long
+    calcPerformArray(const double * const *pparg, const epicsUInt32 *pnarg,
+        double *presult, epicsUInt32 nelem, const char *ppostfix,
+        double *pwork);
+
 epicsShareFunc long
     calcArgUsage(const char *ppostfix, unsigned long *pinputs, unsigned long *pstores);
 
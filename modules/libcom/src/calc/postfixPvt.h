@@ -20,6 +20,10 @@
  *     a byte giving the number of arguments to process.
  *  4. You can't use strlen() on an RPN buffer since the literal values
  *     can contain zero bytes.
+ *  5. The optimizer in postfix() may replace COND_IF and COND_ELSE with
+ *     COND_IF_JUMP and COND_ELSE_JUMP, which are followed by a byte
+ *     giving the forward distance to the instruction to continue at,
+ *     counted from the byte after it. The COND_END is then omitted.
  */
 
 #ifndef INCpostfixPvth
@@ -97,8 +101,16 @@ typedef enum {
 	COND_IF,
 	COND_ELSE,
 	COND_END,
+	COND_IF_JUMP,
+	COND_ELSE_JUMP,
     /* Misc */
 	NOT_GENERATED
 } rpn_opcode;
 
+/* Shared by calcPerform() and calcPerformArray(), not exported */
+#if defined(__GNUC__) && !defined(_WIN32)
+__attribute__((visibility("hidden")))
+#endif
+double epicsCalcRandom(void);
+
 #endif /* INCpostfixPvth */
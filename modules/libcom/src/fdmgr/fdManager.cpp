@@ -20,6 +20,16 @@
 //
 
 #include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+
+#if defined(__linux__)
+#   include <unistd.h>
+#   include <sys/epoll.h>
+#   define FDMGR_USE_EPOLL
+#endif
 
 #define instantiateRecourceLib
 #define epicsExportSharedSymbols
@@ -34,6 +44,7 @@ epicsShareDef fdManager fileDescriptorManager;
 
 const unsigned mSecPerSec = 1000u;
 const unsigned uSecPerSec = 1000u * mSecPerSec;
+const int epollMaxEvents = 256;
 
 //
 // fdManager::fdManager()
@@ -44,6 +55,7 @@ const unsigned uSecPerSec = 1000u * mSecPerSec;
 epicsShareFunc fdManager::fdManager () : 
     sleepQuantum ( epicsThreadSleepQuantum () ), 
         fdSetsPtr ( new fd_set [fdrNEnums] ),
+        epollFd ( -1 ), pEpollEvents ( 0 ),
         pTimerQueue ( 0 ), maxFD ( 0 ), processInProg ( false ), 
         pCBReg ( 0 )
 {
@@ -53,6 +65,14 @@ epicsShareFunc fdManager::fdManager () :
     for ( size_t i = 0u; i < fdrNEnums; i++ ) {
         FD_ZERO ( &fdSetsPtr[i] ); 
     }
+
+#ifdef FDMGR_USE_EPOLL
+    // fall back to select() if epoll isnt available
+    this->epollFd = epoll_create1 ( EPOLL_CLOEXEC );
+    if ( this->epollFd >= 0 ) {
+        this->pEpollEvents = new struct epoll_event [epollMaxEvents];
+    }
+#endif
 }
 
 //
@@ -72,6 +92,12 @@ epicsShareFunc fdManager::~fdManager()
     }
     delete this->pTimerQueue;
     delete [] this->fdSetsPtr;
+#ifdef FDMGR_USE_EPOLL
+    if ( this->epollFd >= 0 ) {
+        close ( this->epollFd );
+    }
+    delete [] this->pEpollEvents;
+#endif
     osiSockRelease();
 }
 
@@ -103,6 +129,29 @@ epicsShareFunc void fdManager::process (double delay)
         minDelay = delay;
     }
 
+    if ( this->epollFd >= 0 && this->regList.count () > 0u ) {
+        int status = this->epollWait ( minDelay );
+
+        this->pTimerQueue->process(epicsTime::getMonotonic());
+
+        if ( status > 0 ) {
+            this->dispatch ();
+        }
+        else if ( status < 0 ) {
+            int errnoCpy = SOCKERRNO;
+            if ( errnoCpy != SOCK_EINTR ) {
+                char sockErrBuf[64];
+                epicsSocketConvertErrnoToString ( 
+                    sockErrBuf, sizeof ( sockErrBuf ) );
+                fprintf ( stderr, 
+                "fdManager: epoll_wait failed because \"%s\"\n",
+                    sockErrBuf );
+            }
+        }
+        this->processInProg = false;
+        return;
+    }
+
     bool ioPending = false;
     tsDLIter < fdReg > iter = this->regList.firstIter ();
     while ( iter.valid () ) {
@@ -142,38 +191,7 @@ epicsShareFunc void fdManager::process (double delay)
                 iter = tmp;
             }
 
-            //
-            // I am careful to prevent problems if they access the
-            // above list while in a "callBack()" routine
-            //
-            fdReg * pReg;
-            while ( (pReg = this->activeList.get()) ) {
-                pReg->state = fdReg::limbo;
-
-                //
-                // Tag current fdReg so that we
-                // can detect if it was deleted 
-                // during the call back
-                //
-                this->pCBReg = pReg;
-                pReg->callBack();
-                if (this->pCBReg != NULL) {
-                    //
-                    // check only after we see that it is non-null so
-                    // that we dont trigger bounds-checker dangling pointer 
-                    // error
-                    //
-                    assert (this->pCBReg==pReg);
-                    this->pCBReg = 0;
-                    if (pReg->onceOnly) {
-                        pReg->destroy();
-                    }
-                    else {
-                        this->regList.add(*pReg);
-                        pReg->state = fdReg::pending;
-                    }
-                }
-            }
+            this->dispatch ();
         }
         else if ( status < 0 ) {
             int errnoCpy = SOCKERRNO;
@@ -210,6 +228,150 @@ epicsShareFunc void fdManager::process (double delay)
     return;
 }
 
+//
+// fdManager::dispatch()
+//
+// call back the fdReg objects on the active list
+//
+void fdManager::dispatch ()
+{
+    //
+    // I am careful to prevent problems if they access the
+    // above list while in a "callBack()" routine
+    //
+    fdReg * pReg;
+    while ( (pReg = this->activeList.get()) ) {
+        pReg->state = fdReg::limbo;
+
+        //
+        // Tag current fdReg so that we
+        // can detect if it was deleted 
+        // during the call back
+        //
+        this->pCBReg = pReg;
+        pReg->callBack();
+        if (this->pCBReg != NULL) {
+            //
+            // check only after we see that it is non-null so
+            // that we dont trigger bounds-checker dangling pointer 
+            // error
+            //
+            assert (this->pCBReg==pReg);
+            this->pCBReg = 0;
+            if (pReg->onceOnly) {
+                pReg->destroy();
+            }
+            else {
+                this->regList.add(*pReg);
+                pReg->state = fdReg::pending;
+                //
+                // The fd is registered edge triggered so re-arm it
+                // here, the kernel reports it again right away if
+                // the call back left it ready.
+                //
+                this->epollUpdate ( pReg->getFD () );
+            }
+        }
+    }
+}
+
+#ifdef FDMGR_USE_EPOLL
+
+//
+// fdManager::epollUpdate()
+//
+// (re)register the fd with an event mask built from all of its
+// pending registrations
+//
+void fdManager::epollUpdate ( const SOCKET fd )
+{
+    if ( this->epollFd < 0 ) {
+        return;
+    }
+    static const unsigned events[fdrNEnums] = { EPOLLIN, EPOLLOUT, EPOLLPRI };
+    struct epoll_event ev;
+    memset ( & ev, 0, sizeof ( ev ) );
+    for ( unsigned i = 0u; i < fdrNEnums; i++ ) {
+        fdRegId id ( fd, static_cast < fdRegType > ( i ) );
+        fdReg * pReg = this->fdTbl.lookup ( id );
+        if ( pReg && pReg->state == fdReg::pending ) {
+            ev.events |= events[i];
+        }
+    }
+    ev.data.fd = fd;
+    if ( ! ev.events ) {
+        // fails harmlessly if the fd is closed or was never added
+        epoll_ctl ( this->epollFd, EPOLL_CTL_DEL, fd, & ev );
+        return;
+    }
+    ev.events |= EPOLLET;
+    int status = epoll_ctl ( this->epollFd, EPOLL_CTL_MOD, fd, & ev );
+    if ( status < 0 && errno == ENOENT ) {
+        status = epoll_ctl ( this->epollFd, EPOLL_CTL_ADD, fd, & ev );
+    }
+    if ( status < 0 ) {
+        char sockErrBuf[64];
+        epicsSocketConvertErrnoToString ( 
+            sockErrBuf, sizeof ( sockErrBuf ) );
+        fprintf ( stderr, 
+            "fdManager: epoll_ctl for fd %d failed because \"%s\"\n",
+            int ( fd ), sockErrBuf );
+    }
+}
+
+//
+// fdManager::epollWait()
+//
+// wait for activity and move the fdReg objects which are
+// ready onto the active list
+//
+int fdManager::epollWait ( double delay )
+{
+    // round up so that we dont spin waiting for a timer
+    int timeout = delay * mSecPerSec >= INT_MAX ? 
+        INT_MAX : static_cast < int > ( ceil ( delay * mSecPerSec ) );
+    int status = epoll_wait ( this->epollFd, this->pEpollEvents,
+        epollMaxEvents, timeout );
+
+    for ( int i = 0; i < status; i++ ) {
+        const uint32_t events = this->pEpollEvents[i].events;
+        const SOCKET fd = this->pEpollEvents[i].data.fd;
+        //
+        // select() reports an error or hang up as readable and writable 
+        //
+        bool ready[fdrNEnums];
+        ready[fdrRead] = ( events & ( EPOLLIN | EPOLLERR | EPOLLHUP ) ) != 0;
+        ready[fdrWrite] = ( events & ( EPOLLOUT | EPOLLERR | EPOLLHUP ) ) != 0;
+        ready[fdrException] = ( events & EPOLLPRI ) != 0;
+        for ( unsigned j = 0u; j < fdrNEnums; j++ ) {
+            if ( ! ready[j] ) {
+                continue;
+            }
+            fdRegId id ( fd, static_cast < fdRegType > ( j ) );
+            fdReg * pReg = this->fdTbl.lookup ( id );
+            if ( pReg && pReg->state == fdReg::pending ) {
+                this->regList.remove ( *pReg );
+                this->activeList.add ( *pReg );
+                pReg->state = fdReg::active;
+            }
+        }
+    }
+    return status;
+}
+
+#else /* FDMGR_USE_EPOLL */
+
+void fdManager::epollUpdate ( const SOCKET )
+{
+}
+
+int fdManager::epollWait ( double )
+{
+    return -1;
+}
+
+#endif /* FDMGR_USE_EPOLL */
+
 //
 // fdReg::destroy()
 // (default destroy method)
@@ -270,6 +432,7 @@ void fdManager::installReg (fdReg &reg)
     if ( status != 0 ) {
         throwWithLocation ( fdInterestSubscriptionAlreadyExits () );
     }
+    this->epollUpdate ( reg.getFD () );
 }
 
 //
@@ -311,7 +474,12 @@ void fdManager::removeReg (fdReg &regIn)
     }
     regIn.state = fdReg::limbo;
 
-    FD_CLR(regIn.getFD(), &this->fdSetsPtr[regIn.getType()]);
+    if ( this->epollFd >= 0 ) {
+        this->epollUpdate ( regIn.getFD () );
+    }
+    else {
+        FD_CLR(regIn.getFD(), &this->fdSetsPtr[regIn.getType()]);
+    }
 }
 
 //
@@ -348,7 +516,7 @@ fdReg::fdReg (const SOCKET fdIn, const fdRegType typIn,
     fdRegId (fdIn,typIn), state (limbo), 
     onceOnly (onceOnlyIn), manager (managerIn)
 { 
-    if (!FD_IN_FDSET(fdIn)) {
+    if (this->manager.epollFd < 0 && !FD_IN_FDSET(fdIn)) {
         fprintf (stderr, "%s: fd > FD_SETSIZE ignored\n", 
             __FILE__);
         return;
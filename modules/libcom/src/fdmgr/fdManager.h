@@ -92,6 +92,12 @@ private:
     resTable < fdReg, fdRegId > fdTbl;
     const double sleepQuantum;
     fd_set * fdSetsPtr;
+    //
+    // on Linux the fds are watched with epoll and fdSetsPtr
+    // is unused, epollFd is -1 when select() is used
+    //
+    int epollFd;
+    struct epoll_event * pEpollEvents;
     epicsTimerQueuePassive * pTimerQueue;
     SOCKET maxFD;
     bool processInProg;
@@ -104,6 +110,9 @@ private:
     double quantum ();
     void installReg (fdReg &reg);
     void removeReg (fdReg &reg);
+    void epollUpdate (const SOCKET fd);
+    int epollWait (double delay);
+    void dispatch ();
     void lazyInitTimerQueue ();
     fdManager ( const fdManager & );
     fdManager & operator = ( const fdManager & );
@@ -20,11 +20,17 @@ extern "C" {
 #endif
 
 epicsShareFunc void epicsShareAPI freeListInitPvt(void **ppvt,int size,int nmalloc);
+/* As freeListInitPvt() with a cache of up to cacheSize free blocks
+ * held by each thread, which takes most allocations off the pool lock.
+ */
+epicsShareFunc void epicsShareAPI freeListInitPvtCache(void **ppvt,int size,
+    int nmalloc,int cacheSize);
 epicsShareFunc void * epicsShareAPI freeListCalloc(void *pvt);
 epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt);
 epicsShareFunc void epicsShareAPI freeListFree(void *pvt,void*pmem);
 epicsShareFunc void epicsShareAPI freeListCleanup(void *pvt);
 epicsShareFunc size_t epicsShareAPI freeListItemsAvail(void *pvt);
+epicsShareFunc void epicsShareAPI freeListShow(void *pvt, int level);
 
 #ifdef __cplusplus
 }
@@ -22,9 +22,14 @@
 #define REDZONE 0
 #endif
 
+#include <stdio.h>
+
 #define epicsExportSharedSymbols
 #include "cantProceed.h"
+#include "ellLib.h"
+#include "epicsExit.h"
 #include "epicsMutex.h"
+#include "epicsThread.h"
 #include "freeList.h"
 #include "adjustment.h"
 
@@ -37,10 +42,30 @@ typedef struct {
     int		nmalloc;
     void	*head;
     allocMem	*mallochead;
-    size_t	nBlocksAvailable;
+    size_t	nBlocksAvailable;   /* on the shared list */
     epicsMutexId lock;
+    int		cacheSize;          /* per thread, 0 if not cached */
+    epicsThreadPrivateId cacheId;
+    ELLLIST	caches;             /* guarded by cacheLock */
 }FREELISTPVT;
 
+/* A magazine of free blocks owned by one thread */
+typedef struct freeListCache {
+    ELLNODE	node;
+    FREELISTPVT	*pfl;   /* NULL once the pool is cleaned up */
+    int		count;  /* also read without a lock by freeListItemsAvail */
+    void	*items[1];
+}freeListCache;
+
+/* Guards cache to pool links against freeListCleanup() */
+static epicsMutexId cacheLock;
+static epicsThreadOnceId cacheOnce = EPICS_THREAD_ONCE_INIT;
+
+static void cacheLockInit(void *arg)
+{
+    cacheLock = epicsMutexMustCreate();
+}
+
 epicsShareFunc void epicsShareAPI 
 	freeListInitPvt(void **ppvt,int size,int nmalloc)
 {
@@ -58,32 +83,28 @@ epicsShareFunc void epicsShareAPI
     return;
 }
 
-epicsShareFunc void * epicsShareAPI freeListCalloc(void *pvt)
+epicsShareFunc void epicsShareAPI 
+	freeListInitPvtCache(void **ppvt,int size,int nmalloc,int cacheSize)
 {
-    FREELISTPVT *pfl = pvt;
-#   ifdef EPICS_FREELIST_DEBUG
-    return callocMustSucceed(1,pfl->size,"freeList Debug Calloc");
-#   else
-    void	*ptemp;
+    FREELISTPVT	*pfl;
 
-    ptemp = freeListMalloc(pvt);
-    if(ptemp) memset((char *)ptemp,0,pfl->size);
-    return(ptemp);
-#   endif
+    freeListInitPvt(ppvt, size, nmalloc);
+    if(cacheSize < 2)
+        return;
+    epicsThreadOnce(&cacheOnce, cacheLockInit, NULL);
+    pfl = *ppvt;
+    pfl->cacheSize = cacheSize;
+    pfl->cacheId = epicsThreadPrivateCreate();
 }
-
-epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt)
+
+/* Take a block off the shared list, pfl->lock must be held */
+static void * sharedGet(FREELISTPVT *pfl)
 {
-    FREELISTPVT *pfl = pvt;
-#   ifdef EPICS_FREELIST_DEBUG
-    return callocMustSucceed(1,pfl->size,"freeList Debug Malloc");
-#   else
     void	*ptemp;
     void	**ppnext;
     allocMem	*pallocmem;
     int		i;
 
-    epicsMutexMustLock(pfl->lock);
     ptemp = pfl->head;
     if(ptemp==0) {
         /* layout of each block. nmalloc+1 REDZONEs for nmallocs.
@@ -95,12 +116,10 @@ epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt)
          */
         ptemp = (void *)malloc(pfl->nmalloc*(pfl->size+REDZONE)+REDZONE);
         if(ptemp==0) {
-            epicsMutexUnlock(pfl->lock);
             return(0);
         }
         pallocmem = (allocMem *)calloc(1,sizeof(allocMem));
         if(pallocmem==0) {
-            epicsMutexUnlock(pfl->lock);
             free(ptemp);
             return(0);
         }
@@ -122,10 +141,140 @@ epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt)
     ppnext = pfl->head;
     pfl->head = *ppnext;
     pfl->nBlocksAvailable--;
-    epicsMutexUnlock(pfl->lock);
     VALGRIND_MEMPOOL_FREE(pfl, ptemp);
+    return(ptemp);
+}
+
+/* Return a block to the shared list, pfl->lock must be held */
+static void sharedPut(FREELISTPVT *pfl, void *pmem)
+{
+    void	**ppnext;
+
+    VALGRIND_MEMPOOL_ALLOC(pfl, pmem, sizeof(void*));
+    ppnext = pmem;
+    *ppnext = pfl->head;
+    pfl->head = pmem;
+    pfl->nBlocksAvailable++;
+}
+
+static void cacheExit(void *arg)
+{
+    freeListCache *pcache = arg;
+
+    epicsMutexMustLock(cacheLock);
+    if(pcache->pfl) {
+        FREELISTPVT *pfl = pcache->pfl;
+
+        epicsMutexMustLock(pfl->lock);
+        while(pcache->count > 0)
+            sharedPut(pfl, pcache->items[--pcache->count]);
+        epicsMutexUnlock(pfl->lock);
+        ellDelete(&pfl->caches, &pcache->node);
+    }
+    epicsMutexUnlock(cacheLock);
+    free(pcache);
+}
+
+static freeListCache * cacheGet(FREELISTPVT *pfl)
+{
+    freeListCache *pcache = epicsThreadPrivateGet(pfl->cacheId);
+
+    /* left by a pool which was cleaned up and whose key was reused */
+    if(pcache && pcache->pfl != pfl)
+        pcache = NULL;
+    if(!pcache) {
+        pcache = calloc(1, sizeof(freeListCache) +
+            (pfl->cacheSize - 1) * sizeof(void *));
+        if(!pcache)
+            return NULL;
+        pcache->pfl = pfl;
+        /* the cache is flushed and freed when this thread exits */
+        if(epicsAtThreadExit(cacheExit, pcache)) {
+            free(pcache);
+            return NULL;
+        }
+        epicsMutexMustLock(cacheLock);
+        ellAdd(&pfl->caches, &pcache->node);
+        epicsMutexUnlock(cacheLock);
+        epicsThreadPrivateSet(pfl->cacheId, pcache);
+    }
+    return pcache;
+}
+
+/*
+ * Blocks move between the shared list and a thread's cache half
+ * a cache at a time, so the pool lock is taken once per batch.
+ */
+static void * cacheMalloc(FREELISTPVT *pfl, freeListCache *pcache)
+{
+    void	*ptemp;
+
+    if(pcache->count == 0) {
+        int	batch = pfl->cacheSize / 2;
+
+        epicsMutexMustLock(pfl->lock);
+        while(pcache->count < batch) {
+            ptemp = sharedGet(pfl);
+            if(!ptemp)
+                break;
+            pcache->items[pcache->count++] = ptemp;
+        }
+        epicsMutexUnlock(pfl->lock);
+        if(pcache->count == 0)
+            return(0);
+    }
+    ptemp = pcache->items[--pcache->count];
     VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, pfl->size);
     return(ptemp);
+}
+
+static void cacheFree(FREELISTPVT *pfl, freeListCache *pcache, void *pmem)
+{
+    VALGRIND_MEMPOOL_FREE(pfl, pmem);
+    if(pcache->count == pfl->cacheSize) {
+        int	keep = pfl->cacheSize - pfl->cacheSize / 2;
+
+        epicsMutexMustLock(pfl->lock);
+        while(pcache->count > keep)
+            sharedPut(pfl, pcache->items[--pcache->count]);
+        epicsMutexUnlock(pfl->lock);
+    }
+    pcache->items[pcache->count++] = pmem;
+}
+
+epicsShareFunc void * epicsShareAPI freeListCalloc(void *pvt)
+{
+    FREELISTPVT *pfl = pvt;
+#   ifdef EPICS_FREELIST_DEBUG
+    return callocMustSucceed(1,pfl->size,"freeList Debug Calloc");
+#   else
+    void	*ptemp;
+
+    ptemp = freeListMalloc(pvt);
+    if(ptemp) memset((char *)ptemp,0,pfl->size);
+    return(ptemp);
+#   endif
+}
+
+epicsShareFunc void * epicsShareAPI freeListMalloc(void *pvt)
+{
+    FREELISTPVT *pfl = pvt;
+#   ifdef EPICS_FREELIST_DEBUG
+    return callocMustSucceed(1,pfl->size,"freeList Debug Malloc");
+#   else
+    void	*ptemp;
+
+    if(pfl->cacheId) {
+        freeListCache *pcache = cacheGet(pfl);
+        if(pcache)
+            return cacheMalloc(pfl, pcache);
+    }
+    epicsMutexMustLock(pfl->lock);
+    ptemp = sharedGet(pfl);
+    epicsMutexUnlock(pfl->lock);
+    if(ptemp)
+        VALGRIND_MEMPOOL_ALLOC(pfl, ptemp, pfl->size);
+    return(ptemp);
 #   endif
 }
 
@@ -136,16 +285,16 @@ epicsShareFunc void epicsShareAPI freeListFree(void *pvt,void*pmem)
     memset ( pmem, 0xdd, pfl->size );
     free(pmem);
 #   else
-    void	**ppnext;
-
+    if(pfl->cacheId) {
+        freeListCache *pcache = cacheGet(pfl);
+        if(pcache) {
+            cacheFree(pfl, pcache, pmem);
+            return;
+        }
+    }
     VALGRIND_MEMPOOL_FREE(pvt, pmem);
-    VALGRIND_MEMPOOL_ALLOC(pvt, pmem, sizeof(void*));
-
     epicsMutexMustLock(pfl->lock);
-    ppnext = pmem;
-    *ppnext = pfl->head;
-    pfl->head = pmem;
-    pfl->nBlocksAvailable++;
+    sharedPut(pfl, pmem);
     epicsMutexUnlock(pfl->lock);
 #   endif
 }
@@ -158,6 +307,19 @@ epicsShareFunc void epicsShareAPI freeListCleanup(void *pvt)
 
     VALGRIND_DESTROY_MEMPOOL(pvt);
 
+    if(pfl->cacheId) {
+        freeListCache *pcache;
+
+        /* caches are freed by their threads at exit */
+        epicsMutexMustLock(cacheLock);
+        while((pcache = (freeListCache *)ellGet(&pfl->caches))) {
+            pcache->pfl = NULL;
+            pcache->count = 0;
+        }
+        epicsMutexUnlock(cacheLock);
+        epicsThreadPrivateDelete(pfl->cacheId);
+    }
+
     phead = pfl->mallochead;
     while(phead) {
         pnext = phead->next;
@@ -176,6 +338,43 @@ epicsShareFunc size_t epicsShareAPI freeListItemsAvail(void *pvt)
     epicsMutexMustLock(pfl->lock);
     nBlocksAvailable = pfl->nBlocksAvailable;
     epicsMutexUnlock(pfl->lock);
+    if(pfl->cacheId) {
+        ELLNODE *pnode;
+
+        epicsMutexMustLock(cacheLock);
+        for(pnode = ellFirst(&pfl->caches); pnode; pnode = ellNext(pnode))
+            nBlocksAvailable += ((freeListCache *)pnode)->count;
+        epicsMutexUnlock(cacheLock);
+    }
     return nBlocksAvailable;
 }
 
+epicsShareFunc void epicsShareAPI freeListShow(void *pvt, int level)
+{
+    FREELISTPVT *pfl = pvt;
+    size_t nShared, nCached = 0u;
+    int nCaches = 0;
+    ELLNODE *pnode;
+
+    epicsMutexMustLock(pfl->lock);
+    nShared = pfl->nBlocksAvailable;
+    epicsMutexUnlock(pfl->lock);
+    if(pfl->cacheId) {
+        epicsMutexMustLock(cacheLock);
+        for(pnode = ellFirst(&pfl->caches); pnode; pnode = ellNext(pnode)) {
+            nCached += ((freeListCache *)pnode)->count;
+            nCaches++;
+        }
+        epicsMutexUnlock(cacheLock);
+    }
+    printf("Free list %p: block size %d, %lu available\n",
+        pvt, pfl->size, (unsigned long)(nShared + nCached));
+    if(level > 0) {
+        printf("    %lu on the shared list, allocated %d at a time\n",
+            (unsigned long)nShared, pfl->nmalloc);
+        if(pfl->cacheId)
+            printf("    %lu in %d thread caches of up to %d\n",
+                (unsigned long)nCached, nCaches, pfl->cacheSize);
+    }
+}
+
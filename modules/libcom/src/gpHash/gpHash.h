@@ -31,7 +31,8 @@ struct gphPvt;
 extern "C" {
 #endif
 
-/*tableSize must be power of 2 in range 256 to 65536*/
+/*tableSize must be power of 2 in range 256 to 65536, the table grows*/
+/*as entries are added until it is frozen*/
 epicsShareFunc void epicsShareAPI
     gphInitPvt(struct gphPvt **ppvt, int tableSize);
 epicsShareFunc GPHENTRY * epicsShareAPI
@@ -42,6 +43,10 @@ epicsShareFunc GPHENTRY * epicsShareAPI
     gphAdd(struct gphPvt *pvt, const char *name, void *pvtid);
 epicsShareFunc void epicsShareAPI
     gphDelete(struct gphPvt *pvt, const char *name, void *pvtid);
+/* Lookups in a frozen table don't lock it, and it doesn't resize.
+ * gphAdd() is still allowed, gphDelete() and gphFreeMem() only when
+ * no other thread can be looking up names. */
+epicsShareFunc void epicsShareAPI gphFreeze(struct gphPvt *pvt);
 epicsShareFunc void epicsShareAPI gphFreeMem(struct gphPvt *pvt);
 epicsShareFunc void epicsShareAPI gphDump(struct gphPvt *pvt);
 epicsShareFunc void epicsShareAPI gphDumpFP(FILE *fp, struct gphPvt *pvt);
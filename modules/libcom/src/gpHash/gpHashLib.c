@@ -15,6 +15,7 @@
 
 #define epicsExportSharedSymbols
 #include "cantProceed.h"
+#include "epicsAtomic.h"
 #include "epicsMutex.h"
 #include "epicsStdioRedirect.h"
 #include "epicsString.h"
@@ -23,16 +24,28 @@
 #include "epicsPrint.h"
 #include "gpHash.h"
 
+/*
+ * The table doubles its number of buckets whenever it holds more than
+ * MAX_LOAD entries per bucket.  Once frozen it never resizes, and lookups
+ * walk the bucket lists without taking the lock.  gphAdd() still works on
+ * a frozen table: it completes the new node before the memory barrier and
+ * the store that links it into its list, so a concurrent lookup either
+ * misses it or sees all of it.
+ */
 typedef struct gphPvt {
     int size;
     unsigned int mask;
-    ELLLIST **paplist; /*pointer to array of pointers to ELLLIST */
+    ELLLIST *buckets;   /* array of size lists */
     epicsMutexId lock;
+    int count;
+    int frozen;
 } gphPvt;
 
 #define MIN_SIZE 256
 #define DEFAULT_SIZE 512
 #define MAX_SIZE 65536
+#define MAX_GROWN_SIZE 1048576
+#define MAX_LOAD 2
 
 
 void epicsShareAPI gphInitPvt(gphPvt **ppvt, int size)
@@ -53,39 +66,77 @@ void epicsShareAPI gphInitPvt(gphPvt **ppvt, int size)
     pgphPvt = callocMustSucceed(1, sizeof(gphPvt), "gphInitPvt");
     pgphPvt->size = size;
     pgphPvt->mask = size - 1;
-    pgphPvt->paplist = callocMustSucceed(size, sizeof(ELLLIST *), "gphInitPvt");
+    pgphPvt->buckets = callocMustSucceed(size, sizeof(ELLLIST), "gphInitPvt");
     pgphPvt->lock = epicsMutexMustCreate();
     *ppvt = pgphPvt;
     return;
 }
 
-GPHENTRY * epicsShareAPI gphFindParse(gphPvt *pgphPvt, const char *name, size_t len, void *pvtid)
+static unsigned int gphHash(const char *name, size_t len, void *pvtid)
 {
-    ELLLIST **paplist;
-    ELLLIST *gphlist;
-    GPHENTRY *pgphNode;
-    int hash;
+    unsigned int hash = epicsMemHash((char *)&pvtid, sizeof(void *), 0);
 
-    if (pgphPvt == NULL) return NULL;
-    paplist = pgphPvt->paplist;
-    hash = epicsMemHash((char *)&pvtid, sizeof(void *), 0);
-    hash = epicsMemHash(name, len, hash) & pgphPvt->mask;
+    return epicsMemHash(name, len, hash);
+}
 
-    epicsMutexMustLock(pgphPvt->lock);
-    gphlist = paplist[hash];
-    if (gphlist == NULL) {
-        pgphNode = NULL;
-    } else {
-        pgphNode = (GPHENTRY *) ellFirst(gphlist);
+/* Caller holds the lock, and the table is not frozen */
+static void gphResize(gphPvt *pgphPvt, int size)
+{
+    ELLLIST *buckets = calloc(size, sizeof(ELLLIST));
+    unsigned int mask = size - 1;
+    int h;
+
+    if (!buckets)
+        return;     /* Carry on with longer lists */
+
+    for (h = 0; h < pgphPvt->size; h++) {
+        ELLLIST *plist = &pgphPvt->buckets[h];
+        GPHENTRY *pgphNode;
+
+        while ((pgphNode = (GPHENTRY *) ellGet(plist))) {
+            unsigned int hash = gphHash(pgphNode->name,
+                strlen(pgphNode->name), pgphNode->pvtid) & mask;
+
+            ellAdd(&buckets[hash], (ELLNODE *)pgphNode);
+        }
     }
+    free(pgphPvt->buckets);
+    pgphPvt->buckets = buckets;
+    pgphPvt->size = size;
+    pgphPvt->mask = mask;
+}
+
+static GPHENTRY * gphSearch(ELLLIST *plist, const char *name, size_t len,
+    void *pvtid)
+{
+    GPHENTRY *pgphNode = (GPHENTRY *) ellFirst(plist);
 
     while (pgphNode) {
         if (pvtid == pgphNode->pvtid &&
-            strlen(pgphNode->name) == len &&
-            strncmp(name, pgphNode->name, len) == 0) break;
+            strncmp(name, pgphNode->name, len) == 0 &&
+            pgphNode->name[len] == 0) break;
         pgphNode = (GPHENTRY *) ellNext((ELLNODE *)pgphNode);
     }
+    return pgphNode;
+}
+
+GPHENTRY * epicsShareAPI gphFindParse(gphPvt *pgphPvt, const char *name, size_t len, void *pvtid)
+{
+    GPHENTRY *pgphNode;
+    unsigned int hash;
+
+    if (pgphPvt == NULL) return NULL;
+    hash = gphHash(name, len, pvtid);
+
+    if (epicsAtomicGetIntT(&pgphPvt->frozen)) {
+        epicsAtomicReadMemoryBarrier();
+        return gphSearch(&pgphPvt->buckets[hash & pgphPvt->mask],
+            name, len, pvtid);
+    }
 
+    epicsMutexMustLock(pgphPvt->lock);
+    pgphNode = gphSearch(&pgphPvt->buckets[hash & pgphPvt->mask],
+        name, len, pvtid);
     epicsMutexUnlock(pgphPvt->lock);
     return pgphNode;
 }
@@ -97,43 +148,32 @@ GPHENTRY * epicsShareAPI gphFind(gphPvt *pgphPvt, const char *name, void *pvtid)
 
 GPHENTRY * epicsShareAPI gphAdd(gphPvt *pgphPvt, const char *name, void *pvtid)
 {
-    ELLLIST **paplist;
     ELLLIST *plist;
     GPHENTRY *pgphNode;
-    int hash;
+    unsigned int hash;
+    size_t len;
 
     if (pgphPvt == NULL) return NULL;
-    paplist = pgphPvt->paplist;
-    hash = epicsMemHash((char *)&pvtid, sizeof(void *), 0);
-    hash = epicsStrHash(name, hash) & pgphPvt->mask;
+    len = strlen(name);
+    hash = gphHash(name, len, pvtid);
 
     epicsMutexMustLock(pgphPvt->lock);
-    plist = paplist[hash];
-    if (plist == NULL) {
-        plist = calloc(1, sizeof(ELLLIST));
-        if(!plist){
-            epicsMutexUnlock(pgphPvt->lock);
-            return NULL;
-        }
-        ellInit(plist);
-        paplist[hash] = plist;
-    }
-
-    pgphNode = (GPHENTRY *) ellFirst(plist);
-    while (pgphNode) {
-        if (pvtid == pgphNode->pvtid &&
-            strcmp(name, pgphNode->name) == 0) {
-            epicsMutexUnlock(pgphPvt->lock);
-            return NULL;
-        }
-        pgphNode = (GPHENTRY *) ellNext((ELLNODE *)pgphNode);
+    plist = &pgphPvt->buckets[hash & pgphPvt->mask];
+    if (gphSearch(plist, name, len, pvtid)) {
+        epicsMutexUnlock(pgphPvt->lock);
+        return NULL;
     }
 
     pgphNode = calloc(1, sizeof(GPHENTRY));
-    if(pgphNode) {
+    if (pgphNode) {
         pgphNode->name = name;
         pgphNode->pvtid = pvtid;
+        epicsAtomicWriteMemoryBarrier();
         ellAdd(plist, (ELLNODE *)pgphNode);
+
+        if (++pgphPvt->count > MAX_LOAD * pgphPvt->size &&
+            pgphPvt->size < MAX_GROWN_SIZE && !pgphPvt->frozen)
+            gphResize(pgphPvt, 2 * pgphPvt->size);
     }
 
     epicsMutexUnlock(pgphPvt->lock);
@@ -142,65 +182,56 @@ GPHENTRY * epicsShareAPI gphAdd(gphPvt *pgphPvt, const char *name, void *pvtid)
 
 void epicsShareAPI gphDelete(gphPvt *pgphPvt, const char *name, void *pvtid)
 {
-    ELLLIST **paplist;
-    ELLLIST *plist = NULL;
+    ELLLIST *plist;
     GPHENTRY *pgphNode;
-    int hash;
+    size_t len;
 
     if (pgphPvt == NULL) return;
-    paplist = pgphPvt->paplist;
-    hash = epicsMemHash((char *)&pvtid, sizeof(void *), 0);
-    hash = epicsStrHash(name, hash) & pgphPvt->mask;
+    len = strlen(name);
 
     epicsMutexMustLock(pgphPvt->lock);
-    if (paplist[hash] == NULL) {
-        pgphNode = NULL;
-    } else {
-        plist = paplist[hash];
-        pgphNode = (GPHENTRY *) ellFirst(plist);
-    }
-
-    while(pgphNode) {
-        if (pvtid == pgphNode->pvtid &&
-            strcmp(name, pgphNode->name) == 0) {
-            ellDelete(plist, (ELLNODE*)pgphNode);
-            free((void *)pgphNode);
-            break;
-        }
-        pgphNode = (GPHENTRY *) ellNext((ELLNODE*)pgphNode);
+    plist = &pgphPvt->buckets[gphHash(name, len, pvtid) & pgphPvt->mask];
+    pgphNode = gphSearch(plist, name, len, pvtid);
+    if (pgphNode) {
+        ellDelete(plist, (ELLNODE*)pgphNode);
+        free((void *)pgphNode);
+        pgphPvt->count--;
     }
 
     epicsMutexUnlock(pgphPvt->lock);
     return;
 }
 
+void epicsShareAPI gphFreeze(gphPvt *pgphPvt)
+{
+    int size;
+
+    if (pgphPvt == NULL) return;
+
+    epicsMutexMustLock(pgphPvt->lock);
+    if (!pgphPvt->frozen) {
+        /* Lookups are lock-free from now on, make them short */
+        for (size = pgphPvt->size;
+             size < pgphPvt->count && size < MAX_GROWN_SIZE; size *= 2);
+        if (size > pgphPvt->size)
+            gphResize(pgphPvt, size);
+        epicsAtomicWriteMemoryBarrier();
+        epicsAtomicSetIntT(&pgphPvt->frozen, 1);
+    }
+    epicsMutexUnlock(pgphPvt->lock);
+}
+
 void epicsShareAPI gphFreeMem(gphPvt *pgphPvt)
 {
-    ELLLIST **paplist;
     int h;
 
     /* Caller must ensure that no other thread is using *pvt */
     if (pgphPvt == NULL) return;
 
-    paplist = pgphPvt->paplist;
-    for (h = 0; h < pgphPvt->size; h++) {
-        ELLLIST *plist = paplist[h];
-        GPHENTRY *pgphNode;
-        GPHENTRY *next;
-
-        if (plist == NULL) continue;
-        pgphNode = (GPHENTRY *) ellFirst(plist);
-
-        while (pgphNode) {
-            next = (GPHENTRY *) ellNext((ELLNODE*)pgphNode);
-            ellDelete(plist, (ELLNODE*)pgphNode);
-            free(pgphNode);
-            pgphNode = next;
-        }
-        free(paplist[h]);
-    }
+    for (h = 0; h < pgphPvt->size; h++)
+        ellFree(&pgphPvt->buckets[h]);
     epicsMutexDestroy(pgphPvt->lock);
-    free(paplist);
+    free(pgphPvt->buckets);
     free(pgphPvt);
 }
 
@@ -212,21 +243,20 @@ void epicsShareAPI gphDump(gphPvt *pgphPvt)
 void epicsShareAPI gphDumpFP(FILE *fp, gphPvt *pgphPvt)
 {
     unsigned int empty = 0;
-    ELLLIST **paplist;
     int h;
 
     if (pgphPvt == NULL)
         return;
 
+    epicsMutexMustLock(pgphPvt->lock);
     fprintf(fp, "Hash table has %d buckets", pgphPvt->size);
 
-    paplist = pgphPvt->paplist;
     for (h = 0; h < pgphPvt->size; h++) {
-        ELLLIST *plist = paplist[h];
+        ELLLIST *plist = &pgphPvt->buckets[h];
         GPHENTRY *pgphNode;
         int i = 0;
 
-        if (plist == NULL) {
+        if (ellCount(plist) == 0) {
             empty++;
             continue;
         }
@@ -240,5 +270,7 @@ void epicsShareAPI gphDumpFP(FILE *fp, gphPvt *pgphPvt)
             pgphNode = (GPHENTRY *) ellNext((ELLNODE*)pgphNode);
         }
     }
-    fprintf(fp, "\n%u buckets empty.\n", empty);
+    fprintf(fp, "\n%u buckets empty, %d entries%s.\n", empty,
+        pgphPvt->count, pgphPvt->frozen ? ", frozen" : "");
+    epicsMutexUnlock(pgphPvt->lock);
 }
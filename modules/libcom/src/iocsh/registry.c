@@ -77,6 +77,12 @@ epicsShareFunc void * epicsShareAPI registryFind(
     return(pentry->userPvt);
 }
 
+epicsShareFunc void epicsShareAPI registryFreeze(void)
+{
+    if(!gphPvt) registryInit(0);
+    gphFreeze(gphPvt);
+}
+
 epicsShareFunc void epicsShareAPI registryFree(void)
 {
     if(!gphPvt) return;
@@ -25,6 +25,8 @@ epicsShareFunc int epicsShareAPI registryChange(
     void *registryID,const char *name,void *data);
 
 epicsShareFunc int epicsShareAPI registrySetTableSize(int size);
+/* Makes registryFind() lock-free, registryAdd() still works */
+epicsShareFunc void epicsShareAPI registryFreeze(void);
 epicsShareFunc void epicsShareAPI registryFree(void);
 epicsShareFunc int epicsShareAPI registryDump(void);
 
@@ -14,6 +14,7 @@
 
 #define epicsExportSharedSymbols
 #include "epicsTypes.h"
+#include "epicsAtomic.h"
 #include "epicsEvent.h"
 #include "epicsMutex.h"
 #include "epicsMessageQueue.h"
@@ -59,10 +60,25 @@ typedef struct {
     } getInt;
 } gtProvider;
 
+/* epicsTimeGetCurrent() calls fastTimeProvider without searching the
+ * provider list or taking timeListLock when it is set.  It is the highest
+ * priority provider, and is cleared when that fails or the provider list
+ * changes.
+ *
+ * Where size_t has 64 bits the last time returned is kept packed as
+ * nanoseconds past the epoch in lastTimePacked, and only ever moved
+ * forward by compare and swap, so the fast path makes one provider call
+ * and never waits.  Elsewhere it is kept in lastProvidedTime guarded by
+ * timeListLock, and there is no fast path.
+ */
+#define LAST_TIME_PACKED (sizeof(size_t) >= 8)
+
 static struct {
     epicsMutexId    timeListLock;
     ELLLIST         timeProviders;
     gtProvider      *lastTimeProvider;
+    gtProvider      *fastTimeProvider;  /* use atomic */
+    size_t          lastTimePacked;     /* use atomic */
     epicsTimeStamp  lastProvidedTime;
 
     epicsMutexId    eventListLock;
@@ -103,6 +119,55 @@ void generalTime_Init(void)
 }
 
 
+/* Move the last time returned forward to *pts.  Returns 0 without
+ * changing it if it is already later than *pts, and sets *pLast to it.
+ * The caller holds timeListLock unless LAST_TIME_PACKED.
+ */
+static int lastTimeAdvance(const epicsTimeStamp *pts, epicsTimeStamp *pLast)
+{
+    if (LAST_TIME_PACKED) {
+        size_t ts = (size_t)pts->secPastEpoch * 1000000000u + pts->nsec;
+        size_t last = epicsAtomicGetSizeT(&gtPvt.lastTimePacked);
+
+        while (ts >= last) {
+            size_t prev = epicsAtomicCmpAndSwapSizeT(&gtPvt.lastTimePacked,
+                last, ts);
+
+            if (prev == last)
+                return 1;
+            last = prev;    /* advanced by another caller, compare again */
+        }
+        pLast->secPastEpoch = (epicsUInt32)(last / 1000000000u);
+        pLast->nsec = (epicsUInt32)(last % 1000000000u);
+        return 0;
+    }
+    if (!epicsTimeGreaterThanEqual(pts, &gtPvt.lastProvidedTime)) {
+        *pLast = gtPvt.lastProvidedTime;
+        return 0;
+    }
+    gtPvt.lastProvidedTime = *pts;
+    return 1;
+}
+
+/* Provider ptp returned *pts, which is older than *pLast */
+static void lastTimeOlder(const gtProvider *ptp, const epicsTimeStamp *pts,
+    const epicsTimeStamp *pLast)
+{
+    int key = epicsInterruptLock();
+
+    gtPvt.ErrorCounts++;
+    epicsInterruptUnlock(key);
+
+    IFDEBUG(10) {
+        char last[40], buff[40];
+
+        epicsTimeToStrftime(last, sizeof(last), tsfmt, pLast);
+        epicsTimeToStrftime(buff, sizeof(buff), tsfmt, pts);
+        printf("eTGC provider '%s' returned older time\n"
+            "    %s, using %s instead\n", ptp->name, buff, last);
+    }
+}
+
 int generalTimeGetExceptPriority(epicsTimeStamp *pDest, int *pPrio, int ignore)
 {
     gtProvider *ptp;
@@ -164,6 +229,21 @@ int epicsShareAPI epicsTimeGetCurrent(epicsTimeStamp *pDest)
     IFDEBUG(20)
         printf("epicsTimeGetCurrent()\n");
 
+    /* Fast path, no list search and no lock */
+    ptp = (gtProvider *)epicsAtomicGetPtrT(
+        (EpicsAtomicPtrT *)&gtPvt.fastTimeProvider);
+    if (ptp) {
+        status = ptp->get.Time(&ts);
+        if (status == epicsTimeOK) {
+            if (lastTimeAdvance(&ts, pDest))
+                *pDest = ts;
+            else
+                lastTimeOlder(ptp, &ts, pDest);
+            return status;
+        }
+        /* The provider failed, search the list */
+    }
+
     epicsMutexMustLock(gtPvt.timeListLock);
     for (ptp = (gtProvider *)ellFirst(&gtPvt.timeProviders);
          ptp; ptp = (gtProvider *)ellNext(&ptp->node)) {
@@ -171,33 +251,20 @@ int epicsShareAPI epicsTimeGetCurrent(epicsTimeStamp *pDest)
         status = ptp->get.Time(&ts);
         if (status == epicsTimeOK) {
             /* check time is monotonic */
-            if (epicsTimeGreaterThanEqual(&ts, &gtPvt.lastProvidedTime)) {
+            if (lastTimeAdvance(&ts, pDest)) {
                 *pDest = ts;
-                gtPvt.lastProvidedTime = ts;
                 gtPvt.lastTimeProvider = ptp;
             } else {
-                int key;
-
-                *pDest = gtPvt.lastProvidedTime;
-                key = epicsInterruptLock();
-                gtPvt.ErrorCounts++;
-                epicsInterruptUnlock(key);
-
-                IFDEBUG(10) {
-                    char last[40], buff[40];
-
-                    epicsTimeToStrftime(last, sizeof(last), tsfmt,
-                        &gtPvt.lastProvidedTime);
-                    epicsTimeToStrftime(buff, sizeof(buff), tsfmt, &ts);
-                    printf("eTGC provider '%s' returned older time\n"
-                        "    %s, using %s instead\n", ptp->name, buff, last);
-                }
+                lastTimeOlder(ptp, &ts, pDest);
             }
             break;
         }
     }
     if (status)
         gtPvt.lastTimeProvider = NULL;
+    epicsAtomicSetPtrT((EpicsAtomicPtrT *)&gtPvt.fastTimeProvider,
+        (LAST_TIME_PACKED && ptp &&
+         ptp == (gtProvider *)ellFirst(&gtPvt.timeProviders)) ? ptp : NULL);
     epicsMutexUnlock(gtPvt.timeListLock);
 
     IFDEBUG(20) {
@@ -394,6 +461,10 @@ static void insertProvider(gtProvider *ptp, ELLLIST *plist, epicsMutexId lock)
         useOsdGetCurrent = 0;
     }
 
+    /* The highest priority provider may have changed */
+    if (plist == &gtPvt.timeProviders)
+        epicsAtomicSetPtrT((EpicsAtomicPtrT *)&gtPvt.fastTimeProvider, NULL);
+
     epicsMutexUnlock(lock);
 }
 
@@ -64,8 +64,8 @@ epicsTimerNotify::expireStatus epicsTimerForC::expire ( const epicsTime & )
 
 epicsTimerQueueActiveForC ::
     epicsTimerQueueActiveForC ( RefMgr & refMgr, 
-        bool okToShare, unsigned priority ) :
-    timerQueueActive ( refMgr, okToShare, priority )
+        bool okToShare, unsigned priority, epicsTimerQueueType type ) :
+    timerQueueActive ( refMgr, okToShare, priority, type )
 {
     timerQueueActive::start();
 }
@@ -82,8 +82,9 @@ void epicsTimerQueueActiveForC::release ()
 epicsTimerQueuePassiveForC::epicsTimerQueuePassiveForC ( 
     epicsTimerQueueNotifyReschedule pRescheduleCallbackIn, 
     epicsTimerQueueNotifyQuantum pSleepQuantumCallbackIn,
-    void * pPrivateIn ) :
-        timerQueuePassive ( * static_cast < epicsTimerQueueNotify * > ( this ) ), 
+    void * pPrivateIn,
+    epicsTimerQueueType type ) :
+        timerQueuePassive ( * static_cast < epicsTimerQueueNotify * > ( this ), type ), 
         pRescheduleCallback ( pRescheduleCallbackIn ), 
         pSleepQuantumCallback ( pSleepQuantumCallbackIn ),
         pPrivate ( pPrivateIn )
@@ -151,12 +152,22 @@ extern "C" epicsTimerQueuePassiveId epicsShareAPI
         epicsTimerQueueNotifyReschedule pRescheduleCallbackIn, 
         epicsTimerQueueNotifyQuantum pSleepQuantumCallbackIn,
         void * pPrivateIn )
+{
+    return epicsTimerQueuePassiveCreateType ( pRescheduleCallbackIn,
+        pSleepQuantumCallbackIn, pPrivateIn, epicsTimerQueueTypeList );
+}
+
+extern "C" epicsTimerQueuePassiveId epicsShareAPI
+    epicsTimerQueuePassiveCreateType ( 
+        epicsTimerQueueNotifyReschedule pRescheduleCallbackIn, 
+        epicsTimerQueueNotifyQuantum pSleepQuantumCallbackIn,
+        void * pPrivateIn, epicsTimerQueueType type )
 {
     try {
         return new epicsTimerQueuePassiveForC ( 
             pRescheduleCallbackIn, 
             pSleepQuantumCallbackIn,
-            pPrivateIn );
+            pPrivateIn, type );
     }
     catch ( ... ) {
         return 0;
@@ -205,12 +216,20 @@ extern "C" void  epicsShareAPI epicsTimerQueuePassiveShow (
 
 extern "C" epicsTimerQueueId epicsShareAPI
     epicsTimerQueueAllocate ( int okToShare, unsigned int threadPriority )
+{
+    return epicsTimerQueueAllocateType ( okToShare, threadPriority,
+        epicsTimerQueueTypeList );
+}
+
+extern "C" epicsTimerQueueId epicsShareAPI
+    epicsTimerQueueAllocateType ( int okToShare, unsigned int threadPriority,
+        epicsTimerQueueType type )
 {
     try {
         epicsSingleton < timerQueueActiveMgr > :: reference ref = 
             timerQueueMgrEPICS.getReference ();
         epicsTimerQueueActiveForC & tmr = 
-            ref->allocate ( ref, okToShare ? true : false, threadPriority );
+            ref->allocate ( ref, okToShare ? true : false, threadPriority, type );
         return &tmr;
     }
     catch ( ... ) {
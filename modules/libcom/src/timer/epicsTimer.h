@@ -20,6 +20,17 @@
 #include "epicsTime.h"
 #include "epicsThread.h"
 
+/*
+ * Pending timers are kept in a time sorted list by default, which is
+ * cheapest for the handful of timers that most queues hold. A queue
+ * created with the heap type keeps them in a binary heap instead so
+ * that start and cancel stay O(log n) with very many timers pending.
+ */
+typedef enum {
+    epicsTimerQueueTypeList,
+    epicsTimerQueueTypeHeap
+} epicsTimerQueueType;
+
 #ifdef __cplusplus
 
 /*
@@ -83,6 +94,8 @@ class epicsTimerQueueActive
 public:
     static epicsShareFunc epicsTimerQueueActive & allocate (
         bool okToShare, unsigned threadPriority = epicsThreadPriorityMin + 10 );
+    static epicsShareFunc epicsTimerQueueActive & allocate (
+        bool okToShare, unsigned threadPriority, epicsTimerQueueType );
     virtual void release () = 0; 
 protected:
     epicsShareFunc virtual ~epicsTimerQueueActive () = 0;
@@ -104,6 +117,8 @@ class epicsTimerQueuePassive
     : public epicsTimerQueue {
 public:
     static epicsShareFunc epicsTimerQueuePassive & create ( epicsTimerQueueNotify & );
+    static epicsShareFunc epicsTimerQueuePassive & create ( epicsTimerQueueNotify &,
+        epicsTimerQueueType );
     epicsShareFunc virtual ~epicsTimerQueuePassive () = 0; /* ok to call delete */
     virtual double process ( const epicsTime & currentTime ) = 0; /* returns delay to next expire */
 };
@@ -137,6 +152,9 @@ typedef void ( *epicsTimerCallback ) ( void *pPrivate );
 typedef struct epicsTimerQueueActiveForC * epicsTimerQueueId;
 epicsShareFunc epicsTimerQueueId epicsShareAPI
     epicsTimerQueueAllocate ( int okToShare, unsigned int threadPriority );
+epicsShareFunc epicsTimerQueueId epicsShareAPI
+    epicsTimerQueueAllocateType ( int okToShare, unsigned int threadPriority,
+        epicsTimerQueueType type );
 epicsShareFunc void epicsShareAPI 
     epicsTimerQueueRelease ( epicsTimerQueueId );
 epicsShareFunc epicsTimerId epicsShareAPI 
@@ -154,6 +172,9 @@ typedef double ( * epicsTimerQueueNotifyQuantum ) ( void * pPrivate );
 epicsShareFunc epicsTimerQueuePassiveId epicsShareAPI
     epicsTimerQueuePassiveCreate ( epicsTimerQueueNotifyReschedule, 
         epicsTimerQueueNotifyQuantum, void *pPrivate );
+epicsShareFunc epicsTimerQueuePassiveId epicsShareAPI
+    epicsTimerQueuePassiveCreateType ( epicsTimerQueueNotifyReschedule,
+        epicsTimerQueueNotifyQuantum, void *pPrivate, epicsTimerQueueType type );
 epicsShareFunc void epicsShareAPI 
     epicsTimerQueuePassiveDestroy ( epicsTimerQueuePassiveId );
 epicsShareFunc epicsTimerId epicsShareAPI 
@@ -50,6 +50,8 @@ private:
     epicsTime exp; // experation time 
     state curState; // current state 
     epicsTimerNotify * pNotify; // callback
+    unsigned heapIndex; // position in the pending heap
+    unsigned heapSeq; // orders timers with equal expiration in the heap
     void privateStart ( epicsTimerNotify & notify, const epicsTime & );
     timer & operator = ( const timer & );
     // Visual C++ .net appears to require operator delete if
@@ -87,18 +89,26 @@ using std :: type_info;
 
 class timerQueue : public epicsTimerQueue {
 public:
-    timerQueue ( epicsTimerQueueNotify &notify );
+    timerQueue ( epicsTimerQueueNotify &notify,
+        epicsTimerQueueType type = epicsTimerQueueTypeList );
     virtual ~timerQueue ();
     epicsTimer & createTimer ();
     epicsTimerForC & createTimerForC ( epicsTimerCallback pCallback, void *pArg );
     double process ( const epicsTime & currentTime );
     void show ( unsigned int level ) const;
+    epicsTimerQueueType queueType () const;
 private:
     tsFreeList < timer, 0x20 > timerFreeList;
     tsFreeList < epicsTimerForC, 0x20 > timerForCFreeList;
     mutable epicsMutex mutex;
     epicsEvent cancelBlockingEvent;
     tsDLList < timer > timerList;
+    timer ** pHeap;
+    unsigned heapCount;
+    unsigned heapSize;
+    unsigned heapSeq;
+    unsigned nTimers;
+    const epicsTimerQueueType type;
     epicsTimerQueueNotify & notify;
     timer * pExpireTmr;
     epicsThreadId processThread;
@@ -107,6 +117,15 @@ private:
     static const double exceptMsgMinPeriod;
     void printExceptMsg ( const char * pName,
                 const type_info & type );
+    void reserve ();
+    void unreserve ();
+    timer * pendingFirst () const;
+    bool pendingInsert ( timer & );
+    void pendingRemove ( timer & );
+    unsigned pendingCount () const;
+    bool heapBefore ( const timer &, const timer & ) const;
+    void heapUp ( unsigned index );
+    void heapDown ( unsigned index );
 	timerQueue ( const timerQueue & );
     timerQueue & operator = ( const timerQueue & );
     friend class timer;
@@ -130,13 +149,15 @@ class timerQueueActive : public epicsTimerQueueActive,
     public timerQueueActiveMgrPrivate {
 public:
     typedef epicsSingleton < timerQueueActiveMgr > :: reference RefMgr;
-    timerQueueActive ( RefMgr &, bool okToShare, unsigned priority );
+    timerQueueActive ( RefMgr &, bool okToShare, unsigned priority,
+        epicsTimerQueueType type = epicsTimerQueueTypeList );
     void start ();
     epicsTimer & createTimer ();
     epicsTimerForC & createTimerForC ( epicsTimerCallback pCallback, void *pArg );
     void show ( unsigned int level ) const;
     bool sharingOK () const;
     unsigned threadPriority () const;
+    epicsTimerQueueType queueType () const;
 protected:
     ~timerQueueActive ();
     RefMgr _refMgr;
@@ -166,7 +187,8 @@ public:
 	timerQueueActiveMgr ();
     ~timerQueueActiveMgr ();
     epicsTimerQueueActiveForC & allocate ( RefThis &, bool okToShare, 
-        unsigned threadPriority = epicsThreadPriorityMin + 10 );
+        unsigned threadPriority = epicsThreadPriorityMin + 10,
+        epicsTimerQueueType type = epicsTimerQueueTypeList );
     void release ( epicsTimerQueueActiveForC & );
 private:
     epicsMutex mutex;
@@ -179,7 +201,8 @@ extern epicsSingleton < timerQueueActiveMgr > timerQueueMgrEPICS;
 
 class timerQueuePassive : public epicsTimerQueuePassive {
 public:
-    timerQueuePassive ( epicsTimerQueueNotify & );
+    timerQueuePassive ( epicsTimerQueueNotify &,
+        epicsTimerQueueType type = epicsTimerQueueTypeList );
     epicsTimer & createTimer ();
     epicsTimerForC & createTimerForC ( epicsTimerCallback pCallback, void *pArg );
     void show ( unsigned int level ) const;
@@ -198,7 +221,8 @@ public:
     epicsTimerQueuePassiveForC ( 
         epicsTimerQueueNotifyReschedule, 
         epicsTimerQueueNotifyQuantum,
-        void * pPrivate );
+        void * pPrivate,
+        epicsTimerQueueType type = epicsTimerQueueTypeList );
     void destroy ();
 protected:
     ~epicsTimerQueuePassiveForC ();
@@ -214,7 +238,8 @@ private:
 struct epicsTimerQueueActiveForC : public timerQueueActive, 
     public tsDLNode < epicsTimerQueueActiveForC > {
 public:
-    epicsTimerQueueActiveForC ( RefMgr &, bool okToShare, unsigned priority );
+    epicsTimerQueueActiveForC ( RefMgr &, bool okToShare, unsigned priority,
+        epicsTimerQueueType type = epicsTimerQueueTypeList );
     void release ();
     void * operator new ( size_t );
     void operator delete ( void * );
@@ -235,6 +260,16 @@ inline unsigned timerQueueActive::threadPriority () const
     return thread.getPriority ();
 }
 
+inline epicsTimerQueueType timerQueueActive::queueType () const
+{
+    return this->queue.queueType ();
+}
+
+inline epicsTimerQueueType timerQueue::queueType () const
+{
+    return this->type;
+}
+
 inline void * timer::operator new ( size_t size, 
                      tsFreeList < timer, 0x20 > & freeList ) 
 {
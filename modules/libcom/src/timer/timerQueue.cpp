@@ -24,8 +24,15 @@ const double timerQueue :: exceptMsgMinPeriod = 60.0 * 5.0; // seconds
 
 epicsTimerQueue::~epicsTimerQueue () {}
 
-timerQueue::timerQueue ( epicsTimerQueueNotify & notifyIn ) :
+timerQueue::timerQueue ( epicsTimerQueueNotify & notifyIn,
+        epicsTimerQueueType typeIn ) :
     mutex(__FILE__, __LINE__),
+    pHeap ( 0 ),
+    heapCount ( 0u ),
+    heapSize ( 0u ),
+    heapSeq ( 0u ),
+    nTimers ( 0u ),
+    type ( typeIn ),
     notify ( notifyIn ), 
     pExpireTmr ( 0 ),  
     processThread ( 0 ), 
@@ -41,6 +48,167 @@ timerQueue::~timerQueue ()
     while ( ( pTmr = this->timerList.get () ) ) {    
         pTmr->curState = timer::stateLimbo;
     }
+    while ( this->heapCount > 0u ) {
+        this->pHeap[--this->heapCount]->curState = timer::stateLimbo;
+    }
+    delete [] this->pHeap;
+}
+
+//
+// The heap has a slot for every timer created on the queue so
+// that starting a timer never needs to allocate. Slots are reserved
+// when the timer is constructed and given back when it is destroyed.
+//
+void timerQueue::reserve ()
+{
+    if ( this->type != epicsTimerQueueTypeHeap ) {
+        return;
+    }
+    epicsGuard < epicsMutex > locker ( this->mutex );
+    if ( this->nTimers >= this->heapSize ) {
+        unsigned newSize = this->heapSize ? this->heapSize * 2u : 64u;
+        timer ** pNewHeap = new timer * [newSize];
+        for ( unsigned i = 0u; i < this->heapCount; i++ ) {
+            pNewHeap[i] = this->pHeap[i];
+        }
+        delete [] this->pHeap;
+        this->pHeap = pNewHeap;
+        this->heapSize = newSize;
+    }
+    this->nTimers++;
+}
+
+void timerQueue::unreserve ()
+{
+    if ( this->type != epicsTimerQueueTypeHeap ) {
+        return;
+    }
+    epicsGuard < epicsMutex > locker ( this->mutex );
+    this->nTimers--;
+}
+
+timer * timerQueue::pendingFirst () const
+{
+    if ( this->type == epicsTimerQueueTypeHeap ) {
+        return this->heapCount ? this->pHeap[0] : 0;
+    }
+    return this->timerList.first ();
+}
+
+unsigned timerQueue::pendingCount () const
+{
+    if ( this->type == epicsTimerQueueTypeHeap ) {
+        return this->heapCount;
+    }
+    return this->timerList.count ();
+}
+
+//
+// insert into the pending queue, returns true if the timer
+// is now the first to expire
+//
+bool timerQueue::pendingInsert ( timer & tmr )
+{
+    if ( this->type == epicsTimerQueueTypeHeap ) {
+        tmr.heapSeq = this->heapSeq++;
+        this->pHeap[this->heapCount] = & tmr;
+        this->heapUp ( this->heapCount++ );
+        return tmr.heapIndex == 0u;
+    }
+
+    //
+    // Finds proper time sorted location using a linear search
+    // from the end of the list.
+    //
+    tsDLIter < timer > pTmr = this->timerList.lastIter ();
+    while ( true ) {
+        if ( ! pTmr.valid () ) {
+            //
+            // add to the beginning of the list
+            //
+            this->timerList.push ( tmr );
+            return true;
+        }
+        if ( pTmr->exp <= tmr.exp ) {
+            //
+            // add after the item found that expires earlier
+            //
+            this->timerList.insertAfter ( tmr, *pTmr );
+            return false;
+        }
+        --pTmr;
+    }
+}
+
+void timerQueue::pendingRemove ( timer & tmr )
+{
+    if ( this->type == epicsTimerQueueTypeHeap ) {
+        unsigned index = tmr.heapIndex;
+        timer * pLast = this->pHeap[--this->heapCount];
+        if ( pLast != & tmr ) {
+            this->pHeap[index] = pLast;
+            if ( index > 0u && 
+                    this->heapBefore ( *pLast, *this->pHeap[(index - 1u) / 2u] ) ) {
+                this->heapUp ( index );
+            }
+            else {
+                this->heapDown ( index );
+            }
+        }
+        return;
+    }
+    this->timerList.remove ( tmr );
+}
+
+// timers with the same expiration time expire in the order started
+bool timerQueue::heapBefore ( const timer & a, const timer & b ) const
+{
+    if ( a.exp < b.exp ) {
+        return true;
+    }
+    if ( a.exp == b.exp ) {
+        return static_cast < int > ( a.heapSeq - b.heapSeq ) < 0;
+    }
+    return false;
+}
+
+void timerQueue::heapUp ( unsigned index )
+{
+    timer * pTmr = this->pHeap[index];
+    while ( index > 0u ) {
+        unsigned parent = ( index - 1u ) / 2u;
+        if ( ! this->heapBefore ( *pTmr, *this->pHeap[parent] ) ) {
+            break;
+        }
+        this->pHeap[index] = this->pHeap[parent];
+        this->pHeap[index]->heapIndex = index;
+        index = parent;
+    }
+    this->pHeap[index] = pTmr;
+    pTmr->heapIndex = index;
+}
+
+void timerQueue::heapDown ( unsigned index )
+{
+    timer * pTmr = this->pHeap[index];
+    while ( true ) {
+        unsigned child = 2u * index + 1u;
+        if ( child >= this->heapCount ) {
+            break;
+        }
+        if ( child + 1u < this->heapCount &&
+                this->heapBefore ( *this->pHeap[child + 1u], *this->pHeap[child] ) ) {
+            child++;
+        }
+        if ( ! this->heapBefore ( *this->pHeap[child], *pTmr ) ) {
+            break;
+        }
+        this->pHeap[index] = this->pHeap[child];
+        this->pHeap[index]->heapIndex = index;
+        index = child;
+    }
+    this->pHeap[index] = pTmr;
+    pTmr->heapIndex = index;
 }
 
 void timerQueue ::
@@ -83,7 +251,7 @@ double timerQueue::process ( const epicsTime & currentTime )
     if ( this->pExpireTmr ) {
         // if some other thread is processing the queue
         // (or if this is a recursive call)
-        timer * pTmr = this->timerList.first ();
+        timer * pTmr = this->pendingFirst ();
         if ( pTmr ) {
             double delay = pTmr->exp - currentTime;
             if ( delay < 0.0 ) {
@@ -100,10 +268,10 @@ double timerQueue::process ( const epicsTime & currentTime )
     // Tag current epired tmr so that we can detect if call back
     // is in progress when canceling the timer.
     //
-    if ( this->timerList.first () ) {
-        if ( currentTime >= this->timerList.first ()->exp ) {
-            this->pExpireTmr = this->timerList.first ();
-            this->timerList.remove ( *this->pExpireTmr ); 
+    if ( this->pendingFirst () ) {
+        if ( currentTime >= this->pendingFirst ()->exp ) {
+            this->pExpireTmr = this->pendingFirst ();
+            this->pendingRemove ( *this->pExpireTmr );
             this->pExpireTmr->curState = timer::stateActive;
             this->processThread = epicsThreadGetIdSelf ();
 #           ifdef DEBUG
@@ -111,7 +279,7 @@ double timerQueue::process ( const epicsTime & currentTime )
 #           endif 
         }
         else {
-            double delay = this->timerList.first ()->exp - currentTime;
+            double delay = this->pendingFirst ()->exp - currentTime;
             debugPrintf ( ( "no activity process %f to next\n", delay ) );
             return delay;
         }
@@ -178,17 +346,17 @@ double timerQueue::process ( const epicsTime & currentTime )
         }
         this->pExpireTmr = 0;
 
-        if ( this->timerList.first () ) {
-            if ( currentTime >= this->timerList.first ()->exp ) {
-                this->pExpireTmr = this->timerList.first ();
-                this->timerList.remove ( *this->pExpireTmr ); 
+        if ( this->pendingFirst () ) {
+            if ( currentTime >= this->pendingFirst ()->exp ) {
+                this->pExpireTmr = this->pendingFirst ();
+                this->pendingRemove ( *this->pExpireTmr );
                 this->pExpireTmr->curState = timer::stateActive;
 #               ifdef DEBUG
                     this->pExpireTmr->show ( 0u );
 #               endif 
             }
             else {
-                delay = this->timerList.first ()->exp - currentTime;
+                delay = this->pendingFirst ()->exp - currentTime;
                 this->processThread = 0;
                 break;
             }
@@ -215,12 +383,16 @@ epicsTimerForC & timerQueue::createTimerForC ( epicsTimerCallback pCallback, voi
 void timerQueue::show ( unsigned level ) const
 {
     epicsGuard < epicsMutex > locker ( this->mutex );
-    printf ( "epicsTimerQueue with %u items pending\n", this->timerList.count () );
+    printf ( "epicsTimerQueue with %u items pending%s\n", this->pendingCount (),
+        this->type == epicsTimerQueueTypeHeap ? " in heap" : "" );
     if ( level >= 1u ) {
         tsDLIterConst < timer > iter = this->timerList.firstIter ();
         while ( iter.valid () ) {   
             iter->show ( level - 1u );
             ++iter;
         }
+        for ( unsigned i = 0u; i < this->heapCount; i++ ) {
+            this->pHeap[i]->show ( level - 1u );
+        }
     }
 }
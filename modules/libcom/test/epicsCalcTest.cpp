@@ -14,10 +14,64 @@
 #include "epicsMath.h"
 #include "epicsAlgorithm.h"
 #include "postfix.h"
+#include "epicsTime.h"
 #include "testMain.h"
 
 /* Infrastructure for running tests */
 
+bool sameAsArray(const char *rpn, double expected) {
+    /* Evaluate one element with calcPerformArray(), compare the bits */
+    double args[CALCPERFORM_NARGS] = {
+        1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
+    };
+    const double *pargs[CALCPERFORM_NARGS];
+    epicsUInt32 nargs[CALCPERFORM_NARGS];
+    size_t size = calcArrayWorkSize(rpn);
+    double *work = (double*)malloc((size ? size : 1) * sizeof(double));
+    double result = 0.0;
+    bool same;
+    result /= result;  /* Start as NaN, like testCalc() */
+
+    if (!size || !work) {
+        free(work);
+        return false;
+    }
+    for (int i = 0; i < CALCPERFORM_NARGS; i++) {
+        pargs[i] = &args[i];
+        nargs[i] = 1;
+    }
+    same = !calcPerformArray(pargs, nargs, &result, 1, rpn, work) &&
+        memcmp(&result, &expected, sizeof(double)) == 0;
+    free(work);
+    return same;
+}
+
+bool sameAsUnoptimized(const char *expr, double expected) {
+    /* Evaluate expression without optimization, compare the bits */
+    double args[CALCPERFORM_NARGS] = {
+        1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
+    };
+    char *rpn = (char*)malloc(INFIX_TO_POSTFIX_SIZE(strlen(expr)+1));
+    short err;
+    double result = 0.0;
+    bool same;
+    result /= result;  /* Start as NaN, like testCalc() */
+
+    if(!rpn)
+        return false;
+
+    postfixOptimize = 0;
+    same = !postfix(expr, rpn, &err);
+    postfixOptimize = 1;
+    if (same) {
+        calcPerform(args, &result, rpn);
+        same = memcmp(&result, &expected, sizeof(double)) == 0 &&
+            sameAsArray(rpn, expected);
+    }
+    free(rpn);
+    return same;
+}
+
 double doCalc(const char *expr) {
     /* Evaluate expression, return result */
     double args[CALCPERFORM_NARGS] = {
@@ -73,6 +127,14 @@ void testCalc(const char *expr, double expected) {
     } else {
         pass = (result == expected);
     }
+    if (pass && !sameAsUnoptimized(expr, result)) {
+        testDiag("Unoptimized expression gives a different result");
+        pass = false;
+    }
+    if (pass && !sameAsArray(rpn, result)) {
+        testDiag("calcPerformArray() gives a different result");
+        pass = false;
+    }
     if (!testOk(pass, "%s", expr)) {
         testDiag("Expected result is %g, actually got %g", expected, result);
         calcExprDump(rpn);
@@ -157,6 +219,178 @@ void testBadExpr(const char *expr, short expected_err) {
     free(rpn);
 }
 
+/* Compare the evaluation speed of optimized and unoptimized expressions */
+
+#define PERF_LOOPS 200000
+
+static double timeCalc(const char *rpn, double *presult) {
+    double args[CALCPERFORM_NARGS] = {
+        1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
+    };
+    epicsTimeStamp start, stop;
+    double result = 0.0;
+
+    epicsTimeGetMonotonic(&start);
+    for (int n = 0; n < PERF_LOOPS; n++) {
+        args[0] = n;
+        calcPerform(args, &result, rpn);
+    }
+    epicsTimeGetMonotonic(&stop);
+    *presult = result;
+    return epicsTimeDiffInSeconds(&stop, &start) / PERF_LOOPS;
+}
+
+void testPerform(const char *expr) {
+    size_t size = INFIX_TO_POSTFIX_SIZE(strlen(expr)+1);
+    char *rpn = (char*)malloc(size);
+    char *opt = (char*)malloc(size);
+    double result, optResult;
+    short err;
+
+    if (!rpn || !opt) {
+        testFail("postfix: %s no memory", expr);
+        return;
+    }
+
+    postfixOptimize = 0;
+    if (postfix(expr, rpn, &err)) {
+        testFail("postfix: %s in expression '%s'", calcErrorStr(err), expr);
+        return;
+    }
+    postfixOptimize = 1;
+    postfix(expr, opt, &err);
+
+    double plain = timeCalc(rpn, &result);
+    double fast = timeCalc(opt, &optResult);
+    testOk(memcmp(&result, &optResult, sizeof(double)) == 0,
+        "Same result from optimized '%s'", expr);
+    testDiag("%8.1f ns %8.1f ns  %s", plain * 1e9, fast * 1e9, expr);
+    free(opt);
+    free(rpn);
+}
+
+/* Compare calcPerformArray() with calcPerform() for each element, using
+ * arrays for A, B, D and VAL and the usual values for the other arguments.
+ */
+
+#define ARRAY_ELEMENTS 1000     /* not a multiple of the block size */
+
+static void fillArrays(double *pa, double *pb, double *pd, double *pval,
+    epicsUInt32 nelem) {
+    for (epicsUInt32 n = 0; n < nelem; n++) {
+        pa[n] = n * 0.37 - 20.0;
+        pb[n] = sin(n * 0.1) * 4.0;
+        pd[n] = n % 7 ? n : epicsNAN;
+        pval[n] = n;
+    }
+}
+
+static double * arrayScalars(const double *pa, const double *pb,
+    const double *pd, double *pval, epicsUInt32 nelem, const char *rpn) {
+    double args[CALCPERFORM_NARGS] = {
+        1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
+    };
+
+    for (epicsUInt32 n = 0; n < nelem; n++) {
+        args[0] = pa[n];
+        args[1] = pb[n];
+        args[3] = pd[n];
+        calcPerform(args, &pval[n], rpn);
+    }
+    return pval;
+}
+
+static void arraySetup(const double *pa, const double *pb, const double *pd,
+    const double **pargs, epicsUInt32 *nargs, epicsUInt32 nelem) {
+    static const double args[CALCPERFORM_NARGS] = {
+        1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0
+    };
+
+    for (int i = 0; i < CALCPERFORM_NARGS; i++) {
+        pargs[i] = &args[i];
+        nargs[i] = 1;
+    }
+    pargs[0] = pa;
+    pargs[1] = pb;
+    pargs[3] = pd;
+    nargs[0] = nargs[1] = nargs[3] = nelem;
+}
+
+void testArray(const char *expr) {
+    static double a[ARRAY_ELEMENTS], b[ARRAY_ELEMENTS], d[ARRAY_ELEMENTS];
+    static double expected[ARRAY_ELEMENTS], result[ARRAY_ELEMENTS];
+    const double *pargs[CALCPERFORM_NARGS];
+    epicsUInt32 nargs[CALCPERFORM_NARGS];
+    char *rpn = (char*)malloc(INFIX_TO_POSTFIX_SIZE(strlen(expr)+1));
+    double *work = NULL;
+    bool pass = false;
+    short err;
+
+    if (!rpn || postfix(expr, rpn, &err)) {
+        testFail("postfix: can't convert '%s'", expr);
+        free(rpn);
+        return;
+    }
+    fillArrays(a, b, d, expected, ARRAY_ELEMENTS);
+    fillArrays(a, b, d, result, ARRAY_ELEMENTS);
+    arrayScalars(a, b, d, expected, ARRAY_ELEMENTS, rpn);
+    arraySetup(a, b, d, pargs, nargs, ARRAY_ELEMENTS);
+
+    work = (double*)malloc(calcArrayWorkSize(rpn) * sizeof(double));
+    if (work && !calcPerformArray(pargs, nargs, result, ARRAY_ELEMENTS,
+            rpn, work))
+        pass = memcmp(result, expected, sizeof(result)) == 0;
+    if (!testOk(pass, "Array %s", expr))
+        calcExprDump(rpn);
+
+    /* Too few elements in an input array */
+    nargs[3] = ARRAY_ELEMENTS - 1;
+    if (work && !calcPerformArray(pargs, nargs, result, ARRAY_ELEMENTS,
+            rpn, work))
+        testDiag("Short array not detected");
+    free(work);
+    free(rpn);
+}
+
+/* Compare the time per element for calcPerform() and calcPerformArray() */
+
+#define PERF_ELEMENTS 100000
+
+void testPerformArray(const char *expr) {
+    static double a[PERF_ELEMENTS], b[PERF_ELEMENTS], d[PERF_ELEMENTS];
+    static double scalar[PERF_ELEMENTS], array[PERF_ELEMENTS];
+    const double *pargs[CALCPERFORM_NARGS];
+    epicsUInt32 nargs[CALCPERFORM_NARGS];
+    char *rpn = (char*)malloc(INFIX_TO_POSTFIX_SIZE(strlen(expr)+1));
+    epicsTimeStamp start, mid, stop;
+    double *work;
+    short err;
+
+    if (!rpn || postfix(expr, rpn, &err)) {
+        testFail("postfix: can't convert '%s'", expr);
+        free(rpn);
+        return;
+    }
+    work = (double*)malloc(calcArrayWorkSize(rpn) * sizeof(double));
+    fillArrays(a, b, d, scalar, PERF_ELEMENTS);
+    fillArrays(a, b, d, array, PERF_ELEMENTS);
+    arraySetup(a, b, d, pargs, nargs, PERF_ELEMENTS);
+
+    epicsTimeGetMonotonic(&start);
+    arrayScalars(a, b, d, scalar, PERF_ELEMENTS, rpn);
+    epicsTimeGetMonotonic(&mid);
+    calcPerformArray(pargs, nargs, array, PERF_ELEMENTS, rpn, work);
+    epicsTimeGetMonotonic(&stop);
+
+    testOk(memcmp(scalar, array, sizeof(array)) == 0,
+        "Same results from array '%s'", expr);
+    testDiag("%8.2f ns %8.2f ns  %s",
+        epicsTimeDiffInSeconds(&mid, &start) * 1e9 / PERF_ELEMENTS,
+        epicsTimeDiffInSeconds(&stop, &mid) * 1e9 / PERF_ELEMENTS, expr);
+    free(work);
+    free(rpn);
+}
+
 /* Test an expression that is also valid C code */
 #define testExpr(expr) testCalc(#expr, expr);
 
@@ -297,7 +531,7 @@ MAIN(epicsCalcTest)
     const double a=1.0, b=2.0, c=3.0, d=4.0, e=5.0, f=6.0,
 		 g=7.0, h=8.0, i=9.0, j=10.0, k=11.0, l=12.0;
     
-    testPlan(613);
+    testPlan(647);
 
     /* LITERAL_OPERAND elements */
     testExpr(0);
@@ -804,6 +1038,15 @@ MAIN(epicsCalcTest)
     testExpr(0 ? 2 : 1 ? 3 : 4);
     testExpr(1 ? 2 : 0 ? 3 : 4);
     testExpr(1 ? 2 : 1 ? 3 : 4);
+    /* Nested conditionals with variable conditions, optimized to jumps */
+    testExpr(a ? b ? 2 : 3 : 4);
+    testExpr(a ? l-12 ? 2 : 3 : 4);
+    testExpr(l-12 ? b ? 2 : 3 : 4);
+    testExpr(a ? 1 ? 2 : 3 : 4);
+    testExpr(l-12 ? 1 ? 2 : 3 : 4);
+    testExpr(a ? 1 : (0 ? 0 ? 2 : 3 : 4) + b);
+    testExpr(l-12 ? 1 : (0 ? 0 ? 2 : 3 : 4) + b);
+    testExpr(l-12 ? b ? 2 : 3 : (c ? 4 : 5) + 1);
     
     /* STORE_OPERATOR and EXPR_TERM elements*/
     testCalc("a := 0; a", 0);
@@ -920,6 +1163,9 @@ MAIN(epicsCalcTest)
     testArgs("11.1;L:=0", 0, A_L);
     testArgs("12.1;A:=0;B:=A;C:=B;D:=C", 0, A_A|A_B|A_C|A_D);
     testArgs("13.1;B:=A;A:=B;C:=D;D:=C", A_A|A_D, A_A|A_B|A_C|A_D);
+    // Constant conditionals that use arguments are kept
+    testArgs("0?A:B", A_A|A_B, 0);
+    testArgs("1?C:D", A_C|A_D, 0);
     
     // Malformed expressions
     testBadExpr("0x0.1", CALC_ERR_SYNTAX);
@@ -981,6 +1227,36 @@ MAIN(epicsCalcTest)
     testUInt32Calc("-1431655766.1 << 0.1", 0xaaaaaaaau);
     testUInt32Calc("2863311530.1 << 0.1", 0xaaaaaaaau);
 
+    // Optimized evaluation speed
+    testDiag("Unoptimized vs optimized time per calcPerform()");
+    testPerform("A+B*C");
+    testPerform("A>B?C:D");
+    testPerform("A<5?B:A<10?C:A<20?D:E");
+    testPerform("SIN(A*(2*PI/360))*(1+1/2)");
+    testPerform("(A-32)*(5/9)+273.15");
+    testPerform("0?A*B:MAX(A,B,C)-MIN(D,E,F)");
+    testPerform("A&&B||C?D:E");
+
+    // Array evaluation
+    testArray("A+B*C");
+    testArray("VAL+1");
+    testArray("A>B?C:D");
+    testArray("A<0?B:A<10?D:A");
+    testArray("A?B?2:3:4");
+    testArray("A>0?B>0?B:-B:(C?A:D)+1");
+    testArray("MIN(A,B,D)+MAX(D,A)");
+    testArray("FINITE(A,D)+ISNAN(D,B)*2");
+    testArray("A%B+(A AND 0xff)+(A>>2)+(B<<3)+~A");
+    testArray("E:=A*2;F:=E+B;F*E");
+    testArray("SIN(A)*COS(B)+ATAN2(A,B)+SQR(ABS(D))+NINT(B)");
+    testArray("A==B||A!=D&&!B");
+    testDiag("calcPerform() vs calcPerformArray() time per element");
+    testPerformArray("A+B*C");
+    testPerformArray("A>B?C:D");
+    testPerformArray("(A-32)*(5/9)+273.15");
+    testPerformArray("SIN(A*(2*PI/360))*(1+1/2)");
+    testPerformArray("MAX(A,B,D)-MIN(A,B)");
+
     return testDone();
 }
 
@@ -0,0 +1,153 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure epicsTimeGetCurrent() call rates from 1 to 32 threads, with a
+ * time provider registered above the OS clock so the general time
+ * provider list is in use.
+ */
+
+#include <stdio.h>
+
+#include "epicsAtomic.h"
+#include "epicsEvent.h"
+#include "epicsGeneralTime.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "generalTimeSup.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define MAXTHREADS 32
+#define RUNTIME 0.5     /* seconds per measurement */
+#define BATCH 1000      /* calls between checks of the stop flag */
+
+static epicsTimeStamp wallBase;
+static epicsTimeStamp monoBase;
+
+/* Wall clock time from the monotonic clock, cheap and never backwards */
+static int benchTimeGetCurrent(epicsTimeStamp *pDest)
+{
+    epicsTimeStamp now;
+
+    epicsTimeGetMonotonic(&now);
+    *pDest = wallBase;
+    epicsTimeAddSeconds(pDest, epicsTimeDiffInSeconds(&now, &monoBase));
+    return epicsTimeOK;
+}
+
+typedef int (*getTimeFn)(epicsTimeStamp *pDest);
+
+static int lockedGetCurrent(epicsTimeStamp *pDest)
+{
+    return generalTimeGetExceptPriority(pDest, NULL, 0);
+}
+
+typedef struct {
+    getTimeFn get;
+    unsigned long calls;
+    int backwards;
+} benchJob;
+
+static epicsEventId jobDone;
+static int jobsReady;
+static int jobsRunning;
+static int jobsGo;
+static int jobsStop;
+
+static void benchThread(void *arg)
+{
+    benchJob *job = (benchJob *)arg;
+    epicsTimeStamp prev, ts;
+    unsigned long calls = 0;
+    int i;
+
+    epicsAtomicIncrIntT(&jobsReady);
+    while (!epicsAtomicGetIntT(&jobsGo))
+        epicsThreadSleep(0.001);
+
+    job->get(&prev);
+    while (!epicsAtomicGetIntT(&jobsStop)) {
+        for (i = 0; i < BATCH; i++) {
+            job->get(&ts);
+            if (epicsTimeLessThan(&ts, &prev))
+                job->backwards++;
+            prev = ts;
+        }
+        calls += BATCH;
+    }
+    job->calls = calls;
+
+    if (!epicsAtomicDecrIntT(&jobsRunning))
+        epicsEventMustTrigger(jobDone);
+}
+
+static double runBench(getTimeFn get, int nthreads, int *pbackwards)
+{
+    static benchJob job[MAXTHREADS];
+    epicsTimeStamp start, stop;
+    double calls = 0.0;
+    int i;
+
+    epicsAtomicSetIntT(&jobsReady, 0);
+    epicsAtomicSetIntT(&jobsRunning, nthreads);
+    epicsAtomicSetIntT(&jobsGo, 0);
+    epicsAtomicSetIntT(&jobsStop, 0);
+    for (i = 0; i < nthreads; i++) {
+        job[i].get = get;
+        job[i].calls = 0;
+        job[i].backwards = 0;
+        epicsThreadMustCreate("timeBench", epicsThreadPriorityMedium,
+            epicsThreadGetStackSize(epicsThreadStackSmall),
+            benchThread, &job[i]);
+    }
+    while (epicsAtomicGetIntT(&jobsReady) < nthreads)
+        epicsThreadSleep(0.001);
+
+    epicsTimeGetMonotonic(&start);
+    epicsAtomicSetIntT(&jobsGo, 1);
+    epicsThreadSleep(RUNTIME);
+    epicsAtomicSetIntT(&jobsStop, 1);
+    epicsTimeGetMonotonic(&stop);
+    epicsEventMustWait(jobDone);
+
+    *pbackwards = 0;
+    for (i = 0; i < nthreads; i++) {
+        calls += job[i].calls;
+        *pbackwards += job[i].backwards;
+    }
+    return calls / epicsTimeDiffInSeconds(&stop, &start);
+}
+
+MAIN(epicsGeneralTimePerform)
+{
+    int nthreads;
+
+    testPlan(7);
+
+    jobDone = epicsEventMustCreate(epicsEventEmpty);
+
+    epicsTimeGetCurrent(&wallBase);
+    epicsTimeGetMonotonic(&monoBase);
+    testOk1(generalTimeRegisterCurrentProvider("Bench", 10,
+        benchTimeGetCurrent) == epicsTimeOK);
+
+    testDiag("THREADS  epicsTimeGetCurrent()  generalTimeGetExceptPriority()");
+    for (nthreads = 1; nthreads <= MAXTHREADS; nthreads *= 2) {
+        int backwards, lockedBackwards;
+        double rate = runBench(epicsTimeGetCurrent, nthreads, &backwards);
+        double locked = runBench(lockedGetCurrent, nthreads, &lockedBackwards);
+
+        testDiag("%7d  %15.3g /sec  %23.3g /sec", nthreads, rate, locked);
+        testOk(backwards == 0, "%d threads, %d backwards times",
+            nthreads, backwards);
+    }
+    testDiag("Provider '%s', backwards time errors prevented %d times",
+        generalTimeCurrentProviderName(), generalTimeGetErrorCounts());
+
+    epicsEventDestroy(jobDone);
+
+    return testDone();
+}
@@ -0,0 +1,112 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Timer queue stress test, measures start, cancel and expire
+ * throughput with large timer populations on the list and
+ * heap queue types.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "epicsTimer.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+static epicsTime lastExpire;
+static unsigned nExpired;
+static unsigned nOutOfOrder;
+
+class stressNotify : public epicsTimerNotify {
+public:
+    epicsTime when;
+    expireStatus expire ( const epicsTime & )
+    {
+        if ( this->when < lastExpire ) {
+            nOutOfOrder++;
+        }
+        lastExpire = this->when;
+        nExpired++;
+        return expireStatus ( noRestart );
+    }
+};
+
+class stressQueueNotify : public epicsTimerQueueNotify {
+public:
+    void reschedule () {}
+    double quantum () { return 0.0; }
+};
+
+static double rate ( unsigned count, const epicsTime & start )
+{
+    double delay = epicsTime::getMonotonic () - start;
+    return delay > 0.0 ? count / delay : 0.0;
+}
+
+static void stress ( epicsTimerQueueType type, unsigned count )
+{
+    const char * pName = type == epicsTimerQueueTypeHeap ? "heap" : "list";
+    stressQueueNotify queueNotify;
+    epicsTimerQueuePassive & queue =
+        epicsTimerQueuePassive::create ( queueNotify, type );
+    epicsTimer ** pTimers = new epicsTimer * [count];
+    stressNotify * pNotify = new stressNotify [count];
+    epicsTime base = epicsTime::getMonotonic ();
+    unsigned i;
+
+    srand ( 12345 );
+    for ( i = 0u; i < count; i++ ) {
+        pTimers[i] = & queue.createTimer ();
+        pNotify[i].when = base + ( rand () % 1000000 ) * 1e-3;
+    }
+
+    epicsTime start = epicsTime::getMonotonic ();
+    for ( i = 0u; i < count; i++ ) {
+        pTimers[i]->start ( pNotify[i], pNotify[i].when );
+    }
+    double startRate = rate ( count, start );
+
+    start = epicsTime::getMonotonic ();
+    for ( i = 0u; i < count; i += 2u ) {
+        pTimers[i]->cancel ();
+    }
+    double cancelRate = rate ( ( count + 1u ) / 2u, start );
+
+    lastExpire = base;
+    nExpired = 0u;
+    nOutOfOrder = 0u;
+    start = epicsTime::getMonotonic ();
+    queue.process ( base + 2000.0 );
+    double expireRate = rate ( nExpired, start );
+
+    testDiag ( "%s queue with %u timers: %.3g starts/sec, "
+        "%.3g cancels/sec, %.3g expires/sec",
+        pName, count, startRate, cancelRate, expireRate );
+    testOk ( nExpired == count / 2u, "%s %u: %u of %u timers expired",
+        pName, count, nExpired, count / 2u );
+    testOk ( nOutOfOrder == 0u, "%s %u: timers expired in order (%u not)",
+        pName, count, nOutOfOrder );
+
+    for ( i = 0u; i < count; i++ ) {
+        pTimers[i]->destroy ();
+    }
+    delete [] pNotify;
+    delete [] pTimers;
+    delete & queue;
+}
+
+MAIN(epicsTimerPerform)
+{
+    testPlan(10);
+    /* starts are O(n) on the list, 100k timers would take minutes */
+    stress ( epicsTimerQueueTypeList, 1000u );
+    stress ( epicsTimerQueueTypeList, 10000u );
+    stress ( epicsTimerQueueTypeHeap, 1000u );
+    stress ( epicsTimerQueueTypeHeap, 10000u );
+    stress ( epicsTimerQueueTypeHeap, 100000u );
+    return testDone();
+}
@@ -0,0 +1,135 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measures fdManager dispatch latency for a few active sockets
+ * while many idle sockets are registered.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+
+#include "fdManager.h"
+#include "epicsTime.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NACTIVE 100
+#define NROUNDS 200
+
+static unsigned nCallBacks;
+
+class perfReg : public fdReg {
+public:
+    perfReg ( const SOCKET fdIn, fdManager & mgr ) :
+        fdReg ( fdIn, fdrRead, false, mgr ) {}
+private:
+    void callBack ()
+    {
+        char buf[16];
+        if ( read ( this->getFD (), buf, sizeof ( buf ) ) > 0 ) {
+            nCallBacks++;
+        }
+    }
+};
+
+/* returns how many socket pairs fit within the fd limit */
+static unsigned maxPairs ( unsigned wanted )
+{
+    struct rlimit lim;
+    if ( getrlimit ( RLIMIT_NOFILE, &lim ) != 0 ) {
+        return 0u;
+    }
+    if ( lim.rlim_cur < lim.rlim_max ) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit ( RLIMIT_NOFILE, &lim );
+        getrlimit ( RLIMIT_NOFILE, &lim );
+    }
+    rlim_t avail = lim.rlim_cur > 64u ? ( lim.rlim_cur - 64u ) / 2u : 0u;
+    return avail < wanted ? static_cast < unsigned > ( avail ) : wanted;
+}
+
+static void measure ( unsigned nIdle )
+{
+    fdManager mgr;
+    int ( * pIdle )[2] = new int [nIdle][2];
+    perfReg ** pIdleReg = new perfReg * [nIdle];
+    int active[NACTIVE][2];
+    perfReg * pActiveReg[NACTIVE];
+    unsigned i, n;
+
+    for ( i = 0u; i < nIdle; i++ ) {
+        if ( socketpair ( AF_UNIX, SOCK_STREAM, 0, pIdle[i] ) != 0 ) {
+            break;
+        }
+        pIdleReg[i] = new perfReg ( pIdle[i][0], mgr );
+    }
+    nIdle = i;
+    for ( i = 0u; i < NACTIVE; i++ ) {
+        if ( socketpair ( AF_UNIX, SOCK_STREAM, 0, active[i] ) != 0 ) {
+            break;
+        }
+        pActiveReg[i] = new perfReg ( active[i][0], mgr );
+    }
+    if ( ! testOk ( i == NACTIVE, "created %u active sockets", i ) ) {
+        testAbort ( "out of file descriptors" );
+    }
+
+    double worst = 0.0;
+    double total = 0.0;
+    bool ok = true;
+    for ( n = 0u; n < NROUNDS && ok; n++ ) {
+        nCallBacks = 0u;
+        epicsTime start = epicsTime::getMonotonic ();
+        for ( i = 0u; i < NACTIVE; i++ ) {
+            ok = ok && write ( active[i][1], "x", 1 ) == 1;
+        }
+        unsigned loops = 0u;
+        while ( nCallBacks < NACTIVE && loops++ < 1000u ) {
+            mgr.process ( 0.1 );
+        }
+        double delay = epicsTime::getMonotonic () - start;
+        total += delay;
+        if ( delay > worst ) {
+            worst = delay;
+        }
+        ok = ok && nCallBacks == NACTIVE;
+    }
+    testOk ( ok, "%u active sockets dispatched %u times with %u idle",
+        NACTIVE, NROUNDS, nIdle );
+    testDiag ( "%u idle: %.1f us mean, %.1f us worst per round of %u, "
+        "%.2f us per event",
+        nIdle, total / n * 1e6, worst * 1e6, NACTIVE,
+        total / n / NACTIVE * 1e6 );
+
+    for ( i = 0u; i < NACTIVE; i++ ) {
+        delete pActiveReg[i];
+        close ( active[i][0] );
+        close ( active[i][1] );
+    }
+    for ( i = 0u; i < nIdle; i++ ) {
+        delete pIdleReg[i];
+        close ( pIdle[i][0] );
+        close ( pIdle[i][1] );
+    }
+    delete [] pIdleReg;
+    delete [] pIdle;
+}
+
+MAIN(fdManagerPerform)
+{
+    testPlan(4);
+    unsigned nIdle = maxPairs ( 10000u + NACTIVE );
+    nIdle = nIdle > NACTIVE ? nIdle - NACTIVE : 0u;
+    if ( nIdle < 10000u ) {
+        testDiag ( "fd limit only allows %u idle sockets", nIdle );
+    }
+    measure ( 0u );
+    measure ( nIdle );
+    return testDone();
+}
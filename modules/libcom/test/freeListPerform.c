@@ -0,0 +1,116 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Measure freeListMalloc()/freeListFree() rates from 1 to 16 threads
+ * sharing one pool, with and without per-thread caches.
+ */
+
+#include <stdio.h>
+
+#include "epicsAtomic.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "freeList.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define MAXTHREADS 16
+#define RUNTIME 0.5     /* seconds per measurement */
+#define NHELD 8         /* blocks held by each thread at a time */
+#define NMALLOC 64
+#define CACHESIZE 32
+
+typedef struct {
+    void *pool;
+    unsigned long calls;
+} benchJob;
+
+static int jobsReady;
+static int jobsGo;
+static int jobsStop;
+
+static void benchThread(void *arg)
+{
+    benchJob *job = (benchJob *)arg;
+    void *held[NHELD];
+    unsigned long calls = 0;
+    int i;
+
+    epicsAtomicIncrIntT(&jobsReady);
+    while (!epicsAtomicGetIntT(&jobsGo))
+        epicsThreadSleep(0.001);
+
+    while (!epicsAtomicGetIntT(&jobsStop)) {
+        for (i = 0; i < NHELD; i++)
+            held[i] = freeListMalloc(job->pool);
+        for (i = 0; i < NHELD; i++)
+            freeListFree(job->pool, held[i]);
+        calls += 2 * NHELD;
+    }
+    job->calls = calls;
+}
+
+static double runBench(void *pool, int nthreads)
+{
+    static benchJob job[MAXTHREADS];
+    epicsThreadId tid[MAXTHREADS];
+    epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    epicsTimeStamp start, stop;
+    double calls = 0.0;
+    int i;
+
+    opts.joinable = 1;
+    opts.stackSize = epicsThreadGetStackSize(epicsThreadStackSmall);
+    epicsAtomicSetIntT(&jobsReady, 0);
+    epicsAtomicSetIntT(&jobsGo, 0);
+    epicsAtomicSetIntT(&jobsStop, 0);
+    for (i = 0; i < nthreads; i++) {
+        job[i].pool = pool;
+        job[i].calls = 0;
+        tid[i] = epicsThreadCreateOpt("listBench", benchThread, &job[i],
+            &opts);
+    }
+    while (epicsAtomicGetIntT(&jobsReady) < nthreads)
+        epicsThreadSleep(0.001);
+
+    epicsTimeGetMonotonic(&start);
+    epicsAtomicSetIntT(&jobsGo, 1);
+    epicsThreadSleep(RUNTIME);
+    epicsAtomicSetIntT(&jobsStop, 1);
+    epicsTimeGetMonotonic(&stop);
+    /* thread caches are flushed as the threads exit */
+    for (i = 0; i < nthreads; i++)
+        epicsThreadMustJoin(tid[i]);
+
+    for (i = 0; i < nthreads; i++)
+        calls += job[i].calls;
+    return calls / epicsTimeDiffInSeconds(&stop, &start);
+}
+
+MAIN(freeListPerform)
+{
+    int nthreads;
+
+    testPlan(0);
+
+    testDiag("THREADS       locked       cached");
+    for (nthreads = 1; nthreads <= MAXTHREADS; nthreads *= 2) {
+        void *locked, *cached;
+        double lockedRate, cachedRate;
+
+        freeListInitPvt(&locked, sizeof(double), NMALLOC);
+        freeListInitPvtCache(&cached, sizeof(double), NMALLOC, CACHESIZE);
+        lockedRate = runBench(locked, nthreads);
+        cachedRate = runBench(cached, nthreads);
+
+        testDiag("%7d  %7.3g /sec  %7.3g /sec",
+            nthreads, lockedRate, cachedRate);
+        freeListCleanup(locked);
+        freeListCleanup(cached);
+    }
+
+    return testDone();
+}
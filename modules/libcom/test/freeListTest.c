@@ -0,0 +1,191 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Checks that free list pools, with and without per-thread caches,
+ * account for every block as threads allocate and free them.
+ */
+
+#include <string.h>
+
+#include "epicsEvent.h"
+#include "epicsThread.h"
+#include "freeList.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define NTHREADS 4
+#define NHELD 8         /* blocks held by each thread at a time */
+#define NLOOPS 1000
+#define NMALLOC 16
+#define CACHESIZE 8
+#define BLOCKSIZE 32
+
+typedef struct {
+    void *pool;
+    void *pmem;         /* left for the main thread to free */
+    epicsEventId wait;  /* until the main thread is ready */
+} listJob;
+
+static epicsThreadId startJob(EPICSTHREADFUNC func, listJob *job)
+{
+    epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+
+    opts.joinable = 1;
+    opts.stackSize = epicsThreadGetStackSize(epicsThreadStackSmall);
+    return epicsThreadCreateOpt("listTest", func, job, &opts);
+}
+
+static void testPlain(void)
+{
+    void *pool;
+    void *pmem[2];
+    char zero[BLOCKSIZE];
+
+    testDiag("Pool without caches");
+
+    freeListInitPvt(&pool, BLOCKSIZE, NMALLOC);
+    pmem[0] = freeListMalloc(pool);
+    memset(pmem[0], 0x55, BLOCKSIZE);
+    freeListFree(pool, pmem[0]);
+    testOk(freeListItemsAvail(pool) == NMALLOC,
+        "%u of %d blocks available", (unsigned) freeListItemsAvail(pool),
+        NMALLOC);
+
+    pmem[0] = freeListCalloc(pool);
+    memset(zero, 0, sizeof(zero));
+    testOk(pmem[0] && memcmp(pmem[0], zero, BLOCKSIZE) == 0,
+        "freeListCalloc() clears a reused block");
+    pmem[1] = freeListMalloc(pool);
+    testOk(freeListItemsAvail(pool) == NMALLOC - 2,
+        "two blocks in use, %u available",
+        (unsigned) freeListItemsAvail(pool));
+    freeListFree(pool, pmem[0]);
+    freeListFree(pool, pmem[1]);
+    freeListCleanup(pool);
+}
+
+static void testCached(void)
+{
+    void *pool;
+    void *pmem[2 * NMALLOC];
+    int i;
+
+    testDiag("Pool with a cache for this thread");
+
+    freeListInitPvtCache(&pool, BLOCKSIZE, NMALLOC, CACHESIZE);
+    pmem[0] = freeListMalloc(pool);
+    testOk(freeListItemsAvail(pool) == NMALLOC - 1,
+        "one block in use, %u available",
+        (unsigned) freeListItemsAvail(pool));
+    freeListFree(pool, pmem[0]);
+    testOk(freeListItemsAvail(pool) == NMALLOC,
+        "none in use, %u available", (unsigned) freeListItemsAvail(pool));
+
+    /* more than the cache holds, so blocks go back to the shared list */
+    for (i = 0; i < 2 * NMALLOC; i++)
+        pmem[i] = freeListMalloc(pool);
+    testOk(freeListItemsAvail(pool) == 0,
+        "all %d blocks in use, %u available", 2 * NMALLOC,
+        (unsigned) freeListItemsAvail(pool));
+    for (i = 0; i < 2 * NMALLOC; i++)
+        freeListFree(pool, pmem[i]);
+    testOk(freeListItemsAvail(pool) == 2 * NMALLOC,
+        "none in use, %u available", (unsigned) freeListItemsAvail(pool));
+    freeListCleanup(pool);
+}
+
+static void churnJob(void *arg)
+{
+    listJob *job = (listJob *)arg;
+    void *held[NHELD];
+    int i, n;
+
+    epicsEventMustWait(job->wait);
+    for (n = 0; n < NLOOPS; n++) {
+        for (i = 0; i < NHELD; i++)
+            held[i] = freeListMalloc(job->pool);
+        for (i = 0; i < NHELD; i++)
+            freeListFree(job->pool, held[i]);
+    }
+    /* freed by the main thread after this one has exited */
+    job->pmem = freeListMalloc(job->pool);
+}
+
+static void testThreads(void)
+{
+    void *pool;
+    listJob job[NTHREADS];
+    epicsThreadId tid[NTHREADS];
+    size_t avail;
+    int i;
+
+    testDiag("Pool with caches for %d threads", NTHREADS);
+
+    freeListInitPvtCache(&pool, BLOCKSIZE, NMALLOC, CACHESIZE);
+    for (i = 0; i < NTHREADS; i++) {
+        job[i].pool = pool;
+        job[i].pmem = NULL;
+        job[i].wait = epicsEventMustCreate(epicsEventEmpty);
+        tid[i] = startJob(churnJob, &job[i]);
+    }
+    for (i = 0; i < NTHREADS; i++)
+        epicsEventMustTrigger(job[i].wait);
+    /* their caches are flushed as the threads exit */
+    for (i = 0; i < NTHREADS; i++)
+        epicsThreadMustJoin(tid[i]);
+
+    avail = freeListItemsAvail(pool);
+    testOk((avail + NTHREADS) % NMALLOC == 0,
+        "%u blocks available with one held for each thread",
+        (unsigned) avail);
+    for (i = 0; i < NTHREADS; i++) {
+        freeListFree(pool, job[i].pmem);
+        epicsEventDestroy(job[i].wait);
+    }
+    avail = freeListItemsAvail(pool);
+    testOk(avail > 0 && avail % NMALLOC == 0,
+        "all %u blocks returned", (unsigned) avail);
+    freeListCleanup(pool);
+}
+
+static void waitJob(void *arg)
+{
+    listJob *job = (listJob *)arg;
+
+    freeListFree(job->pool, freeListMalloc(job->pool));
+    epicsEventMustWait(job->wait);
+}
+
+static void testCleanupFirst(void)
+{
+    listJob job;
+    epicsThreadId tid;
+
+    testDiag("Pool cleaned up before a thread with a cache exits");
+
+    freeListInitPvtCache(&job.pool, BLOCKSIZE, NMALLOC, CACHESIZE);
+    job.wait = epicsEventMustCreate(epicsEventEmpty);
+    tid = startJob(waitJob, &job);
+    while (freeListItemsAvail(job.pool) != NMALLOC)
+        epicsThreadSleep(0.01);
+    freeListCleanup(job.pool);
+    epicsEventMustTrigger(job.wait);
+    epicsThreadMustJoin(tid);
+    testPass("thread exited after its pool was cleaned up");
+    epicsEventDestroy(job.wait);
+}
+
+MAIN(freeListTest)
+{
+    testPlan(10);
+
+    testPlain();
+    testCached();
+    testThreads();
+    testCleanupFirst();
+
+    return testDone();
+}
@@ -0,0 +1,186 @@
+/*************************************************************************\
+* EPICS BASE is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ * Check that gpHash tables keep their entries as they grow and once they
+ * are frozen, then measure registryFind() rates from 1 to 16 threads
+ * before and after registryFreeze().
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "epicsAtomic.h"
+#include "epicsThread.h"
+#include "epicsTime.h"
+#include "gpHash.h"
+#include "registry.h"
+#include "epicsUnitTest.h"
+#include "testMain.h"
+
+#define MAXTHREADS 16
+#define RUNTIME 0.5     /* seconds per measurement */
+#define NNAMES 4096
+
+static char names[NNAMES][16];
+static int ids[2];
+
+static int findAll(struct gphPvt *pgph, int first, int step, void *pvtid)
+{
+    int i, found = 0;
+
+    for (i = first; i < NNAMES; i += step) {
+        GPHENTRY *pentry = gphFind(pgph, names[i], pvtid);
+
+        if (pentry && pentry->name == names[i] &&
+            pentry->userPvt == &names[i])
+            found++;
+    }
+    return found;
+}
+
+static void testTable(void)
+{
+    struct gphPvt *pgph;
+    GPHENTRY *pentry;
+    int i, added = 0;
+
+    gphInitPvt(&pgph, 256);
+    for (i = 0; i < NNAMES / 2; i++) {
+        pentry = gphAdd(pgph, names[i], &ids[0]);
+        if (pentry) {
+            pentry->userPvt = &names[i];
+            added++;
+        }
+    }
+    testOk(added == NNAMES / 2, "Added %d names", added);
+    testOk(findAll(pgph, 0, 1, &ids[0]) == NNAMES / 2,
+        "Found them all after growing");
+    testOk(gphFind(pgph, names[0], &ids[1]) == NULL,
+        "Not found with another pvtid");
+    testOk(gphAdd(pgph, names[1], &ids[0]) == NULL, "Duplicate refused");
+    pentry = gphFindParse(pgph, "name17 and more", 6, &ids[0]);
+    testOk(pentry && pentry->name == names[17], "gphFindParse() name17");
+    testOk(gphFindParse(pgph, "name20480", 8, &ids[0]) == NULL,
+        "gphFindParse() name2048 not found yet");
+
+    for (i = 0; i < NNAMES / 2; i += 2)
+        gphDelete(pgph, names[i], &ids[0]);
+    testOk(findAll(pgph, 0, 2, &ids[0]) == 0 &&
+           findAll(pgph, 1, 2, &ids[0]) == NNAMES / 4,
+        "Deleted every other name");
+
+    gphFreeze(pgph);
+    testOk(findAll(pgph, 1, 2, &ids[0]) == NNAMES / 4,
+        "Found the rest when frozen");
+    added = 0;
+    for (i = NNAMES / 2; i < NNAMES; i++) {
+        pentry = gphAdd(pgph, names[i], &ids[0]);
+        if (pentry) {
+            pentry->userPvt = &names[i];
+            added++;
+        }
+    }
+    testOk(added == NNAMES / 2 &&
+           findAll(pgph, NNAMES / 2, 1, &ids[0]) == NNAMES / 2,
+        "Added and found %d more when frozen", added);
+    gphFreeMem(pgph);
+}
+
+static int jobsReady;
+static int jobsGo;
+static int jobsStop;
+static int jobsFound;
+
+static void benchThread(void *arg)
+{
+    unsigned long *pcalls = (unsigned long *) arg;
+    unsigned long calls = 0, found = 0;
+    int i = (int) *pcalls;     /* Where to start */
+
+    epicsAtomicIncrIntT(&jobsReady);
+    while (!epicsAtomicGetIntT(&jobsGo))
+        epicsThreadSleep(0.001);
+
+    while (!epicsAtomicGetIntT(&jobsStop)) {
+        int n;
+
+        for (n = 0; n < 64; n++) {
+            if (registryFind(&ids[1], names[i]) == &names[i])
+                found++;
+            i = (i + 7) % NNAMES;
+        }
+        calls += 64;
+    }
+    if (found == calls)
+        epicsAtomicIncrIntT(&jobsFound);
+    *pcalls = calls;
+}
+
+static double runBench(int nthreads)
+{
+    static unsigned long calls[MAXTHREADS];
+    epicsThreadId tid[MAXTHREADS];
+    epicsThreadOpts opts = EPICS_THREAD_OPTS_INIT;
+    epicsTimeStamp start, stop;
+    double total = 0.0;
+    int i;
+
+    opts.joinable = 1;
+    opts.stackSize = epicsThreadGetStackSize(epicsThreadStackSmall);
+    epicsAtomicSetIntT(&jobsReady, 0);
+    epicsAtomicSetIntT(&jobsGo, 0);
+    epicsAtomicSetIntT(&jobsStop, 0);
+    for (i = 0; i < nthreads; i++) {
+        calls[i] = i * (NNAMES / MAXTHREADS);
+        tid[i] = epicsThreadCreateOpt("hashBench", benchThread, &calls[i],
+            &opts);
+    }
+    while (epicsAtomicGetIntT(&jobsReady) < nthreads)
+        epicsThreadSleep(0.001);
+
+    epicsTimeGetMonotonic(&start);
+    epicsAtomicSetIntT(&jobsGo, 1);
+    epicsThreadSleep(RUNTIME);
+    epicsAtomicSetIntT(&jobsStop, 1);
+    epicsTimeGetMonotonic(&stop);
+    for (i = 0; i < nthreads; i++)
+        epicsThreadMustJoin(tid[i]);
+
+    for (i = 0; i < nthreads; i++)
+        total += calls[i];
+    return total / epicsTimeDiffInSeconds(&stop, &start);
+}
+
+MAIN(gpHashPerform)
+{
+    double lockedRate[MAXTHREADS + 1];
+    int nthreads, i, added = 0;
+
+    testPlan(11);
+
+    for (i = 0; i < NNAMES; i++)
+        sprintf(names[i], "name%d", i);
+    testTable();
+
+    for (i = 0; i < NNAMES; i++)
+        added += registryAdd(&ids[1], names[i], &names[i]);
+    testOk(added == NNAMES, "Registered %d names", added);
+
+    jobsFound = 0;
+    for (nthreads = 1; nthreads <= MAXTHREADS; nthreads *= 2)
+        lockedRate[nthreads] = runBench(nthreads);
+    registryFreeze();
+
+    testDiag("THREADS       locked       frozen");
+    for (nthreads = 1; nthreads <= MAXTHREADS; nthreads *= 2)
+        testDiag("%7d  %7.3g /sec  %7.3g /sec",
+            nthreads, lockedRate[nthreads], runBench(nthreads));
+    testOk(jobsFound == 2 * (2 * MAXTHREADS - 1),
+        "Every thread found every name it looked up");
+
+    registryFree();
+    return testDone();
+}